@@ -8,8 +8,8 @@ OWN_VERSION = (0,26,-1,1)
 SCHEMA_VERSION = 1305
 NVSCHEMA_VERSION = 1007
 MUSICSCHEMA_VERSION = 1018
-PROTO_VERSION = '75'
-PROTO_TOKEN = 'SweetRock'
+PROTO_VERSION = '76'
+PROTO_TOKEN = 'GreenMeadow'
 BACKEND_SEP = '[]:[]'
 INSTALL_PREFIX = '/usr/local'
 
@@ -94,6 +94,8 @@ AudioOutputBase::AudioOutputBase(const AudioSettings &settings) :
     audiotime(0),
     raud(0),                    waud(0),
     audbuf_timecode(0),
+    m_snapshot_seq(0),
+    m_snapshot_waud(0),         m_snapshot_timecode(0),
 
     killAudioLock(QMutex::NonRecursive),
     current_seconds(-1),        source_bitrate(-1),
@@ -339,6 +341,7 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
             VBGENERAL(QString("Cancelling time stretch"));
             bytes_per_frame = m_previousbpf;
             waud = raud = 0;
+            PublishAudiotime();
             reset_active.Ref();
         }
         else
@@ -367,6 +370,7 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
             bytes_per_frame = source_channels *
                               AudioOutputSettings::SampleSize(FORMAT_FLT);
             waud = raud = 0;
+            PublishAudiotime();
             reset_active.Ref();
         }
     }
@@ -613,6 +617,7 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
     QMutexLocker lockav(&avsync_lock);
 
     waud = raud = 0;
+    PublishAudiotime();
     reset_active.Clear();
     actually_paused = processing = m_forcedprocessing = false;
 
@@ -953,6 +958,7 @@ void AudioOutputBase::Reset()
     {
         waud = raud;        // empty ring buffer
     }
+    PublishAudiotime();
     reset_active.Ref();
     current_seconds = -1;
     was_paused = !pauseaudio;
@@ -976,8 +982,12 @@ void AudioOutputBase::Reset()
  */
 void AudioOutputBase::SetTimecode(int64_t timecode)
 {
+    QMutexLocker lock(&audio_buflock);
+    QMutexLocker lockav(&avsync_lock);
+
     audbuf_timecode = audiotime = timecode;
     frames_buffered = (timecode * source_samplerate) / 1000;
+    PublishAudiotime();
 }
 
 /**
@@ -1029,16 +1039,91 @@ int AudioOutputBase::audioready()
         return audiolen() * output_bytes_per_frame / bytes_per_frame;
 }
 
+/**
+ * Same as audioready(), counting up to the write position wpos instead
+ * of the current one
+ *
+ * wpos may be older than waud, AddData() moves waud on once per chunk
+ * before the pair is published. If the output thread has already read
+ * past wpos nothing is left before it, rather than almost the whole ring.
+ */
+int AudioOutputBase::audioready(uint wpos)
+{
+    uint rpos = raud;
+    uint cur  = waud;
+
+    // distances going forward round the ring, starting at wpos
+    uint to_read  = (rpos + kAudioRingBufferSize - wpos) % kAudioRingBufferSize;
+    uint to_write = (cur  + kAudioRingBufferSize - wpos) % kAudioRingBufferSize;
+    if (to_read && to_read <= to_write)
+        return 0;
+
+    int  len  = (wpos >= rpos) ? wpos - rpos :
+                                 kAudioRingBufferSize - (rpos - wpos);
+
+    if (passthru || enc || bytes_per_frame == output_bytes_per_frame)
+        return len;
+    else
+        return len * output_bytes_per_frame / bytes_per_frame;
+}
+
+/**
+ * Publish the current write position and the timecode of the audio at
+ * that position as one consistent pair for GetAudiotime()
+ *
+ * Must be called with audio_buflock held, so there is only ever one writer.
+ */
+void AudioOutputBase::PublishAudiotime(void)
+{
+    m_snapshot_seq.fetchAndAddOrdered(1);
+    m_snapshot_waud     = waud;
+    m_snapshot_timecode = audbuf_timecode;
+    m_snapshot_seq.fetchAndAddOrdered(1);
+}
+
+/**
+ * Read the pair published by PublishAudiotime() without locking
+ *
+ * Retries a bounded number of times if the writer is updating it
+ * concurrently, so the caller never waits. Returns false if no consistent
+ * snapshot could be read.
+ */
+bool AudioOutputBase::ReadAudiotimeSnapshot(uint &wpos, int64_t &timecode)
+{
+    for (int tries = 0; tries < 64; tries++)
+    {
+        int seq = m_snapshot_seq.fetchAndAddOrdered(0);
+        if (seq & 1)
+            continue;
+
+        wpos     = m_snapshot_waud;
+        timecode = m_snapshot_timecode;
+
+        if (m_snapshot_seq.fetchAndAddOrdered(0) == seq)
+            return true;
+    }
+    return false;
+}
+
 /**
  * Calculate the timecode of the samples that are about to become audible
  */
 int64_t AudioOutputBase::GetAudiotime(void)
 {
-    if (audbuf_timecode == 0 || !m_configure_succeeded)
+    uint    wpos;
+    int64_t timecode;
+
+    if (!m_configure_succeeded)
+        return 0;
+
+    if (!ReadAudiotimeSnapshot(wpos, timecode))
+        return audiotime;
+
+    if (timecode == 0)
         return 0;
 
     int obpf = output_bytes_per_frame;
-    int64_t oldaudiotime;
+    int64_t newaudiotime;
 
     /* We want to calculate 'audiotime', which is the timestamp of the audio
        Which is leaving the sound card at this instant.
@@ -1047,40 +1132,43 @@ int64_t AudioOutputBase::GetAudiotime(void)
 
        'effdsp' is frames/sec
 
-       'audbuf_timecode' is the timecode of the audio that has just been
-       written into the buffer.
+       'timecode' is the timecode of the audio that has just been
+       written into the buffer, at write position 'wpos'. Both are read
+       as one consistent pair, without taking any lock, so the player
+       thread never contends with the audio threads here.
 
        'totalbuffer' is the total # of bytes in our audio buffer, and the
        sound card's buffer. */
 
-
-    QMutexLocker lockav(&avsync_lock);
-
     int soundcard_buffer = GetBufferedOnSoundcard(); // bytes
 
     /* audioready tells us how many bytes are in audiobuffer
        scaled appropriately if output format != internal format */
-    int main_buffer = audioready();
-
-    oldaudiotime = audiotime;
+    int main_buffer = audioready(wpos);
 
     /* timecode is the stretch adjusted version
        of major post-stretched buffer contents
        processing latencies are catered for in AddData/SetAudiotime
        to eliminate race */
-    audiotime = audbuf_timecode - (
+    newaudiotime = timecode - (
         ((int64_t)(main_buffer + soundcard_buffer) * eff_stretchfactor) /
         (effdsp * obpf));
 
     /* audiotime should never go backwards, but we might get a negative
        value if GetBufferedOnSoundcard() isn't updated by the driver very
-       quickly (e.g. ALSA) */
-    if (audiotime < oldaudiotime)
-        audiotime = oldaudiotime;
+       quickly (e.g. ALSA). Only clamp if nobody else is updating
+       'audiotime' right now, never wait for it. */
+    if (avsync_lock.tryLock())
+    {
+        if (newaudiotime < audiotime)
+            newaudiotime = audiotime;
+        audiotime = newaudiotime;
+        avsync_lock.unlock();
+    }
 
     VBAUDIOTS(QString("GetAudiotime audt=%1 atc=%2 mb=%3 sb=%4 tb=%5 "
                       "sr=%6 obpf=%7 bpf=%8 sf=%9 %10 %11")
-              .arg(audiotime).arg(audbuf_timecode)
+              .arg(newaudiotime).arg(timecode)
               .arg(main_buffer)
               .arg(soundcard_buffer)
               .arg(main_buffer+soundcard_buffer)
@@ -1090,7 +1178,7 @@ int64_t AudioOutputBase::GetAudiotime(void)
                    (effdsp * obpf))
               );
 
-    return audiotime;
+    return newaudiotime;
 }
 
 /**
@@ -1130,7 +1218,12 @@ void AudioOutputBase::SetAudiotime(int frames, int64_t timecode)
     // timecode will always be monotonic asc if not seeked and reset
     // happens if seek or pause happens
     if (audbuf_timecode < old_audbuf_timecode)
+    {
+        QMutexLocker lockav(&avsync_lock);
         audiotime = 0;
+    }
+
+    PublishAudiotime();
 
     VBAUDIOTS(QString("SetAudiotime atc=%1 tc=%2 f=%3 pfu=%4 pfs=%5")
               .arg(audbuf_timecode)
@@ -1435,6 +1528,13 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
     int maxframes = (kAudioSRCInputSize / source_channels) & ~0xf;
     int offset = 0;
 
+    // When downmixing, the software volume is applied by the fused
+    // conversion/downmix pass rather than by a separate pass further down
+    bool  sw_volume    = internal_vol && SWVolume();
+    bool  fused_volume = sw_volume && needs_downmix;
+    float gain         = fused_volume ?
+        AudioOutputUtil::VolumeGain(volume, music, false) : 1.0f;
+
     while(frames_remaining > 0)
     {
         buffer = (char *)in_buffer + offset;
@@ -1449,19 +1549,24 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
                 len = frames * source_bytes_per_frame;
                 offset += len;
             }
-            // Convert to floats
-            len = AudioOutputUtil::toFloat(format, src_in, buffer, len);
+
+            if (needs_downmix)
+            {
+                // Convert to floats, adjust volume and downmix in one pass
+                if (AudioOutputDownmix::DownmixFrames(
+                        format, source_channels, configured_channels,
+                        src_in, buffer, frames, gain) < 0)
+                    VBERROR("Error occurred while downmixing");
+            }
+            else
+            {
+                // Convert to floats
+                len = AudioOutputUtil::toFloat(format, src_in, buffer, len);
+            }
         }
 
         frames_remaining -= frames;
 
-        // Perform downmix if necessary
-        if (needs_downmix)
-            if(AudioOutputDownmix::DownmixFrames(source_channels,
-                                                 configured_channels,
-                                                 src_in, src_in, frames) < 0)
-                VBERROR("Error occurred while downmixing");
-
         // Resample if necessary
         if (need_resampler && src_ctx)
         {
@@ -1538,7 +1643,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
             org_waud = (org_waud + nFrames * bpf) % kAudioRingBufferSize;
         }
 
-        if (internal_vol && SWVolume())
+        if (sw_volume && !fused_volume)
         {
             org_waud    = waud;
             int num     = len;
@@ -1656,7 +1761,9 @@ void AudioOutputBase::OutputAudioLoop(void)
             }
 
             actually_paused = true;
+            avsync_lock.lock();
             audiotime = 0; // mark 'audiotime' as invalid.
+            avsync_lock.unlock();
 
             WriteAudio(zeros, zero_fragment_size);
             continue;
@@ -11,6 +11,7 @@ using namespace std;
 // Qt headers
 #include <QString>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QWaitCondition>
 
 // MythTV headers
@@ -151,6 +152,10 @@ class AudioOutputBase : public AudioOutput, public MThread
     inline int audiolen(); // number of valid bytes in audio buffer
     int audiofree();       // number of free bytes in audio buffer
     int audioready();      // number of bytes ready to be written
+    int audioready(uint wpos); // same, up to write position wpos
+
+    void PublishAudiotime(void);
+    bool ReadAudiotimeSnapshot(uint &wpos, int64_t &timecode);
 
     void SetStretchFactorLocked(float factor);
 
@@ -237,8 +242,8 @@ class AudioOutputBase : public AudioOutput, public MThread
     QMutex audio_buflock;
 
     /**
-     *  must hold avsync_lock to read or write 'audiotime' and
-     *  'audiotime_updated'
+     *  must hold avsync_lock to write 'audiotime', GetAudiotime() only
+     *  ever tries to take it so the player thread never waits on it
      */
     QMutex avsync_lock;
 
@@ -255,6 +260,15 @@ class AudioOutputBase : public AudioOutput, public MThread
      * timecode of audio most recently placed into buffer
      */
     int64_t audbuf_timecode;
+    /**
+     * Lock free snapshot of the (waud, audbuf_timecode) pair, published
+     * by PublishAudiotime() with audio_buflock held and read without any
+     * lock by GetAudiotime(). The sequence number is odd while the
+     * snapshot is being updated.
+     */
+    QAtomicInt       m_snapshot_seq;
+    volatile uint    m_snapshot_waud;
+    volatile int64_t m_snapshot_timecode;
     AsyncLooseLock reset_active;
 
     QMutex killAudioLock;
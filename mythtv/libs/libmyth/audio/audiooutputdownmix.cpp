@@ -16,11 +16,16 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include "mythconfig.h"
 #include "audiooutputbase.h"
 #include "audiooutputdownmix.h"
 
 #include "string.h"
 
+#if ARCH_X86 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define LOC QString("Downmixer: ")
 
 /*
@@ -209,3 +214,144 @@ int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
 
     return frames;
 }
+
+static inline float LoadSample(const uchar *s, int)     { return *s - 0x80; }
+static inline float LoadSample(const short *s, int)     { return *s; }
+static inline float LoadSample(const int *s, int shift) { return *s >> shift; }
+static inline float LoadSample(const float *s, int)     { return *s; }
+
+/*
+ Convert, scale and downmix in a single pass over the source samples.
+ The sample format normalisation factor and the volume gain are folded
+ into the downmix coefficients up front, so each output sample costs one
+ multiply-add per input channel and the intermediate float buffer used by
+ toFloat() is never written or read back.
+ */
+template <class AudioDataType, int channels_out>
+static void _ConvertDownmix(float *dst, const AudioDataType *src,
+                            int channels_in,
+                            const float coef[8][channels_out],
+                            float scale, int shift, int frames)
+{
+    float m[8][channels_out];
+    float in[8];
+
+    for (int j = 0; j < channels_in; j++)
+        for (int i = 0; i < channels_out; i++)
+            m[j][i] = coef[j][i] * scale;
+
+    int n = 0;
+
+#if ARCH_X86 && defined(__SSE2__)
+    if (channels_out == 2)
+    {
+        // Two frames per iteration: acc = [L0 R0 L1 R1]
+        __m128 mc[8];
+        for (int j = 0; j < channels_in; j++)
+            mc[j] = _mm_setr_ps(m[j][0], m[j][1], m[j][0], m[j][1]);
+
+        for (; n + 1 < frames; n += 2)
+        {
+            __m128 acc = _mm_setzero_ps();
+            for (int j = 0; j < channels_in; j++)
+            {
+                float a = LoadSample(src + j, shift);
+                float b = LoadSample(src + channels_in + j, shift);
+                acc = _mm_add_ps(acc,
+                                 _mm_mul_ps(_mm_setr_ps(a, a, b, b), mc[j]));
+            }
+            _mm_storeu_ps(dst, acc);
+            src += channels_in * 2;
+            dst += 4;
+        }
+    }
+#endif
+
+    for (; n < frames; n++)
+    {
+        for (int j = 0; j < channels_in; j++)
+            in[j] = LoadSample(src + j, shift);
+
+        for (int i = 0; i < channels_out; i++)
+        {
+            float tmp = 0.0f;
+            for (int j = 0; j < channels_in; j++)
+                tmp += in[j] * m[j][i];
+            *dst++ = tmp;
+        }
+        src += channels_in;
+    }
+}
+
+template <int channels_out>
+static int _ConvertDownmix(AudioFormat format, float *dst, const void *src,
+                           int channels_in,
+                           const float coef[8][channels_out],
+                           float gain, int frames)
+{
+    int bits  = AudioOutputSettings::FormatToBits(format);
+    int shift = (format == FORMAT_S24LSB) ? 0 : 32 - bits;
+
+    // Same normalisation as AudioOutputUtil::toFloat()
+    switch (format)
+    {
+        case FORMAT_U8:
+            _ConvertDownmix<uchar, channels_out>(
+                dst, (const uchar *)src, channels_in, coef,
+                gain / ((1<<7) - 1), 0, frames);
+            break;
+        case FORMAT_S16:
+            _ConvertDownmix<short, channels_out>(
+                dst, (const short *)src, channels_in, coef,
+                gain / ((1<<15) - 1), 0, frames);
+            break;
+        case FORMAT_S24:
+        case FORMAT_S24LSB:
+        case FORMAT_S32:
+            _ConvertDownmix<int, channels_out>(
+                dst, (const int *)src, channels_in, coef,
+                gain / ((uint)(1<<(bits-1)) - 128), shift, frames);
+            break;
+        case FORMAT_FLT:
+            _ConvertDownmix<float, channels_out>(
+                dst, (const float *)src, channels_in, coef,
+                gain, 0, frames);
+            break;
+        default:
+            return -1;
+    }
+
+    return frames;
+}
+
+/**
+ * Convert samples of any AudioFormat to floats, apply a volume gain and
+ * downmix them, in one pass.
+ *
+ * Equivalent to AudioOutputUtil::toFloat() followed by the float
+ * DownmixFrames() and AudioOutputUtil::AdjustVolume(), dst must not
+ * overlap src.
+ */
+int AudioOutputDownmix::DownmixFrames(AudioFormat format,
+                                      int channels_in, int channels_out,
+                                      float *dst, const void *src, int frames,
+                                      float gain)
+{
+    if (channels_in < channels_out || channels_in > 8)
+        return -1;
+
+    if (channels_out == 2)
+    {
+        return _ConvertDownmix<2>(format, dst, src, channels_in,
+                                  stereo_matrix[channels_in - 1],
+                                  gain, frames);
+    }
+    else if (channels_out == 6)
+    {
+        return _ConvertDownmix<6>(format, dst, src, channels_in,
+                                  s51_matrix[channels_in - 6],
+                                  gain, frames);
+    }
+
+    return -1;
+}
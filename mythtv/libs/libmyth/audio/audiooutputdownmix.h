@@ -1,11 +1,17 @@
 #ifndef AUDIOOUTPUTDOWNMIX
 #define AUDIOOUTPUTDOWNMIX
 
+#include "audiooutputsettings.h"
+
 class AudioOutputDownmix
 {
 public:
     static int DownmixFrames(int channels_in, int  channels_out,
                              float *dst, float *src, int frames);
+    static int DownmixFrames(AudioFormat format,
+                             int channels_in, int channels_out,
+                             float *dst, const void *src, int frames,
+                             float gain = 1.0f);
 };
 
 #endif
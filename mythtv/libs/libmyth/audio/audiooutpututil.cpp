@@ -536,18 +536,14 @@ void AudioOutputUtil::MonoToStereo(void *dst, void *src, int samples)
 }
 
 /**
- * Adjust the volume of samples
+ * Returns the linear gain AdjustVolume() applies for a volume setting
  *
  * Makes a crude attempt to normalise the relative volumes of
  * PCM from mythmusic, PCM from video and upmixed AC-3
  */
-void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
-                                   bool music, bool upmix)
+float AudioOutputUtil::VolumeGain(int volume, bool music, bool upmix)
 {
-    float g     = volume / 100.0f;
-    float *fptr = (float *)buf;
-    int samples = len >> 2;
-    int i       = 0;
+    float g = volume / 100.0f;
 
     // Should be exponential - this'll do
     g *= g;
@@ -560,6 +556,20 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
     if (music)
         g *= 0.4f;
 
+    return g;
+}
+
+/**
+ * Adjust the volume of samples
+ */
+void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
+                                   bool music, bool upmix)
+{
+    float g     = VolumeGain(volume, music, upmix);
+    float *fptr = (float *)buf;
+    int samples = len >> 2;
+    int i       = 0;
+
     if (g == 1.0f)
         return;
 
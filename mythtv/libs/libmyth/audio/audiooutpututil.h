@@ -13,6 +13,7 @@ class MPUBLIC AudioOutputUtil
     static int  toFloat(AudioFormat format, void *out, void *in, int bytes);
     static int  fromFloat(AudioFormat format, void *out, void *in, int bytes);
     static void MonoToStereo(void *dst, void *src, int samples);
+    static float VolumeGain(int volume, bool music, bool upmix);
     static void AdjustVolume(void *buffer, int len, int volume,
                              bool music, bool upmix);
     static void MuteChannel(int obits, int channels, int ch,
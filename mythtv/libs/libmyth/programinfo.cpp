@@ -4732,15 +4732,7 @@ bool LoadFromRecorded(
     const QMap<QString, ProgramInfo*> &recMap,
     int sort)
 {
-    destination.clear();
-
-    QString     fs_db_name = "";
-    QDateTime   rectime    = MythDate::current().addSecs(
-        -gCoreContext->GetNumSetting("RecordOverTime"));
-
-    // ----------------------------------------------------------------------
-
-    QString thequery = ProgramInfo::kFromRecordedQuery;
+    QString thequery;
     if (possiblyInProgressRecordingsOnly)
         thequery += "WHERE r.endtime >= NOW() AND r.starttime <= NOW() ";
 
@@ -4749,8 +4741,43 @@ bool LoadFromRecorded(
     if (sort < 0)
         thequery += "DESC ";
 
+    return LoadFromRecorded(destination, thequery, MSqlBindings(),
+                            inUseMap, isJobRunning, recMap);
+}
+
+/** \fn LoadFromRecorded(ProgramList&, const QString&, const MSqlBindings&,
+ *                        const QMap<QString,uint32_t>&,
+ *                        const QMap<QString,bool>&,
+ *                        const QMap<QString, ProgramInfo*>&)
+ *  \brief Loads the recordings selected by sql, which is appended to
+ *         ProgramInfo::kFromRecordedQuery and may contain WHERE, ORDER BY
+ *         and LIMIT clauses on the "r" (recorded) table.
+ */
+bool LoadFromRecorded(
+    ProgramList &destination,
+    const QString &sql,
+    const MSqlBindings &bindings,
+    const QMap<QString,uint32_t> &inUseMap,
+    const QMap<QString,bool> &isJobRunning,
+    const QMap<QString, ProgramInfo*> &recMap)
+{
+    destination.clear();
+
+    QDateTime   rectime    = MythDate::current().addSecs(
+        -gCoreContext->GetNumSetting("RecordOverTime"));
+
+    // ----------------------------------------------------------------------
+
+    QString thequery = ProgramInfo::kFromRecordedQuery + sql;
+
     MSqlQuery query(MSqlQuery::InitCon());
     query.prepare(thequery);
+    MSqlBindings::const_iterator bit;
+    for (bit = bindings.begin(); bit != bindings.end(); ++bit)
+    {
+        if (thequery.contains(bit.key()))
+            query.bindValue(bit.key(), bit.value());
+    }
 
     if (!query.exec())
     {
@@ -738,6 +738,14 @@ MPUBLIC bool LoadFromRecorded(
     const QMap<QString, ProgramInfo*> &recMap,
     int                 sort = 0);
 
+MPUBLIC bool LoadFromRecorded(
+    ProgramList        &destination,
+    const QString      &sql,
+    const MSqlBindings &bindings,
+    const QMap<QString,uint32_t> &inUseMap,
+    const QMap<QString,bool> &isJobRunning,
+    const QMap<QString, ProgramInfo*> &recMap);
+
 template<typename TYPE>
 bool LoadFromScheduler(
     AutoDeleteDeque<TYPE*> &destination,
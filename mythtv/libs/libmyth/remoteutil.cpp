@@ -342,6 +342,79 @@ QDateTime RemoteGetPreviewIfModified(
     return retdatetime;
 }
 
+/** \brief Fetches scaled previews of many recordings in one round trip.
+ *
+ *  \param etags   ETags the caller already has, one per pginfo, an empty
+ *                 string (or a short list) means "not cached".
+ *  \param size    wanted size, a zero dimension keeps the aspect ratio
+ *  \param format  "jpg" or "webp"
+ *  \param secsin  preview offset in seconds, -1 for the default preview
+ */
+bool RemoteGetPreviews(
+    const vector<ProgramInfo *> &pginfos, const QStringList &etags,
+    const QSize &size, const QString &format, int secsin,
+    QList<RemotePreview> &previews)
+{
+    QString loc("RemoteGetPreviews: ");
+
+    previews.clear();
+    if (pginfos.empty())
+        return true;
+
+    QStringList strlist("QUERY_PREVIEWS");
+    strlist << QString::number(size.width())
+            << QString::number(size.height())
+            << format
+            << QString::number(secsin)
+            << QString::number(pginfos.size());
+    for (uint i = 0; i < pginfos.size(); i++)
+    {
+        QString etag = ((int)i < etags.size()) ? etags[i] : QString();
+        strlist << (etag.isEmpty() ? QString("<EMPTY>") : etag);
+        pginfos[i]->ToStringList(strlist);
+    }
+
+    if (!gCoreContext->SendReceiveStringList(strlist) ||
+        strlist.size() < 2 || strlist[0] != "OK" ||
+        strlist.size() < 2 + (int)pginfos.size() * 6)
+    {
+        LOG(VB_GENERAL, LOG_ERR, loc + "Remote error" +
+            ((strlist.size() >= 2) ? (":\n\t\t\t" + strlist[1]) : ""));
+        return false;
+    }
+
+    for (uint i = 0; i < pginfos.size(); i++)
+    {
+        QStringList::const_iterator it = strlist.begin() + 2 + i * 6;
+
+        RemotePreview preview;
+        preview.status       = *it++;
+        preview.etag         = *it++;
+        preview.format       = *it++;
+        preview.lastModified = MythDate::fromString(*it++);
+        int length           = (*it++).toInt();
+        if (preview.status == "OK")
+        {
+            preview.data = QByteArray::fromBase64((*it).toAscii());
+            if (preview.data.size() < length)
+            {
+                LOG(VB_GENERAL, LOG_ERR, loc +
+                    QString("Preview size check failed %1 < %2")
+                        .arg(preview.data.size()).arg(length));
+                preview.status = "ERROR";
+                preview.data.clear();
+            }
+            else
+            {
+                preview.data.resize(length);
+            }
+        }
+        previews.push_back(preview);
+    }
+
+    return true;
+}
+
 bool RemoteFillProgramInfo(ProgramInfo &pginfo, const QString &playbackhost)
 {
     QStringList strlist( "FILL_PROGRAM_INFO" );
@@ -3,6 +3,7 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QSize>
 
 #include <vector>
 using namespace std;
@@ -12,6 +13,17 @@ using namespace std;
 class ProgramInfo;
 class MythEvent;
 
+/// One entry of the reply to RemoteGetPreviews()
+class MPUBLIC RemotePreview
+{
+  public:
+    QString    status; ///< OK, NOT_MODIFIED, PENDING or ERROR
+    QString    etag;
+    QString    format;
+    QDateTime  lastModified; ///< when the backend generated the preview
+    QByteArray data;   ///< encoded image, empty unless status is OK
+};
+
 MPUBLIC vector<ProgramInfo *> *RemoteGetRecordedList(int sort);
 MPUBLIC bool RemoteGetLoad(float load[3]);
 MPUBLIC bool RemoteGetUptime(time_t &uptime);
@@ -34,6 +46,10 @@ MPUBLIC vector<ProgramInfo *> *RemoteGetConflictList(const ProgramInfo *pginfo);
 MPUBLIC QDateTime RemoteGetPreviewLastModified(const ProgramInfo *pginfo);
 MPUBLIC QDateTime RemoteGetPreviewIfModified(
     const ProgramInfo &pginfo, const QString &cachefile);
+MPUBLIC bool RemoteGetPreviews(
+    const vector<ProgramInfo *> &pginfos, const QStringList &etags,
+    const QSize &size, const QString &format, int secsin,
+    QList<RemotePreview> &previews);
 MPUBLIC bool RemoteFillProgramInfo(
     ProgramInfo &pginfo, const QString &playbackhostname);
 MPUBLIC QStringList RemoteRecordings(void);
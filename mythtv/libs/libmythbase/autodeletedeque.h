@@ -64,6 +64,7 @@ class AutoDeleteDeque
     size_t size(void) const { return list.size(); }
     void push_front(T info) { list.push_front(info); }
     void push_back( T info) { list.push_back( info); }
+    iterator insert(iterator it, T info) { return list.insert(it, info); }
 
     // compatibility with old Q3PtrList
     void setAutoDelete(bool auto_delete) { autodelete = auto_delete; }
@@ -35,8 +35,8 @@
  *       mythtv/bindings/python/MythTV/static.py (version number)
  *       mythtv/bindings/python/MythTV/mythproto.py (layout)
  */
-#define MYTH_PROTO_VERSION "75"
-#define MYTH_PROTO_TOKEN "SweetRock"
+#define MYTH_PROTO_VERSION "76"
+#define MYTH_PROTO_TOKEN "GreenMeadow"
 
 /** \brief Increment this whenever the MythTV core database schema changes.
  *
@@ -6,6 +6,7 @@
 #include "mythcorecontext.h"
 #include "dbaccess.h"
 #include "dirscan.h"
+#include "videodirindex.h"
 #include "remoteutil.h"
 #include "mythcontext.h"
 #include "mythlogging.h"
@@ -46,21 +47,16 @@ namespace
         }
     };
 
-    bool scan_dir(const QString &start_path, DirectoryHandler *handler,
-                  const ext_lookup &ext_settings)
+    bool list_dir(const QString &start_path, VideoDirIndex::EntryList &entries)
     {
-        QDir d(start_path);
+        QFileInfo dir_info(start_path);
 
         // Return a fail if directory doesn't exist.
-        if (!d.exists())
+        if (!dir_info.exists() || !dir_info.isDir())
             return false;
 
+        QDir d(start_path);
         QFileInfoList list = d.entryInfoList();
-        // An empty directory is fine
-        if (!list.size())
-            return true;
-
-        QDir dir_tester;
 
         for (QFileInfoList::iterator p = list.begin(); p != list.end(); ++p)
         {
@@ -71,35 +67,82 @@ namespace
                 continue;
             }
 
-            if (!p->isDir() &&
-                ext_settings.extension_ignored(p->suffix())) continue;
+            VideoDirIndex::Entry entry;
+            entry.name = p->fileName();
+            entry.isDir = p->isDir();
+            entries.push_back(entry);
+        }
+
+        return true;
+    }
+
+    bool get_entries(const QString &start_path, VideoDirIndex *index,
+                     VideoDirIndex::EntryList &entries)
+    {
+        // Unchanged directories are not listed again, see VideoDirIndex.
+        if (index && index->Lookup(start_path, entries))
+            return true;
+
+        uint mtime = QFileInfo(start_path).lastModified().toTime_t();
+
+        if (!list_dir(start_path, entries))
+            return false;
+
+        if (index)
+            index->Store(start_path, mtime, entries);
+
+        return true;
+    }
+
+    bool is_disc(const VideoDirIndex::EntryList &entries)
+    {
+        VideoDirIndex::EntryList::const_iterator p = entries.begin();
+        for (; p != entries.end(); ++p)
+        {
+            if (p->isDir && (p->name == "VIDEO_TS" || p->name == "BDMV"))
+                return true;
+        }
+        return false;
+    }
+
+    void scan_entries(const QString &start_path,
+                      const VideoDirIndex::EntryList &entries,
+                      DirectoryHandler *handler,
+                      const ext_lookup &ext_settings, VideoDirIndex *index)
+    {
+        QDir d(start_path);
+
+        VideoDirIndex::EntryList::const_iterator p = entries.begin();
+        for (; p != entries.end(); ++p)
+        {
+            QString suffix = QFileInfo(p->name).suffix();
+
+            if (!p->isDir &&
+                ext_settings.extension_ignored(suffix)) continue;
+
+            QString abs_path = d.absoluteFilePath(p->name);
 
             bool add_as_file = true;
 
-            if (p->isDir())
+            if (p->isDir)
             {
-                add_as_file = false;
+                // Since we are dealing with a subdirectory failure is fine,
+                // so we'll just ignore the failue and continue
+                VideoDirIndex::EntryList sub_entries;
+                bool listed = get_entries(abs_path, index, sub_entries);
 
-                dir_tester.setPath(p->absoluteFilePath() + "/VIDEO_TS");
-                QDir bd_dir_tester;
-                bd_dir_tester.setPath(p->absoluteFilePath() + "/BDMV");
-                if (dir_tester.exists() || bd_dir_tester.exists())
-                {
-                    add_as_file = true;
-                }
-                else
+                if (!listed || !is_disc(sub_entries))
                 {
+                    add_as_file = false;
 #if 0
-                    LOG(VB_GENERAL, LOG_DEBUG, 
-                        QString(" -- Dir : %1").arg(p->absoluteFilePath()));
+                    LOG(VB_GENERAL, LOG_DEBUG,
+                        QString(" -- Dir : %1").arg(abs_path));
 #endif
-                    DirectoryHandler *dh =
-                            handler->newDir(p->fileName(),
-                                            p->absoluteFilePath());
+                    DirectoryHandler *dh = handler->newDir(p->name, abs_path);
 
-                    // Since we are dealing with a subdirectory failure is fine,
-                    // so we'll just ignore the failue and continue
-                    (void) scan_dir(p->absoluteFilePath(), dh, ext_settings);
+                    if (listed)
+                        scan_entries(abs_path, sub_entries, dh, ext_settings,
+                                     index);
                 }
             }
 
@@ -107,12 +150,23 @@ namespace
             {
 #if 0
                 LOG(VB_GENERAL, LOG_DEBUG,
-                    QString(" -- File : %1").arg(p->fileName()));
+                    QString(" -- File : %1").arg(p->name));
 #endif
-                handler->handleFile(p->fileName(), p->absoluteFilePath(),
-                                    p->suffix(), "");
+                handler->handleFile(p->name, abs_path, suffix, "");
             }
         }
+    }
+
+    bool scan_dir(const QString &start_path, DirectoryHandler *handler,
+                  const ext_lookup &ext_settings, VideoDirIndex *index)
+    {
+        VideoDirIndex::EntryList entries;
+
+        if (!get_entries(start_path, index, entries))
+            return false;
+
+        // An empty directory is fine
+        scan_entries(start_path, entries, handler, ext_settings, index);
 
         return true;
     }
@@ -232,7 +286,7 @@ namespace
 
 bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions)
+        bool list_unknown_extensions, VideoDirIndex *index)
 {
     ext_lookup extlookup(ext_disposition, list_unknown_extensions);
 
@@ -244,7 +298,7 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        if (!scan_dir(start_path, handler, extlookup, index))
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
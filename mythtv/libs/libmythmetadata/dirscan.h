@@ -3,6 +3,8 @@
 
 #include "mythmetaexp.h"
 
+class VideoDirIndex;
+
 class META_PUBLIC DirectoryHandler
 {
   public:
@@ -17,6 +19,6 @@ class META_PUBLIC DirectoryHandler
 
 META_PUBLIC bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions);
+        bool list_unknown_extensions, VideoDirIndex *index = NULL);
 
 #endif // DIRSCAN_H_
@@ -0,0 +1,344 @@
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QFileSystemWatcher>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QFile>
+
+#ifdef linux
+#include <sys/vfs.h>
+#endif
+
+#include "videodirindex.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythdirs.h"
+#include "mythdate.h"
+
+#define LOC QString("VideoDirIndex: ")
+
+/// inotify watches are a limited resource (fs.inotify.max_user_watches),
+/// beyond this many directories we fall back to checking mtimes.
+const int     VideoDirIndex::kMaxWatches   = 4096;
+const quint32 VideoDirIndex::kIndexVersion = 1;
+
+QDataStream &operator<<(QDataStream &out,
+                        const VideoDirIndex::Entry &entry)
+{
+    return out << entry.name << entry.isDir;
+}
+
+QDataStream &operator>>(QDataStream &in, VideoDirIndex::Entry &entry)
+{
+    return in >> entry.name >> entry.isDir;
+}
+
+QDataStream &operator<<(QDataStream &out, const VideoDirIndex::Dir &dir)
+{
+    return out << dir.mtime << dir.scanned << dir.entries;
+}
+
+QDataStream &operator>>(QDataStream &in, VideoDirIndex::Dir &dir)
+{
+    return in >> dir.mtime >> dir.scanned >> dir.entries;
+}
+
+/// inotify only sees changes made through this host, which on a network
+/// filesystem misses everything done by the NAS or other clients.
+static bool is_local_dir(const QString &path)
+{
+#ifdef linux
+    struct statfs statbuf;
+    memset(&statbuf, 0, sizeof(statbuf));
+
+    if (statfs(path.toLocal8Bit().constData(), &statbuf))
+        return false;
+
+    long fstype = statbuf.f_type;
+    return !((fstype == 0x6969)  ||             // NFS
+             (fstype == 0x517B)  ||             // SMB
+             (fstype == (long)0xFF534D42));     // CIFS
+#else
+    (void) path;
+    return false;
+#endif
+}
+
+VideoDirIndex *VideoDirIndex::GetIndex(void)
+{
+    static QMutex lock;
+    static VideoDirIndex *index = NULL;
+
+    QMutexLocker locker(&lock);
+    if (!index)
+    {
+        index = new VideoDirIndex();
+        // The watcher needs an event loop, the scanner thread has none.
+        index->moveToThread(QCoreApplication::instance()->thread());
+    }
+    return index;
+}
+
+VideoDirIndex::VideoDirIndex() :
+    m_lastFullScan(0), m_fullRescan(false), m_hits(0), m_misses(0),
+    m_watcher(new QFileSystemWatcher(this))
+{
+    connect(m_watcher, SIGNAL(directoryChanged(const QString&)),
+            SLOT(DirectoryChanged(const QString&)));
+    Load();
+}
+
+VideoDirIndex::~VideoDirIndex()
+{
+}
+
+QString VideoDirIndex::GetIndexFile(void)
+{
+    return GetConfDir() + "/videoscan.index";
+}
+
+/** \fn VideoDirIndex::BeginScan(bool)
+ *  \brief Called by the scanner before it walks the video directories.
+ *
+ *  With fullRescan set every directory is listed again, regardless of
+ *  the index, and the index is rebuilt from the result.
+ */
+void VideoDirIndex::BeginScan(bool fullRescan)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_fullRescan = fullRescan;
+    m_visited.clear();
+    m_hits = m_misses = 0;
+
+    if (fullRescan)
+    {
+        m_dirs.clear();
+        m_trusted.clear();
+    }
+}
+
+/** \fn VideoDirIndex::EndScan(void)
+ *  \brief Drops directories the scan did not reach and saves the index.
+ */
+void VideoDirIndex::EndScan(void)
+{
+    {
+        QMutexLocker locker(&m_lock);
+
+        QMap<QString, Dir>::iterator it = m_dirs.begin();
+        while (it != m_dirs.end())
+        {
+            if (!m_visited.contains(it.key()))
+            {
+                m_trusted.remove(it.key());
+                it = m_dirs.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        if (m_fullRescan)
+            m_lastFullScan = MythDate::current().toTime_t();
+
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("%1 directories unchanged, %2 listed%3")
+            .arg(m_hits).arg(m_misses)
+            .arg(m_fullRescan ? " (full rescan)" : ""));
+    }
+
+    Save();
+
+    QMetaObject::invokeMethod(this, "UpdateWatches", Qt::QueuedConnection);
+}
+
+/** \fn VideoDirIndex::NeedsFullRescan(void) const
+ *  \brief Returns true if the index is older than "VideoScanFullRescanDays",
+ *         as a safety net for filesystems with unreliable mtimes.
+ */
+bool VideoDirIndex::NeedsFullRescan(void) const
+{
+    int days = gCoreContext->GetNumSetting("VideoScanFullRescanDays", 7);
+
+    QMutexLocker locker(&m_lock);
+
+    if (!m_lastFullScan || m_dirs.empty())
+        return true;
+
+    if (days <= 0)
+        return false;
+
+    uint now = MythDate::current().toTime_t();
+    return now - m_lastFullScan > (uint)days * 24 * 60 * 60;
+}
+
+/** \fn VideoDirIndex::Lookup(const QString&, EntryList&)
+ *  \brief Returns the indexed entries of path if it has not changed
+ *         since it was listed.
+ *
+ *  When this returns false the caller is expected to list the directory
+ *  and Store() the result.
+ */
+bool VideoDirIndex::Lookup(const QString &path, EntryList &entries)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_visited.insert(path);
+
+    QMap<QString, Dir>::const_iterator it = m_dirs.find(path);
+    bool found = !m_fullRescan && it != m_dirs.end() && !m_dirty.contains(path);
+
+    if (found && !m_trusted.contains(path))
+    {
+        // A directory changed in the same second it was listed has the
+        // same mtime as the listing, so only trust strictly older ones.
+        QFileInfo fi(path);
+        uint mtime = fi.exists() ? fi.lastModified().toTime_t() : 0;
+        found = mtime && mtime == (*it).mtime && mtime < (*it).scanned;
+
+        if (found && m_watched.contains(path))
+            m_trusted.insert(path);
+    }
+
+    if (!found)
+    {
+        // Anything the watcher reports from here on is newer than the
+        // listing the caller is about to make.
+        m_dirty.remove(path);
+        m_trusted.remove(path);
+        m_misses++;
+        return false;
+    }
+
+    entries = (*it).entries;
+    m_hits++;
+    return true;
+}
+
+void VideoDirIndex::Store(const QString &path, uint mtime,
+                          const EntryList &entries)
+{
+    QMutexLocker locker(&m_lock);
+
+    Dir &dir = m_dirs[path];
+    dir.mtime   = mtime;
+    dir.scanned = MythDate::current().toTime_t();
+    dir.entries = entries;
+}
+
+/** \fn VideoDirIndex::UpdateWatches(void)
+ *  \brief Watches every indexed directory on a local filesystem, up to
+ *         kMaxWatches.
+ */
+void VideoDirIndex::UpdateWatches(void)
+{
+    QStringList dirs;
+    {
+        QMutexLocker locker(&m_lock);
+        dirs = m_dirs.keys();
+    }
+
+    QStringList wanted;
+    QStringList::const_iterator dit = dirs.begin();
+    for (; dit != dirs.end() && wanted.size() < kMaxWatches; ++dit)
+    {
+        if (is_local_dir(*dit))
+            wanted.push_back(*dit);
+    }
+
+    QSet<QString> wantedset = wanted.toSet();
+    QStringList current = m_watcher->directories();
+    QStringList stale;
+    QStringList::const_iterator it = current.begin();
+    for (; it != current.end(); ++it)
+    {
+        if (!wantedset.contains(*it))
+            stale.push_back(*it);
+    }
+
+    if (!stale.empty())
+        m_watcher->removePaths(stale);
+
+    QStringList added;
+    QSet<QString> currentset = current.toSet();
+    for (it = wanted.begin(); it != wanted.end(); ++it)
+    {
+        if (!currentset.contains(*it))
+            added.push_back(*it);
+    }
+
+    if (!added.empty())
+        m_watcher->addPaths(added);
+
+    QStringList watched = m_watcher->directories();
+
+    QMutexLocker locker(&m_lock);
+    m_watched = watched.toSet();
+    m_trusted.intersect(m_watched);
+
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Watching %1 of %2 directories")
+        .arg(m_watched.size()).arg(m_dirs.size()));
+}
+
+void VideoDirIndex::DirectoryChanged(const QString &path)
+{
+    LOG(VB_FILE, LOG_DEBUG, LOC + QString("'%1' changed").arg(path));
+
+    QMutexLocker locker(&m_lock);
+    m_dirty.insert(path);
+    m_trusted.remove(path);
+}
+
+void VideoDirIndex::Load(void)
+{
+    QFile file(GetIndexFile());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    quint32 version;
+    in >> version;
+    if (version != kIndexVersion)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC + "Ignoring index of an older version");
+        return;
+    }
+
+    QMutexLocker locker(&m_lock);
+    in >> m_lastFullScan >> m_dirs;
+
+    if (in.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to read '%1'").arg(GetIndexFile()));
+        m_lastFullScan = 0;
+        m_dirs.clear();
+    }
+}
+
+void VideoDirIndex::Save(void)
+{
+    QString filename = GetIndexFile();
+    QFile file(filename + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to write '%1'").arg(file.fileName()));
+        return;
+    }
+
+    QDataStream out(&file);
+    {
+        QMutexLocker locker(&m_lock);
+        out << kIndexVersion << m_lastFullScan << m_dirs;
+    }
+    file.close();
+
+    QFile::remove(filename);
+    if (!QFile::rename(file.fileName(), filename))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to replace '%1'").arg(filename));
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef VIDEODIRINDEX_H_
+#define VIDEODIRINDEX_H_
+
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+#include <QSet>
+
+#include "mythmetaexp.h"
+
+class QFileSystemWatcher;
+class QDataStream;
+
+/** \class VideoDirIndex
+ *  \brief Persistent index of the local video directories, used by the
+ *         video scanner to skip directories which have not changed.
+ *
+ *  For every directory the scanner lists, the index keeps its mtime and
+ *  its entries. On the next scan a directory whose mtime has not changed
+ *  is not listed again, its entries come from the index, which turns a
+ *  walk of every file into one stat per directory.
+ *
+ *  Once a scan is done every indexed directory on a local filesystem is
+ *  also watched (inotify on Linux, through QFileSystemWatcher), network
+ *  mounts are left to the mtime check. Directories which were checked
+ *  while being watched are trusted without even the stat until the
+ *  watcher reports a change, so a rescan only touches changed subtrees.
+ *
+ *  Storage group directories on other hosts are listed by their backend
+ *  and are not indexed. The index is stored in the config dir and
+ *  ignored entirely for a full rescan, which rebuilds it.
+ */
+class META_PUBLIC VideoDirIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    class Entry
+    {
+      public:
+        Entry() : isDir(false) {}
+
+        QString name;
+        bool    isDir;
+    };
+    typedef QList<Entry> EntryList;
+
+    static VideoDirIndex *GetIndex(void);
+
+    void BeginScan(bool fullRescan);
+    void EndScan(void);
+    bool NeedsFullRescan(void) const;
+
+    bool Lookup(const QString &path, EntryList &entries);
+    void Store(const QString &path, uint mtime, const EntryList &entries);
+
+  public slots:
+    void UpdateWatches(void);
+
+  private slots:
+    void DirectoryChanged(const QString &path);
+
+  private:
+    VideoDirIndex();
+   ~VideoDirIndex();
+
+    class Dir
+    {
+      public:
+        Dir() : mtime(0), scanned(0) {}
+
+        uint      mtime;    ///< time_t the directory was last modified
+        uint      scanned;  ///< time_t the entries were listed
+        EntryList entries;
+    };
+
+    void Load(void);
+    void Save(void);
+    static QString GetIndexFile(void);
+
+    friend QDataStream &operator<<(QDataStream &out, const Dir &dir);
+    friend QDataStream &operator>>(QDataStream &in, Dir &dir);
+
+  private:
+    mutable QMutex       m_lock;
+    QMap<QString, Dir>   m_dirs;
+    QSet<QString>        m_visited;  ///< directories seen by this scan
+    QSet<QString>        m_dirty;    ///< changed since they were listed
+    QSet<QString>        m_watched;
+    QSet<QString>        m_trusted;  ///< verified while being watched
+    uint                 m_lastFullScan;
+    bool                 m_fullRescan;
+    uint                 m_hits;
+    uint                 m_misses;
+
+    QFileSystemWatcher  *m_watcher;
+
+    static const int     kMaxWatches;
+    static const quint32 kIndexVersion;
+};
+
+#endif // VIDEODIRINDEX_H_
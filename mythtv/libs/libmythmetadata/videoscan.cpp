@@ -9,6 +9,7 @@
 #include "globals.h"
 #include "dbaccess.h"
 #include "dirscan.h"
+#include "videodirindex.h"
 #include "videometadatalistmanager.h"
 #include "videoscan.h"
 #include "videoutils.h"
@@ -75,7 +76,7 @@ class MythUIProgressDialog;
 
 VideoScannerThread::VideoScannerThread(QObject *parent) :
     MThread("VideoScanner"),
-    m_RemoveAll(false), m_KeepAll(false),
+    m_RemoveAll(false), m_KeepAll(false), m_FullRescan(false),
     m_DBDataChanged(false)
 {
     m_parent = parent;
@@ -161,7 +162,14 @@ void VideoScannerThread::run()
         imageExtensions.push_back(QString(*p));
     }
 
-    LOG(VB_GENERAL, LOG_INFO, QString("Beginning Video Scan."));
+    // Local directories which have not changed since the last scan are
+    // not walked again, a full rescan rebuilds the index from scratch.
+    VideoDirIndex *index = VideoDirIndex::GetIndex();
+    bool fullRescan = m_FullRescan || index->NeedsFullRescan();
+    index->BeginScan(fullRescan);
+
+    LOG(VB_GENERAL, LOG_INFO, QString("Beginning %1 Video Scan.")
+        .arg(fullRescan ? "full" : "incremental"));
 
     uint counter = 0;
     FileCheckList fs_files;
@@ -190,6 +198,8 @@ void VideoScannerThread::run()
             SendProgressEvent(++counter);
     }
 
+    index->EndScan();
+
     PurgeList db_remove;
     verifyFiles(fs_files, db_remove);
     m_DBDataChanged = updateDB(fs_files, db_remove);
@@ -395,7 +405,8 @@ bool VideoScannerThread::buildFileList(const QString &directory,
     FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
-    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown);
+    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown,
+                              VideoDirIndex::GetIndex());
 }
 
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
@@ -412,6 +423,9 @@ void VideoScannerThread::SendProgressEvent(uint progress, uint total,
 VideoScanner::VideoScanner()
 {
     m_scanThread = new VideoScannerThread(this);
+
+    // Create the index on the UI thread, its watcher needs an event loop.
+    (void) VideoDirIndex::GetIndex();
 }
 
 VideoScanner::~VideoScanner()
@@ -420,7 +434,13 @@ VideoScanner::~VideoScanner()
         delete m_scanThread;
 }
 
-void VideoScanner::doScan(const QStringList &dirs)
+/** \fn VideoScanner::doScan(const QStringList&, bool)
+ *  \brief Scans dirs for added and removed videos.
+ *
+ *  By default only local directories which changed since the last scan
+ *  are walked, fullRescan walks everything.
+ */
+void VideoScanner::doScan(const QStringList &dirs, bool fullRescan)
 {
     if (m_scanThread->isRunning())
         return;
@@ -457,12 +477,13 @@ void VideoScanner::doScan(const QStringList &dirs)
     }
     m_scanThread->SetHosts(hosts);
     m_scanThread->SetDirs(dirs);
+    m_scanThread->SetFullRescan(fullRescan);
     m_scanThread->start();
 }
 
-void VideoScanner::doScanAll()
+void VideoScanner::doScanAll(bool fullRescan)
 {
-    doScan(GetVideoDirs());
+    doScan(GetVideoDirs(), fullRescan);
 }
 
 void VideoScanner::finishedScan()
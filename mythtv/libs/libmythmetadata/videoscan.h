@@ -26,8 +26,8 @@ class META_PUBLIC VideoScanner : public QObject
     VideoScanner();
     ~VideoScanner();
 
-    void doScan(const QStringList &dirs);
-    void doScanAll(void);
+    void doScan(const QStringList &dirs, bool fullRescan = false);
+    void doScanAll(bool fullRescan = false);
 
   signals:
     void finished(bool);
@@ -66,6 +66,7 @@ class META_PUBLIC VideoScannerThread : public MThread
     void SetDirs(QStringList dirs);
     void SetHosts(const QStringList &hosts);
     void SetProgressDialog(MythUIProgressDialog *dialog) { m_dialog = dialog; };
+    void SetFullRescan(bool full) { m_FullRescan = full; };
     QStringList GetOfflineSGHosts(void) { return m_offlineSGHosts; };
     bool getDataChanged() { return m_DBDataChanged; };
 
@@ -98,6 +99,7 @@ class META_PUBLIC VideoScannerThread : public MThread
     bool m_ListUnknown;
     bool m_RemoveAll;
     bool m_KeepAll;
+    bool m_FullRescan;
     bool m_HasGUI;
     QStringList m_directories;
     QStringList m_liveSGHosts;
@@ -32,6 +32,9 @@
 //    type.  Defaults to "BOTH", available values:
 //          "GET", "POST" or "BOTH"
 //
+//  * Q_CLASSINFO( "<methodName>_Cache", ...) caches the method's responses
+//    until one of the listed (comma separated) events is seen.
+//
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
@@ -44,6 +47,11 @@ class SERVICE_PUBLIC DvrServices : public Service  //, public QScriptable ???
     Q_CLASSINFO( "RemoveRecordSchedule_Method",                 "POST" )
     Q_CLASSINFO( "EnableRecordSchedule_Method",                 "POST" )
     Q_CLASSINFO( "DisableRecordSchedule_Method",                "POST" )
+    Q_CLASSINFO( "GetExpiringList_Cache",         "RECORDING_LIST_CHANGE" )
+    Q_CLASSINFO( "GetRecordedList_Cache",         "RECORDING_LIST_CHANGE" )
+    Q_CLASSINFO( "GetFilteredRecordedList_Cache", "RECORDING_LIST_CHANGE" )
+    Q_CLASSINFO( "GetConflictList_Cache",         "SCHEDULE_CHANGE" )
+    Q_CLASSINFO( "GetUpcomingList_Cache",         "SCHEDULE_CHANGE" )
 
     public:
 
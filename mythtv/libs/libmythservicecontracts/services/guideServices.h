@@ -32,6 +32,9 @@
 //    type.  Defaults to "BOTH", available values:
 //          "GET", "POST" or "BOTH"
 //
+//  * Q_CLASSINFO( "<methodName>_Cache", ...) caches the method's responses
+//    until one of the listed (comma separated) events is seen.
+//
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
@@ -39,6 +42,10 @@ class SERVICE_PUBLIC GuideServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
     Q_CLASSINFO( "version"    , "1.0" );
+    Q_CLASSINFO( "GetProgramGuide_Cache",   "SCHEDULE_CHANGE,"
+                                            "SYSTEM_EVENT MYTHFILLDATABASE_RAN" )
+    Q_CLASSINFO( "GetProgramDetails_Cache", "SCHEDULE_CHANGE,"
+                                            "SYSTEM_EVENT MYTHFILLDATABASE_RAN" )
 
     public:
 
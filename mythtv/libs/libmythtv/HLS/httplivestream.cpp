@@ -26,12 +26,14 @@
 #include <QFileInfo>
 #include <QIODevice>
 #include <QRunnable>
+#include <QWaitCondition>
 #include <QUrl>
 
 #include "mythcorecontext.h"
 #include "mythdirs.h"
 #include "mythtimer.h"
 #include "mthreadpool.h"
+#include "mthread.h"
 #include "mythsystem.h"
 #include "exitcodes.h"
 #include "mythlogging.h"
@@ -43,6 +45,10 @@
 #define SLOC QString("HLS(): ")
 #define SLOC_ERR QString("HLS() Error: ")
 
+/// Minimum time between database updates of the segment info and of the
+/// percent complete, clients poll these so they need not be exact.
+static const int kStatusUpdateInterval = 5000;
+
 /** \class HTTPLiveStreamThread
  *  \brief QRunnable class for running mythtranscode for HTTP Live Streams
  *
@@ -86,6 +92,70 @@ class HTTPLiveStreamThread : public QRunnable
     int m_streamID;
 };
 
+/** \class HTTPLiveStreamWriter
+ *  \brief Writes the playlists and segment info of an HTTP Live Stream
+ *         in the background while the transcoder keeps encoding.
+ *
+ *  Requests are coalesced, if the transcoder publishes several segments
+ *  while the previous playlists are still being written only the latest
+ *  state is written out.
+ */
+class HTTPLiveStreamWriter : public MThread
+{
+  public:
+    HTTPLiveStreamWriter(HTTPLiveStream *parent)
+      : MThread("HLSWriter"), m_parent(parent),
+        m_pending(false), m_stopping(false) {}
+
+    void Publish(void)
+    {
+        QMutexLocker locker(&m_lock);
+        m_pending = true;
+        m_wait.wakeAll();
+    }
+
+    /// Writes anything still pending, then stops the thread.
+    void Stop(void)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            m_stopping = true;
+            m_wait.wakeAll();
+        }
+        wait();
+    }
+
+  protected:
+    void run(void)
+    {
+        RunProlog();
+
+        QMutexLocker locker(&m_lock);
+        while (true)
+        {
+            while (!m_pending && !m_stopping)
+                m_wait.wait(&m_lock);
+
+            if (!m_pending)
+                break;
+
+            m_pending = false;
+            locker.unlock();
+            m_parent->WriteSegments(false);
+            locker.relock();
+        }
+
+        RunEpilog();
+    }
+
+  private:
+    HTTPLiveStream *m_parent;
+    QMutex          m_lock;
+    QWaitCondition  m_wait;
+    bool            m_pending;
+    bool            m_stopping;
+};
+
 
 HTTPLiveStream::HTTPLiveStream(QString srcFile, uint16_t width, uint16_t height,
                                uint32_t bitrate, uint32_t abitrate,
@@ -96,7 +166,7 @@ HTTPLiveStream::HTTPLiveStream(QString srcFile, uint16_t width, uint16_t height,
     m_sourceWidth(0),            m_sourceHeight(0),
     m_segmentSize(segmentSize),  m_maxSegments(maxSegments),
     m_segmentCount(0),           m_startSegment(0),
-    m_curSegment(0),
+    m_curSegment(0),             m_writer(NULL),
     m_height(height),            m_width(width),
     m_bitrate(bitrate),
     m_audioBitrate(abitrate),    m_audioOnlyBitrate(aobitrate),
@@ -149,19 +219,27 @@ HTTPLiveStream::HTTPLiveStream(QString srcFile, uint16_t width, uint16_t height,
 
 HTTPLiveStream::HTTPLiveStream(int streamid)
   : m_writing(false),
-    m_streamid(streamid)
+    m_streamid(streamid),
+    m_writer(NULL)
 {
     LoadFromDB();
 }
 
 HTTPLiveStream::~HTTPLiveStream()
 {
-    if (m_writing)
+    if (m_writer)
     {
-        WritePlaylist(false, true);
-        if (m_audioOnlyBitrate)
-            WritePlaylist(true, true);
+        m_writer->Stop();
+        delete m_writer;
+        m_writer = NULL;
+
+        // The writer may have held back the latest segment info.
+        if (!m_writing)
+            SaveSegmentInfo();
     }
+
+    if (m_writing)
+        WriteSegments(true);
 }
 
 bool HTTPLiveStream::InitForWrite(void)
@@ -179,11 +257,17 @@ bool HTTPLiveStream::InitForWrite(void)
 }
 
 QString HTTPLiveStream::GetFilename(uint16_t segmentNumber, bool fileOnly,
-                                    bool audioOnly, bool encoded) const
+                                    bool audioOnly, bool encoded,
+                                    int variant) const
 {
     QString filename;
 
-    if (encoded)
+    if (!audioOnly && variant > 0 && variant <= m_variants.size())
+    {
+        const HTTPLiveStreamVariant &var = m_variants[variant - 1];
+        filename = encoded ? var.outFileEncoded : var.outFile;
+    }
+    else if (encoded)
         filename = audioOnly ? m_audioOutFileEncoded : m_outFileEncoded;
     else
         filename = audioOnly ? m_audioOutFile : m_outFile;
@@ -199,9 +283,23 @@ QString HTTPLiveStream::GetFilename(uint16_t segmentNumber, bool fileOnly,
     return filename.arg(1, 6, 10, QChar('0'));
 }
 
-QString HTTPLiveStream::GetCurrentFilename(bool audioOnly, bool encoded) const
+QString HTTPLiveStream::GetCurrentFilename(bool audioOnly, bool encoded,
+                                           int variant) const
 {
-    return GetFilename(m_curSegment, false, audioOnly, encoded);
+    QMutexLocker locker(&m_segmentLock);
+    return GetFilename(m_curSegment, false, audioOnly, encoded, variant);
+}
+
+/** \fn HTTPLiveStream::GetVariant(int) const
+ *  \brief Returns the given rung of the bitrate ladder, 1 is the highest
+ *         bitrate below the main stream.
+ */
+HTTPLiveStreamVariant HTTPLiveStream::GetVariant(int variant) const
+{
+    if (variant < 1 || variant > m_variants.size())
+        return HTTPLiveStreamVariant();
+
+    return m_variants[variant - 1];
 }
 
 int HTTPLiveStream::AddStream(void)
@@ -274,12 +372,20 @@ int HTTPLiveStream::AddStream(void)
     return m_streamid;
 }
 
+/** \fn HTTPLiveStream::AddSegment(void)
+ *  \brief Starts a new segment.
+ *
+ *  This only updates the segment counters, the playlists, the segment
+ *  info in the database and the removal of segments beyond maxSegments
+ *  are left to PublishSegments(), which should be called once the writers
+ *  have switched to the new segment and flushed the previous one.
+ */
 bool HTTPLiveStream::AddSegment(void)
 {
     if (m_streamid == -1)
         return false;
 
-    MSqlQuery query(MSqlQuery::InitCon());
+    QMutexLocker locker(&m_segmentLock);
 
     ++m_curSegment;
     ++m_segmentCount;
@@ -290,23 +396,75 @@ bool HTTPLiveStream::AddSegment(void)
     if ((m_maxSegments) &&
         (m_segmentCount > (uint16_t)(m_maxSegments + 1)))
     {
-        QString thisFile = GetFilename(m_startSegment);
+        m_expiredFiles.push_back(GetFilename(m_startSegment));
 
-        if (!QFile::remove(thisFile))
-            LOG(VB_GENERAL, LOG_ERR, LOC +
-                QString("Unable to delete %1.").arg(thisFile));
+        if (m_audioOnlyBitrate)
+            m_expiredFiles.push_back(
+                GetFilename(m_startSegment, false, true));
+
+        for (int v = 1; v <= m_variants.size(); ++v)
+            m_expiredFiles.push_back(
+                GetFilename(m_startSegment, false, false, false, v));
 
         ++m_startSegment;
         --m_segmentCount;
     }
 
-    SaveSegmentInfo();
-    WritePlaylist(false);
+    return true;
+}
+
+/** \fn HTTPLiveStream::PublishSegments(void)
+ *  \brief Queues the playlists and segment info for writing on the
+ *         background writer thread.
+ */
+void HTTPLiveStream::PublishSegments(void)
+{
+    if (m_streamid == -1)
+        return;
 
-    if (m_audioOnlyBitrate)
-        WritePlaylist(true);
+    if (!m_writer)
+    {
+        m_writer = new HTTPLiveStreamWriter(this);
+        m_writer->start();
+    }
 
-    return true;
+    m_writer->Publish();
+}
+
+/** \fn HTTPLiveStream::WriteSegments(bool)
+ *  \brief Writes the playlists, then removes the expired segments and
+ *         updates the segment info in the database.
+ *
+ *  The database is updated at most every kStatusUpdateInterval ms,
+ *  except for the final write with the end tag.
+ */
+void HTTPLiveStream::WriteSegments(bool writeEndTag)
+{
+    // Segments expired after this are still listed by the playlists
+    // written below, they are removed on the next write.
+    QStringList expired;
+    {
+        QMutexLocker locker(&m_segmentLock);
+        expired = m_expiredFiles;
+        m_expiredFiles.clear();
+    }
+
+    WritePlaylists(writeEndTag);
+
+    QStringList::const_iterator it = expired.begin();
+    for (; it != expired.end(); ++it)
+    {
+        if (!QFile::remove(*it))
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Unable to delete %1.").arg(*it));
+    }
+
+    if (writeEndTag || !m_segmentInfoTimer.isRunning() ||
+        m_segmentInfoTimer.elapsed() >= kStatusUpdateInterval)
+    {
+        SaveSegmentInfo();
+        m_segmentInfoTimer.start();
+    }
 }
 
 QString HTTPLiveStream::GetHTMLPageName(void) const
@@ -378,11 +536,23 @@ bool HTTPLiveStream::WriteMetaPlaylist(void)
 
     file.write(QString(
         "#EXTM3U\n"
-        "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%1\n"
-        "%2.m3u8\n"
+        "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%1,RESOLUTION=%2x%3\n"
+        "%4.m3u8\n"
         ).arg((int)((m_bitrate + m_audioBitrate) * 1.1))
+         .arg(m_width).arg(m_height)
          .arg(m_outFileEncoded).toAscii());
 
+    QList<HTTPLiveStreamVariant>::const_iterator it = m_variants.begin();
+    for (; it != m_variants.end(); ++it)
+    {
+        file.write(QString(
+            "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%1,RESOLUTION=%2x%3\n"
+            "%4.m3u8\n"
+            ).arg((int)(((*it).bitrate + m_audioBitrate) * 1.1))
+             .arg((*it).width).arg((*it).height)
+             .arg((*it).outFileEncoded).toAscii());
+    }
+
     if (m_audioOnlyBitrate)
     {
         file.write(QString(
@@ -397,7 +567,7 @@ bool HTTPLiveStream::WriteMetaPlaylist(void)
     return true;
 }
 
-QString HTTPLiveStream::GetPlaylistName(bool audioOnly) const
+QString HTTPLiveStream::GetPlaylistName(bool audioOnly, int variant) const
 {
     if (m_streamid == -1)
         return QString();
@@ -405,17 +575,26 @@ QString HTTPLiveStream::GetPlaylistName(bool audioOnly) const
     if (audioOnly && m_audioOutFile.isEmpty())
         return QString();
 
+    if (!audioOnly && variant > m_variants.size())
+        return QString();
+
     QString base = audioOnly ? m_audioOutFile : m_outFile;
+    if (!audioOnly && variant > 0)
+        base = m_variants[variant - 1].outFile;
     QString outFile = m_outDir + "/" + base + ".m3u8";
     return outFile;
 }
 
-bool HTTPLiveStream::WritePlaylist(bool audioOnly, bool writeEndTag)
+bool HTTPLiveStream::WritePlaylist(bool audioOnly, bool writeEndTag,
+                                   int variant)
 {
     if (m_streamid == -1)
         return false;
 
-    QString outFile = GetPlaylistName(audioOnly);
+    QString outFile = GetPlaylistName(audioOnly, variant);
+    if (outFile.isEmpty())
+        return false;
+
     QString tmpFile = outFile + ".tmp";
 
     QFile file(tmpFile);
@@ -426,19 +605,23 @@ bool HTTPLiveStream::WritePlaylist(bool audioOnly, bool writeEndTag)
         return false;
     }
 
+    m_segmentLock.lock();
+    unsigned int segmentid = m_startSegment;
+    unsigned int segmentCount = m_segmentCount;
+    m_segmentLock.unlock();
+
     file.write(QString(
         "#EXTM3U\n"
         "#EXT-X-TARGETDURATION:%1\n"
         "#EXT-X-MEDIA-SEQUENCE:%2\n"
-        ).arg(m_segmentSize).arg(m_startSegment).toAscii());
+        ).arg(m_segmentSize).arg(segmentid).toAscii());
 
     if (writeEndTag)
         file.write("#EXT-X-ENDLIST\n");
 
     // Don't write out the current segment until the end
-    unsigned int tmpSegCount = m_segmentCount - 1;
+    unsigned int tmpSegCount = segmentCount - 1;
     unsigned int i = 0;
-    unsigned int segmentid = m_startSegment;
 
     if (writeEndTag)
         ++tmpSegCount;
@@ -449,7 +632,8 @@ bool HTTPLiveStream::WritePlaylist(bool audioOnly, bool writeEndTag)
             "#EXTINF:%1,\n"
             "%2\n"
             ).arg(m_segmentSize)
-             .arg(GetFilename(segmentid + i, true, audioOnly, true)).toAscii());
+             .arg(GetFilename(segmentid + i, true, audioOnly, true, variant))
+             .toAscii());
 
         ++i;
     }
@@ -461,6 +645,19 @@ bool HTTPLiveStream::WritePlaylist(bool audioOnly, bool writeEndTag)
     return true;
 }
 
+bool HTTPLiveStream::WritePlaylists(bool writeEndTag)
+{
+    bool ok = WritePlaylist(false, writeEndTag);
+
+    for (int v = 1; v <= m_variants.size(); ++v)
+        ok &= WritePlaylist(false, writeEndTag, v);
+
+    if (m_audioOnlyBitrate)
+        ok &= WritePlaylist(true, writeEndTag);
+
+    return ok;
+}
+
 bool HTTPLiveStream::SaveSegmentInfo(void)
 {
     if (m_streamid == -1)
@@ -472,9 +669,11 @@ bool HTTPLiveStream::SaveSegmentInfo(void)
         "SET startsegment = :START, currentsegment = :CURRENT, "
         "    segmentcount = :COUNT "
         "WHERE id = :STREAMID; ");
+    m_segmentLock.lock();
     query.bindValue(":START", m_startSegment);
     query.bindValue(":CURRENT", m_curSegment);
     query.bindValue(":COUNT", m_segmentCount);
+    m_segmentLock.unlock();
     query.bindValue(":STREAMID", m_streamid);
 
     if (query.exec())
@@ -600,6 +799,13 @@ bool HTTPLiveStream::UpdatePercentComplete(int percent)
     if (m_streamid == -1)
         return false;
 
+    if (percent == m_percentComplete)
+        return true;
+
+    if ((percent != 100) && (m_percentTimer.isRunning()) &&
+        (m_percentTimer.elapsed() < kStatusUpdateInterval))
+        return true;
+
     MSqlQuery query(MSqlQuery::InitCon());
     query.prepare(
         "UPDATE livestream "
@@ -611,6 +817,7 @@ bool HTTPLiveStream::UpdatePercentComplete(int percent)
     if (query.exec())
     {
         m_percentComplete = percent;
+        m_percentTimer.start();
         return true;
     }
 
@@ -706,6 +913,8 @@ void HTTPLiveStream::SetOutputVars(void)
             QString(".ao_%1kA").arg(m_audioOnlyBitrate/1000);
     }
 
+    BuildVariants();
+
     m_httpPrefix = gCoreContext->GetSetting("HTTPLiveStreamPrefix", QString(
         "http://%1:%2/StorageGroup/Streaming/")
         .arg(gCoreContext->GetSetting("MasterServerIP"))
@@ -726,6 +935,49 @@ void HTTPLiveStream::SetOutputVars(void)
         m_httpPrefixRel = "";
 }
 
+/** \fn HTTPLiveStream::BuildVariants(void)
+ *  \brief Builds the bitrate ladder below the main stream.
+ *
+ *  Each rung has half the bitrate of the one above it and about half
+ *  the pixels, up to "HTTPLiveStreamVariants" rungs, stopping at rungs
+ *  too small to be useful. The ladder only depends on the size and
+ *  bitrate of the main stream and the setting, so the backend and
+ *  mythtranscode agree on it without storing it.
+ */
+void HTTPLiveStream::BuildVariants(void)
+{
+    m_variants.clear();
+
+    if (!m_width || !m_height || !m_bitrate)
+        return;
+
+    int maxVariants = gCoreContext->GetNumSetting("HTTPLiveStreamVariants", 2);
+
+    double   scale   = 1.0;
+    uint32_t bitrate = m_bitrate;
+    for (int i = 0; i < maxVariants; ++i)
+    {
+        scale   *= 0.7071;
+        bitrate /= 2;
+
+        HTTPLiveStreamVariant var;
+        // make sure dimensions are valid for MPEG codecs
+        var.width   = ((int)(m_width * scale) + 15) & ~0xF;
+        var.height  = ((int)(m_height * scale) + 15) & ~0xF;
+        var.bitrate = bitrate;
+
+        if ((var.width < 176) || (var.bitrate < 128000))
+            break;
+
+        QString suffix = QString(".av_%1x%2_%3kV")
+            .arg(var.width).arg(var.height).arg(var.bitrate/1000);
+        var.outFile        = m_outBase + suffix;
+        var.outFileEncoded = m_outBaseEncoded + suffix;
+
+        m_variants.push_back(var);
+    }
+}
+
 HTTPLiveStreamStatus HTTPLiveStream::GetDBStatus(void) const
 {
     if (m_streamid == -1)
@@ -834,6 +1086,16 @@ bool HTTPLiveStream::RemoveStream(int id)
         if (!thisFile.isEmpty() && !QFile::remove(thisFile))
             LOG(VB_GENERAL, LOG_ERR, SLOC +
                 QString("Unable to delete %1.").arg(thisFile));
+
+        for (int v = 1; v <= hls->GetVariantCount(); ++v)
+        {
+            thisFile = hls->GetFilename(startSegment + x, false, false,
+                                        false, v);
+
+            if (!thisFile.isEmpty() && !QFile::remove(thisFile))
+                LOG(VB_GENERAL, LOG_ERR, SLOC +
+                    QString("Unable to delete %1.").arg(thisFile));
+        }
     }
 
     thisFile = hls->GetMetaPlaylistName();
@@ -851,6 +1113,14 @@ bool HTTPLiveStream::RemoveStream(int id)
         LOG(VB_GENERAL, LOG_ERR, SLOC +
             QString("Unable to delete %1.").arg(thisFile));
 
+    for (int v = 1; v <= hls->GetVariantCount(); ++v)
+    {
+        thisFile = hls->GetPlaylistName(false, v);
+        if (!thisFile.isEmpty() && !QFile::remove(thisFile))
+            LOG(VB_GENERAL, LOG_ERR, SLOC +
+                QString("Unable to delete %1.").arg(thisFile));
+    }
+
     thisFile = hls->GetHTMLPageName();
     if (!thisFile.isEmpty() && !QFile::remove(thisFile))
         LOG(VB_GENERAL, LOG_ERR, SLOC +
@@ -1,10 +1,14 @@
 #ifndef HTTPLIVESTREAM_H
 #define HTTPLIVESTREAM_H
 
+#include <QStringList>
 #include <QString>
+#include <QMutex>
+#include <QList>
 
 #include "datacontracts/liveStreamInfoList.h"
 
+#include "mythtimer.h"
 #include "frame.h"
 
 typedef enum {
@@ -18,9 +22,31 @@ typedef enum {
     kHLSStatusStopped      = 6
 } HTTPLiveStreamStatus;
 
+/** \class HTTPLiveStreamVariant
+ *  \brief A lower bitrate rung of the ladder of an HTTP Live Stream.
+ *
+ *  The variants are encoded by the same mythtranscode run as the main
+ *  stream, from the same decoded frames, and are segmented at the same
+ *  key frames so clients can switch between them at any segment.
+ */
+class MTV_PUBLIC HTTPLiveStreamVariant
+{
+ public:
+    HTTPLiveStreamVariant() : width(0), height(0), bitrate(0) {}
+
+    uint16_t    width;
+    uint16_t    height;
+    uint32_t    bitrate;
+    QString     outFile;
+    QString     outFileEncoded;
+};
+
+class HTTPLiveStreamWriter;
 
 class MTV_PUBLIC HTTPLiveStream
 {
+    friend class HTTPLiveStreamWriter;
+
  public:
     HTTPLiveStream(QString srcFile, uint16_t width = 640, uint16_t height = 480,
                    uint32_t bitrate = 800000, uint32_t abitrate = 64000,
@@ -42,12 +68,16 @@ class MTV_PUBLIC HTTPLiveStream
     QString  GetSourceFile(void) const { return m_sourceFile; }
     QString  GetHTMLPageName(void) const;
     QString  GetMetaPlaylistName(void) const;
-    QString  GetPlaylistName(bool audioOnly = false) const;
+    QString  GetPlaylistName(bool audioOnly = false, int variant = 0) const;
     uint16_t GetSegmentSize(void) const { return m_segmentSize; }
     QString  GetFilename(uint16_t segmentNumber = 0, bool fileOnly = false,
-                         bool audioOnly = false, bool encoded = false) const;
-    QString  GetCurrentFilename(
-        bool audioOnly = false, bool encoded = false) const;
+                         bool audioOnly = false, bool encoded = false,
+                         int variant = 0) const;
+    QString  GetCurrentFilename(bool audioOnly = false, bool encoded = false,
+                                int variant = 0) const;
+
+    int      GetVariantCount(void) const { return m_variants.size(); }
+    HTTPLiveStreamVariant GetVariant(int variant) const;
 
     void SetOutputVars(void);
 
@@ -55,10 +85,13 @@ class MTV_PUBLIC HTTPLiveStream
 
     int      AddStream(void);
     bool     AddSegment(void);
+    void     PublishSegments(void);
 
     bool WriteHTML(void);
     bool WriteMetaPlaylist(void);
-    bool WritePlaylist(bool audioOnly = false, bool writeEndTag = false);
+    bool WritePlaylist(bool audioOnly = false, bool writeEndTag = false,
+                       int variant = 0);
+    bool WritePlaylists(bool writeEndTag = false);
 
     bool SaveSegmentInfo(void);
 
@@ -80,6 +113,9 @@ class MTV_PUBLIC HTTPLiveStream
     static DTC::LiveStreamInfoList *GetLiveStreamInfoList( const QString &FileName = "");
 
  protected:
+    void BuildVariants(void);
+    void WriteSegments(bool writeEndTag);
+
     bool        m_writing;
     int         m_streamid;
     QString     m_sourceFile;
@@ -99,6 +135,13 @@ class MTV_PUBLIC HTTPLiveStream
     uint16_t    m_segmentCount;
     uint16_t    m_startSegment;
     uint16_t    m_curSegment;
+    /// Protects the segment counters and m_expiredFiles, which are
+    /// updated by the transcoder and read by the segment writer
+    mutable QMutex m_segmentLock;
+    QStringList m_expiredFiles;
+    HTTPLiveStreamWriter *m_writer;
+    MythTimer   m_segmentInfoTimer;
+    MythTimer   m_percentTimer;
     QString     m_httpPrefix;
     QString     m_httpPrefixRel;
     uint16_t    m_height;
@@ -107,6 +150,7 @@ class MTV_PUBLIC HTTPLiveStream
     uint32_t    m_audioBitrate;
     uint32_t    m_audioOnlyBitrate;
     uint16_t    m_sampleRate;
+    QList<HTTPLiveStreamVariant> m_variants;
 
     QDateTime   m_created;
     QDateTime   m_lastModified;
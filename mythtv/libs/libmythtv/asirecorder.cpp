@@ -140,6 +140,7 @@ void ASIRecorder::run(void)
         }
     }
 
+    SaveListenerStats();
     m_stream_handler->RemoveListener(_stream_data);
     _stream_data->RemoveWritingListener(this);
     _stream_data->RemoveAVListener(this);
@@ -170,6 +171,12 @@ bool ASIRecorder::Open(void)
     return true;
 }
 
+bool ASIRecorder::GetListenerStats(StreamListenerStats &stats) const
+{
+    return m_stream_handler &&
+        m_stream_handler->GetListenerStats(_stream_data, stats);
+}
+
 bool ASIRecorder::IsOpen(void) const
 {
     return m_stream_handler;
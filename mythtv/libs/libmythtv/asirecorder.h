@@ -69,6 +69,9 @@ class ASIRecorder : public DTVRecorder
     bool IsOpen(void) const;
     void Close(void);
 
+  private:
+    bool GetListenerStats(StreamListenerStats &stats) const;
+
   private:
     ASIChannel       *m_channel;
     ASIStreamHandler *m_stream_handler;
@@ -3061,6 +3061,8 @@ bool AvFormatDecoder::ProcessVideoPacket(AVStream *curstream, AVPacket *pkt)
     if (pkt->pts != (int64_t)AV_NOPTS_VALUE)
         pts_detected = true;
 
+    int64_t start_usecs = collectStats ? DecoderStats::Now() : 0;
+
     avcodeclock->lock();
     if (private_dec)
     {
@@ -3081,6 +3083,14 @@ bool AvFormatDecoder::ProcessVideoPacket(AVStream *curstream, AVPacket *pkt)
     }
     avcodeclock->unlock();
 
+    if (collectStats)
+    {
+        stats.video_usecs += DecoderStats::Now() - start_usecs;
+        stats.video_packets++;
+        if (gotpicture)
+            stats.video_frames++;
+    }
+
     if (ret < 0)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Unknown decoding error");
@@ -4270,7 +4280,13 @@ int AvFormatDecoder::DecodeAudio(AVCodecContext *ctx,
     AVFrame frame;
     int got_frame = 0;
 
+    int64_t start_usecs = collectStats ? DecoderStats::Now() : 0;
     int ret = avcodec_decode_audio4(ctx, &frame, &got_frame, pkt);
+    if (collectStats)
+    {
+        stats.audio_usecs += DecoderStats::Now() - start_usecs;
+        stats.audio_packets++;
+    }
     if (ret < 0 || !got_frame)
     {
         data_size = 0;
@@ -4406,7 +4422,15 @@ bool AvFormatDecoder::GetFrame(DecodeType decodetype)
             }
 
             int retval = 0;
-            if (!ic || ((retval = av_read_frame(ic, pkt)) < 0))
+            int64_t start_usecs = collectStats ? DecoderStats::Now() : 0;
+            if (ic)
+                retval = av_read_frame(ic, pkt);
+            if (collectStats)
+            {
+                stats.demux_usecs += DecoderStats::Now() - start_usecs;
+                stats.demux_packets++;
+            }
+            if (!ic || retval < 0)
             {
                 if (retval == -EAGAIN)
                     continue;
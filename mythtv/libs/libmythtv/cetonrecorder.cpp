@@ -109,6 +109,7 @@ void CetonRecorder::run(void)
 
     LOG(VB_RECORD, LOG_INFO, LOC + "run -- ending...");
 
+    SaveListenerStats();
     _stream_handler->RemoveListener(_stream_data);
     _stream_data->RemoveWritingListener(this);
     _stream_data->RemoveAVListener(this);
@@ -124,6 +125,12 @@ void CetonRecorder::run(void)
     LOG(VB_RECORD, LOG_INFO, LOC + "run -- end");
 }
 
+bool CetonRecorder::GetListenerStats(StreamListenerStats &stats) const
+{
+    return _stream_handler &&
+        _stream_handler->GetListenerStats(_stream_data, stats);
+}
+
 bool CetonRecorder::PauseAndWait(int timeout)
 {
     QMutexLocker locker(&pauseLock);
@@ -131,6 +138,7 @@ bool CetonRecorder::PauseAndWait(int timeout)
     {
         if (!IsPaused(true))
         {
+            SaveListenerStats();
             _stream_handler->RemoveListener(_stream_data);
 
             paused = true;
@@ -34,6 +34,7 @@ class CetonRecorder : public DTVRecorder
   private:
     void ReaderPaused(int fd);
     bool PauseAndWait(int timeout = 100);
+    bool GetListenerStats(StreamListenerStats &stats) const;
 
   private:
     CetonChannel       *_channel;
@@ -1,3 +1,4 @@
+#include <sys/time.h>
 #include <unistd.h>
 #include <math.h>
 
@@ -42,7 +43,8 @@ DecoderBase::DecoderBase(MythPlayer *parent, const ProgramInfo &pginfo)
 
       hasKeyFrameAdjustTable(false), lowbuffers(false),
       getrawframes(false), getrawvideo(false),
-      errored(false), waitingForChange(false), readAdjust(0),
+      errored(false), collectStats(false),
+      waitingForChange(false), readAdjust(0),
       justAfterChange(false),
       decodeAllSubtitles(false),
       // language preference
@@ -1020,6 +1022,13 @@ int DecoderBase::AutoSelectTrack(uint type)
     return selTrack;
 }
 
+int64_t DecoderStats::Now(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+}
+
 QString toString(TrackType type)
 {
     QString str = QObject::tr("Track");
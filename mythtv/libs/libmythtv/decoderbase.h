@@ -98,6 +98,35 @@ class StreamInfo
 };
 typedef vector<StreamInfo> sinfo_vec_t;
 
+/** \class DecoderStats
+ *  \brief Cumulative time spent in each decoder stage, in microseconds.
+ *
+ *  Only collected after DecoderBase::SetCollectStats(true), so normal
+ *  playback does not pay for the extra clock reads.
+ */
+class DecoderStats
+{
+  public:
+    DecoderStats() { Reset(); }
+
+    void Reset(void)
+    {
+        demux_usecs = video_usecs = audio_usecs = 0;
+        demux_packets = video_packets = video_frames = audio_packets = 0;
+    }
+
+    /// Monotonic enough wall clock in microseconds for stage timings.
+    static int64_t Now(void);
+
+    int64_t  demux_usecs;    ///< time spent in av_read_frame()
+    int64_t  video_usecs;    ///< time spent decoding video packets
+    int64_t  audio_usecs;    ///< time spent decoding audio packets
+    uint64_t demux_packets;
+    uint64_t video_packets;
+    uint64_t video_frames;   ///< video packets that produced a picture
+    uint64_t audio_packets;
+};
+
 class DecoderBase
 {
   public:
@@ -179,6 +208,11 @@ class DecoderBase
 
     void SetTranscoding(bool value) { transcoding = value; }
 
+    /// Enables collection of per stage timings, see DecoderStats
+    void SetCollectStats(bool enable) { collectStats = enable; }
+    bool GetCollectStats(void) const  { return collectStats; }
+    DecoderStats GetStats(void) const { return stats; }
+
     bool IsErrored() const { return errored; }
 
     void SetWaitForChange(void);
@@ -283,6 +317,9 @@ class DecoderBase
 
     bool errored;
 
+    bool collectStats;
+    DecoderStats stats;
+
     bool waitingForChange;
     long long readAdjust;
     bool justAfterChange;
@@ -22,6 +22,7 @@
 #include "mpegstreamdata.h"
 #include "dvbstreamdata.h"
 #include "dtvrecorder.h"
+#include "streamhandler.h"
 #include "programinfo.h"
 #include "mythlogging.h"
 #include "mpegtables.h"
@@ -81,7 +82,9 @@ DTVRecorder::DTVRecorder(TVRec *rec) :
     _use_pts(false),
     _packet_count(0),
     _continuity_error_count(0),
-    _frames_seen_count(0),          _frames_written_count(0)
+    _frames_seen_count(0),          _frames_written_count(0),
+    _listener_dropped(0),           _listener_dropped_base(0),
+    _listener_max_lag(0)
 {
     SetPositionMapType(MARK_GOP_BYFRAME);
     _payload_buffer.reserve(TSPacket::kSize * (50 + 1));
@@ -218,6 +221,29 @@ void DTVRecorder::ClearStatistics(void)
     _continuity_error_count.fetchAndStoreRelaxed(0);
     _frames_seen_count          = 0;
     _frames_written_count       = 0;
+
+    StreamListenerStats stats;
+    _listener_dropped_base = GetListenerStats(stats) ? stats.dropped : 0;
+    _listener_dropped      = 0;
+    _listener_max_lag      = 0;
+}
+
+/** \brief Adds the counters of our StreamHandler listener queue to the
+ *         recording's totals.
+ *
+ *  The queue and its counters go away with the listener, so call this
+ *  before removing it from the stream handler.
+ */
+void DTVRecorder::SaveListenerStats(void)
+{
+    StreamListenerStats stats;
+    if (!GetListenerStats(stats))
+        return;
+
+    _listener_dropped += stats.dropped - min(stats.dropped,
+                                             _listener_dropped_base);
+    _listener_dropped_base = 0;
+    _listener_max_lag = max(_listener_max_lag, stats.max_lag);
 }
 
 // documented in recorderbase.h
@@ -1349,6 +1375,17 @@ RecordingQuality *DTVRecorder::GetRecordingQuality(void) const
     recq->AddTSStatistics(
         _continuity_error_count.fetchAndAddRelaxed(0),
         _packet_count.fetchAndAddRelaxed(0));
+
+    uint64_t dropped = _listener_dropped;
+    uint     max_lag = _listener_max_lag;
+    StreamListenerStats stats;
+    if (GetListenerStats(stats))
+    {
+        dropped += stats.dropped - min(stats.dropped, _listener_dropped_base);
+        max_lag  = max(max_lag, stats.max_lag);
+    }
+    recq->AddListenerStatistics(dropped, max_lag);
+
     return recq;
 }
 
@@ -20,6 +20,7 @@ using namespace std;
 #include "H264Parser.h"
 
 class MPEGStreamData;
+class StreamListenerStats;
 class TSPacket;
 class QTime;
 
@@ -118,6 +119,9 @@ class DTVRecorder :
 
     virtual QString GetSIStandard(void) const { return "mpeg"; }
     virtual void SetCAMPMT(const ProgramMapTable*) {}
+    /// Stats of our listener queue on the StreamHandler, if there is one
+    virtual bool GetListenerStats(StreamListenerStats&) const { return false; }
+    void SaveListenerStats(void);
     virtual void UpdateCAMTimeOffset(void) {}
 
     // file handle for stream
@@ -182,6 +186,11 @@ class DTVRecorder :
     mutable QAtomicInt _continuity_error_count;
     unsigned long long _frames_seen_count;
     unsigned long long _frames_written_count;
+    /// packets dropped by listener queues already removed from the handler
+    uint64_t      _listener_dropped;
+    /// dropped count of the current listener queue at ClearStatistics()
+    uint64_t      _listener_dropped_base;
+    uint          _listener_max_lag;
 
     // constants
     /// If the number of regular frames detected since the last
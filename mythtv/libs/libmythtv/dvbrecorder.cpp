@@ -131,6 +131,7 @@ void DVBRecorder::run(void)
         }
     }
 
+    SaveListenerStats();
     _stream_handler->RemoveListener(_stream_data);
     _stream_data->RemoveWritingListener(this);
     _stream_data->RemoveAVListener(this);
@@ -144,6 +145,12 @@ void DVBRecorder::run(void)
     recordingWait.wakeAll();
 }
 
+bool DVBRecorder::GetListenerStats(StreamListenerStats &stats) const
+{
+    return _stream_handler &&
+        _stream_handler->GetListenerStats(_stream_data, stats);
+}
+
 bool DVBRecorder::PauseAndWait(int timeout)
 {
     QMutexLocker locker(&pauseLock);
@@ -151,6 +158,7 @@ bool DVBRecorder::PauseAndWait(int timeout)
     {
         if (!IsPaused(true))
         {
+            SaveListenerStats();
             _stream_handler->RemoveListener(_stream_data);
 
             paused = true;
@@ -31,6 +31,7 @@ class DVBRecorder : public DTVRecorder
 
   private:
     bool PauseAndWait(int timeout = 100);
+    bool GetListenerStats(StreamListenerStats &stats) const;
 
     QString GetSIStandard(void) const;
     void SetCAMPMT(const ProgramMapTable*);
@@ -245,22 +245,10 @@ void DVBStreamHandler::RunTS(void)
             continue;
         }
 
-        _listener_lock.lock();
-
-        if (_stream_data_list.empty())
-        {
-            _listener_lock.unlock();
-            continue;
-        }
-
-        StreamDataList::const_iterator sit = _stream_data_list.begin();
-        for (; sit != _stream_data_list.end(); ++sit)
-            remainder = sit.key()->ProcessData(buffer, len);
-
-        _listener_lock.unlock();
-
-        if (remainder > 0 && (len > remainder)) // leftover bytes
-            memmove(buffer, &(buffer[len - remainder]), remainder);
+        // Each listener processes the data on its own thread and
+        // keeps any partial packet for its next buffer.
+        DispatchToListeners(buffer, len);
+        remainder = 0;
     }
     LOG(VB_RECORD, LOG_INFO, LOC + "RunTS(): " + "shutdown");
 
@@ -110,6 +110,7 @@ void HDHRRecorder::run(void)
 
     LOG(VB_RECORD, LOG_INFO, LOC + "run -- ending...");
 
+    SaveListenerStats();
     _stream_handler->RemoveListener(_stream_data);
     _stream_data->RemoveWritingListener(this);
     _stream_data->RemoveAVListener(this);
@@ -125,6 +126,12 @@ void HDHRRecorder::run(void)
     LOG(VB_RECORD, LOG_INFO, LOC + "run -- end");
 }
 
+bool HDHRRecorder::GetListenerStats(StreamListenerStats &stats) const
+{
+    return _stream_handler &&
+        _stream_handler->GetListenerStats(_stream_data, stats);
+}
+
 bool HDHRRecorder::PauseAndWait(int timeout)
 {
     QMutexLocker locker(&pauseLock);
@@ -132,6 +139,7 @@ bool HDHRRecorder::PauseAndWait(int timeout)
     {
         if (!IsPaused(true))
         {
+            SaveListenerStats();
             _stream_handler->RemoveListener(_stream_data);
 
             paused = true;
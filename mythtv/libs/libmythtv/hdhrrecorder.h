@@ -32,6 +32,7 @@ class HDHRRecorder : public DTVRecorder
   private:
     void ReaderPaused(int fd);
     bool PauseAndWait(int timeout = 100);
+    bool GetListenerStats(StreamListenerStats &stats) const;
 
   private:
     HDHRChannel       *_channel;
@@ -128,7 +128,6 @@ void HDHRStreamHandler::run(void)
 
     LOG(VB_RECORD, LOG_INFO, LOC + "RunTS(): begin");
 
-    int remainder = 0;
     QTime last_update;
     while (_running_desired && !_error)
     {
@@ -156,27 +155,9 @@ void HDHRStreamHandler::run(void)
             continue;
         }
 
-        // Assume data_length is a multiple of 188 (packet size)
-
-        _listener_lock.lock();
-
-        if (_stream_data_list.empty())
-        {
-            _listener_lock.unlock();
-            continue;
-        }
-
-        StreamDataList::const_iterator sit = _stream_data_list.begin();
-        for (; sit != _stream_data_list.end(); ++sit)
-            remainder = sit.key()->ProcessData(data_buffer, data_length);
-
-        _listener_lock.unlock();
-        if (remainder != 0)
-        {
-            LOG(VB_RECORD, LOG_INFO, LOC +
-                QString("RunTS(): data_length = %1 remainder = %2")
-                    .arg(data_length).arg(remainder));
-        }
+        // Each listener processes the data on its own thread and
+        // keeps any partial packet for its next buffer.
+        DispatchToListeners(data_buffer, data_length);
     }
     LOG(VB_RECORD, LOG_INFO, LOC + "RunTS(): " + "shutdown");
 
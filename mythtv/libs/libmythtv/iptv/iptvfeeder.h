@@ -7,9 +7,25 @@
 #ifndef _IPTV_FEEDER_H_
 #define _IPTV_FEEDER_H_
 
+#include <stdint.h>
+
 class QString;
 class TSDataListener;
 
+/// Datagram counters of a socket based IPTVFeeder, since it was opened.
+class IPTVFeederStats
+{
+  public:
+    IPTVFeederStats() :
+        rtp(false), datagrams(0), lost(0), reordered(0), duplicates(0) {}
+
+    bool     rtp;         ///< loss and reordering are only known for RTP
+    uint64_t datagrams;
+    uint64_t lost;        ///< never arrived, or too late to be used
+    uint64_t reordered;   ///< arrived out of order, but in time
+    uint64_t duplicates;
+};
+
 /** \class IPTVFeeder
  *  \brief Base class for UDP and RTSP data sources for IPTVRecorder.
  *
@@ -52,6 +68,10 @@ class IPTVFeeder
 
     virtual void AddListener(TSDataListener*) = 0;
     virtual void RemoveListener(TSDataListener*) = 0;
+
+    /// \brief Fills in stats and returns true if the feeder keeps them
+    virtual bool GetStats(IPTVFeederStats &stats) const
+        { (void) stats; return false; }
 };
 
 #endif // _IPTV_FEEDER_H_
@@ -0,0 +1,508 @@
+/** -*- Mode: c++ -*-
+ *  IPTVFeederSocket -- native UDP/RTP IPTVFeeder
+ *  Distributed as part of MythTV under GPL v2 and later.
+ */
+
+// C++ headers
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+// POSIX headers
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+
+// Qt headers
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QUrl>
+
+// MythTV headers
+#include "iptvfeedersocket.h"
+#include "streamlisteners.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "tspacket.h"
+
+#define LOC QString("IPTVFeedSocket: ")
+
+/// Datagrams read per system call.
+const uint IPTVFeederSocket::kBatchSize        = 64;
+/// Seven TS packets plus an RTP header and some room for extensions.
+const uint IPTVFeederSocket::kMaxDatagramSize  = 2048;
+/// Most datagrams held back waiting for a missing one, a power of two.
+const uint IPTVFeederSocket::kSlots            = 256;
+/// The kernel caps this at net.core.rmem_max unless we may override it.
+const int  IPTVFeederSocket::kSocketBufferSize = 8 * 1024 * 1024;
+
+IPTVFeederSocket::IPTVFeederSocket() :
+    m_socket(-1),       m_rtp(false),
+    m_interrupted(false), m_running(false),
+    m_buffer(new unsigned char[kBatchSize * kMaxDatagramSize]),
+    m_out(new unsigned char[kBatchSize * kMaxDatagramSize]),
+    m_out_len(0),
+    m_slots(new Slot[kSlots]),
+    m_have_seq(false),  m_next_seq(0),
+    m_highest_seq(0),   m_held(0),
+    m_jitter_window(0)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC + "ctor -- success");
+}
+
+IPTVFeederSocket::~IPTVFeederSocket()
+{
+    LOG(VB_RECORD, LOG_INFO, LOC + "dtor -- begin");
+    Close();
+    delete [] m_buffer;
+    delete [] m_out;
+    delete [] m_slots;
+    LOG(VB_RECORD, LOG_INFO, LOC + "dtor -- end");
+}
+
+bool IPTVFeederSocket::IsUDP(const QString &url)
+{
+    return url.startsWith("udp://", Qt::CaseInsensitive);
+}
+
+bool IPTVFeederSocket::IsRTP(const QString &url)
+{
+    return url.startsWith("rtp://", Qt::CaseInsensitive);
+}
+
+bool IPTVFeederSocket::IsOpen(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_socket >= 0;
+}
+
+bool IPTVFeederSocket::Open(const QString &url)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("Open(%1) -- begin").arg(url));
+
+    QMutexLocker locker(&m_lock);
+
+    if (m_socket >= 0)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC + "Open() -- end 1");
+        return true;
+    }
+
+    QUrl parse(url);
+    if (!parse.isValid() || parse.host().isEmpty() || (-1 == parse.port()))
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC + "Open() -- end 2");
+        return false;
+    }
+
+    QHostAddress host(parse.host());
+    if (host.protocol() != QAbstractSocket::IPv4Protocol)
+    {
+        QList<QHostAddress> addrs =
+            QHostInfo::fromName(parse.host()).addresses();
+        host = QHostAddress();
+        for (int i = 0; i < addrs.size(); i++)
+        {
+            if (addrs[i].protocol() == QAbstractSocket::IPv4Protocol)
+            {
+                host = addrs[i];
+                break;
+            }
+        }
+    }
+    if (host.isNull())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Can not resolve '%1'").arg(parse.host()));
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to create socket" + ENO);
+        return false;
+    }
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    // A burst of HD multicast overruns the default buffer long before
+    // the read thread gets scheduled.
+    int bufsize = kSocketBufferSize;
+#ifdef SO_RCVBUFFORCE
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &bufsize, sizeof(bufsize)))
+#endif
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+    socklen_t optlen = sizeof(bufsize);
+    if (!getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, &optlen) &&
+        bufsize < kSocketBufferSize)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Receive buffer is only %1 KB, raise "
+                    "net.core.rmem_max to at least %2 KB")
+                .arg(bufsize / 1024).arg(kSocketBufferSize / 1024));
+    }
+
+    quint32 ipv4 = host.toIPv4Address();
+    bool multicast = IN_MULTICAST(ipv4);
+
+    // Binding to the group keeps out other groups on the same port.
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(parse.port());
+    addr.sin_addr.s_addr = multicast ? htonl(ipv4) : htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to bind to port %1").arg(parse.port()) + ENO);
+        close(fd);
+        return false;
+    }
+
+    if (multicast)
+    {
+        struct ip_mreq mreq;
+        memset(&mreq, 0, sizeof(mreq));
+        mreq.imr_multiaddr.s_addr = htonl(ipv4);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                       &mreq, sizeof(mreq)) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Failed to join %1").arg(host.toString()) + ENO);
+            close(fd);
+            return false;
+        }
+    }
+
+    m_socket        = fd;
+    m_rtp           = IsRTP(url);
+    m_jitter_window = gCoreContext->GetNumSetting("IPTVJitterWindow", 50);
+    m_have_seq      = false;
+    m_held          = 0;
+    for (uint i = 0; i < kSlots; i++)
+        m_slots[i].used = false;
+    m_clock.start();
+
+    {
+        QMutexLocker statslocker(&m_listener_lock);
+        m_stats     = IPTVFeederStats();
+        m_stats.rtp = m_rtp;
+    }
+
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("Open() -- end, %1 %2:%3")
+        .arg(m_rtp ? "RTP" : "UDP").arg(host.toString()).arg(parse.port()));
+
+    return true;
+}
+
+void IPTVFeederSocket::Close(void)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC + "Close() -- begin");
+    Stop();
+
+    QMutexLocker locker(&m_lock);
+
+    if (m_socket >= 0)
+    {
+        close(m_socket);
+        m_socket = -1;
+    }
+
+    LOG(VB_RECORD, LOG_INFO, LOC + "Close() -- end");
+}
+
+void IPTVFeederSocket::Run(void)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC + "Run() -- begin");
+
+    m_lock.lock();
+    m_running = true;
+    m_interrupted = false;
+    int fd = m_socket;
+    m_lock.unlock();
+
+#ifdef linux
+    vector<struct mmsghdr> msgs(kBatchSize);
+    vector<struct iovec>   iovs(kBatchSize);
+    memset(&msgs[0], 0, kBatchSize * sizeof(struct mmsghdr));
+    for (uint i = 0; i < kBatchSize; i++)
+    {
+        iovs[i].iov_base = m_buffer + i * kMaxDatagramSize;
+        iovs[i].iov_len  = kMaxDatagramSize;
+        msgs[i].msg_hdr.msg_iov    = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+
+    while (fd >= 0)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            if (m_interrupted)
+                break;
+        }
+
+        struct pollfd pfd;
+        pfd.fd      = fd;
+        pfd.events  = POLLIN;
+        pfd.revents = 0;
+
+        int ret = poll(&pfd, 1, 100 /* msec */);
+        if (ret < 0 && errno != EINTR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "poll() failed" + ENO);
+            break;
+        }
+
+        if (ret > 0)
+        {
+#ifdef linux
+            int count = recvmmsg(fd, &msgs[0], kBatchSize, MSG_DONTWAIT, NULL);
+            for (int i = 0; i < count; i++)
+            {
+                HandleDatagram(m_buffer + i * kMaxDatagramSize,
+                               msgs[i].msg_len);
+            }
+#else
+            ssize_t len = recv(fd, m_buffer, kMaxDatagramSize, MSG_DONTWAIT);
+            if (len > 0)
+                HandleDatagram(m_buffer, len);
+#endif
+        }
+
+        // Give up on missing datagrams that took too long.
+        if (m_rtp && m_held)
+            FlushJitterBuffer(false);
+
+        Deliver();
+    }
+
+    if (m_rtp && m_held)
+        FlushJitterBuffer(true);
+    Deliver();
+
+    m_lock.lock();
+    m_running = false;
+    m_waitcond.wakeAll();
+    m_lock.unlock();
+
+    LOG(VB_RECORD, LOG_INFO, LOC + "Run() -- end");
+}
+
+void IPTVFeederSocket::Stop(void)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC + "Stop() -- begin");
+    QMutexLocker locker(&m_lock);
+    m_interrupted = true;
+
+    while (m_running)
+        m_waitcond.wait(&m_lock, 500);
+
+    LOG(VB_RECORD, LOG_INFO, LOC + "Stop() -- end");
+}
+
+void IPTVFeederSocket::AddListener(TSDataListener *item)
+{
+    if (!item)
+        return;
+
+    // avoid duplicates
+    RemoveListener(item);
+
+    QMutexLocker locker(&m_listener_lock);
+    m_listeners.push_back(item);
+}
+
+void IPTVFeederSocket::RemoveListener(TSDataListener *item)
+{
+    QMutexLocker locker(&m_listener_lock);
+    vector<TSDataListener*>::iterator it =
+        find(m_listeners.begin(), m_listeners.end(), item);
+
+    if (it != m_listeners.end())
+        m_listeners.erase(it);
+}
+
+bool IPTVFeederSocket::GetStats(IPTVFeederStats &stats) const
+{
+    QMutexLocker locker(&m_listener_lock);
+    stats = m_stats;
+    return true;
+}
+
+void IPTVFeederSocket::HandleDatagram(const unsigned char *data, uint len)
+{
+    {
+        QMutexLocker locker(&m_listener_lock);
+        m_stats.datagrams++;
+    }
+
+    if (m_rtp)
+        HandleRTP(data, len);
+    else
+        Append(data, len);
+}
+
+/// Strips the RTP header and puts the payload in sequence order.
+void IPTVFeederSocket::HandleRTP(const unsigned char *data, uint len)
+{
+    if (len < 12 || (data[0] >> 6) != 2)
+        return;
+
+    uint header = 12 + (data[0] & 0x0f) * 4;
+    if ((data[0] & 0x10) && len >= header + 4)
+        header += 4 + ((data[header + 2] << 8) | data[header + 3]) * 4;
+    uint padding = (data[0] & 0x20) ? data[len - 1] : 0;
+    if (header + padding >= len)
+        return;
+
+    uint16_t seq = (data[2] << 8) | data[3];
+    const unsigned char *payload = data + header;
+    uint payload_len = len - header - padding;
+
+    if (!m_have_seq)
+    {
+        m_have_seq    = true;
+        m_next_seq    = seq;
+        m_highest_seq = seq;
+    }
+
+    int16_t diff = (int16_t)(seq - m_next_seq);
+    if (diff < 0)
+    {
+        // Already delivered or given up on, or the sender restarted.
+        if (diff > -(int)kSlots)
+        {
+            QMutexLocker locker(&m_listener_lock);
+            m_stats.duplicates++;
+            return;
+        }
+        FlushJitterBuffer(true);
+        m_next_seq = m_highest_seq = seq;
+        diff = 0;
+    }
+    else if (diff >= (int)kSlots)
+    {
+        // Too far ahead to hold back everything in between.
+        FlushJitterBuffer(true);
+        QMutexLocker locker(&m_listener_lock);
+        m_stats.lost += (uint16_t)(seq - m_next_seq);
+        m_next_seq = m_highest_seq = seq;
+        diff = 0;
+    }
+
+    Slot &slot = m_slots[seq & (kSlots - 1)];
+    if (slot.used)
+    {
+        QMutexLocker locker(&m_listener_lock);
+        m_stats.duplicates++;
+        return;
+    }
+
+    if ((int16_t)(seq - m_highest_seq) < 0)
+    {
+        QMutexLocker locker(&m_listener_lock);
+        m_stats.reordered++;
+    }
+    else
+    {
+        m_highest_seq = seq;
+    }
+
+    if (diff == 0)
+    {
+        Append(payload, payload_len);
+        m_next_seq++;
+    }
+    else
+    {
+        slot.used    = true;
+        slot.seq     = seq;
+        slot.arrived = m_clock.elapsed();
+        slot.len     = min(payload_len, (uint)sizeof(slot.data));
+        memcpy(slot.data, payload, slot.len);
+        m_held++;
+    }
+
+    FlushJitterBuffer(m_jitter_window <= 0);
+}
+
+/** \fn IPTVFeederSocket::FlushJitterBuffer(bool)
+ *  \brief Delivers held datagrams which are next in sequence.
+ *
+ *   If the oldest held datagram has waited longer than the jitter window,
+ *   or force is set, the datagrams missing before it are counted as lost
+ *   and skipped.
+ */
+void IPTVFeederSocket::FlushJitterBuffer(bool force)
+{
+    int now = m_clock.elapsed();
+
+    while (m_held)
+    {
+        Slot &slot = m_slots[m_next_seq & (kSlots - 1)];
+        if (slot.used && slot.seq == m_next_seq)
+        {
+            Append(slot.data, slot.len);
+            slot.used = false;
+            m_held--;
+            m_next_seq++;
+            continue;
+        }
+
+        // Find the first held datagram after the gap.
+        uint gap = 1;
+        for (; gap < kSlots; gap++)
+        {
+            const Slot &next = m_slots[(m_next_seq + gap) & (kSlots - 1)];
+            if (next.used && next.seq == (uint16_t)(m_next_seq + gap))
+                break;
+        }
+
+        if (gap >= kSlots)
+        {
+            m_held = 0;
+            for (uint i = 0; i < kSlots; i++)
+                m_slots[i].used = false;
+            break;
+        }
+
+        const Slot &next = m_slots[(m_next_seq + gap) & (kSlots - 1)];
+        int age = now - next.arrived;
+        if (!force && age >= 0 && age < m_jitter_window)
+            break;
+
+        QMutexLocker locker(&m_listener_lock);
+        m_stats.lost += gap;
+        m_next_seq += gap;
+    }
+}
+
+void IPTVFeederSocket::Append(const unsigned char *data, uint len)
+{
+    if (m_out_len + len > kBatchSize * kMaxDatagramSize)
+        Deliver();
+    memcpy(m_out + m_out_len, data, len);
+    m_out_len += len;
+}
+
+/// Hands everything read since the last call to the listeners at once.
+void IPTVFeederSocket::Deliver(void)
+{
+    if (!m_out_len)
+        return;
+
+    QMutexLocker locker(&m_listener_lock);
+    vector<TSDataListener*>::iterator it = m_listeners.begin();
+    for (; it != m_listeners.end(); ++it)
+        (*it)->AddData(m_out, m_out_len);
+    m_out_len = 0;
+}
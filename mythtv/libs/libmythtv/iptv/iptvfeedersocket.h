@@ -0,0 +1,116 @@
+/** -*- Mode: c++ -*-
+ *  IPTVFeederSocket -- native UDP/RTP IPTVFeeder
+ *  Distributed as part of MythTV under GPL v2 and later.
+ */
+
+#ifndef _IPTV_FEEDER_SOCKET_H_
+#define _IPTV_FEEDER_SOCKET_H_
+
+// C headers
+#include <stdint.h>
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QWaitCondition>
+#include <QMutex>
+
+// MythTV headers
+#include "iptvfeeder.h"
+#include "mythtimer.h"
+
+/** \class IPTVFeederSocket
+ *  \brief Reads udp:// and rtp:// streams straight from a socket.
+ *
+ *   Datagrams are read in batches (recvmmsg() on Linux) from a socket
+ *   with a large receive buffer, and handed to the listeners a batch at
+ *   a time. Each datagram normally carries seven whole TS packets, so
+ *   what the listeners get is packet aligned.
+ *
+ *   RTP datagrams are put back in sequence order. A datagram that
+ *   arrives ahead of a missing one is held for up to "IPTVJitterWindow"
+ *   msec waiting for the gap to be filled, after that the missing
+ *   datagrams are counted as lost and skipped.
+ */
+class IPTVFeederSocket : public IPTVFeeder
+{
+  public:
+    IPTVFeederSocket();
+    virtual ~IPTVFeederSocket();
+
+    bool CanHandle(const QString &url) const
+        { return IsUDP(url) || IsRTP(url); }
+    bool IsOpen(void) const;
+
+    bool Open(const QString &url);
+    void Close(void);
+    void Run(void);
+    void Stop(void);
+
+    void AddListener(TSDataListener*);
+    void RemoveListener(TSDataListener*);
+
+    bool GetStats(IPTVFeederStats &stats) const;
+
+    static bool IsUDP(const QString &url);
+    static bool IsRTP(const QString &url);
+
+  private:
+    void HandleDatagram(const unsigned char *data, uint len);
+    void HandleRTP(const unsigned char *data, uint len);
+    void FlushJitterBuffer(bool force);
+    void Append(const unsigned char *data, uint len);
+    void Deliver(void);
+
+  private:
+    IPTVFeederSocket &operator=(const IPTVFeederSocket&);
+    IPTVFeederSocket(const IPTVFeederSocket&);
+
+    class Slot
+    {
+      public:
+        Slot() : used(false), seq(0), arrived(0), len(0) {}
+
+        bool     used;
+        uint16_t seq;
+        int      arrived;  ///< msec, from m_clock
+        uint     len;
+        unsigned char data[2048];
+    };
+
+  private:
+    int             m_socket;
+    bool            m_rtp;
+
+    mutable QMutex  m_lock;
+    QWaitCondition  m_waitcond;
+    bool            m_interrupted;
+    bool            m_running;
+
+    // only used by Run()
+    unsigned char  *m_buffer;
+    unsigned char  *m_out;
+    uint            m_out_len;
+
+    // RTP reordering, only used by Run()
+    Slot           *m_slots;
+    bool            m_have_seq;
+    uint16_t        m_next_seq;
+    uint16_t        m_highest_seq;
+    uint            m_held;
+    int             m_jitter_window;
+    MythTimer       m_clock;
+
+    mutable QMutex          m_listener_lock;
+    vector<TSDataListener*> m_listeners;
+    IPTVFeederStats         m_stats;  ///< protected by m_listener_lock
+
+    static const uint kBatchSize;
+    static const uint kMaxDatagramSize;
+    static const uint kSlots;
+    static const int  kSocketBufferSize;
+};
+
+#endif // _IPTV_FEEDER_SOCKET_H_
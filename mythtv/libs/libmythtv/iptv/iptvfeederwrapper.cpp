@@ -17,6 +17,9 @@ using namespace std;
 #include "iptvfeederrtp.h"
 #include "iptvfeederfile.h"
 #include "iptvfeederhls.h"
+#ifndef USING_MINGW
+#include "iptvfeedersocket.h"
+#endif
 #include "mythcontext.h"
 #include "mythlogging.h"
 
@@ -58,6 +61,12 @@ bool IPTVFeederWrapper::InitFeeder(const QString &url)
     {
         tmp_feeder = new IPTVFeederRTSP();
     }
+#ifndef USING_MINGW
+    else if (IPTVFeederSocket::IsUDP(url) || IPTVFeederSocket::IsRTP(url))
+    {
+        tmp_feeder = new IPTVFeederSocket();
+    }
+#endif
     else if (IPTVFeederUDP::IsUDP(url))
     {
         tmp_feeder = new IPTVFeederUDP();
@@ -208,3 +217,9 @@ void IPTVFeederWrapper::RemoveListener(TSDataListener *item)
                                            "removed)")
                        .arg((uint64_t)item,0,16));
 }
+
+bool IPTVFeederWrapper::GetStats(IPTVFeederStats &stats) const
+{
+    QMutexLocker locker(&_lock);
+    return _feeder && _feeder->GetStats(stats);
+}
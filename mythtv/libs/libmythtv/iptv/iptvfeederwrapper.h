@@ -14,6 +14,7 @@ using namespace std;
 #include <QMutex>
 
 class IPTVFeeder;
+class IPTVFeederStats;
 class TSDataListener;
 
 /** \class IPTVFeederWrapper
@@ -37,6 +38,8 @@ class IPTVFeederWrapper
     void AddListener(TSDataListener*);
     void RemoveListener(TSDataListener*);
 
+    bool GetStats(IPTVFeederStats &stats) const;
+
   private:
     bool InitFeeder(const QString &url);
 
@@ -128,29 +128,33 @@ static int IPTVRecorder_findTSHeader(const unsigned char *data,
 // ===================================================
 void IPTVRecorder::AddData(const unsigned char *data, unsigned int dataSize)
 {
+    // If recorder is paused, stop there. This takes a lock, so it is
+    // checked once per batch of datagrams rather than for every packet.
+    if (IsPaused(false))
+        return;
+
     unsigned int readIndex = 0;
 
     // data may be compose from more than one packet, loop to consume all data
     while (readIndex < dataSize)
     {
-        // If recorder is paused, stop there
-        if (IsPaused(false))
-            return;
-
-        // Find the next TS Header in data
-        int tsPos = IPTVRecorder_findTSHeader(
-            data + readIndex, dataSize - readIndex);
-
-        // if no TS, something bad happens
-        if (tsPos == -1)
-        {
-            LOG(VB_GENERAL, LOG_ERR, LOC + "No TS header.");
-            break;
-        }
-
-        // if TS Header not at start of data, we receive out of sync data
-        if (tsPos > 0)
+        // Datagrams carry whole packets, so as long as we are in sync
+        // the next packet starts right where the last one ended.
+        int tsPos = 0;
+        if (data[readIndex] != SYNC_BYTE)
         {
+            // Find the next TS Header in data
+            tsPos = IPTVRecorder_findTSHeader(
+                data + readIndex, dataSize - readIndex);
+
+            // if no TS, something bad happens
+            if (tsPos == -1)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC + "No TS header.");
+                break;
+            }
+
+            // if TS Header not at start of data, we receive out of sync data
             LOG(VB_GENERAL, LOG_ERR, LOC +
                 QString("TS packet at %1, not in sync.").arg(tsPos));
         }
@@ -2,10 +2,15 @@
 
 #include <unistd.h>
 
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 // MythTV headers
 #include "mpegstreamdata.h"
 #include "iptvchannel.h"
 #include "iptvfeederwrapper.h"
+#include "iptvfeeder.h"
 #include "iptvsignalmonitor.h"
 #include "mythlogging.h"
 
@@ -40,7 +45,13 @@ IPTVSignalMonitor::IPTVSignalMonitor(int db_cardnum,
                                      IPTVChannel *_channel,
                                      uint64_t _flags) :
     DTVSignalMonitor(db_cardnum, _channel, _flags),
-    dtvMonitorRunning(false), tableMonitorThread(NULL)
+    dtvMonitorRunning(false), tableMonitorThread(NULL),
+    m_hasFeederStats(false),
+    // These are informational only, they are always "good"
+    m_lostDatagrams     (QObject::tr("Lost Datagrams"),      "lost",
+                         65535,  false,     0, 65535, 0),
+    m_reorderedDatagrams(QObject::tr("Reordered Datagrams"), "reordered",
+                         65535,  false,     0, 65535, 0)
 {
     bool isLocked = false;
     IPTVChannelInfo chaninfo = GetChannel()->GetCurrentChanInfo();
@@ -131,6 +142,35 @@ bool IPTVSignalMonitor::IsAllGood(void) const
 }
 
 
+QStringList IPTVSignalMonitor::GetStatusList(void) const
+{
+    QStringList list = DTVSignalMonitor::GetStatusList();
+    QMutexLocker locker(&statusLock);
+    if (m_hasFeederStats)
+    {
+        list<<m_lostDatagrams.GetName()<<m_lostDatagrams.GetStatus();
+        list<<m_reorderedDatagrams.GetName()
+            <<m_reorderedDatagrams.GetStatus();
+    }
+    return list;
+}
+
+/** \fn IPTVSignalMonitor::UpdateFeederStats(void)
+ *  \brief Copies the RTP loss and reordering counters of the feeder,
+ *         if it keeps them, into the values sent to the frontend.
+ */
+void IPTVSignalMonitor::UpdateFeederStats(void)
+{
+    IPTVFeederStats stats;
+    if (!GetChannel()->GetFeeder()->GetStats(stats) || !stats.rtp)
+        return;
+
+    QMutexLocker locker(&statusLock);
+    m_hasFeederStats = true;
+    m_lostDatagrams.SetValue(min(stats.lost, (uint64_t)65535));
+    m_reorderedDatagrams.SetValue(min(stats.reordered, (uint64_t)65535));
+}
+
 /** \fn IPTVSignalMonitor::UpdateValues(void)
  *  \brief Fills in frontend stats and emits status Qt signals.
  *
@@ -142,6 +182,8 @@ void IPTVSignalMonitor::UpdateValues(void)
     if (!running || exit)
         return;
 
+    UpdateFeederStats();
+
     if (dtvMonitorRunning)
     {
         EmitStatus();
@@ -32,6 +32,8 @@ class IPTVSignalMonitor : public DTVSignalMonitor, public TSDataListener
     bool HasExtraSlowTuning(void) const { return true; }
     bool IsAllGood(void) const;
 
+    virtual QStringList GetStatusList(void) const;
+
     // implements TSDataListener
     void AddData(const unsigned char *data, unsigned int dataSize);
 
@@ -40,6 +42,7 @@ class IPTVSignalMonitor : public DTVSignalMonitor, public TSDataListener
     IPTVSignalMonitor(const IPTVSignalMonitor&);
 
     virtual void UpdateValues(void);
+    void UpdateFeederStats(void);
 
     void RunTableMonitor(void);
 
@@ -51,6 +54,9 @@ class IPTVSignalMonitor : public DTVSignalMonitor, public TSDataListener
 
   private:
     mutable bool m_gotlock;
+    bool               m_hasFeederStats;
+    SignalMonitorValue m_lostDatagrams;
+    SignalMonitorValue m_reorderedDatagrams;
 };
 
 #endif // _IPTVSIGNALMONITOR_H_
@@ -4,6 +4,7 @@
 #include <sys/stat.h>
 #include <iostream>
 #include <cstdlib>
+#include <algorithm>
 #include <fcntl.h>
 #include <pthread.h>
 using namespace std;
@@ -13,6 +14,8 @@ using namespace std;
 #include <QRegExp>
 #include <QEvent>
 #include <QCoreApplication>
+#include <QThread>
+#include <QFile>
 
 #include "mythconfig.h"
 
@@ -43,6 +46,11 @@ using namespace std;
 
 #define LOC     QString("JobQueue: ")
 
+/// Minimum time between two samples of /proc/diskstats, in msec
+static const int kDiskSampleInterval = 5000;
+/// Shortest window the disk utilization is measured over, in msec
+static const int kDiskSampleWindow   = 1000;
+
 JobQueue::JobQueue(bool master) :
     m_hostname(gCoreContext->GetHostName()),
     jobsRunning(0),
@@ -51,10 +59,22 @@ JobQueue::JobQueue(bool master) :
     runningJobsLock(new QMutex(QMutex::Recursive)),
     isMaster(master),
     queueThread(new MThread("JobQueue", this)),
-    processQueue(false)
+    processQueue(false),
+    queueChanged(false),
+    m_diskBusy(0.0),
+    m_diskBusyValid(false),
+    m_statsStarted(0),
+    m_statsFinished(0),
+    m_statsLatency(0),
+    m_statsStartTime(MythDate::current()),
+    m_statsLastLog(MythDate::current())
 {
     jobQueueCPU = gCoreContext->GetNumSetting("JobQueueCPU", 0);
 
+    // Seed the disk counters, so the first GetDiskBusy() has a baseline
+    if (SampleDiskTicks(m_diskTicks))
+        m_diskSampleTimer.start();
+
 #ifndef USING_VALGRIND
     QMutexLocker locker(&queueThreadCondLock);
     processQueue = true;
@@ -91,6 +111,17 @@ void JobQueue::customEvent(QEvent *e)
         MythEvent *me = (MythEvent *)e;
         QString message = me->Message();
 
+        if (message.left(10) == "JOB_QUEUED")
+        {
+            // JOB_QUEUED type hostname
+            // Jobs are pushed to the queue thread instead of waiting for
+            // the next JobQueueCheckFrequency poll.
+            QMutexLocker locker(&queueThreadCondLock);
+            queueChanged = true;
+            queueThreadCond.wakeAll();
+            return;
+        }
+
         if (message.left(9) == "LOCAL_JOB")
         {
             // LOCAL_JOB action ID jobID
@@ -177,6 +208,7 @@ void JobQueue::ProcessQueue(void)
 
     QMap<int, int> jobStatus;
     int maxJobs;
+    int runningByClass[JOB_CLASS_COUNT];
     QString message;
     QMap<int, JobQueueEntry> jobs;
     bool atMax = false;
@@ -208,6 +240,8 @@ void JobQueue::ProcessQueue(void)
         runningJobsLock->unlock();
 
         jobsRunning = 0;
+        for (int c = 0; c < JOB_CLASS_COUNT; c++)
+            runningByClass[c] = 0;
         GetJobsInQueue(jobs);
 
         if (jobs.size())
@@ -222,7 +256,10 @@ void JobQueue::ProcessQueue(void)
                      (status == JOB_STARTING) ||
                      (status == JOB_PAUSED)) &&
                     (hostname == m_hostname))
-                jobsRunning++;
+                {
+                    jobsRunning++;
+                    runningByClass[JobClass(jobs[x].type)]++;
+                }
             }
 
             message = QString("Currently Running %1 jobs.")
@@ -435,6 +472,17 @@ void JobQueue::ProcessQueue(void)
                 if (startedJobAlready)
                     continue;
 
+                // Don't claim jobs we can't start now so an idle host can
+                if ((inTimeWindow) &&
+                    (!ResourcesAvailable(jobs[x], runningByClass, message)))
+                {
+                    message = QString("Deferring '%1' job for %2, %3")
+                                      .arg(JobText(jobs[x].type)).arg(logInfo)
+                                      .arg(message);
+                    LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
+                    continue;
+                }
+
                 if ((inTimeWindow) &&
                     (hostname.isEmpty()) &&
                     (!ChangeJobHost(jobID, m_hostname)))
@@ -490,14 +538,244 @@ void JobQueue::ProcessQueue(void)
         }
 
 
+        LogQueueStats();
+
         locker.relock();
-        if (processQueue)
+        if (processQueue && !queueChanged)
         {
             int st = (startedJobAlready) ? (5 * 1000) : (sleepTime * 1000);
             if (st > 0)
                 queueThreadCond.wait(locker.mutex(), st);
         }
+        queueChanged = false;
+    }
+
+    LogQueueStats(true);
+}
+
+/** \fn JobQueue::JobClass(int)
+ *  \brief Returns the concurrency class (JobClasses) of a job type.
+ */
+int JobQueue::JobClass(int jobType)
+{
+    if (jobType & JOB_USERJOB)
+        return JOB_CLASS_USERJOB;
+    if (jobType == JOB_TRANSCODE)
+        return JOB_CLASS_TRANSCODE;
+    if (jobType == JOB_METADATA)
+        return JOB_CLASS_METADATA;
+    return JOB_CLASS_COMMFLAG;
+}
+
+/** \fn JobQueue::ResourcesAvailable(const JobQueueEntry&, const int*,
+ *                                   QString&)
+ *  \brief Checks the per class job limit and, for the CPU and disk heavy
+ *         commercial flagging and transcoding jobs, the live CPU load,
+ *         disk I/O pressure and the number of active recorders.
+ *
+ *  A limit of 0 in any of the settings disables that check.
+ *  \param reason set to a description of the limit that was hit
+ */
+bool JobQueue::ResourcesAvailable(const JobQueueEntry &job,
+                                  const int *runningByClass, QString &reason)
+{
+    static const char *classSettings[JOB_CLASS_COUNT] =
+    {
+        "JobQueueMaxCommFlagJobs", "JobQueueMaxTranscodeJobs",
+        "JobQueueMaxMetadataJobs", "JobQueueMaxUserJobs",
+    };
+
+    int jobClass = JobClass(job.type);
+    int maxClass = gCoreContext->GetNumSetting(classSettings[jobClass], 0);
+    if ((maxClass > 0) && (runningByClass[jobClass] >= maxClass))
+    {
+        reason = QString("%1 job(s) of this class already running")
+                         .arg(runningByClass[jobClass]);
+        return false;
+    }
+
+    if ((jobClass != JOB_CLASS_COMMFLAG) && (jobClass != JOB_CLASS_TRANSCODE))
+        return true;
+
+    int maxLoad = gCoreContext->GetNumSetting("JobQueueMaxCPULoad", 0);
+    if (maxLoad > 0)
+    {
+        double load = GetCPULoad();
+        if (load * 100.0 > maxLoad)
+        {
+            reason = QString("CPU load is %1% of the available cores")
+                             .arg((int)(load * 100.0));
+            return false;
+        }
+    }
+
+    int maxDisk = gCoreContext->GetNumSetting("JobQueueMaxDiskBusy", 0);
+    if (maxDisk > 0)
+    {
+        double busy = GetDiskBusy();
+        if (busy > maxDisk)
+        {
+            reason = QString("busiest disk is %1% utilized").arg((int)busy);
+            return false;
+        }
+    }
+
+    int maxRec = gCoreContext->GetNumSetting("JobQueueMaxActiveRecorders", 0);
+    if (maxRec > 0)
+    {
+        int recorders = GetActiveRecorderCount();
+        if (recorders >= maxRec)
+        {
+            reason = QString("%1 recorder(s) are active on this host")
+                             .arg(recorders);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Returns the one minute load average divided by the number of cores.
+double JobQueue::GetCPULoad(void)
+{
+    double loadavg[3];
+    if (getloadavg(loadavg, 3) == -1)
+        return 0.0;
+
+    int cores = max(QThread::idealThreadCount(), 1);
+    return loadavg[0] / cores;
+}
+
+/** \fn JobQueue::GetDiskBusy(void)
+ *  \brief Returns the utilization, in percent, of the busiest disk,
+ *         based on the io_ticks of /proc/diskstats.
+ *
+ *  The utilization is measured between two samples of the counters,
+ *  over the time that actually passed between them. A new figure is
+ *  measured at most once every kDiskSampleInterval msec, calls in
+ *  between get the last result, so every job checked in the same queue
+ *  pass sees the same figure.
+ *
+ *  The window is kDiskSampleInterval to twice that. When the previous
+ *  sample is older, or there is none, a fresh one is taken and the
+ *  utilization is measured over the next kDiskSampleWindow msec.
+ *
+ *  Returns 0 on systems without /proc/diskstats.
+ */
+double JobQueue::GetDiskBusy(void)
+{
+    if (m_diskBusyValid &&
+        m_diskSampleTimer.elapsed() < kDiskSampleInterval)
+    {
+        return m_diskBusy;
+    }
+
+    if (!m_diskSampleTimer.isRunning() ||
+        m_diskSampleTimer.elapsed() > 2 * kDiskSampleInterval)
+    {
+        if (!SampleDiskTicks(m_diskTicks))
+            return 0.0;
+        m_diskSampleTimer.start();
+    }
+
+    int wait = kDiskSampleWindow - m_diskSampleTimer.elapsed();
+    if (wait > 0)
+        usleep(wait * 1000);
+
+    QMap<QString, qulonglong> ticks;
+    if (!SampleDiskTicks(ticks))
+        return 0.0;
+    qint64 elapsed = m_diskSampleTimer.restart();
+
+    double busiest = 0.0;
+    QMap<QString, qulonglong>::const_iterator it = ticks.begin();
+    for (; it != ticks.end(); ++it)
+    {
+        QMap<QString, qulonglong>::const_iterator prev =
+            m_diskTicks.find(it.key());
+        if (prev != m_diskTicks.end() && elapsed > 0 && *it >= *prev)
+            busiest = max(busiest, (*it - *prev) * 100.0 / elapsed);
+    }
+    m_diskTicks = ticks;
+
+    m_diskBusy = min(busiest, 100.0);
+    m_diskBusyValid = true;
+    return m_diskBusy;
+}
+
+/// Reads the io_ticks of each disk from /proc/diskstats, by device name.
+bool JobQueue::SampleDiskTicks(QMap<QString, qulonglong> &ticks)
+{
+    QFile file("/proc/diskstats");
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    ticks.clear();
+    QString line;
+    while (!(line = file.readLine()).isEmpty())
+    {
+        QStringList fields = line.simplified().split(' ');
+        if (fields.size() < 13)
+            continue;
+
+        QString dev = fields[2];
+        if (dev.startsWith("loop") || dev.startsWith("ram"))
+            continue;
+
+        // field 13 is the number of milliseconds spent doing I/O
+        ticks[dev] = fields[12].toULongLong();
+    }
+
+    return true;
+}
+
+/// Returns the number of recorders currently recording on this host.
+int JobQueue::GetActiveRecorderCount(void)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    query.prepare("SELECT COUNT(*) FROM inuseprograms "
+                  "WHERE recusage = :RECUSAGE AND hostname = :HOSTNAME "
+                  "  AND lastupdatetime > :ONEHOURAGO ;");
+    query.bindValue(":RECUSAGE", kRecorderInUseID);
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+    query.bindValue(":ONEHOURAGO", MythDate::current().addSecs(-60 * 60));
+
+    if (!query.exec() || !query.next())
+    {
+        MythDB::DBError("JobQueue::GetActiveRecorderCount()", query);
+        return 0;
     }
+
+    return query.value(0).toInt();
+}
+
+/** \fn JobQueue::LogQueueStats(bool)
+ *  \brief Logs queue latency (time from insertion to start) and
+ *         throughput every 15 minutes, or immediately when forced.
+ */
+void JobQueue::LogQueueStats(bool force)
+{
+    QMutexLocker locker(&m_statsLock);
+
+    QDateTime now = MythDate::current();
+    if (!force && m_statsLastLog.secsTo(now) < 15 * 60)
+        return;
+    m_statsLastLog = now;
+
+    if (!m_statsStarted && !m_statsFinished)
+        return;
+
+    qint64 secs  = max((qint64)m_statsStartTime.secsTo(now), (qint64)1);
+    double hours = secs / 3600.0;
+    QString avgLatency = (m_statsStarted) ?
+        QString::number(m_statsLatency / m_statsStarted) : QString("-");
+
+    LOG(VB_JOBQUEUE, LOG_INFO, LOC +
+        QString("Queue statistics: %1 job(s) started, average queue "
+                "latency %2 secs, %3 job(s) finished, %4 jobs/hour")
+            .arg(m_statsStarted).arg(avgLatency).arg(m_statsFinished)
+            .arg(m_statsFinished / hours, 0, 'f', 2));
 }
 
 bool JobQueue::QueueRecordingJobs(const RecordingInfo &recinfo, int jobTypes)
@@ -609,6 +887,9 @@ bool JobQueue::QueueJob(int jobType, uint chanid, const QDateTime &recstartts,
         return false;
     }
 
+    gCoreContext->SendMessage(QString("JOB_QUEUED %1 %2")
+                              .arg(jobType).arg(host));
+
     return true;
 }
 
@@ -1686,6 +1967,13 @@ void JobQueue::ProcessJob(JobQueueEntry job)
     }
 
 
+    m_statsLock.lock();
+    m_statsStarted++;
+    if (job.inserttime.isValid())
+        m_statsLatency += max(
+            (qint64)job.inserttime.secsTo(MythDate::current()), (qint64)0);
+    m_statsLock.unlock();
+
     runningJobsLock->lock();
 
     ChangeJobStatus(jobID, JOB_STARTING);
@@ -1830,6 +2118,15 @@ void JobQueue::RemoveRunningJob(int id)
         }
 
         runningJobs.remove(id);
+
+        m_statsLock.lock();
+        m_statsFinished++;
+        m_statsLock.unlock();
+
+        // Let the queue thread start the next job right away
+        QMutexLocker locker(&queueThreadCondLock);
+        queueChanged = true;
+        queueThreadCond.wakeAll();
     }
 
     runningJobsLock->unlock();
@@ -2283,6 +2580,8 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
     uint breaksFound = 0;
     QString path;
     QString command;
+    QDateTime startTime = MythDate::current();
+    bool previewFromFlagger = false;
 
     runningJobsLock->lock();
     if (runningJobs[jobID].command == "mythcommflag")
@@ -2291,6 +2590,13 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
         command = QString("%1 -j %2 --noprogress")
                           .arg(path).arg(jobID);
         command += logPropagateArgs;
+
+        // mythcommflag makes the preview from the frames it decodes
+        // anyway, rather than us decoding the recording again after it
+        previewFromFlagger =
+            gCoreContext->GetNumSetting("JobQueueCommFlagPreview", 0);
+        if (previewFromFlagger)
+            command += " --preview";
     }
     else
     {
@@ -2345,7 +2651,17 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
 
         if (!program_info->IsLocal())
             program_info->SetPathname(program_info->GetPlaybackURL(false,true));
-        if (program_info->IsLocal())
+        // A preview made since we started is from mythcommflag, or from
+        // the recorder if we flagged while recording, either will do
+        QFileInfo preview(program_info->GetPathname() + ".png");
+        if (previewFromFlagger && program_info->IsLocal() &&
+            preview.exists() && (preview.lastModified() >= startTime))
+        {
+            LOG(VB_JOBQUEUE, LOG_INFO, LOC +
+                QString("Preview made by mythcommflag '%1'")
+                    .arg(preview.filePath()));
+        }
+        else if (program_info->IsLocal())
         {
             PreviewGenerator *pg = new PreviewGenerator(
                 program_info, QString(), PreviewGenerator::kLocal);
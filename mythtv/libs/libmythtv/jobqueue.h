@@ -12,6 +12,7 @@
 #include <QMap>
 
 #include "mythtvexp.h"
+#include "mythtimer.h"
 
 class MThread;
 class ProgramInfo;
@@ -85,6 +86,15 @@ enum JobTypes {
     JOB_USERJOB4     = 0x0800
 };
 
+/// Concurrency classes, each with its own limit on simultaneous jobs
+enum JobClasses {
+    JOB_CLASS_COMMFLAG  = 0,
+    JOB_CLASS_TRANSCODE = 1,
+    JOB_CLASS_METADATA  = 2,
+    JOB_CLASS_USERJOB   = 3,
+    JOB_CLASS_COUNT     = 4
+};
+
 typedef struct jobqueueentry {
     int id;
     uint chanid;
@@ -186,6 +196,7 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
 
     static QString JobText(int jobType);
     static QString StatusText(int status);
+    static int JobClass(int jobType);
 
     static bool HasRunningOrPendingJobs(int startingWithinMins = 0);
 
@@ -210,6 +221,14 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     void ProcessJob(JobQueueEntry job);
 
     bool AllowedToRun(JobQueueEntry job);
+    bool ResourcesAvailable(const JobQueueEntry &job,
+                            const int *runningByClass, QString &reason);
+
+    double GetDiskBusy(void);
+    static bool SampleDiskTicks(QMap<QString, qulonglong> &ticks);
+    static double GetCPULoad(void);
+    static int GetActiveRecorderCount(void);
+    void LogQueueStats(bool force = false);
 
     static bool InJobRunWindow(int orStartingWithinMins = 0);
 
@@ -252,6 +271,22 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     QWaitCondition queueThreadCond;
     QMutex queueThreadCondLock;
     bool processQueue;
+    /// set when a job was queued or finished since the last queue check
+    bool queueChanged;
+
+    // Disk I/O pressure sampling, see GetDiskBusy()
+    QMap<QString, qulonglong> m_diskTicks;
+    MythTimer m_diskSampleTimer;
+    double    m_diskBusy;
+    bool      m_diskBusyValid;
+
+    // Queue latency and throughput statistics
+    QMutex    m_statsLock;
+    uint      m_statsStarted;
+    uint      m_statsFinished;
+    qint64    m_statsLatency;
+    QDateTime m_statsStartTime;
+    QDateTime m_statsLastLog;
 };
 
 #endif
@@ -575,6 +575,12 @@ using_backend {
         SOURCES += iptv/iptvfeederrtp.cpp     iptv/timeoutedtaskscheduler.cpp
         SOURCES += iptv/iptvfeederhls.cpp
 
+        # native UDP/RTP reader, uses POSIX sockets
+        !mingw {
+            HEADERS += iptv/iptvfeedersocket.h
+            SOURCES += iptv/iptvfeedersocket.cpp
+        }
+
         DEFINES += USING_IPTV
     }
 
@@ -20,6 +20,44 @@ static inline void clear(LiveTVChainEntry &entry)
     entry.inputname = QString();
 }
 
+/*
+ * LIVETV_CHAIN UPDATE events carry what changed in the chain, so that the
+ * chains watching it can follow along without going to the database:
+ *
+ *   "APPEND" <chainpos> <entry>
+ *   "FINISHED" <chanid> <starttime> <endtime>
+ *   "DELETE" <chanid> <starttime>
+ *   "RELOAD"
+ *
+ * An event without them (e.g. from an older backend) means reload.
+ */
+static const int kEntryFields = 8;
+
+static void toStringList(const LiveTVChainEntry &entry, QStringList &list)
+{
+    list << QString::number(entry.chanid)
+         << MythDate::toString(entry.starttime, MythDate::ISODate)
+         << MythDate::toString(entry.endtime, MythDate::ISODate)
+         << QString::number(entry.discontinuity)
+         << entry.hostprefix
+         << entry.cardtype
+         << entry.channum
+         << entry.inputname;
+}
+
+static void fromStringList(const QStringList &list, int at,
+                           LiveTVChainEntry &entry)
+{
+    entry.chanid        = list[at++].toUInt();
+    entry.starttime     = MythDate::fromString(list[at++]);
+    entry.endtime       = MythDate::fromString(list[at++]);
+    entry.discontinuity = list[at++].toInt();
+    entry.hostprefix    = list[at++];
+    entry.cardtype      = list[at++];
+    entry.channum       = list[at++];
+    entry.inputname     = list[at++];
+}
+
 /** \class LiveTVChain
  *  \brief Keeps track of recordings in a current LiveTV instance
  */
@@ -70,6 +108,10 @@ void LiveTVChain::AppendNewProgram(ProgramInfo *pginfo, QString channum,
     newent.starttime = QDateTime(
         pginfo->GetRecordingStartTime().date(),
         QTime(tmptime.hour(), tmptime.minute(), tmptime.second()), Qt::UTC);
+    tmptime = pginfo->GetRecordingEndTime().time();
+    newent.endtime = QDateTime(
+        pginfo->GetRecordingEndTime().date(),
+        QTime(tmptime.hour(), tmptime.minute(), tmptime.second()), Qt::UTC);
     newent.discontinuity = discont;
     newent.hostprefix = m_hostprefix;
     newent.cardtype = m_cardtype;
@@ -105,8 +147,12 @@ void LiveTVChain::AppendNewProgram(ProgramInfo *pginfo, QString channum,
             .arg(MythDate::toString(newent.starttime, MythDate::kFilename))
             .arg(m_maxpos));
 
+    QStringList delta;
+    delta << "APPEND" << QString::number(m_maxpos);
+    toStringList(newent, delta);
+
     m_maxpos++;
-    BroadcastUpdate();
+    BroadcastUpdate(delta);
 }
 
 void LiveTVChain::FinishedRecording(ProgramInfo *pginfo)
@@ -138,7 +184,12 @@ void LiveTVChain::FinishedRecording(ProgramInfo *pginfo)
             (*it).endtime = pginfo->GetRecordingEndTime();
         }
     }
-    BroadcastUpdate();
+
+    QStringList delta;
+    delta << "FINISHED" << QString::number(pginfo->GetChanID())
+          << pginfo->GetRecordingStartTime(MythDate::ISODate)
+          << pginfo->GetRecordingEndTime(MythDate::ISODate);
+    BroadcastUpdate(delta);
 }
 
 void LiveTVChain::DeleteProgram(ProgramInfo *pginfo)
@@ -178,21 +229,90 @@ void LiveTVChain::DeleteProgram(ProgramInfo *pginfo)
             if (!query.exec())
                 MythDB::DBError("LiveTVChain::DeleteProgram -- delete", query);
 
+            QStringList delta;
+            delta << "DELETE" << QString::number((*del).chanid)
+                  << MythDate::toString((*del).starttime, MythDate::ISODate);
+
             m_chain.erase(del);
 
-            BroadcastUpdate();
+            BroadcastUpdate(delta);
             break;
         }
     }
 }
 
-void LiveTVChain::BroadcastUpdate(void)
+void LiveTVChain::BroadcastUpdate(const QStringList &delta)
 {
     QString message = QString("LIVETV_CHAIN UPDATE %1").arg(m_id);
-    MythEvent me(message);
+    MythEvent me(message, delta);
     gCoreContext->dispatch(me);
 }
 
+/** \fn LiveTVChain::ApplyDelta(const QStringList&)
+ *  \brief Applies the changes sent with LIVETV_CHAIN UPDATE events.
+ *  \return false if they don't apply to this chain as it stands (e.g. an
+ *          earlier update was missed), and it needs to be reloaded.
+ */
+bool LiveTVChain::ApplyDelta(const QStringList &delta)
+{
+    QMutexLocker lock(&m_lock);
+
+    int prev_size = m_chain.size();
+    int i = 0;
+    while (i < delta.size())
+    {
+        const QString &op = delta[i];
+        if (op == "APPEND" && i + 2 + kEntryFields <= delta.size())
+        {
+            int pos = delta[i + 1].toInt();
+            LiveTVChainEntry entry;
+            fromStringList(delta, i + 2, entry);
+            i += 2 + kEntryFields;
+
+            if (ProgramIsAt(entry.chanid, entry.starttime) >= 0)
+                continue; // already loaded from the database
+            if (pos != m_maxpos)
+                return false;
+
+            m_chain.append(entry);
+            m_maxpos = pos + 1;
+        }
+        else if (op == "FINISHED" && i + 4 <= delta.size())
+        {
+            uint      chanid    = delta[i + 1].toUInt();
+            QDateTime starttime = MythDate::fromString(delta[i + 2]);
+            QDateTime endtime   = MythDate::fromString(delta[i + 3]);
+            i += 4;
+
+            int at = ProgramIsAt(chanid, starttime);
+            if (at < 0)
+                return false;
+            m_chain[at].endtime = endtime;
+        }
+        else if (op == "DELETE" && i + 3 <= delta.size())
+        {
+            uint      chanid    = delta[i + 1].toUInt();
+            QDateTime starttime = MythDate::fromString(delta[i + 2]);
+            i += 3;
+
+            int at = ProgramIsAt(chanid, starttime);
+            if (at < 0)
+                continue; // already gone
+            if (at + 1 < m_chain.size())
+                m_chain[at + 1].discontinuity = true;
+            m_chain.removeAt(at);
+        }
+        else
+        {
+            // "RELOAD", or an update from an older backend
+            return false;
+        }
+    }
+
+    UpdatePositions(prev_size);
+    return true;
+}
+
 void LiveTVChain::DestroyChain(void)
 {
     QMutexLocker lock(&m_lock);
@@ -207,10 +327,19 @@ void LiveTVChain::DestroyChain(void)
         MythDB::DBError("LiveTVChain::DestroyChain", query);
 }
 
-void LiveTVChain::ReloadAll(void)
+/** \fn LiveTVChain::ReloadAll(const QStringList&)
+ *  \brief Brings the chain up to date.
+ *  \param data The changes sent with a LIVETV_CHAIN UPDATE event, if any.
+ *               When they can be applied to the chain as it stands, the
+ *               database isn't read.
+ */
+void LiveTVChain::ReloadAll(const QStringList &data)
 {
     QMutexLocker lock(&m_lock);
 
+    if (!data.isEmpty() && ApplyDelta(data))
+        return;
+
     int prev_size = m_chain.size();
     m_chain.clear();
 
@@ -242,6 +371,11 @@ void LiveTVChain::ReloadAll(void)
         }
     }
 
+    UpdatePositions(prev_size);
+}
+
+void LiveTVChain::UpdatePositions(int prev_size)
+{
     m_curpos = ProgramIsAt(m_cur_chanid, m_cur_startts);
     if (m_curpos < 0)
         m_curpos = 0;
@@ -397,9 +531,16 @@ void LiveTVChain::ClearSwitch(void)
 ProgramInfo *LiveTVChain::GetSwitchProgram(bool &discont, bool &newtype,
                                            int &newid)
 {
-    ReloadAll();
     QMutexLocker lock(&m_lock);
 
+    // The update events keep the chain current, only reload if the
+    // program to switch to has gone missing from it.
+    if (m_switchid >= 0 &&
+        ProgramIsAt(m_switchentry.chanid, m_switchentry.starttime) < 0)
+    {
+        ReloadAll();
+    }
+
     if (m_switchid < 0 || m_curpos == m_switchid)
     {
         ClearSwitch();
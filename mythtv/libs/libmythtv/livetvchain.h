@@ -5,6 +5,7 @@
 #include <QDateTime>
 #include <QMutex>
 #include <QList>
+#include <QStringList>
 
 #include "mythtvexp.h"
 
@@ -42,7 +43,7 @@ class MTV_PUBLIC LiveTVChain
     void FinishedRecording(ProgramInfo *pginfo);
     void DeleteProgram(ProgramInfo *pginfo);
 
-    void ReloadAll();
+    void ReloadAll(const QStringList &data = QStringList());
 
     // const gets
     QString GetID(void)  const { return m_id; }
@@ -85,7 +86,9 @@ class MTV_PUBLIC LiveTVChain
     QString toString() const;
 
   private:
-    void BroadcastUpdate();
+    void BroadcastUpdate(const QStringList &delta);
+    bool ApplyDelta(const QStringList &delta);
+    void UpdatePositions(int prev_size);
     void GetEntryAt(int at, LiveTVChainEntry &entry) const;
     static ProgramInfo *EntryToProgram(const LiveTVChainEntry &entry);
 
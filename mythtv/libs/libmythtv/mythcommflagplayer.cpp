@@ -197,3 +197,17 @@ bool MythCommFlagPlayer::RebuildSeekTable(
 
     return true;
 }
+
+VideoFrame *MythCommFlagPlayer::GetRawVideoFrame(long long frameNumber)
+{
+    VideoFrame *frame = MythPlayer::GetRawVideoFrame(frameNumber);
+
+    if (frame && frame->buf)
+    {
+        QList<FrameTap*>::iterator it = m_taps.begin();
+        for (; it != m_taps.end(); ++it)
+            (*it)->ProcessFrame(frame);
+    }
+
+    return frame;
+}
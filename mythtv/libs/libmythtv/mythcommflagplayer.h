@@ -1,14 +1,37 @@
 #ifndef MYTHCOMMFLAGPLAYER_H
 #define MYTHCOMMFLAGPLAYER_H
 
+#include <QList>
+
 #include "mythplayer.h"
 
+/** \class FrameTap
+ *  \brief Sees each frame a MythCommFlagPlayer hands to the commercial
+ *         detector, so other post-recording work can share that decode.
+ *
+ *   ProcessFrame() is called from the detector's thread, the frame is only
+ *   valid until it returns.
+ */
+class MTV_PUBLIC FrameTap
+{
+  public:
+    virtual ~FrameTap() { }
+    virtual void ProcessFrame(const VideoFrame *frame) = 0;
+};
+
 class MTV_PUBLIC MythCommFlagPlayer : public MythPlayer
 {
   public:
     MythCommFlagPlayer(PlayerFlags flags = kNoFlags) : MythPlayer(flags) { }
     bool RebuildSeekTable(bool showPercentage = true, StatusCallback cb = NULL,
                           void* cbData = NULL);
+
+    /// Taps are not owned by the player
+    void AddFrameTap(FrameTap *tap) { m_taps.push_back(tap); }
+    virtual VideoFrame *GetRawVideoFrame(long long frameNumber = -1);
+
+  private:
+    QList<FrameTap*> m_taps;
 };
 
 #endif // MYTHCOMMFLAGPLAYER_H
@@ -243,7 +243,7 @@ class MTV_PUBLIC MythPlayer
 
     // Decoder stuff..
     VideoFrame *GetNextVideoFrame(void);
-    VideoFrame *GetRawVideoFrame(long long frameNumber = -1);
+    virtual VideoFrame *GetRawVideoFrame(long long frameNumber = -1);
     VideoFrame *GetCurrentFrame(int &w, int &h);
     void DeLimboFrame(VideoFrame *frame);
     virtual void ReleaseNextVideoFrame(VideoFrame *buffer, int64_t timecode,
@@ -8,6 +8,7 @@ using namespace std;
 // Qt headers
 #include <QWidget>
 #include <QString>
+#include <QStringList>
 #include <QMutex>
 #include <QHash>
 #include <QRect>
@@ -60,7 +61,7 @@ class MTV_PUBLIC PlayerContext
     void TeardownPlayer(void);
     bool StartPlaying(int maxWait = -1);
     void StopPlaying(void);
-    void UpdateTVChain(void);
+    void UpdateTVChain(const QStringList &data = QStringList());
     bool ReloadTVChain(void);
     void CreatePIPWindow(const QRect&, int pos = -1, 
                         QWidget *widget = NULL);
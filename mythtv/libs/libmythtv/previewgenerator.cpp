@@ -12,6 +12,7 @@
 #include <QTemporaryFile>
 #include <QFileInfo>
 #include <QMetaType>
+#include <QBuffer>
 #include <QImage>
 #include <QDir>
 #include <QUrl>
@@ -466,6 +467,7 @@ bool PreviewGenerator::event(QEvent *e)
 
 bool PreviewGenerator::SaveOutFile(const QByteArray &data, const QDateTime &dt)
 {
+    QByteArray jpeg;
     if (outFileName.isEmpty())
     {
         QString remotecachedirname =
@@ -483,10 +485,25 @@ bool PreviewGenerator::SaveOutFile(const QByteArray &data, const QDateTime &dt)
             }
         }
 
-        QString filename = programInfo.GetBasename() + ".png";
+        // Same name and format as the previews PreviewGeneratorQueue
+        // fetches with RemoteGetPreviews(), so either can find the other.
+        QString filename = programInfo.GetBasename() + ".jpg";
         outFileName = QString("%1/%2").arg(remotecachedirname).arg(filename);
+
+        QImage image;
+        QBuffer buffer(&jpeg);
+        if (!image.loadFromData(data) || !buffer.open(QIODevice::WriteOnly) ||
+            !image.save(&buffer, "JPG", 85))
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Failed to convert preview for '%1'")
+                    .arg(outFileName));
+            return false;
+        }
     }
 
+    const QByteArray &out = jpeg.isEmpty() ? data : jpeg;
+
     QFile file(outFileName);
     bool ok = file.open(QIODevice::Unbuffered|QIODevice::WriteOnly);
     if (!ok)
@@ -496,11 +513,11 @@ bool PreviewGenerator::SaveOutFile(const QByteArray &data, const QDateTime &dt)
     }
 
     off_t offset = 0;
-    size_t remaining = data.size();
+    size_t remaining = out.size();
     uint failure_cnt = 0;
     while ((remaining > 0) && (failure_cnt < 5))
     {
-        ssize_t written = file.write(data.data() + offset, remaining);
+        ssize_t written = file.write(out.data() + offset, remaining);
         if (written < 0)
         {
             failure_cnt++;
@@ -598,6 +615,58 @@ bool PreviewGenerator::SavePreview(QString filename,
     return false;
 }
 
+/**
+ *  \brief Returns where a preview is taken from when no time is given.
+ *
+ *   This is the bookmark if there is one, as a frame number, otherwise
+ *   a third of the way into the scheduled program, in seconds.
+ *
+ *  \param pginfo     Recording the preview is for.
+ *  \param in_seconds Returns true if the time is in seconds, false if it
+ *                    is a frame number.
+ */
+long long PreviewGenerator::GetDefaultPreviewTime(
+    const ProgramInfo &pginfo, bool &in_seconds)
+{
+    long long captime = pginfo.QueryBookmark();
+    if (captime > 0)
+    {
+        in_seconds = false;
+        return captime;
+    }
+
+    in_seconds = true;
+    captime = -1;
+    int startEarly = 0;
+    int programDuration = 0;
+    int preroll =  gCoreContext->GetNumSetting("RecordPreRoll", 0);
+    if (pginfo.GetScheduledStartTime().isValid() &&
+        pginfo.GetScheduledEndTime().isValid() &&
+        (pginfo.GetScheduledStartTime() !=
+         pginfo.GetScheduledEndTime()))
+    {
+        programDuration = pginfo.GetScheduledStartTime()
+            .secsTo(pginfo.GetScheduledEndTime());
+    }
+    if (pginfo.GetRecordingStartTime().isValid() &&
+        pginfo.GetScheduledStartTime().isValid() &&
+        (pginfo.GetRecordingStartTime() !=
+         pginfo.GetScheduledStartTime()))
+    {
+        startEarly = pginfo.GetRecordingStartTime()
+            .secsTo(pginfo.GetScheduledStartTime());
+    }
+    if (programDuration > 0)
+    {
+        captime = startEarly + (programDuration / 3);
+    }
+    if (captime < 0)
+        captime = 600;
+    captime += preroll;
+
+    return captime;
+}
+
 bool PreviewGenerator::LocalPreviewRun(void)
 {
     programInfo.MarkAsInUse(true, kPreviewGeneratorInUseID);
@@ -611,50 +680,20 @@ bool PreviewGenerator::LocalPreviewRun(void)
     if (captime > 0)
         LOG(VB_GENERAL, LOG_INFO, "Preview from time spec");
 
-    if (captime < 0)
+    if (captime <= 0)
     {
-        captime = programInfo.QueryBookmark();
-        if (captime > 0)
+        captime = GetDefaultPreviewTime(programInfo, timeInSeconds);
+        if (!timeInSeconds)
         {
-            timeInSeconds = false;
             LOG(VB_GENERAL, LOG_INFO,
                 QString("Preview from bookmark (frame %1)").arg(captime));
         }
         else
-            captime = -1;
-    }
-
-    if (captime <= 0)
-    {
-        timeInSeconds = true;
-        int startEarly = 0;
-        int programDuration = 0;
-        int preroll =  gCoreContext->GetNumSetting("RecordPreRoll", 0);
-        if (programInfo.GetScheduledStartTime().isValid() &&
-            programInfo.GetScheduledEndTime().isValid() &&
-            (programInfo.GetScheduledStartTime() !=
-             programInfo.GetScheduledEndTime()))
-        {
-            programDuration = programInfo.GetScheduledStartTime()
-                .secsTo(programInfo.GetScheduledEndTime());
-        }
-        if (programInfo.GetRecordingStartTime().isValid() &&
-            programInfo.GetScheduledStartTime().isValid() &&
-            (programInfo.GetRecordingStartTime() !=
-             programInfo.GetScheduledStartTime()))
-        {
-            startEarly = programInfo.GetRecordingStartTime()
-                .secsTo(programInfo.GetScheduledStartTime());
-        }
-        if (programDuration > 0)
         {
-            captime = startEarly + (programDuration / 3);
+            LOG(VB_GENERAL, LOG_INFO,
+                QString("Preview at calculated offset (%1 seconds)")
+                    .arg(captime));
         }
-        if (captime < 0)
-            captime = 600;
-        captime += preroll;
-        LOG(VB_GENERAL, LOG_INFO,
-            QString("Preview at calculated offset (%1 seconds)").arg(captime));
     }
 
     width = height = sz = 0;
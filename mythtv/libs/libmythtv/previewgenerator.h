@@ -67,6 +67,14 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
 
     void AttachSignals(QObject*);
 
+    static long long GetDefaultPreviewTime(const ProgramInfo &pginfo,
+                                           bool &in_seconds);
+
+    static bool SavePreview(QString filename,
+                            const unsigned char *data,
+                            uint width, uint height, float aspect,
+                            int desired_width, int desired_height);
+
   public slots:
     void deleteLater();
 
@@ -89,12 +97,6 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
                                int               &video_height,
                                float             &video_aspect);
 
-    static bool SavePreview(QString filename,
-                            const unsigned char *data,
-                            uint width, uint height, float aspect,
-                            int desired_width, int desired_height);
-
-
     static QString CreateAccessibleFilename(
         const QString &pathname, const QString &outFileName);
 
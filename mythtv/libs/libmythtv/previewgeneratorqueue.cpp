@@ -1,5 +1,10 @@
+#include <sys/types.h> // for utime
+#include <utime.h>     // for utime
+
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QFile>
+#include <QDir>
 
 #include "previewgeneratorqueue.h"
 #include "previewgenerator.h"
@@ -12,6 +17,13 @@
 
 #define LOC QString("PreviewQueue: ")
 
+/// Where a preview fetched with RemoteGetPreviews() is kept locally.
+static QString fetched_preview_file(const ProgramInfo &pginfo)
+{
+    return QString("%1/remotecache/%2.jpg")
+        .arg(GetConfDir()).arg(pginfo.GetPathname().section('/', -1));
+}
+
 PreviewGeneratorQueue *PreviewGeneratorQueue::s_pgq = NULL;
 
 void PreviewGeneratorQueue::CreatePreviewGeneratorQueue(
@@ -42,12 +54,20 @@ PreviewGeneratorQueue::PreviewGeneratorQueue(
         m_maxThreads = (idealThreads >= 1) ? idealThreads * 2 : 2;
     }
 
+    // Previews the backend reports as PENDING are fetched once it
+    // announces them with GENERATED_PIXMAP.
+    if (PreviewGenerator::kRemote & mode)
+        gCoreContext->addListener(this);
+
     moveToThread(qthread());
     start();
 }
 
 PreviewGeneratorQueue::~PreviewGeneratorQueue()
 {
+    if (PreviewGenerator::kRemote & m_mode)
+        gCoreContext->removeListener(this);
+
     // disconnect preview generators
     QMutexLocker locker(&m_lock);
     PreviewMap::iterator it = m_previewMap.begin();
@@ -58,6 +78,18 @@ PreviewGeneratorQueue::~PreviewGeneratorQueue()
     }
     locker.unlock();
     wait();
+
+    QList<QPair<ProgramInfo*,QString> >::iterator fit = m_fetchQueue.begin();
+    for (; fit != m_fetchQueue.end(); ++fit)
+        delete (*fit).first;
+
+    QMap<QString,QList<QPair<ProgramInfo*,QString> > >::iterator pit =
+        m_fetchPending.begin();
+    for (; pit != m_fetchPending.end(); ++pit)
+    {
+        for (fit = (*pit).begin(); fit != (*pit).end(); ++fit)
+            delete (*fit).first;
+    }
 }
 
 void PreviewGeneratorQueue::GetPreviewImage(
@@ -88,6 +120,18 @@ void PreviewGeneratorQueue::GetPreviewImage(
     QCoreApplication::postEvent(s_pgq, e);
 }
 
+/** \brief Sets the size of the previews fetched from the backend,
+ *         a width or height of 0 keeps the aspect ratio.
+ */
+void PreviewGeneratorQueue::SetFetchSize(const QSize &size)
+{
+    if (!s_pgq)
+        return;
+
+    QMutexLocker locker(&s_pgq->m_lock);
+    s_pgq->m_fetchSize = size;
+}
+
 void PreviewGeneratorQueue::AddListener(QObject *listener)
 {
     if (!s_pgq)
@@ -141,6 +185,37 @@ bool PreviewGeneratorQueue::event(QEvent *e)
         }
         return true;
     }
+    else if (me->Message() == "FETCH_PREVIEWS")
+    {
+        FetchPreviews();
+        return true;
+    }
+    else if (me->Message() == "GENERATED_PIXMAP" &&
+             me->ExtraDataCount() >= 3)
+    {
+        QMap<QString,QList<QPair<ProgramInfo*,QString> > >::iterator pit =
+            m_fetchPending.find(me->ExtraData(1)); // pginfo->MakeUniqueKey()
+        if (pit == m_fetchPending.end())
+            return false;
+
+        QList<QPair<ProgramInfo*,QString> > pending = *pit;
+        m_fetchPending.erase(pit);
+
+        bool ok = me->ExtraData(0) == "OK";
+        QList<QPair<ProgramInfo*,QString> >::iterator it = pending.begin();
+        for (; it != pending.end(); ++it)
+        {
+            if (ok)
+            {
+                QueueFetch((*it).first, (*it).second);
+                continue;
+            }
+            SendEvent(*(*it).first, "PREVIEW_FAILED", QString(),
+                      (*it).second, me->ExtraData(2), QDateTime());
+            delete (*it).first;
+        }
+        return true;
+    }
     else if (me->Message() == "PREVIEW_SUCCESS" ||
              me->Message() == "PREVIEW_FAILED")
     {
@@ -242,12 +317,19 @@ void PreviewGeneratorQueue::SendEvent(
     }
 }
 
+/** \fn PreviewGeneratorQueue::GeneratePreviewImage(ProgramInfo&,
+ *           const QSize&, const QString&, long long, bool, QString,
+ *           bool, const QDateTime&)
+ *  \param fetched     true when called back by FetchPreviews()
+ *  \param fetchedTime when the backend generated the fetched preview,
+ *                     invalid if it has none
+ */
 QString PreviewGeneratorQueue::GeneratePreviewImage(
     ProgramInfo &pginfo,
     const QSize &size,
     const QString &outputfile,
     long long time, bool in_seconds,
-    QString token)
+    QString token, bool fetched, const QDateTime &fetchedTime)
 {
     QString key = QString("%1_%2x%3_%4%5")
         .arg(pginfo.GetBasename()).arg(size.width()).arg(size.height())
@@ -287,11 +369,14 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
 
         if (streaming)
         {
-            ret_file = QString("%1/remotecache/%2")
-                .arg(GetConfDir()).arg(filename.section('/', -1));
+            ret_file = fetched_preview_file(pginfo);
 
             QFileInfo finfo(ret_file);
-            if (finfo.isReadable() && finfo.lastModified() >= cmp_ts)
+            if (fetched)
+            {
+                previewLastModified = fetchedTime;
+            }
+            else if (finfo.isReadable() && finfo.lastModified() >= cmp_ts)
             {
                 // This is just an optimization to avoid
                 // hitting the backend if our cached copy
@@ -300,10 +385,21 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
                 // bookmark changes.
                 previewLastModified = finfo.lastModified();
             }
+            else if (m_fetchPending.contains(pginfo.MakeUniqueKey()))
+            {
+                // The backend is still generating it, wait for that.
+                m_fetchPending[pginfo.MakeUniqueKey()].push_back(
+                    qMakePair(new ProgramInfo(pginfo), token));
+                SendEvent(pginfo, "PREVIEW_QUEUED", QString(), token,
+                          "Pending on backend", QDateTime());
+                return QString();
+            }
             else if (!IsGeneratingPreview(key))
             {
-                previewLastModified =
-                    RemoteGetPreviewIfModified(pginfo, ret_file);
+                // Requests that arrive together are sent to the backend
+                // in one round trip, this one is finished by FetchPreviews().
+                QueueFetch(new ProgramInfo(pginfo), token);
+                return QString();
             }
         }
         else
@@ -416,6 +512,118 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
     return ret;
 }
 
+/** \fn PreviewGeneratorQueue::FetchPreviews(void)
+ *  \brief Gets the previews queued by GeneratePreviewImage() from the
+ *         backend with a single QUERY_PREVIEWS, then finishes each request.
+ *
+ *  A preview the backend is still generating is fetched again when it
+ *  sends GENERATED_PIXMAP, one it failed to get is requested through a
+ *  PreviewGenerator as before.
+ */
+void PreviewGeneratorQueue::FetchPreviews(void)
+{
+    QList<QPair<ProgramInfo*,QString> > fetch = m_fetchQueue;
+    m_fetchQueue.clear();
+    if (fetch.empty())
+        return;
+
+    QSize size;
+    {
+        QMutexLocker locker(&m_lock);
+        size = m_fetchSize;
+    }
+
+    vector<ProgramInfo*> pginfos;
+    QStringList files, etags;
+    QList<QPair<ProgramInfo*,QString> >::const_iterator it = fetch.begin();
+    for (; it != fetch.end(); ++it)
+    {
+        QString file = fetched_preview_file(*(*it).first);
+        pginfos.push_back((*it).first);
+        files.push_back(file);
+        etags.push_back(QFileInfo(file).isReadable() ?
+                        m_fetchETags.value(file) : QString());
+    }
+
+    QList<RemotePreview> previews;
+    if (!RemoteGetPreviews(pginfos, etags, size, "jpg", -1, previews))
+        previews.clear();
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("Fetched %1 of %2 previews in one request")
+            .arg(previews.size()).arg(fetch.size()));
+
+    for (int i = 0; i < fetch.size(); i++)
+    {
+        QDateTime dt;
+        if (i < previews.size())
+        {
+            const RemotePreview &preview = previews[i];
+            if (preview.status == "OK" &&
+                SaveFetchedPreview(files[i], preview.data,
+                                   preview.lastModified))
+            {
+                m_fetchETags[files[i]] = preview.etag;
+                dt = preview.lastModified;
+            }
+            else if (preview.status == "NOT_MODIFIED")
+            {
+                dt = preview.lastModified;
+            }
+            else if (preview.status == "PENDING")
+            {
+                ProgramInfo *pginfo = fetch[i].first;
+                m_fetchPending[pginfo->MakeUniqueKey()].push_back(fetch[i]);
+                SendEvent(*pginfo, "PREVIEW_QUEUED", QString(),
+                          fetch[i].second, "Pending on backend", QDateTime());
+                continue;
+            }
+        }
+
+        GeneratePreviewImage(*fetch[i].first, QSize(0,0), "", -1, true,
+                             fetch[i].second, true, dt);
+        delete fetch[i].first;
+    }
+}
+
+/// Queues a preview for the next FetchPreviews(), which takes ownership
+/// of \p pginfo.
+void PreviewGeneratorQueue::QueueFetch(ProgramInfo *pginfo,
+                                       const QString &token)
+{
+    if (m_fetchQueue.empty())
+        QCoreApplication::postEvent(this, new MythEvent("FETCH_PREVIEWS"));
+    m_fetchQueue.push_back(qMakePair(pginfo, token));
+}
+
+/// Writes a fetched preview with the backend's time stamp, as
+/// PreviewGenerator::SaveOutFile() does.
+bool PreviewGeneratorQueue::SaveFetchedPreview(
+    const QString &filename, const QByteArray &data, const QDateTime &dt)
+{
+    QDir().mkpath(QFileInfo(filename).path());
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(data) != data.size())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to write preview '%1'").arg(filename));
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    if (dt.isValid())
+    {
+        struct utimbuf times;
+        times.actime = times.modtime = dt.toTime_t();
+        utime(filename.toLocal8Bit().constData(), &times);
+    }
+
+    return true;
+}
+
 void PreviewGeneratorQueue::GetInfo(
     const QString &key, uint &queue_depth, uint &token_cnt)
 {
@@ -4,7 +4,10 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QSize>
 #include <QMutex>
+#include <QPair>
+#include <QList>
 #include <QMap>
 #include <QSet>
 
@@ -13,7 +16,6 @@
 #include "mthread.h"
 
 class ProgramInfo;
-class QSize;
 
 class PreviewGenState
 {
@@ -48,6 +50,7 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
                                 const QString &outputfile,
                                 long long time, bool in_seconds,
                                 QString token);
+    static void SetFetchSize(const QSize&);
     static void AddListener(QObject*);
     static void RemoveListener(QObject*);
 
@@ -59,7 +62,12 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     QString GeneratePreviewImage(ProgramInfo &pginfo, const QSize&,
                                  const QString &outputfile,
                                  long long time, bool in_seconds,
-                                 QString token);
+                                 QString token, bool fetched = false,
+                                 const QDateTime &fetchedTime = QDateTime());
+    void FetchPreviews(void);
+    void QueueFetch(ProgramInfo *pginfo, const QString &token);
+    bool SaveFetchedPreview(const QString &filename, const QByteArray &data,
+                            const QDateTime &dt);
 
     void GetInfo(const QString &key, uint &queue_depth, uint &preview_tokens);
     void SetPreviewGenerator(const QString &key, PreviewGenerator *g);
@@ -91,6 +99,15 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     uint                   m_maxThreads;
     uint                   m_maxAttempts;
     uint                   m_minBlockSeconds;
+    QSize                  m_fetchSize;
+
+    // only used by the queue thread
+    /// remote previews waiting for FetchPreviews(), with their tokens
+    QList<QPair<ProgramInfo*,QString> > m_fetchQueue;
+    /// ETags of the previews in the remote cache, by file name
+    QMap<QString,QString>  m_fetchETags;
+    /// previews the backend is still generating, by ProgramInfo key
+    QMap<QString,QList<QPair<ProgramInfo*,QString> > > m_fetchPending;
 };
 
 #endif // _PREVIEW_GENERATOR_QUEUE_H_
@@ -14,6 +14,7 @@ RecordingQuality::RecordingQuality(
     const ProgramInfo *pi, const RecordingGaps &rg,
     const QDateTime &first, const QDateTime &latest) :
     m_continuity_error_count(0), m_packet_count(0),
+    m_dropped_packet_count(0), m_max_lag(0),
     m_overall_score(1.0), m_recording_gaps(rg)
 {
     if (!pi)
@@ -79,6 +80,22 @@ void RecordingQuality::AddTSStatistics(
         m_overall_score = min(m_overall_score, 0.5);
 }
 
+/** \brief Adds how well the stream handler kept up with the recorder.
+ *
+ *  Dropped packets also show up as continuity errors, which is what the
+ *  score is based on, so these are only reported.
+ *
+ *  \param dropped_packet_count TS packets dropped because the
+ *                              recorder's queue was full
+ *  \param max_lag              worst time data waited in the queue, in msec
+ */
+void RecordingQuality::AddListenerStatistics(
+    int dropped_packet_count, uint max_lag)
+{
+    m_dropped_packet_count = dropped_packet_count;
+    m_max_lag = max_lag;
+}
+
 bool RecordingQuality::IsDamaged(void) const
 {
     return (m_overall_score * 100) <
@@ -97,6 +114,12 @@ QString RecordingQuality::toStringXML(void) const
             .arg(m_continuity_error_count).arg(m_packet_count);
     }
 
+    if (m_dropped_packet_count || m_max_lag)
+    {
+        str += QString(" dropped_packet_count=\"%1\" max_queue_lag=\"%2\"")
+            .arg(m_dropped_packet_count).arg(m_max_lag);
+    }
+
     if (m_recording_gaps.empty())
         return str + " />";
 
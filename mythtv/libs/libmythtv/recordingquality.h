@@ -37,12 +37,15 @@ class MTV_PUBLIC RecordingQuality
         const QDateTime &firstData, const QDateTime &latestData);
 
     void AddTSStatistics(int continuity_error_count, int packet_count);
+    void AddListenerStatistics(int dropped_packet_count, uint max_lag);
     bool IsDamaged(void) const;
     QString toStringXML(void) const;
 
   private:
     int           m_continuity_error_count;
     int           m_packet_count;
+    int           m_dropped_packet_count;
+    uint          m_max_lag;
     QString       m_program_key;
     double        m_overall_score;
     RecordingGaps m_recording_gaps;
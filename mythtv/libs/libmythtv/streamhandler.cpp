@@ -4,6 +4,196 @@
 #include "streamhandler.h"
 
 #define LOC      QString("SH(%1): ").arg(_device)
+#define LOC_Q    QString("SH(%1): Listener 0x%2: ") \
+                     .arg(m_device).arg((uint64_t)m_data,0,16)
+
+/// About a second of a full DVB-S2 multiplex.
+const uint StreamListenerQueue::kMaxQueuedBytes  = TSPacket::kSize * 50000;
+
+StreamListenerQueue::StreamListenerQueue(
+    const QString &device, MPEGStreamData *data) :
+    MThread("StreamListener"),
+    m_device(device), m_data(data),
+    m_queued_bytes(0), m_stop(false),
+    m_dropping(false), m_dropped_burst(0),
+    m_refresh_pids(false)
+{
+}
+
+StreamListenerQueue::~StreamListenerQueue()
+{
+    Stop();
+}
+
+void StreamListenerQueue::Stop(void)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_stop = true;
+        m_wait.wakeAll();
+    }
+    wait();
+}
+
+/** \fn StreamListenerQueue::Push(const QByteArray&)
+ *  \brief Queues a buffer for the listener, dropping it if the listener
+ *         is already kMaxQueuedBytes behind.
+ */
+void StreamListenerQueue::Push(const QByteArray &buffer)
+{
+    QMutexLocker locker(&m_lock);
+
+    uint packets = buffer.size() / TSPacket::kSize;
+
+    if (m_queued_bytes + buffer.size() > kMaxQueuedBytes)
+    {
+        if (!m_dropping)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC_Q +
+                QString("Listener is %1 msec behind, dropping packets")
+                    .arg(m_queue.empty() ? 0 :
+                         m_queue.front().queued.elapsed()));
+        }
+        m_dropping = true;
+        m_dropped_burst += packets;
+        m_stats.dropped += packets;
+        return;
+    }
+
+    if (m_dropping)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC_Q +
+            QString("Listener caught up, %1 packets were dropped")
+                .arg(m_dropped_burst));
+        m_dropping = false;
+        m_dropped_burst = 0;
+    }
+
+    Item item;
+    item.data = buffer;
+    item.queued.start();
+    m_queue.push_back(item);
+    m_queued_bytes += buffer.size();
+    m_stats.packets += packets;
+    m_wait.wakeAll();
+}
+
+void StreamListenerQueue::run(void)
+{
+    RunProlog();
+
+    QMutexLocker locker(&m_lock);
+    while (!m_stop)
+    {
+        if (m_queue.empty())
+        {
+            m_wait.wait(&m_lock);
+            continue;
+        }
+
+        Item item = m_queue.takeFirst();
+        m_queued_bytes  -= item.data.size();
+        m_stats.lag      = item.queued.elapsed();
+        m_stats.max_lag  = max(m_stats.max_lag, m_stats.lag);
+
+        locker.unlock();
+        Process(item.data);
+        locker.relock();
+    }
+
+    m_queue.clear();
+    m_queued_bytes = 0;
+
+    RunEpilog();
+}
+
+void StreamListenerQueue::Process(const QByteArray &buffer)
+{
+    // Partial packets are carried over to the next buffer for this
+    // listener only, each listener may be resynced differently.
+    QByteArray joined;
+    const unsigned char *data =
+        reinterpret_cast<const unsigned char*>(buffer.constData());
+    int len = buffer.size();
+    if (!m_remainder.isEmpty())
+    {
+        joined = m_remainder + buffer;
+        data = reinterpret_cast<const unsigned char*>(joined.constData());
+        len = joined.size();
+    }
+
+    m_data_lock.lock();
+    int remainder = m_data->ProcessData(data, len);
+
+    bool refresh;
+    {
+        QMutexLocker locker(&m_lock);
+        refresh = m_refresh_pids;
+    }
+    if (refresh)
+    {
+        pid_map_t pids;
+        m_data->GetPIDs(pids);
+        QMutexLocker locker(&m_lock);
+        m_pids = pids;
+        m_refresh_pids = false;
+    }
+    m_data_lock.unlock();
+
+    if (remainder > 0 && remainder <= len)
+    {
+        m_remainder = QByteArray(
+            reinterpret_cast<const char*>(data) + len - remainder, remainder);
+    }
+    else
+    {
+        m_remainder.clear();
+    }
+}
+
+/// Adds the listener's PIDs, or if it is busy the ones it had the last
+/// time it could be asked, and has it refresh them after its next buffer.
+void StreamListenerQueue::GetPIDs(pid_map_t &pids)
+{
+    pid_map_t current;
+    bool ok = TryLockData();
+    if (ok)
+    {
+        m_data->GetPIDs(current);
+        UnlockData();
+    }
+
+    QMutexLocker locker(&m_lock);
+    if (ok)
+        m_pids = current;
+    m_refresh_pids = !ok;
+
+    pid_map_t::const_iterator it = m_pids.begin();
+    for (; it != m_pids.end(); ++it)
+        pids[it.key()] = max(pids[it.key()], *it);
+}
+
+PIDPriority StreamListenerQueue::GetPIDPriority(uint pid)
+{
+    if (TryLockData())
+    {
+        PIDPriority tmp = m_data->GetPIDPriority(pid);
+        UnlockData();
+        return tmp;
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_refresh_pids = true;
+    return m_pids.value(pid, kPIDPriorityNone);
+}
+
+StreamListenerStats StreamListenerQueue::GetStats(void) const
+{
+    QMutexLocker locker(&m_lock);
+    StreamListenerStats stats = m_stats;
+    stats.queued = m_queued_bytes;
+    return stats;
+}
 
 StreamHandler::StreamHandler(const QString &device) :
     MThread("StreamHandler"),
@@ -34,6 +224,10 @@ StreamHandler::~StreamHandler()
     // This should never be triggered.. just to be safe..
     if (_running)
         Stop();
+
+    StreamListenerQueues::iterator it = _listener_queues.begin();
+    for (; it != _listener_queues.end(); ++it)
+        delete *it;
 }
 
 void StreamHandler::AddListener(MPEGStreamData *data,
@@ -117,16 +311,28 @@ void StreamHandler::RemoveListener(MPEGStreamData *data)
         _stream_data_list.erase(it);
     }
 
-    if (_stream_data_list.empty())
-    {
-        _listener_lock.unlock();
-        Stop();
-    }
-    else
+    StreamListenerQueue *queue = _listener_queues.take(data);
+    bool empty = _stream_data_list.empty();
+
+    _listener_lock.unlock();
+
+    // The caller may delete data as soon as we return, so wait for the
+    // queue thread to be done with it. Whatever is still queued is lost.
+    if (queue)
     {
-        _listener_lock.unlock();
+        StreamListenerStats stats = queue->GetStats();
+        delete queue;
+
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("RemoveListener(0x%1) -- %2 packets, %3 dropped, "
+                    "max lag %4 msec")
+                .arg((uint64_t)data,0,16).arg(stats.packets)
+                .arg(stats.dropped).arg(stats.max_lag));
     }
 
+    if (empty)
+        Stop();
+
     LOG(VB_RECORD, LOG_INFO, LOC + QString("RemoveListener(0x%1) -- end")
                 .arg((uint64_t)data,0,16));
 }
@@ -196,6 +402,26 @@ bool StreamHandler::IsRunning(void) const
     return _running;
 }
 
+/** \fn StreamHandler::GetListenerStats(MPEGStreamData*,
+ *                                      StreamListenerStats&) const
+ *  \brief Returns the packet, drop and lag counters of a listener fed
+ *         through DispatchToListeners().
+ *
+ *  \return false if the listener does not have a queue (yet).
+ */
+bool StreamHandler::GetListenerStats(MPEGStreamData *data,
+                                     StreamListenerStats &stats) const
+{
+    QMutexLocker locker(&_listener_lock);
+
+    StreamListenerQueue *queue = _listener_queues.value(data);
+    if (!queue)
+        return false;
+
+    stats = queue->GetStats();
+    return true;
+}
+
 void StreamHandler::SetRunning(bool is_running,
                                bool is_using_buffering,
                                bool is_using_section_reader)
@@ -283,6 +509,12 @@ void StreamHandler::UpdateListeningForEIT(void)
     for (; it != _stream_data_list.end(); ++it)
     {
         MPEGStreamData *sd = it.key();
+
+        // A busy listener is picked up on one of the next updates.
+        StreamListenerQueue *queue = _listener_queues.value(sd);
+        if (queue && !queue->TryLockData())
+            continue;
+
         if (sd->HasEITPIDChanges(_eit_pids) &&
             sd->GetEITPIDChanges(_eit_pids, add_eit, del_eit))
         {
@@ -301,6 +533,9 @@ void StreamHandler::UpdateListeningForEIT(void)
                 sd->AddListeningPID(add_eit[i]);
             }
         }
+
+        if (queue)
+            queue->UnlockData();
     }
 }
 
@@ -314,7 +549,13 @@ bool StreamHandler::UpdateFiltersFromStreamData(void)
         QMutexLocker read_locker(&_listener_lock);
         StreamDataList::const_iterator it = _stream_data_list.begin();
         for (; it != _stream_data_list.end(); ++it)
-            it.key()->GetPIDs(pids);
+        {
+            StreamListenerQueue *queue = _listener_queues.value(it.key());
+            if (queue)
+                queue->GetPIDs(pids);
+            else
+                it.key()->GetPIDs(pids);
+        }
     }
 
     QMap<uint, PIDInfo*> add_pids;
@@ -370,7 +611,49 @@ PIDPriority StreamHandler::GetPIDPriority(uint pid) const
 
     StreamDataList::const_iterator it = _stream_data_list.begin();
     for (; it != _stream_data_list.end(); ++it)
-        tmp = max(tmp, it.key()->GetPIDPriority(pid));
+    {
+        StreamListenerQueue *queue = _listener_queues.value(it.key());
+        if (queue)
+            tmp = max(tmp, queue->GetPIDPriority(pid));
+        else
+            tmp = max(tmp, it.key()->GetPIDPriority(pid));
+    }
 
     return tmp;
 }
+
+/** \fn StreamHandler::DispatchToListeners(const unsigned char*, uint)
+ *  \brief Hands a buffer read from the device to every listener.
+ *
+ *  The buffer is copied once into a shared QByteArray and queued for
+ *  each listener, which processes it on its own StreamListenerQueue
+ *  thread, so this never waits for a listener. Partial packets at the
+ *  end of the buffer are kept by each listener for its next buffer.
+ *
+ *  \return false if there are no listeners.
+ */
+bool StreamHandler::DispatchToListeners(const unsigned char *buffer,
+                                        uint len)
+{
+    QMutexLocker locker(&_listener_lock);
+
+    if (_stream_data_list.empty())
+        return false;
+
+    QByteArray shared(reinterpret_cast<const char*>(buffer), len);
+
+    StreamDataList::const_iterator it = _stream_data_list.begin();
+    for (; it != _stream_data_list.end(); ++it)
+    {
+        StreamListenerQueue *queue = _listener_queues.value(it.key());
+        if (!queue)
+        {
+            queue = new StreamListenerQueue(_device, it.key());
+            queue->start();
+            _listener_queues[it.key()] = queue;
+        }
+        queue->Push(shared);
+    }
+
+    return true;
+}
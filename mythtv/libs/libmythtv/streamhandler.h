@@ -7,8 +7,11 @@
 using namespace std;
 
 #include <QWaitCondition>
+#include <QByteArray>
 #include <QString>
 #include <QMutex>
+#include <QList>
+#include <QTime>
 #include <QMap>
 
 #include "DeviceReadBuffer.h" // for ReaderPausedCB
@@ -44,6 +47,84 @@ class PIDInfo
 // iterator returning these in order of ascending pid number.
 typedef QMap<uint,PIDInfo*> PIDInfoMap;
 
+class StreamListenerStats
+{
+  public:
+    StreamListenerStats() :
+        packets(0), dropped(0), queued(0), lag(0), max_lag(0) {}
+
+    uint64_t packets;   ///< TS packets handed to the listener
+    uint64_t dropped;   ///< TS packets dropped because its queue was full
+    uint     queued;    ///< bytes waiting in the queue
+    uint     lag;       ///< msec the last buffer waited in the queue
+    uint     max_lag;   ///< worst lag seen, in msec
+};
+
+/** \class StreamListenerQueue
+ *  \brief Feeds one MPEGStreamData listener from its own thread.
+ *
+ *  The device read thread pushes shared (implicitly shared QByteArray)
+ *  buffers into a bounded queue per listener, so a listener blocked on
+ *  disk or database access only loses its own packets instead of
+ *  stalling the reads for everyone on the multiplex.
+ *
+ *  ProcessData() is called with the data lock held. The device thread
+ *  never waits for that lock, when the listener is busy it uses the PIDs
+ *  cached from the last time it was asked, and the queue thread updates
+ *  that cache after the buffer it is working on.
+ */
+class StreamListenerQueue : public MThread
+{
+  public:
+    StreamListenerQueue(const QString &device, MPEGStreamData *data);
+   ~StreamListenerQueue();
+
+    void Stop(void);
+    void Push(const QByteArray &buffer);
+
+    void GetPIDs(pid_map_t &pids);
+    PIDPriority GetPIDPriority(uint pid);
+    bool TryLockData(void) { return m_data_lock.tryLock(); }
+    void UnlockData(void) { m_data_lock.unlock(); }
+
+    StreamListenerStats GetStats(void) const;
+
+  protected:
+    void run(void);
+
+  private:
+    void Process(const QByteArray &buffer);
+
+    class Item
+    {
+      public:
+        QByteArray data;
+        QTime      queued;
+    };
+
+    QString             m_device;
+    MPEGStreamData     *m_data;
+
+    mutable QMutex      m_lock;
+    QWaitCondition      m_wait;
+    QList<Item>         m_queue;
+    uint                m_queued_bytes;
+    bool                m_stop;
+    bool                m_dropping;
+    uint64_t            m_dropped_burst;
+    StreamListenerStats m_stats;
+
+    // only used by the queue thread
+    QByteArray          m_remainder;
+
+    QMutex              m_data_lock;
+    pid_map_t           m_pids;     ///< protected by m_lock
+    bool                m_refresh_pids; ///< protected by m_lock
+
+    static const uint   kMaxQueuedBytes;
+};
+typedef QMap<MPEGStreamData*,StreamListenerQueue*> StreamListenerQueues;
+
 // locking order
 // _pid_lock -> _listener_lock -> _start_stop_lock
 
@@ -56,6 +137,8 @@ class StreamHandler : protected MThread, public DeviceReaderCB
                              QString output_file       = QString());
     virtual void RemoveListener(MPEGStreamData *data);
     bool IsRunning(void) const;
+    bool GetListenerStats(MPEGStreamData *data,
+                          StreamListenerStats &stats) const;
 
   protected:
     StreamHandler(const QString &device);
@@ -79,6 +162,8 @@ class StreamHandler : protected MThread, public DeviceReaderCB
 
     PIDPriority GetPIDPriority(uint pid) const;
 
+    bool DispatchToListeners(const unsigned char *buffer, uint len);
+
     // DeviceReaderCB
     virtual void ReaderPaused(int fd) { (void) fd; }
     virtual void PriorityEvent(int fd) { (void) fd; }
@@ -118,6 +203,8 @@ class StreamHandler : protected MThread, public DeviceReaderCB
     typedef QMap<MPEGStreamData*,QString> StreamDataList;
     mutable QMutex    _listener_lock;
     StreamDataList    _stream_data_list;
+    /// Listeners fed through DispatchToListeners(), created on first use
+    StreamListenerQueues _listener_queues;
 };
 
 #endif // _STREAM_HANDLER_H_
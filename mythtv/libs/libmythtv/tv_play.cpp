@@ -2728,6 +2728,7 @@ void TV::timerEvent(QTimerEvent *te)
 
     // Check if it matches a tvchainUpdateTimerId
     ctx = NULL;
+    QStringList tvchain_data;
     {
         QMutexLocker locker(&timerIdLock);
         TimerContextMap::iterator it = tvchainUpdateTimerId.find(timer_id);
@@ -2736,6 +2737,7 @@ void TV::timerEvent(QTimerEvent *te)
             KillTimer(timer_id);
             ctx = *it;
             tvchainUpdateTimerId.erase(it);
+            tvchain_data = tvchainUpdate.take(ctx);
         }
     }
 
@@ -2745,7 +2747,7 @@ void TV::timerEvent(QTimerEvent *te)
         bool still_exists = find_player_index(ctx) >= 0;
 
         if (still_exists)
-            ctx->UpdateTVChain();
+            ctx->UpdateTVChain(tvchain_data);
 
         ReturnPlayerLock(mctx);
         handled = true;
@@ -7617,6 +7619,7 @@ void TV::UpdateOSDSignal(const PlayerContext *ctx, const QStringList &strlist)
     uint  ber  = 0xffffffff;
     int   pos  = -1;
     int   tuned = -1;
+    int   lost = -1, reordered = -1;
     QString pat(""), pmt(""), mgt(""), vct(""), nit(""), sdt(""), crypt("");
     QString err = QString::null, msg = QString::null;
     for (it = slist.begin(); it != slist.end(); ++it)
@@ -7645,6 +7648,10 @@ void TV::UpdateOSDSignal(const PlayerContext *ctx, const QStringList &strlist)
             pos = it->GetValue();
         else if ("tuned" == it->GetShortName())
             tuned = it->GetValue();
+        else if ("lost" == it->GetShortName())
+            lost = it->GetValue();
+        else if ("reordered" == it->GetShortName())
+            reordered = it->GetValue();
         else if ("seen_pat" == it->GetShortName())
             pat = it->IsGood() ? "a" : "_";
         else if ("matching_pat" == it->GetShortName())
@@ -7690,6 +7697,11 @@ void TV::UpdateOSDSignal(const PlayerContext *ctx, const QStringList &strlist)
         sigDesc += " | " + tr("BE %1", "Bit Errors").arg(ber, 2);
     if ((pos >= 0) && (pos < 100))
         sigDesc += " | " + tr("Rotor %1%").arg(pos,2);
+    if (lost >= 0)
+        sigDesc += " | " + tr("Lost %1", "Lost datagrams").arg(lost);
+    if (reordered >= 0)
+        sigDesc += " | " + tr("Reordered %1", "Reordered datagrams")
+            .arg(reordered);
 
     if (tuned == 1)
         tuneCode = 't';
@@ -9017,8 +9029,16 @@ void TV::customEvent(QEvent *e)
             PlayerContext *ctx = GetPlayer(mctx, i);
             if (ctx->tvchain && ctx->tvchain->GetID() == id)
             {
+                // An update without changes means reload, make sure that
+                // is not lost among the changes merged with it.
+                QStringList data = me->ExtraDataList();
+                if (data.isEmpty() || data[0] == "empty")
+                    data = QStringList("RELOAD");
+
                 QMutexLocker locker(&timerIdLock);
-                tvchainUpdateTimerId[StartTimer(1, __LINE__)] = ctx;
+                if (!tvchainUpdate.contains(ctx))
+                    tvchainUpdateTimerId[StartTimer(1, __LINE__)] = ctx;
+                tvchainUpdate[ctx] += data;
                 break;
             }
         }
@@ -829,6 +829,8 @@ class MTV_PUBLIC TV : public QObject
     TimerContextMap      stateChangeTimerId;
     TimerContextMap      signalMonitorTimerId;
     TimerContextMap      tvchainUpdateTimerId;
+    /// LIVETV_CHAIN UPDATE changes waiting for the tvchainUpdateTimerId
+    QMap<PlayerContext*,QStringList> tvchainUpdate;
 
   public:
     // Constants
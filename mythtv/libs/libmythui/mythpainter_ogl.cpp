@@ -1,6 +1,10 @@
 // Config header generated in base directory by configure
 #include "config.h"
 
+// C++ headers
+#include <algorithm>
+#include <cstring>
+
 // QT headers
 #include <QCoreApplication>
 #include <QPainter>
@@ -17,10 +21,61 @@
 
 using namespace std;
 
+/// Images this size or smaller in both dimensions are placed in the atlas.
+static const int kAtlasMaxImageSize = 256;
+/// Width and height of an atlas page, if the GL supports it.
+static const int kAtlasPageSize     = 1024;
+/// Pending quads are drawn once there are this many.
+static const int kMaxBatchedQuads   = 4096;
+/// How many pending batches to look back through for one to join.
+static const int kMaxBatchLookBack  = 16;
+
+/** \fn MythGLAtlasPage::Allocate(const QSize&, QRect&)
+ *  \brief Finds room for an area of the given size on this page.
+ *
+ *  Areas are placed left to right on shelves, a new shelf is started
+ *  below the last when none of the existing ones has room. Space is
+ *  not reused until every image on the page has gone.
+ */
+bool MythGLAtlasPage::Allocate(const QSize &size, QRect &area)
+{
+    if (size.width() > m_size.width() || size.height() > m_size.height())
+        return false;
+
+    // Best fitting shelf that is not much taller than we need
+    int best = -1;
+    for (int i = 0; i < m_shelves.size(); i++)
+    {
+        const Shelf &shelf = m_shelves[i];
+        if (shelf.m_height < size.height() ||
+            shelf.m_height > size.height() * 3 / 2 + 2 ||
+            shelf.m_used + size.width() > m_size.width())
+            continue;
+        if (best < 0 || shelf.m_height < m_shelves[best].m_height)
+            best = i;
+    }
+
+    if (best < 0)
+    {
+        if (m_used + size.height() > m_size.height())
+            return false;
+        m_shelves.push_back(Shelf(m_used, size.height()));
+        m_used += size.height();
+        best = m_shelves.size() - 1;
+    }
+
+    Shelf &shelf = m_shelves[best];
+    area = QRect(QPoint(shelf.m_used, shelf.m_top), size);
+    shelf.m_used += size.width();
+    m_entries++;
+    return true;
+}
+
 MythOpenGLPainter::MythOpenGLPainter(MythRenderOpenGL *render,
                                      QGLWidget *parent) :
     MythPainter(), realParent(parent), realRender(render),
-    target(0), swapControl(true)
+    target(0), swapControl(true),
+    m_frame(0), m_rectTextures(false), m_batchedQuads(0)
 {
     if (realRender)
         LOG(VB_GENERAL, LOG_INFO,
@@ -43,10 +98,15 @@ void MythOpenGLPainter::FreeResources(void)
 
 void MythOpenGLPainter::DeleteTextures(void)
 {
-    if (!realRender || m_textureDeleteList.empty())
+    if (!realRender)
         return;
 
+    ReleaseAtlasImages();
+
     QMutexLocker locker(&m_textureDeleteLock);
+    if (m_textureDeleteList.empty())
+        return;
+
     while (!m_textureDeleteList.empty())
     {
         uint tex = m_textureDeleteList.front();
@@ -61,6 +121,9 @@ void MythOpenGLPainter::ClearCache(void)
 {
     LOG(VB_GENERAL, LOG_INFO, "Clearing OpenGL painter cache.");
 
+    m_batches.clear();
+    m_batchedQuads = 0;
+
     QMutexLocker locker(&m_textureDeleteLock);
     QMapIterator<MythImage *, unsigned int> it(m_ImageIntMap);
     while (it.hasNext())
@@ -70,6 +133,22 @@ void MythOpenGLPainter::ClearCache(void)
         m_ImageExpireList.remove(it.key());
     }
     m_ImageIntMap.clear();
+
+    QMapIterator<MythImage *, MythGLAtlasEntry> ait(m_atlasEntries);
+    while (ait.hasNext())
+    {
+        ait.next();
+        m_ImageExpireList.remove(ait.key());
+    }
+    m_atlasEntries.clear();
+    m_atlasDeleteList.clear();
+
+    while (!m_atlasPages.empty())
+    {
+        MythGLAtlasPage *page = m_atlasPages.takeFirst();
+        m_textureDeleteList.push_back(page->m_texture);
+        delete page;
+    }
 }
 
 void MythOpenGLPainter::Begin(QPaintDevice *parent)
@@ -100,6 +179,9 @@ void MythOpenGLPainter::Begin(QPaintDevice *parent)
     DeleteTextures();
     realRender->makeCurrent();
 
+    m_frame++;
+    realRender->GetTextureType(m_rectTextures);
+
     if (target || swapControl)
     {
         realRender->BindFramebuffer(target);
@@ -119,6 +201,7 @@ void MythOpenGLPainter::End(void)
     }
     else
     {
+        FlushBatches();
         realRender->Flush(false);
         if (target == 0 && swapControl)
             realRender->swapBuffers();
@@ -143,7 +226,7 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
         }
         else
         {
-            DeleteFormatImagePriv(im);
+            ReleaseImage(im);
         }
     }
 
@@ -169,28 +252,380 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
     m_ImageIntMap[im] = tx_id;
     m_ImageExpireList.push_back(im);
 
+    ExpireHardwareCache();
+
+    return m_ImageIntMap.contains(im) ? tx_id : 0;
+}
+
+/** \fn MythOpenGLPainter::ExpireHardwareCache(void)
+ *  \brief Releases the least recently used textures, and then the least
+ *         recently drawn atlas pages, until the cache is back within its
+ *         VRAM budget.
+ *
+ *   Releasing a single atlas entry gives nothing back until its page is
+ *   empty, so atlas entries are left alone and whole pages are dropped
+ *   one at a time instead.
+ */
+void MythOpenGLPainter::ExpireHardwareCache(void)
+{
+    if (m_HardwareCacheSize <= m_MaxHardwareCacheSize)
+        return;
+
+    // Pending quads may reference the textures about to be deleted.
+    FlushBatches();
+
+    std::list<MythImage *> expired;
+    std::list<MythImage *>::const_iterator it = m_ImageExpireList.begin();
+    for (; it != m_ImageExpireList.end(); ++it)
+    {
+        if (m_ImageIntMap.contains(*it))
+            expired.push_back(*it);
+    }
+
+    while (m_HardwareCacheSize > m_MaxHardwareCacheSize && !expired.empty())
+    {
+        ReleaseImage(expired.front());
+        expired.pop_front();
+        DeleteTextures();
+    }
+
     while (m_HardwareCacheSize > m_MaxHardwareCacheSize)
     {
-        MythImage *expiredIm = m_ImageExpireList.front();
-        m_ImageExpireList.pop_front();
-        DeleteFormatImagePriv(expiredIm);
+        MythGLAtlasPage *oldest = OldestAtlasPage();
+        if (!oldest)
+            break;
+        DeleteAtlasPage(oldest);
+        DeleteTextures();
+    }
+}
+
+/** \fn MythOpenGLPainter::AllocateAtlasArea(const QSize&, QRect&)
+ *  \brief Finds room for an image in the atlas, adding a page when
+ *         the VRAM budget allows and recycling the least recently
+ *         drawn page when it does not.
+ */
+MythGLAtlasPage *MythOpenGLPainter::AllocateAtlasArea(const QSize &size,
+                                                      QRect &area)
+{
+    QList<MythGLAtlasPage *>::iterator it = m_atlasPages.begin();
+    for (; it != m_atlasPages.end(); ++it)
+    {
+        if ((*it)->Allocate(size, area))
+            return *it;
+    }
+
+    int pagesize = min(kAtlasPageSize, realRender->GetMaxTextureSize());
+    if (pagesize < size.width() || pagesize < size.height())
+        return NULL;
+
+    int pagebytes = pagesize * pagesize * 4;
+    if (m_HardwareCacheSize + pagebytes > m_MaxHardwareCacheSize &&
+        !m_atlasPages.empty())
+    {
+        // Recycle the page that has gone longest without being drawn,
+        // its images are uploaded again the next time they are drawn.
+        MythGLAtlasPage *oldest = OldestAtlasPage();
+        if (!oldest)
+        {
+            LOG(VB_GUI, LOG_DEBUG, "OpenGL atlas is full for this frame.");
+            return NULL;
+        }
+
+        DeleteAtlasPage(oldest);
         DeleteTextures();
     }
 
-    return tx_id;
+    uint tex = realRender->CreateTexture(QSize(pagesize, pagesize), false, 0,
+                                         GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8,
+                                         GL_LINEAR);
+    if (!tex)
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Failed to create OpenGL atlas texture.");
+        return NULL;
+    }
+
+    MythGLAtlasPage *page = new MythGLAtlasPage();
+    page->m_texture = tex;
+    page->m_size    = QSize(pagesize, pagesize);
+    m_atlasPages.push_back(page);
+    m_HardwareCacheSize += realRender->GetTextureDataSize(tex);
+
+    LOG(VB_GUI, LOG_INFO, QString("Created OpenGL atlas page %1 (%2 pages)")
+            .arg(tex).arg(m_atlasPages.size()));
+
+    if (!page->Allocate(size, area))
+        return NULL;
+    return page;
+}
+
+/// Returns the page drawn longest ago, NULL if all were drawn this frame.
+MythGLAtlasPage *MythOpenGLPainter::OldestAtlasPage(void) const
+{
+    MythGLAtlasPage *oldest = NULL;
+    QList<MythGLAtlasPage *>::const_iterator it = m_atlasPages.begin();
+    for (; it != m_atlasPages.end(); ++it)
+    {
+        if ((*it)->m_lastUsed != m_frame &&
+            (!oldest || (*it)->m_lastUsed < oldest->m_lastUsed))
+        {
+            oldest = *it;
+        }
+    }
+    return oldest;
+}
+
+/// Drops a page and forgets every image that was placed on it.
+void MythOpenGLPainter::DeleteAtlasPage(MythGLAtlasPage *page)
+{
+    FlushBatches();
+
+    QMap<MythImage *, MythGLAtlasEntry>::iterator it = m_atlasEntries.begin();
+    while (it != m_atlasEntries.end())
+    {
+        if ((*it).m_page == page)
+        {
+            m_ImageExpireList.remove(it.key());
+            it = m_atlasEntries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    m_atlasPages.removeOne(page);
+    {
+        QMutexLocker locker(&m_textureDeleteLock);
+        m_textureDeleteList.push_back(page->m_texture);
+    }
+    delete page;
+}
+
+/** \fn MythOpenGLPainter::UploadToAtlas(MythImage*, const MythGLAtlasEntry&)
+ *  \brief Copies an image into its atlas area, surrounded by a copy of
+ *         its own edge pixels so filtering never samples a neighbour.
+ */
+void MythOpenGLPainter::UploadToAtlas(MythImage *im,
+                                      const MythGLAtlasEntry &entry)
+{
+    int width  = im->width();
+    int height = im->height();
+
+    QImage padded(width + 2, height + 2, QImage::Format_ARGB32);
+    QImage source = im->convertToFormat(QImage::Format_ARGB32);
+    for (int y = 0; y < height + 2; y++)
+    {
+        int sy = min(max(y - 1, 0), height - 1);
+        const QRgb *in = (const QRgb *)source.constScanLine(sy);
+        QRgb *out = (QRgb *)padded.scanLine(y);
+        out[0] = in[0];
+        memcpy(out + 1, in, width * sizeof(QRgb));
+        out[width + 1] = in[width - 1];
+    }
+
+    QImage tx = QGLWidget::convertToGLFormat(padded);
+    realRender->UpdateTextureRegion(entry.m_page->m_texture,
+                                    entry.m_area.adjusted(-1, -1, 1, 1),
+                                    tx.bits());
+}
+
+/** \fn MythOpenGLPainter::GetAtlasEntry(MythImage*)
+ *  \brief Returns where a small image lives in the atlas, placing and
+ *         uploading it first if needed. Returns NULL if it does not fit.
+ */
+MythGLAtlasEntry *MythOpenGLPainter::GetAtlasEntry(MythImage *im)
+{
+    // A deleted image's entry must go before its address is reused.
+    ReleaseAtlasImages();
+
+    QMap<MythImage *, MythGLAtlasEntry>::iterator it = m_atlasEntries.find(im);
+    if (it != m_atlasEntries.end())
+    {
+        if (!im->IsChanged())
+        {
+            m_ImageExpireList.remove(im);
+            m_ImageExpireList.push_back(im);
+            (*it).m_page->m_lastUsed = m_frame;
+            return &(*it);
+        }
+
+        if ((*it).m_area.size() == im->size())
+        {
+            // Same size, upload again in place.
+            im->SetChanged(false);
+            FlushBatches();
+            UploadToAtlas(im, *it);
+            m_ImageExpireList.remove(im);
+            m_ImageExpireList.push_back(im);
+            (*it).m_page->m_lastUsed = m_frame;
+            return &(*it);
+        }
+
+        ReleaseImage(im);
+    }
+
+    QRect area;
+    MythGLAtlasPage *page =
+        AllocateAtlasArea(QSize(im->width() + 2, im->height() + 2), area);
+    if (!page)
+        return NULL;
+
+    im->SetChanged(false);
+    CheckFormatImage(im);
+
+    MythGLAtlasEntry entry;
+    entry.m_page = page;
+    entry.m_area = area.adjusted(1, 1, -1, -1);
+    UploadToAtlas(im, entry);
+    page->m_lastUsed = m_frame;
+
+    m_ImageExpireList.push_back(im);
+    return &(m_atlasEntries.insert(im, entry).value());
+}
+
+/** \fn MythOpenGLPainter::AddQuad(uint, const QPoint&, const QSize&,
+ *                                 const QRect&, const QRect&, int)
+ *  \brief Queues a textured quad, using the same texture coordinates
+ *         MythRenderOpenGL::DrawBitmap() would for a texture of its own.
+ *
+ *  \param origin where the image starts within the texture
+ *  \param limit  size the source rectangle is clipped to
+ *
+ *  The quad joins the most recent pending batch for the same texture
+ *  unless a batch queued after that one overlaps it, since drawing it
+ *  earlier would then change the blending result.
+ */
+void MythOpenGLPainter::AddQuad(uint tex, const QPoint &origin,
+                                const QSize &limit, const QRect &src,
+                                const QRect &dst, int alpha)
+{
+    QSize texsize = realRender->GetTextureSize(tex);
+    if (!tex || texsize.isEmpty())
+        return;
+
+    int width  = min(src.width(),  limit.width());
+    int height = min(src.height(), limit.height());
+    QRect quad(dst.left(), dst.top(),
+               min(width, dst.width()), min(height, dst.height()));
+
+    GLfloat s0 = origin.x() + src.left();
+    GLfloat t0 = origin.y() + src.top() + height;
+    GLfloat s1 = origin.x() + src.left() + width;
+    GLfloat t1 = origin.y() + src.top();
+    if (!m_rectTextures)
+    {
+        s0 /= texsize.width();
+        s1 /= texsize.width();
+        t0 /= texsize.height();
+        t1 /= texsize.height();
+    }
+
+    int join = -1;
+    int stop = max(0, m_batches.size() - kMaxBatchLookBack);
+    for (int i = m_batches.size() - 1; i >= stop; i--)
+    {
+        if (m_batches[i].m_texture == tex)
+        {
+            join = i;
+            break;
+        }
+        if (m_batches[i].m_bounds.intersects(quad))
+            break;
+    }
+
+    if (join < 0)
+    {
+        m_batches.push_back(MythGLQuadBatch());
+        m_batches.back().m_texture = tex;
+        join = m_batches.size() - 1;
+    }
+
+    MythGLQuadBatch &batch = m_batches[join];
+    batch.m_bounds |= quad;
+
+    // two triangles, (top left, bottom left, top right) and
+    // (top right, bottom left, bottom right)
+    GLfloat x0 = quad.left(), x1 = quad.left() + quad.width();
+    GLfloat y0 = quad.top(),  y1 = quad.top() + quad.height();
+    GLfloat vertices[12]  = { x0, y0, x0, y1, x1, y0,
+                              x1, y0, x0, y1, x1, y1 };
+    GLfloat texcoords[12] = { s0, t0, s0, t1, s1, t0,
+                              s1, t0, s0, t1, s1, t1 };
+    GLfloat a = alpha / 255.0f;
+    for (int i = 0; i < 12; i++)
+    {
+        batch.m_vertices.push_back(vertices[i]);
+        batch.m_texcoords.push_back(texcoords[i]);
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        batch.m_colors.push_back(1.0f);
+        batch.m_colors.push_back(1.0f);
+        batch.m_colors.push_back(1.0f);
+        batch.m_colors.push_back(a);
+    }
+
+    if (++m_batchedQuads >= kMaxBatchedQuads)
+        FlushBatches();
+}
+
+/// Draws every pending batch, one call per batch, in the order queued.
+void MythOpenGLPainter::FlushBatches(void)
+{
+    if (m_batches.empty())
+        return;
+
+    if (realRender)
+    {
+        QList<MythGLQuadBatch>::const_iterator it = m_batches.begin();
+        for (; it != m_batches.end(); ++it)
+        {
+            realRender->DrawQuads((*it).m_texture, target,
+                                  (*it).m_vertices.constData(),
+                                  (*it).m_texcoords.constData(),
+                                  (*it).m_colors.constData(),
+                                  (*it).m_vertices.size() / 12);
+        }
+    }
+
+    LOG(VB_GUI, LOG_DEBUG, QString("Drew %1 quads in %2 calls")
+            .arg(m_batchedQuads).arg(m_batches.size()));
+
+    m_batches.clear();
+    m_batchedQuads = 0;
 }
 
 void MythOpenGLPainter::DrawImage(const QRect &r, MythImage *im,
                                   const QRect &src, int alpha)
 {
-    if (realRender)
-        realRender->DrawBitmap(GetTextureFromCache(im), target,
-                               &src, &r, 0, alpha);
+    if (!realRender || !im)
+        return;
+
+    // Small images, which includes most text, share atlas textures
+    if (im->width() <= kAtlasMaxImageSize &&
+        im->height() <= kAtlasMaxImageSize && !im->isNull() &&
+        !m_ImageIntMap.contains(im))
+    {
+        MythGLAtlasEntry *entry = GetAtlasEntry(im);
+        if (entry)
+        {
+            AddQuad(entry->m_page->m_texture, entry->m_area.topLeft(),
+                    entry->m_area.size(), src, r, alpha);
+            return;
+        }
+    }
+
+    uint tex = GetTextureFromCache(im);
+    if (tex)
+        AddQuad(tex, QPoint(0, 0), realRender->GetTextureSize(tex),
+                src, r, alpha);
 }
 
 void MythOpenGLPainter::DrawRect(const QRect &area, const QBrush &fillBrush,
                                  const QPen &linePen, int alpha)
 {
+    FlushBatches();
+
     if ((fillBrush.style() == Qt::SolidPattern ||
          fillBrush.style() == Qt::NoBrush) && realRender)
     {
@@ -204,6 +639,8 @@ void MythOpenGLPainter::DrawRoundRect(const QRect &area, int cornerRadius,
                                       const QBrush &fillBrush,
                                       const QPen &linePen, int alpha)
 {
+    FlushBatches();
+
     if (realRender && realRender->RectanglesAreAccelerated())
     {
         if (fillBrush.style() == Qt::SolidPattern ||
@@ -217,7 +654,27 @@ void MythOpenGLPainter::DrawRoundRect(const QRect &area, int cornerRadius,
     MythPainter::DrawRoundRect(area, cornerRadius, fillBrush, linePen, alpha);
 }
 
+/** \fn MythOpenGLPainter::DeleteFormatImagePriv(MythImage*)
+ *  \brief Called when an image is deleted, which may happen on any thread.
+ *
+ *   Its atlas entry is only queued here, the atlas is owned by the UI
+ *   thread and dropping a page needs the GL context, it is released by
+ *   ReleaseAtlasImages().
+ */
 void MythOpenGLPainter::DeleteFormatImagePriv(MythImage *im)
+{
+    QMutexLocker locker(&m_textureDeleteLock);
+    if (m_ImageIntMap.contains(im))
+    {
+        m_textureDeleteList.push_back(m_ImageIntMap[im]);
+        m_ImageIntMap.remove(im);
+        m_ImageExpireList.remove(im);
+    }
+    m_atlasDeleteList.push_back(im);
+}
+
+/// Releases an image's texture or atlas area right away, UI thread only.
+void MythOpenGLPainter::ReleaseImage(MythImage *im)
 {
     if (m_ImageIntMap.contains(im))
     {
@@ -226,16 +683,52 @@ void MythOpenGLPainter::DeleteFormatImagePriv(MythImage *im)
         m_ImageIntMap.remove(im);
         m_ImageExpireList.remove(im);
     }
+    ReleaseAtlasEntry(im);
+}
+
+void MythOpenGLPainter::ReleaseAtlasEntry(MythImage *im)
+{
+    QMap<MythImage *, MythGLAtlasEntry>::iterator it = m_atlasEntries.find(im);
+    if (it == m_atlasEntries.end())
+        return;
+
+    MythGLAtlasPage *page = (*it).m_page;
+    m_atlasEntries.erase(it);
+    m_ImageExpireList.remove(im);
+
+    // Atlas space is only reclaimed once the whole page is empty.
+    if (--page->m_entries <= 0)
+        DeleteAtlasPage(page);
+}
+
+/// Releases the atlas entries of images deleted since the last call.
+void MythOpenGLPainter::ReleaseAtlasImages(void)
+{
+    std::list<MythImage *> deleted;
+    {
+        QMutexLocker locker(&m_textureDeleteLock);
+        if (m_atlasDeleteList.empty())
+            return;
+        deleted.swap(m_atlasDeleteList);
+    }
+
+    while (!deleted.empty())
+    {
+        ReleaseAtlasEntry(deleted.front());
+        deleted.pop_front();
+    }
 }
 
 void MythOpenGLPainter::PushTransformation(const UIEffects &fx, QPointF center)
 {
+    FlushBatches();
     if (realRender)
         realRender->PushTransformation(fx, center);
 }
 
 void MythOpenGLPainter::PopTransformation(void)
 {
+    FlushBatches();
     if (realRender)
         realRender->PopTransformation();
 }
@@ -2,6 +2,8 @@
 #define MYTHPAINTER_OPENGL_H_
 
 #include <QMutex>
+#include <QVector>
+#include <QList>
 #include <QGLWidget>
 
 #include <list>
@@ -10,6 +12,58 @@
 #include "mythimage.h"
 #include "mythrender_opengl.h"
 
+/** \class MythGLAtlasPage
+ *  \brief One texture shared by many small images, filled shelf by shelf.
+ */
+class MythGLAtlasPage
+{
+  public:
+    MythGLAtlasPage() : m_texture(0), m_used(0), m_entries(0), m_lastUsed(0) {}
+
+    bool Allocate(const QSize &size, QRect &area);
+
+    class Shelf
+    {
+      public:
+        Shelf(int top, int height) : m_top(top), m_height(height), m_used(0) {}
+        int m_top;
+        int m_height;
+        int m_used;
+    };
+
+    uint          m_texture;
+    QSize         m_size;
+    QList<Shelf>  m_shelves;
+    int           m_used;     ///< height taken by shelves
+    int           m_entries;  ///< images currently placed on this page
+    uint          m_lastUsed; ///< frame this page was last drawn in
+};
+
+/** \class MythGLAtlasEntry
+ *  \brief Where an image lives in the atlas, excluding its 1 pixel border.
+ */
+class MythGLAtlasEntry
+{
+  public:
+    MythGLAtlasEntry() : m_page(NULL) {}
+    MythGLAtlasPage *m_page;
+    QRect            m_area;
+};
+
+/** \class MythGLQuadBatch
+ *  \brief Textured quads waiting to be drawn with a single call.
+ */
+class MythGLQuadBatch
+{
+  public:
+    MythGLQuadBatch() : m_texture(0) {}
+    uint             m_texture;
+    QRect            m_bounds;
+    QVector<GLfloat> m_vertices;
+    QVector<GLfloat> m_texcoords;
+    QVector<GLfloat> m_colors;
+};
+
 class MUI_PUBLIC MythOpenGLPainter : public MythPainter
 {
   public:
@@ -44,6 +98,19 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     void       ClearCache(void);
     void       DeleteTextures(void);
     int        GetTextureFromCache(MythImage *im);
+    MythGLAtlasEntry *GetAtlasEntry(MythImage *im);
+    MythGLAtlasPage  *AllocateAtlasArea(const QSize &size, QRect &area);
+    MythGLAtlasPage  *OldestAtlasPage(void) const;
+    void       UploadToAtlas(MythImage *im, const MythGLAtlasEntry &entry);
+    void       DeleteAtlasPage(MythGLAtlasPage *page);
+    void       ReleaseImage(MythImage *im);
+    void       ReleaseAtlasEntry(MythImage *im);
+    void       ReleaseAtlasImages(void);
+    void       ExpireHardwareCache(void);
+
+    void       AddQuad(uint tex, const QPoint &origin, const QSize &limit,
+                       const QRect &src, const QRect &dst, int alpha);
+    void       FlushBatches(void);
 
     QGLWidget        *realParent;
     MythRenderOpenGL *realRender;
@@ -53,7 +120,16 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     QMap<MythImage *, uint>    m_ImageIntMap;
     std::list<MythImage *>     m_ImageExpireList;
     std::list<uint>            m_textureDeleteList;
+    std::list<MythImage *>     m_atlasDeleteList; ///< images deleted off the UI thread
     QMutex                     m_textureDeleteLock;
+
+    QMap<MythImage *, MythGLAtlasEntry> m_atlasEntries;
+    QList<MythGLAtlasPage *>   m_atlasPages;
+    uint                       m_frame;
+    bool                       m_rectTextures;
+
+    QList<MythGLQuadBatch>     m_batches;
+    int                        m_batchedQuads;
 };
 
 #endif
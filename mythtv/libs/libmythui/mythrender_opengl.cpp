@@ -324,6 +324,25 @@ void MythRenderOpenGL::UpdateTexture(uint tex, void *buf)
     doneCurrent();
 }
 
+/** \fn MythRenderOpenGL::UpdateTextureRegion(uint, const QRect&, void*)
+ *  \brief Uploads buf into part of a texture, buf must match the
+ *         texture's data format and be exactly area sized.
+ */
+void MythRenderOpenGL::UpdateTextureRegion(uint tex, const QRect &area,
+                                           void *buf)
+{
+    if (!m_textures.contains(tex) || !buf)
+        return;
+
+    makeCurrent();
+    EnableTextures(tex);
+    glBindTexture(m_textures[tex].m_type, tex);
+    glTexSubImage2D(m_textures[tex].m_type, 0, area.left(), area.top(),
+                    area.width(), area.height(), m_textures[tex].m_data_fmt,
+                    m_textures[tex].m_data_type, buf);
+    doneCurrent();
+}
+
 int MythRenderOpenGL::GetTextureType(bool &rect)
 {
     static bool rects = true;
@@ -710,6 +729,30 @@ void MythRenderOpenGL::DrawBitmap(uint *textures, uint texture_count,
     doneCurrent();
 }
 
+/** \fn MythRenderOpenGL::DrawQuads(uint, uint, const GLfloat*,
+ *                                   const GLfloat*, const GLfloat*, uint)
+ *  \brief Draws count textured quads from one texture in a single call.
+ *
+ *  Each quad is two triangles, i.e. 6 vertices of 2 position floats,
+ *  2 texture coordinate floats and 4 RGBA colour floats.
+ */
+void MythRenderOpenGL::DrawQuads(uint tex, uint target,
+                                 const GLfloat *vertices,
+                                 const GLfloat *texcoords,
+                                 const GLfloat *colors, uint count)
+{
+    if (!tex || !m_textures.contains(tex) || !count)
+        return;
+
+    if (target && !m_framebuffers.contains(target))
+        target = 0;
+
+    makeCurrent();
+    BindFramebuffer(target);
+    DrawQuadsPriv(tex, vertices, texcoords, colors, count);
+    doneCurrent();
+}
+
 void MythRenderOpenGL::DrawRect(const QRect &area, const QBrush &fillBrush,
                                 const QPen &linePen, int alpha)
 {
@@ -134,6 +134,7 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
 
     void* GetTextureBuffer(uint tex, bool create_buffer = true);
     void  UpdateTexture(uint tex, void *buf);
+    void  UpdateTextureRegion(uint tex, const QRect &area, void *buf);
     int   GetTextureType(bool &rect);
     bool  IsRectTexture(uint type);
     uint  CreateTexture(QSize act_size, bool use_pbo, uint type,
@@ -165,6 +166,9 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
                     int red = 255, int green = 255, int blue = 255);
     void DrawBitmap(uint *textures, uint texture_count, uint target,
                     const QRectF *src, const QRectF *dst, uint prog);
+    void DrawQuads(uint tex, uint target, const GLfloat *vertices,
+                   const GLfloat *texcoords, const GLfloat *colors,
+                   uint count);
     void DrawRect(const QRect &area, const QBrush &fillBrush,
                   const QPen &linePen, int alpha);
     void DrawRoundRect(const QRect &area, int cornerRadius,
@@ -180,6 +184,9 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
     virtual void DrawBitmapPriv(uint *textures, uint texture_count,
                                 const QRectF *src, const QRectF *dst,
                                 uint prog) = 0;
+    virtual void DrawQuadsPriv(uint tex, const GLfloat *vertices,
+                               const GLfloat *texcoords,
+                               const GLfloat *colors, uint count) = 0;
     virtual void DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                               const QPen &linePen, int alpha) = 0;
     virtual void DrawRoundRectPriv(const QRect &area, int cornerRadius,
@@ -378,6 +378,31 @@ void MythRenderOpenGL1::DrawBitmapPriv(uint *textures, uint texture_count,
     glDisableClientState(GL_VERTEX_ARRAY);
 }
 
+void MythRenderOpenGL1::DrawQuadsPriv(uint tex, const GLfloat *vertices,
+                                      const GLfloat *texcoords,
+                                      const GLfloat *colors, uint count)
+{
+    EnableShaderObject(0);
+    SetBlend(true);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    EnableTextures(tex);
+    glBindTexture(m_textures[tex].m_type, tex);
+    glVertexPointer(2, GL_FLOAT, 0, vertices);
+    glTexCoordPointer(2, GL_FLOAT, 0, texcoords);
+    glColorPointer(4, GL_FLOAT, 0, colors);
+    glDrawArrays(GL_TRIANGLES, 0, count * 6);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    // the current colour is undefined after using a colour array
+    m_color = 0;
+    SetColor(255, 255, 255, 255);
+}
+
 void MythRenderOpenGL1::DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                                      const QPen &linePen, int alpha)
 {
@@ -552,6 +552,40 @@ void MythRenderOpenGL2::DrawBitmapPriv(uint *textures, uint texture_count,
     m_glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void MythRenderOpenGL2::DrawQuadsPriv(uint tex, const GLfloat *vertices,
+                                      const GLfloat *texcoords,
+                                      const GLfloat *colors, uint count)
+{
+    uint prog = m_shaders[kShaderDefault];
+
+    EnableShaderObject(prog);
+    SetShaderParams(prog, &m_projection[0][0], "u_projection");
+    SetShaderParams(prog, &m_transforms.top().m[0][0], "u_transform");
+    SetBlend(true);
+
+    EnableTextures(tex);
+    glBindTexture(m_textures[tex].m_type, tex);
+
+    // Client side arrays, the geometry changes every frame.
+    m_glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_glEnableVertexAttribArray(VERTEX_INDEX);
+    m_glEnableVertexAttribArray(TEXTURE_INDEX);
+    m_glEnableVertexAttribArray(COLOR_INDEX);
+
+    m_glVertexAttribPointer(VERTEX_INDEX, VERTEX_SIZE, GL_FLOAT, GL_FALSE,
+                            VERTEX_SIZE * sizeof(GLfloat), vertices);
+    m_glVertexAttribPointer(TEXTURE_INDEX, TEXTURE_SIZE, GL_FLOAT, GL_FALSE,
+                            TEXTURE_SIZE * sizeof(GLfloat), texcoords);
+    m_glVertexAttribPointer(COLOR_INDEX, 4, GL_FLOAT, GL_FALSE,
+                            4 * sizeof(GLfloat), colors);
+
+    glDrawArrays(GL_TRIANGLES, 0, count * 6);
+
+    m_glDisableVertexAttribArray(COLOR_INDEX);
+    m_glDisableVertexAttribArray(TEXTURE_INDEX);
+    m_glDisableVertexAttribArray(VERTEX_INDEX);
+}
+
 void MythRenderOpenGL2::DrawRectPriv(const QRect &area, const QBrush &fillBrush,
                                      const QPen &linePen, int alpha)
 {
@@ -15,6 +15,10 @@
 #include <QStyleFactory>
 #include <QSize>
 #include <QFile>
+#include <QHash>
+#include <QLinkedList>
+#include <QImageWriter>
+#include <QImageReader>
 
 #include "mythdirs.h"
 #include "mythlogging.h"
@@ -34,6 +38,7 @@
 #include "mthreadpool.h"
 #include "storagegroup.h"
 #include "mythdate.h"
+#include "mythtimer.h"
 
 #define LOC      QString("MythUIHelper: ")
 
@@ -107,13 +112,22 @@ public:
     int m_baseWidth, m_baseHeight;
     bool m_isWide;
 
+    void TouchCachedImage(const QString &url);
+    void RemoveCachedImage(const QString &url);
+    void ExpireCachedImages(size_t incoming);
+
     QMap<QString, MythImage *> imageCache;
     QMap<QString, uint> CacheTrack;
+    /// image cache keys in least recently used first order
+    QLinkedList<QString> m_cacheLRU;
+    QHash<QString, QLinkedList<QString>::iterator> m_cacheLRUPos;
+    ImageCacheStats m_cacheStats;
     QMutex *m_cacheLock;
     size_t m_cacheSize;
     QMutex *m_cacheSizeLock;
 
     uint maxImageCacheSize;
+    qint64 maxDiskCacheSize;
 
     // The part of the screen(s) allocated for the GUI. Unless
     // overridden by the user, defaults to drawable area above.
@@ -157,6 +171,7 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
       m_baseWidth(800), m_baseHeight(600), m_isWide(false),
       m_cacheLock(new QMutex(QMutex::Recursive)), m_cacheSize(0),
       m_cacheSizeLock(new QMutex(QMutex::Recursive)),
+      maxImageCacheSize(20 * 1024 * 1024), maxDiskCacheSize(0),
       m_screenxbase(0), m_screenybase(0), m_screenwidth(0), m_screenheight(0),
       screensaver(NULL), screensaverEnabled(false), display_res(NULL),
       screenSetup(false), m_imageThreadPool(new MThreadPool("MythUIHelper")),
@@ -177,6 +192,8 @@ MythUIHelperPrivate::~MythUIHelperPrivate()
     }
 
     CacheTrack.clear();
+    m_cacheLRU.clear();
+    m_cacheLRUPos.clear();
 
     delete m_cacheLock;
     delete m_cacheSizeLock;
@@ -188,6 +205,88 @@ MythUIHelperPrivate::~MythUIHelperPrivate()
         DisplayRes::SwitchToDesktop();
 }
 
+/// Moves url to the most recently used end of the LRU, m_cacheLock held.
+void MythUIHelperPrivate::TouchCachedImage(const QString &url)
+{
+    QHash<QString, QLinkedList<QString>::iterator>::iterator it =
+        m_cacheLRUPos.find(url);
+
+    if (it != m_cacheLRUPos.end())
+        m_cacheLRU.erase(*it);
+
+    m_cacheLRUPos[url] = m_cacheLRU.insert(m_cacheLRU.end(), url);
+}
+
+/// Drops url from the memory cache, m_cacheLock held.
+void MythUIHelperPrivate::RemoveCachedImage(const QString &url)
+{
+    QMap<QString, MythImage *>::iterator it = imageCache.find(url);
+
+    if (it != imageCache.end())
+    {
+        (*it)->SetIsInCache(false);
+        (*it)->DownRef();
+        imageCache.erase(it);
+    }
+
+    CacheTrack.remove(url);
+
+    QHash<QString, QLinkedList<QString>::iterator>::iterator pit =
+        m_cacheLRUPos.find(url);
+
+    if (pit != m_cacheLRUPos.end())
+    {
+        m_cacheLRU.erase(*pit);
+        m_cacheLRUPos.erase(pit);
+    }
+}
+
+/** \brief Expires least recently used images until there is room for
+ *         incoming more bytes, m_cacheLock held.
+ *
+ *  Only images held by nothing but the cache count towards the budget,
+ *  images still on screen are skipped rather than dropped.
+ */
+void MythUIHelperPrivate::ExpireCachedImages(size_t incoming)
+{
+    QLinkedList<QString>::iterator it = m_cacheLRU.begin();
+
+    while (it != m_cacheLRU.end())
+    {
+        m_cacheSizeLock->lock();
+        bool full = (m_cacheSize + incoming >= maxImageCacheSize);
+        m_cacheSizeLock->unlock();
+
+        if (!full)
+            break;
+
+        MythImage *im = imageCache.value(*it);
+
+        if (im && im->RefCount() > 1)
+        {
+            ++it;
+            continue;
+        }
+
+        LOG(VB_GUI | VB_FILE, LOG_DEBUG, LOC +
+            QString("Cache too big (%1), removing :%2:")
+            .arg(m_cacheSize + incoming).arg(*it));
+
+        QString url = *it;
+        it = m_cacheLRU.erase(it);
+        m_cacheLRUPos.remove(url);
+        CacheTrack.remove(url);
+
+        if (im)
+        {
+            im->DownRef();
+            imageCache.remove(url);
+        }
+
+        m_cacheStats.evictions++;
+    }
+}
+
 void MythUIHelperPrivate::Init(void)
 {
     screensaver = ScreenSaverControl::get();
@@ -402,11 +501,13 @@ void MythUIHelper::Init(MythUIMenuCallbacks &cbs)
     d->m_cacheSizeLock->lock();
     d->maxImageCacheSize = GetMythDB()->GetNumSetting("UIImageCacheSize", 20)
                            * 1024 * 1024;
+    d->maxDiskCacheSize = (qint64)GetMythDB()->GetNumSetting(
+                              "UIDiskCacheSize", 256) * 1024 * 1024;
     d->m_cacheSizeLock->unlock();
 
     LOG(VB_GUI, LOG_INFO, LOC +
-        QString("MythUI Image Cache size set to %1 bytes")
-        .arg(d->maxImageCacheSize));
+        QString("MythUI Image Cache size set to %1 bytes, %2 bytes on disk")
+        .arg(d->maxImageCacheSize).arg(d->maxDiskCacheSize));
 }
 
 MythUIMenuCallbacks *MythUIHelper::GetMenuCBs(void)
@@ -495,6 +596,14 @@ void MythUIHelper::UpdateImageCache(void)
 {
     QMutexLocker locker(d->m_cacheLock);
 
+    const ImageCacheStats &stats = d->m_cacheStats;
+    LOG(VB_GUI, LOG_INFO, LOC +
+        QString("Image cache: %1 memory hits, %2 disk hits, %3 misses, "
+                "%4 evictions, %5 ms average load")
+        .arg(stats.memoryHits).arg(stats.diskHits).arg(stats.misses)
+        .arg(stats.evictions)
+        .arg(stats.loads ? stats.loadMSecs / stats.loads : 0));
+
     QMutableMapIterator<QString, MythImage *> i(d->imageCache);
 
     while (i.hasNext())
@@ -506,6 +615,8 @@ void MythUIHelper::UpdateImageCache(void)
     }
 
     d->CacheTrack.clear();
+    d->m_cacheLRU.clear();
+    d->m_cacheLRUPos.clear();
 
     d->m_cacheSizeLock->lock();
     d->m_cacheSize = 0;
@@ -521,6 +632,7 @@ MythImage *MythUIHelper::GetImageFromCache(const QString &url)
     if (d->imageCache.contains(url))
     {
         d->CacheTrack[url] = MythDate::current().toTime_t();
+        d->TouchCachedImage(url);
         return d->imageCache[url];
     }
 
@@ -576,58 +688,27 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
         if (!themedir.exists())
             themedir.mkdir(GetMythUI()->GetThemeCacheDir());
 
-        // Save to disk cache
-        im->save(dstfile, "PNG");
-    }
-
-    // delete the oldest cached images until we fall below threshold.
-    QMutexLocker locker(d->m_cacheLock);
-    d->m_cacheSizeLock->lock();
-
-    while (d->m_cacheSize + im->numBytes() >= d->maxImageCacheSize &&
-           d->imageCache.size())
-    {
-        d->m_cacheSizeLock->unlock();
-        QMap<QString, MythImage *>::iterator it = d->imageCache.begin();
-        uint oldestTime = MythDate::current().toTime_t();
-        QString oldestKey = it.key();
-
-        int count = 0;
-
-        for (; it != d->imageCache.end(); ++it)
-        {
-            if (d->CacheTrack[it.key()] < oldestTime &&
-                (it.value()->RefCount() == 1))
-            {
-                oldestTime = d->CacheTrack[it.key()];
-                oldestKey = it.key();
-                count++;
-            }
-        }
+        // Save to disk cache. Large opaque images, which is mostly fanart,
+        // covers and screenshots, are stored as JPEG, they are many times
+        // smaller than PNG and just as quick to load at their final size.
+        // The file keeps its name, it is read back by content.
+        const int kJPEGMinPixels = 128 * 128;
 
-        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-            QString("%1 images are eligible for expiry").arg(count));
-
-        if (count > 0)
+        if (!im->hasAlphaChannel() &&
+            im->width() * im->height() >= kJPEGMinPixels)
         {
-            LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-                QString("Cache too big (%1), removing :%2:")
-                .arg(d->m_cacheSize + im->numBytes()).arg(oldestKey));
-
-            d->imageCache[oldestKey]->DownRef();
-            d->imageCache.remove(oldestKey);
-            d->CacheTrack.remove(oldestKey);
-
-            d->m_cacheSizeLock->lock();
+            QImageWriter writer(dstfile, "JPEG");
+            writer.setQuality(90);
+            writer.write(*im);
         }
         else
-        {
-            d->m_cacheSizeLock->lock();
-            break;
-        }
+            im->save(dstfile, "PNG");
     }
 
-    d->m_cacheSizeLock->unlock();
+    QMutexLocker locker(d->m_cacheLock);
+
+    // delete the least recently used images until we fall below threshold.
+    d->ExpireCachedImages(im->numBytes());
 
     QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
 
@@ -643,6 +724,8 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
             .arg(url).arg(im->numBytes()));
     }
 
+    d->TouchCachedImage(url);
+
     LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
         QString("MythUIHelper::CacheImage : Cache Count = :%1: size :%2:")
         .arg(d->imageCache.count()).arg(d->m_cacheSize));
@@ -652,16 +735,9 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
 
 void MythUIHelper::RemoveFromCacheByURL(const QString &url)
 {
-    QMutexLocker locker(d->m_cacheLock);
-    QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
-
-    if (it != d->imageCache.end())
-    {
-        d->imageCache[url]->SetIsInCache(false);
-        d->imageCache[url]->DownRef();
-        d->imageCache.remove(url);
-        d->CacheTrack.remove(url);
-    }
+    d->m_cacheLock->lock();
+    d->RemoveCachedImage(url);
+    d->m_cacheLock->unlock();
 
     QString dstfile;
 
@@ -800,6 +876,44 @@ void MythUIHelper::ClearOldImageCache(void)
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
             QString("Keeping cache dir: %1").arg(*dit));
     }
+
+    TrimCacheDir(themecachedir);
+}
+
+/** \brief Removes the oldest files of the current theme cache dir until
+ *         it fits within the "UIDiskCacheSize" budget.
+ */
+void MythUIHelper::TrimCacheDir(const QString &dirname)
+{
+    d->m_cacheSizeLock->lock();
+    qint64 budget = d->maxDiskCacheSize;
+    d->m_cacheSizeLock->unlock();
+
+    if (budget <= 0)
+        return;
+
+    QDir dir(dirname);
+    QFileInfoList list = dir.entryInfoList(QDir::Files, QDir::Time);
+
+    qint64 total = 0;
+    QFileInfoList::const_iterator it = list.begin();
+    for (; it != list.end(); ++it)
+        total += it->size();
+
+    if (total <= budget)
+        return;
+
+    LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
+        QString("Theme cache dir is %1 bytes, trimming to %2 bytes")
+        .arg(total).arg(budget));
+
+    // Newest first, so remove from the end.
+    while (total > budget && !list.empty())
+    {
+        QFileInfo fi = list.takeLast();
+        if (dir.remove(fi.fileName()))
+            total -= fi.size();
+    }
 }
 
 void MythUIHelper::RemoveCacheDir(const QString &dirname)
@@ -1514,8 +1628,20 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
         if (d->imageCache.contains(label) &&
             d->CacheTrack[label] + kImageCacheTimeout > now)
         {
+            d->TouchCachedImage(label);
+            d->m_cacheStats.memoryHits++;
             return d->imageCache[label];
         }
+
+        // Nothing on disk can satisfy a memory only lookup, so don't stat
+        // anything. This is called from the UI thread to decide whether an
+        // image needs a background load, and the stats add up when
+        // scrolling through a long list of artwork.
+        if ((cacheMode & kCacheCheckMemoryOnly) &&
+            !d->imageCache.contains(label))
+        {
+            return NULL;
+        }
     }
 
     QString cachefilepath = GetThemeCacheDir() + '/' + label;
@@ -1550,12 +1676,32 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
             // Check Memory Cache
             ret = GetImageFromCache(label);
 
-            if (!ret && (cacheMode == kCacheNormal) && painter)
+            if (ret)
+            {
+                QMutexLocker locker(d->m_cacheLock);
+                d->m_cacheStats.memoryHits++;
+            }
+            else if ((cacheMode == kCacheNormal) && painter)
             {
                 // Load file from disk cache to memory cache
+                MythTimer timer;
+                timer.start();
+
                 ret = painter->GetFormatImage();
 
-                if (!ret->Load(cachefilepath, false))
+                // The disk cache holds both PNG and JPEG files, whatever
+                // the name says, so go by the content.
+                QImageReader reader(cachefilepath);
+                reader.setDecideFormatFromContent(true);
+                QImage image;
+
+                if (reader.read(&image))
+                {
+                    ret->Assign(image);
+                    ret->SetFileName(cachefilepath);
+                }
+
+                if (image.isNull())
                 {
                     LOG(VB_GUI | VB_FILE, LOG_WARNING, LOC +
                         QString("LoadCacheImage: Could not load :%1")
@@ -1569,6 +1715,11 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
                     // Add to ram cache, and skip saving to disk since that is
                     // where we found this in the first place.
                     CacheImage(label, ret, true);
+
+                    QMutexLocker locker(d->m_cacheLock);
+                    d->m_cacheStats.diskHits++;
+                    d->m_cacheStats.loads++;
+                    d->m_cacheStats.loadMSecs += timer.elapsed();
                 }
             }
         }
@@ -1580,9 +1731,53 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
         }
     }
 
+    if (!ret && !(cacheMode & kCacheCheckMemoryOnly))
+    {
+        QMutexLocker locker(d->m_cacheLock);
+        d->m_cacheStats.misses++;
+    }
+
     return ret;
 }
 
+/** \brief Accounts for an image which was not cached and had to be
+ *         decoded from its original file, see GetImageCacheStats().
+ */
+void MythUIHelper::RecordImageLoad(int msecs)
+{
+    QMutexLocker locker(d->m_cacheLock);
+    d->m_cacheStats.loads++;
+    d->m_cacheStats.loadMSecs += msecs;
+}
+
+/** \brief Returns a snapshot of the image cache counters.
+ *
+ *  memoryHits and diskHits count lookups satisfied by each tier, misses
+ *  the lookups which had to go back to the original file. loads and
+ *  loadMSecs cover every decode, from the disk cache or the original, so
+ *  loadMSecs / loads is the average time an image took to show up.
+ */
+ImageCacheStats MythUIHelper::GetImageCacheStats(void)
+{
+    QMutexLocker locker(d->m_cacheLock);
+
+    ImageCacheStats stats = d->m_cacheStats;
+    stats.count = d->imageCache.size();
+
+    d->m_cacheSizeLock->lock();
+    stats.bytesUsed  = d->m_cacheSize;
+    stats.byteBudget = d->maxImageCacheSize;
+    d->m_cacheSizeLock->unlock();
+
+    return stats;
+}
+
+void MythUIHelper::ResetImageCacheStats(void)
+{
+    QMutexLocker locker(d->m_cacheLock);
+    d->m_cacheStats = ImageCacheStats();
+}
+
 QFont MythUIHelper::GetBigFont(void)
 {
     QFont font = QApplication::font();
@@ -30,6 +30,26 @@ typedef enum ImageCacheMode
     kCacheForceStat       = 0x4,
 } ImageCacheMode;
 
+/** \brief Counters of the MythUIHelper image cache,
+ *         see MythUIHelper::GetImageCacheStats().
+ */
+struct MUI_PUBLIC ImageCacheStats
+{
+    ImageCacheStats() :
+        memoryHits(0), diskHits(0), misses(0), evictions(0),
+        loads(0), loadMSecs(0), count(0), bytesUsed(0), byteBudget(0) {}
+
+    quint64 memoryHits;
+    quint64 diskHits;
+    quint64 misses;
+    quint64 evictions;
+    quint64 loads;
+    quint64 loadMSecs;
+    uint    count;      ///< images in the memory cache
+    quint64 bytesUsed;  ///< bytes of images held only by the cache
+    quint64 byteBudget;
+};
+
 struct MUI_PUBLIC MythUIMenuCallbacks
 {
     void (*exec_program)(const QString &cmd);
@@ -60,6 +80,10 @@ class MUI_PUBLIC MythUIHelper
     void IncludeInCacheSize(MythImage *im);
     void ExcludeFromCacheSize(MythImage *im);
 
+    void RecordImageLoad(int msecs);
+    ImageCacheStats GetImageCacheStats(void);
+    void ResetImageCacheStats(void);
+
     Settings *qtconfig(void);
 
     bool IsScreenSetup(void);
@@ -147,6 +171,7 @@ class MUI_PUBLIC MythUIHelper
 
     void ClearOldImageCache(void);
     void RemoveCacheDir(const QString &dirname);
+    void TrimCacheDir(const QString &dirname);
 
     MythUIHelperPrivate *d;
 
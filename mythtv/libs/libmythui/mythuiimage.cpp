@@ -20,6 +20,7 @@
 
 // libmythbase
 #include "mythlogging.h"
+#include "mythtimer.h"
 
 // Mythui
 #include "mythpainter.h"
@@ -210,6 +211,53 @@ class ImageLoader
         return imagelabel;
     }
 
+    /**
+    *  \brief Decodes a local image file straight to the size it will be
+    *         shown at.
+    *
+    *  Posters and fanart are usually many times larger than their widget,
+    *  formats which support it (JPEG) decode at a reduced scale for a
+    *  fraction of the time and memory of a full decode followed by a
+    *  resize. Returns false, leaving image untouched, when the file should
+    *  be loaded the usual way.
+    */
+    static bool LoadScaled(MythImage *image, const QString &filename,
+                           const QSize &size, bool preserveAspect)
+    {
+        if (size.width() <= 0 || size.height() <= 0 ||
+            filename.startsWith("myth://") ||
+            filename.startsWith("http://") ||
+            filename.startsWith("https://") ||
+            filename.startsWith("ftp://"))
+            return false;
+
+        QString path = filename;
+        if (!GetMythUI()->FindThemeFile(path))
+            return false;
+
+        QImageReader reader(path);
+        if (!reader.supportsOption(QImageIOHandler::ScaledSize))
+            return false;
+
+        QSize scaled = reader.size();
+        if (!scaled.isValid() ||
+            (scaled.width() <= size.width() &&
+             scaled.height() <= size.height()))
+            return false;
+
+        scaled.scale(size, preserveAspect ? Qt::KeepAspectRatio :
+                                            Qt::IgnoreAspectRatio);
+        reader.setScaledSize(scaled);
+
+        QImage decoded;
+        if (!reader.read(&decoded))
+            return false;
+
+        image->Assign(decoded);
+        image->SetFileName(filename);
+        return true;
+    }
+
     static MythImage *LoadImage(MythPainter *painter,
                                  // Must be a copy for thread safety
                                 ImageProperties imProps,
@@ -274,12 +322,19 @@ class ImageLoader
                 QString("ImageLoader::LoadImage(%1) NOT Found in cache. "
                         "Loading Directly").arg(cacheKey));
 
+            MythTimer timer;
+            timer.start();
+
             image = painter->GetFormatImage();
             image->UpRef();
             bool ok = false;
 
             if (imageReader)
                 ok = image->Load(imageReader);
+            else if (bForceResize &&
+                     LoadScaled(image, filename, QSize(w, h),
+                                imProps.preserveAspect))
+                ok = true;
             else
                 ok = image->Load(filename);
 
@@ -288,6 +343,8 @@ class ImageLoader
                 image->DownRef();
                 image = NULL;
             }
+            else if (!imageReader)
+                GetMythUI()->RecordImageLoad(timer.elapsed());
         }
 
         if (image && !bFoundInCache)
@@ -11,6 +11,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "httprequest.h"
+#include "httpresponsestream.h"
 
 #include <QFile>
 #include <QFileInfo>
@@ -132,7 +133,9 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
                              m_bSOAPRequest   ( false ),
                              m_eResponseType  ( ResponseTypeUnknown),
                              m_nResponseStatus( 200 ),
-                             m_pPostProcess   ( NULL )
+                             m_bStreamable    ( true ),
+                             m_pPostProcess   ( NULL ),
+                             m_pResponseStream( NULL )
 {
     m_response.open( QIODevice::ReadWrite );
 }
@@ -141,6 +144,15 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
 //
 /////////////////////////////////////////////////////////////////////////////
 
+HTTPRequest::~HTTPRequest()
+{
+    delete m_pResponseStream;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 RequestType HTTPRequest::SetRequestType( const QString &sType )
 {
     if (sType == "GET"        ) return( m_eType = RequestTypeGet         );
@@ -181,11 +193,17 @@ QString HTTPRequest::BuildHeader( long long nSize )
     sHeader += GetAdditionalHeaders();
 
     sHeader += QString( "Connection: %1\r\n"
-                        "Content-Type: %2\r\n"
-                        "Content-Length: %3\r\n" )
+                        "Content-Type: %2\r\n" )
                         .arg( GetKeepAlive() ? "Keep-Alive" : "Close" )
-                        .arg( sContentType )
-                        .arg( nSize );
+                        .arg( sContentType );
+
+    // A negative size means the length isn't known yet, the body follows
+    // in chunks (see HTTPResponseStream).
+
+    if (nSize < 0)
+        sHeader += "Transfer-Encoding: chunked\r\n";
+    else
+        sHeader += QString( "Content-Length: %1\r\n" ).arg( nSize );
 
     // ----------------------------------------------------------------------
     // Temp Hack to process DLNA header
@@ -238,6 +256,14 @@ long HTTPRequest::SendResponse( void )
              .arg(m_sFileName) .arg(GetResponseStatus())
              .arg(GetPeerAddress()) .arg(m_eResponseType));
 
+    // ----------------------------------------------------------------------
+    // Large responses have already been partly sent while serializing,
+    // only the end of the stream is left.
+    // ----------------------------------------------------------------------
+
+    if (m_pResponseStream && m_pResponseStream->IsStreaming())
+        return( m_pResponseStream->Finish() );
+
     // ----------------------------------------------------------------------
     // Make it so the header is sent with the data
     // ----------------------------------------------------------------------
@@ -279,8 +305,10 @@ long HTTPRequest::SendResponse( void )
 
     if (( nContentLen > 0 ) && m_mapHeaders[ "accept-encoding" ].contains( "gzip" ))
     {
-        QByteArray compressed = gzipCompress( m_response.buffer() );
-        compBuffer.setData( compressed );
+        if (m_gzipResponse.isEmpty())
+            m_gzipResponse = gzipCompress( m_response.buffer() );
+
+        compBuffer.setData( m_gzipResponse );
 
         if (compBuffer.buffer().length() > 0)
         {
@@ -1448,32 +1476,61 @@ bool HTTPRequest::ProcessSOAPPayload( const QString &sSOAPAction )
 Serializer *HTTPRequest::GetSerializer()
 {
     Serializer *pSerializer = NULL;
+    QIODevice  *pDevice     = &m_response;
+
+    if (CanStreamResponse())
+    {
+        if (m_pResponseStream == NULL)
+            m_pResponseStream = new HTTPResponseStream( this );
+
+        pDevice = m_pResponseStream;
+    }
 
     if (m_bSOAPRequest) 
-        pSerializer = (Serializer *)new SoapSerializer(&m_response,
+        pSerializer = (Serializer *)new SoapSerializer(pDevice,
                                                        m_sNameSpace, m_sMethod);
     else
     {
         QString sAccept = GetHeaderValue( "Accept", "*/*" );
         
         if (sAccept.contains( "application/json", Qt::CaseInsensitive ))    
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/javascript", Qt::CaseInsensitive ))    
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/x-apple-plist+xml", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new XmlPListSerializer(&m_response);
+            pSerializer = (Serializer *)new XmlPListSerializer(pDevice);
     }
 
     // Default to XML
 
     if (pSerializer == NULL)
-        pSerializer = (Serializer *)new XmlSerializer(&m_response, m_sMethod);
+        pSerializer = (Serializer *)new XmlSerializer(pDevice, m_sMethod);
+
+    if (pDevice == m_pResponseStream)
+        m_pResponseStream->SetContentType( pSerializer->GetContentType() );
 
     return pSerializer;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Chunked transfer encoding needs HTTP/1.1, and a client asking whether its
+// cached copy is current would rather have the 304 only a complete (hashed)
+// response can give it.
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPRequest::CanStreamResponse()
+{
+    if (!m_bStreamable || (m_eType == RequestTypeHead))
+        return false;
+
+    if ((m_nMajor < 1) || ((m_nMajor == 1) && (m_nMinor < 1)))
+        return false;
+
+    return GetHeaderValue( "If-None-Match", "" ).isEmpty();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
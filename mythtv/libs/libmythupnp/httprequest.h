@@ -25,6 +25,8 @@ using namespace std;
 #include "bufferedsocketdevice.h"
 #include "serializers/serializer.h"
 
+class HTTPResponseStream;
+
 #define SOAP_ENVELOPE_BEGIN  "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" " \
                              "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">"     \
                              "<s:Body>"
@@ -134,9 +136,17 @@ class UPNP_PUBLIC HTTPRequest
         QString             m_sFileName;
 
         QBuffer             m_response;
+        QByteArray          m_gzipResponse;     // m_response, already gzip'd
+        bool                m_bStreamable;      // see HTTPResponseStream
 
         IPostProcess       *m_pPostProcess;
 
+    protected:
+
+        friend class HTTPResponseStream;
+
+        HTTPResponseStream *m_pResponseStream;
+
     protected:
 
         RequestType     SetRequestType      ( const QString &sType  );
@@ -163,13 +173,15 @@ class UPNP_PUBLIC HTTPRequest
         qint64          SendData            ( QIODevice *pDevice, qint64 llStart, qint64 llBytes );
         qint64          SendFile            ( QFile &file, qint64 llStart, qint64 llBytes );
 
+        bool            CanStreamResponse   ();
+
         bool            IsUrlProtected      ( const QString &sBaseUrl );
         bool            Authenticated       ();
 
     public:
         
                         HTTPRequest     ();
-        virtual        ~HTTPRequest     () {};
+        virtual        ~HTTPRequest     ();
 
         bool            ParseRequest    ();
 
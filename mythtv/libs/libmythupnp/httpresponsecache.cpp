@@ -0,0 +1,300 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsecache.cpp
+// Created     : Oct. 19, 2026
+//
+// Purpose     : Cache of serialized Service method responses
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <QCoreApplication>
+
+#include "httpresponsecache.h"
+#include "httprequest.h"
+
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythevent.h"
+#include "mythdate.h"
+
+#define LOC QString("HttpResponseCache: ")
+
+const uint   HttpResponseCache::kMaxAgeSecs = 5 * 60;
+const qint64 HttpResponseCache::kMaxBytes   = 32 * 1024 * 1024;
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HttpResponseCache *HttpResponseCache::Get()
+{
+    static QMutex             lock;
+    static HttpResponseCache *pCache = NULL;
+
+    QMutexLocker locker( &lock );
+
+    if (!pCache)
+    {
+        pCache = new HttpResponseCache();
+        // Events are delivered on the main thread, not on the
+        // HTTP server thread which happened to create us.
+        pCache->moveToThread( QCoreApplication::instance()->thread() );
+        gCoreContext->addListener( pCache );
+    }
+
+    return pCache;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+HttpResponseCache::HttpResponseCache() : m_nBytes     ( 0 ),
+                                         m_nGeneration( 0 ),
+                                         m_nHits      ( 0 ),
+                                         m_nMisses    ( 0 )
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// The same call serialized for another client type (SOAP, JSON, XML,
+// plist) is a different response.
+//////////////////////////////////////////////////////////////////////////////
+
+QString HttpResponseCache::GetKey( HTTPRequest *pRequest )
+{
+    QString sKey = pRequest->m_sBaseUrl + "/" + pRequest->m_sMethod + "?";
+
+    QStringMap::const_iterator it = pRequest->m_mapParams.begin();
+
+    for (; it != pRequest->m_mapParams.end(); ++it)
+        sKey += it.key() + "=" + *it + "&";
+
+    if (pRequest->m_bSOAPRequest)
+        sKey += "|soap:" + pRequest->m_sNameSpace;
+    else
+        sKey += "|" + pRequest->GetHeaderValue( "Accept", "*/*" );
+
+    return sKey;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Fills in the response from the cache.  On a miss nGeneration is set for
+// the Insert() of the response about to be built.
+//////////////////////////////////////////////////////////////////////////////
+
+bool HttpResponseCache::Lookup( const QString     &sKey,
+                                const QStringList &sEvents,
+                                HTTPRequest       *pRequest,
+                                uint              &nGeneration )
+{
+    QMutexLocker locker( &m_lock );
+
+    m_knownEvents.unite( sEvents.toSet() );
+
+    nGeneration = m_nGeneration;
+
+    Expire( MythDate::current().toTime_t() );
+
+    QHash< QString, Entry >::const_iterator it = m_entries.find( sKey );
+
+    if (it == m_entries.end())
+    {
+        m_nMisses++;
+        return false;
+    }
+
+    m_nHits++;
+
+    const Entry &entry = *it;
+
+    pRequest->m_eResponseType     = ResponseTypeOther;
+    pRequest->m_sResponseTypeText = entry.sContentType;
+    pRequest->m_nResponseStatus   = 200;
+
+    QStringMap::const_iterator hit = entry.mapHeaders.begin();
+
+    for (; hit != entry.mapHeaders.end(); ++hit)
+        pRequest->m_mapRespHeaders[ hit.key() ] = *hit;
+
+    pRequest->m_response.buffer() = entry.response;
+    pRequest->m_gzipResponse      = entry.gzipResponse;
+
+    LOG(VB_UPNP, LOG_DEBUG, LOC + QString("Hit %1 (%2 hits, %3 misses)")
+        .arg(sKey).arg(m_nHits).arg(m_nMisses));
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void HttpResponseCache::Insert( const QString     &sKey,
+                                const QStringList &sEvents,
+                                uint               nGeneration,
+                                HTTPRequest       *pRequest )
+{
+    if ((pRequest->m_nResponseStatus != 200               ) ||
+        (pRequest->m_eResponseType   != ResponseTypeOther ))
+        return;
+
+    const QByteArray &response = pRequest->m_response.buffer();
+
+    if (response.isEmpty() || (response.size() > kMaxBytes / 4))
+        return;
+
+    // Compressed once here, SendResponse uses it for this request too.
+
+    pRequest->m_gzipResponse = gzipCompress( response );
+
+    Entry entry;
+
+    entry.sContentType = pRequest->m_sResponseTypeText;
+    entry.mapHeaders   = pRequest->m_mapRespHeaders;
+    entry.response     = response;
+    entry.gzipResponse = pRequest->m_gzipResponse;
+    entry.sEvents      = sEvents;
+    entry.nCreated     = MythDate::current().toTime_t();
+
+    QMutexLocker locker( &m_lock );
+
+    if (nGeneration != m_nGeneration)
+    {
+        LOG(VB_UPNP, LOG_DEBUG, LOC +
+            QString("Not caching %1, invalidated while it was built")
+                .arg(sKey));
+        return;
+    }
+
+    Remove( sKey );
+
+    m_entries.insert( sKey, entry );
+    m_order.push_back( sKey );
+    m_nBytes += entry.response.size() + entry.gzipResponse.size();
+
+    Expire( entry.nCreated );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void HttpResponseCache::Clear()
+{
+    QMutexLocker locker( &m_lock );
+
+    m_entries.clear();
+    m_order.clear();
+    m_nBytes = 0;
+    m_nGeneration++;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void HttpResponseCache::customEvent( QEvent *e )
+{
+    if (e->type() != MythEvent::MythEventMessage)
+        return;
+
+    MythEvent *me = static_cast< MythEvent* >(e);
+
+    Invalidate( me->Message() );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static bool event_matches( const QString &sMessage, const QString &sEvent )
+{
+    return sMessage.startsWith( sEvent ) &&
+           ((sMessage.length() == sEvent.length()) ||
+            (sMessage.at( sEvent.length() ) == ' '));
+}
+
+void HttpResponseCache::Invalidate( const QString &sMessage )
+{
+    QMutexLocker locker( &m_lock );
+
+    bool bKnown = false;
+
+    QSet< QString >::const_iterator kit = m_knownEvents.begin();
+
+    for (; kit != m_knownEvents.end() && !bKnown; ++kit)
+        bKnown = event_matches( sMessage, *kit );
+
+    if (!bKnown)
+        return;
+
+    m_nGeneration++;
+
+    QStringList stale;
+
+    QHash< QString, Entry >::const_iterator it = m_entries.begin();
+
+    for (; it != m_entries.end(); ++it)
+    {
+        QStringList::const_iterator eit = (*it).sEvents.begin();
+
+        for (; eit != (*it).sEvents.end(); ++eit)
+        {
+            if (event_matches( sMessage, *eit ))
+            {
+                stale.push_back( it.key() );
+                break;
+            }
+        }
+    }
+
+    QStringList::const_iterator sit = stale.begin();
+
+    for (; sit != stale.end(); ++sit)
+        Remove( *sit );
+
+    if (!stale.isEmpty())
+    {
+        LOG(VB_UPNP, LOG_INFO, LOC + QString("%1 dropped %2 responses")
+            .arg(sMessage.section( ' ', 0, 1 )).arg(stale.size()));
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Must be called with m_lock held.
+//////////////////////////////////////////////////////////////////////////////
+
+void HttpResponseCache::Remove( const QString &sKey )
+{
+    QHash< QString, Entry >::iterator it = m_entries.find( sKey );
+
+    if (it == m_entries.end())
+        return;
+
+    m_nBytes -= (*it).response.size() + (*it).gzipResponse.size();
+
+    m_entries.erase( it );
+    m_order.removeOne( sKey );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Drops entries past kMaxAgeSecs, then the oldest ones until the cache
+// fits in kMaxBytes.
+// Must be called with m_lock held.
+//////////////////////////////////////////////////////////////////////////////
+
+void HttpResponseCache::Expire( uint nNow )
+{
+    while (!m_order.isEmpty())
+    {
+        QString sKey     = m_order.front();
+        uint    nCreated = m_entries.value( sKey ).nCreated;
+
+        if ((nNow - nCreated <= kMaxAgeSecs) && (m_nBytes <= kMaxBytes))
+            break;
+
+        Remove( sKey );
+    }
+}
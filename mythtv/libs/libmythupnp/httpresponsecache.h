@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsecache.h
+// Created     : Oct. 19, 2026
+//
+// Purpose     : Cache of serialized Service method responses
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPRESPONSECACHE_H_
+#define HTTPRESPONSECACHE_H_
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QStringList>
+#include <QByteArray>
+
+#include "upnpexp.h"
+#include "upnputil.h"
+
+class HTTPRequest;
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Service methods declared with Q_CLASSINFO( "<methodName>_Cache", ... )
+// have their responses kept here, keyed by URL, parameters and the format
+// the client asked for.  The class info lists the events (message
+// prefixes) which make a response stale, e.g. "SCHEDULE_CHANGE" or
+// "RECORDING_LIST_CHANGE".  Anything older than kMaxAgeSecs is dropped
+// regardless, as a safety net for changes nobody announces.
+//
+// Responses are stored both as serialized and gzip'd, with their ETag, so
+// a client polling the same call costs a hash lookup and a send, or just
+// a 304 when it sends If-None-Match.
+//
+/////////////////////////////////////////////////////////////////////////////
+
+class UPNP_PUBLIC HttpResponseCache : public QObject
+{
+    public:
+
+        static HttpResponseCache *Get   ();
+
+        static QString  GetKey          ( HTTPRequest *pRequest );
+
+        bool            Lookup          ( const QString     &sKey,
+                                          const QStringList &sEvents,
+                                          HTTPRequest       *pRequest,
+                                          uint              &nGeneration );
+
+        void            Insert          ( const QString     &sKey,
+                                          const QStringList &sEvents,
+                                          uint               nGeneration,
+                                          HTTPRequest       *pRequest );
+
+        void            Clear           ();
+
+    protected:
+
+        virtual void    customEvent     ( QEvent *e );
+
+    private:
+
+                        HttpResponseCache();
+        virtual        ~HttpResponseCache() {}
+
+        void            Invalidate      ( const QString &sMessage );
+        void            Remove          ( const QString &sKey );
+        void            Expire          ( uint nNow );
+
+    private:
+
+        class Entry
+        {
+            public:
+
+                Entry() : nCreated( 0 ) {}
+
+                QString         sContentType;
+                QStringMap      mapHeaders;
+                QByteArray      response;
+                QByteArray      gzipResponse;
+                QStringList     sEvents;
+                uint            nCreated;   ///< time_t the entry was stored
+        };
+
+        QMutex                  m_lock;
+        QHash< QString, Entry > m_entries;
+        QSet< QString >         m_knownEvents;
+        QList< QString >        m_order;        ///< keys, oldest first
+        qint64                  m_nBytes;
+
+        /// Bumped by every invalidation, so a response built while its
+        /// data changed underneath it isn't cached.
+        uint                    m_nGeneration;
+
+        uint                    m_nHits;
+        uint                    m_nMisses;
+
+        static const uint       kMaxAgeSecs;
+        static const qint64     kMaxBytes;
+};
+
+#endif
@@ -0,0 +1,284 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsestream.cpp
+// Created     : Oct. 19, 2026
+//
+// Purpose     : Chunked (and optionally gzip'd) Http Response Body
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "httpresponsestream.h"
+#include "httprequest.h"
+
+#include "mythconfig.h"
+#if !( CONFIG_DARWIN || CONFIG_CYGWIN || defined(__FreeBSD__) || defined(USING_MINGW))
+#define USE_SETSOCKOPT
+#endif
+
+#ifndef USING_MINGW
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
+#endif
+
+#include "zlib.h"
+
+#include "mythlogging.h"
+
+#define LOC QString("HTTPResponseStream: ")
+
+const int HTTPResponseStream::kStreamThreshold = 256 * 1024;
+const int HTTPResponseStream::kChunkSize       =  64 * 1024;
+
+#ifdef USE_SETSOCKOPT
+static const int g_on          = 1;
+static const int g_off         = 0;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HTTPResponseStream::HTTPResponseStream( HTTPRequest *pRequest )
+                  : m_pRequest  ( pRequest ),
+                    m_bStreaming( false    ),
+                    m_bFailed   ( false    ),
+                    m_nBytes    ( 0        ),
+                    m_pZStream  ( NULL     )
+{
+    open( QIODevice::WriteOnly );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HTTPResponseStream::~HTTPResponseStream()
+{
+    if (m_pZStream != NULL)
+    {
+        deflateEnd( m_pZStream );
+        delete m_pZStream;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HTTPResponseStream::SetContentType( const QString &sContentType )
+{
+    m_sContentType = sContentType;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPResponseStream::readData( char * /*pData*/, qint64 /*nMaxLen*/ )
+{
+    return -1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPResponseStream::writeData( const char *pData, qint64 nLen )
+{
+    if (!m_bStreaming)
+    {
+        m_pRequest->m_response.write( pData, nLen );
+
+        if (m_pRequest->m_response.size() >= kStreamThreshold)
+            Begin();
+
+        return nLen;
+    }
+
+    // Once the client is gone the rest of the response is thrown away,
+    // the serializer still has to run to completion.
+
+    if (!m_bFailed && !Append( pData, nLen, false ))
+        m_bFailed = true;
+
+    return nLen;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPResponseStream::Begin()
+{
+    m_bStreaming = true;
+
+    m_pRequest->m_eResponseType     = ResponseTypeOther;
+    m_pRequest->m_sResponseTypeText = m_sContentType;
+    m_pRequest->m_nResponseStatus   = 200;
+
+    // The ETag is a hash of the whole response, it can't be sent up front.
+
+    m_pRequest->m_mapRespHeaders.remove( "ETag" );
+    m_pRequest->m_mapRespHeaders[ "Cache-Control" ] = "no-cache=\"Ext\", "
+                                                      "max-age = 5000";
+
+    if (m_pRequest->m_mapHeaders[ "accept-encoding" ].contains( "gzip" ))
+    {
+        m_pZStream = new z_stream;
+
+        m_pZStream->zalloc = Z_NULL;
+        m_pZStream->zfree  = Z_NULL;
+        m_pZStream->opaque = Z_NULL;
+
+        if (deflateInit2( m_pZStream,
+                          Z_DEFAULT_COMPRESSION,
+                          Z_DEFLATED,
+                          15 + 16,
+                          8,
+                          Z_DEFAULT_STRATEGY ) == Z_OK)  // gzip encoding
+        {
+            m_pRequest->m_mapRespHeaders[ "Content-Encoding" ] = "gzip";
+        }
+        else
+        {
+            delete m_pZStream;
+            m_pZStream = NULL;
+        }
+    }
+
+    LOG(VB_UPNP, LOG_INFO, LOC +
+        QString("Streaming %1 response to %2%3")
+            .arg(m_sContentType).arg(m_pRequest->GetPeerAddress())
+            .arg(m_pZStream ? " (gzip)" : ""));
+
+#ifdef USE_SETSOCKOPT
+    // Never send out partially complete segments
+    setsockopt( m_pRequest->getSocketHandle(), SOL_TCP, TCP_CORK,
+                &g_on, sizeof( g_on ));
+#endif
+
+    QByteArray sHeader = m_pRequest->BuildHeader( -1 ).toUtf8();
+
+    qlonglong nWritten = m_pRequest->WriteBlockDirect( sHeader.constData(),
+                                                       sHeader.length() );
+    if (nWritten != sHeader.length())
+    {
+        m_bFailed = true;
+        return false;
+    }
+
+    m_nBytes += nWritten;
+
+    // Everything serialized so far goes out as the first chunk(s).
+
+    QByteArray &buffer = m_pRequest->m_response.buffer();
+
+    bool bOK = Append( buffer.constData(), buffer.size(), false );
+
+    buffer.clear();
+    m_pRequest->m_response.seek( 0 );
+
+    if (!bOK)
+        m_bFailed = true;
+
+    return bOK;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPResponseStream::Append( const char *pData, qint64 nLen, bool bFinish )
+{
+    if (m_pZStream == NULL)
+    {
+        m_chunk.append( pData, nLen );
+    }
+    else
+    {
+        char out[ 16 * 1024 ];
+
+        m_pZStream->next_in  = (Bytef*)(pData);
+        m_pZStream->avail_in = nLen;
+
+        do
+        {
+            m_pZStream->next_out  = (Bytef*)(out);
+            m_pZStream->avail_out = sizeof( out );
+
+            if (deflate( m_pZStream, bFinish ? Z_FINISH : Z_NO_FLUSH )
+                    == Z_STREAM_ERROR)
+            {
+                return false;
+            }
+
+            m_chunk.append( out, sizeof( out ) - m_pZStream->avail_out );
+        }
+        while (m_pZStream->avail_out == 0);
+    }
+
+    if (m_chunk.size() >= kChunkSize || bFinish)
+        return SendChunk();
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPResponseStream::SendChunk()
+{
+    if (m_chunk.isEmpty())
+        return true;
+
+    m_chunk.prepend( QByteArray::number( m_chunk.size(), 16 ) + "\r\n" );
+    m_chunk.append( "\r\n" );
+
+    qlonglong nWritten = m_pRequest->WriteBlockDirect( m_chunk.constData(),
+                                                       m_chunk.size() );
+    bool bOK = (nWritten == m_chunk.size());
+
+    m_nBytes += nWritten;
+    m_chunk.clear();
+
+    return bOK;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Sends whatever is left and the terminating chunk.  Returns the number of
+// bytes sent for the whole response, or -1 if the client went away.
+/////////////////////////////////////////////////////////////////////////////
+
+long HTTPResponseStream::Finish()
+{
+    if (!m_bFailed && !Append( NULL, 0, true ))
+        m_bFailed = true;
+
+    if (!m_bFailed)
+    {
+        static const char szLastChunk[] = "0\r\n\r\n";
+
+        qlonglong nLen     = sizeof( szLastChunk ) - 1;
+        qlonglong nWritten = m_pRequest->WriteBlockDirect( szLastChunk, nLen );
+
+        if (nWritten != nLen)
+            m_bFailed = true;
+        else
+            m_nBytes += nWritten;
+    }
+
+#ifdef USE_SETSOCKOPT
+    // Turn off the option so any small remaining packets will be sent
+    setsockopt( m_pRequest->getSocketHandle(), SOL_TCP, TCP_CORK,
+                &g_off, sizeof( g_off ));
+#endif
+
+    LOG(VB_UPNP, LOG_INFO, LOC + QString("Sent %1 bytes to %2%3")
+        .arg(m_nBytes).arg(m_pRequest->GetPeerAddress())
+        .arg(m_bFailed ? ", client went away" : ""));
+
+    return m_bFailed ? -1 : m_nBytes;
+}
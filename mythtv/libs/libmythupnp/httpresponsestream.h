@@ -0,0 +1,76 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsestream.h
+// Created     : Oct. 19, 2026
+//
+// Purpose     : Chunked (and optionally gzip'd) Http Response Body
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPRESPONSESTREAM_H_
+#define HTTPRESPONSESTREAM_H_
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+
+class HTTPRequest;
+struct z_stream_s;
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Device the serializers write a service response into.
+//
+// Small responses are collected in HTTPRequest::m_response and sent as
+// before, with a Content-Length, an ETag and gzip'd as a whole.  Once a
+// response outgrows kStreamThreshold the header is sent and the rest is
+// written to the socket with "Transfer-Encoding: chunked" as it is
+// serialized, so a large result neither has to be held in memory twice
+// (plain and compressed) nor delays the first byte until it is complete.
+//
+/////////////////////////////////////////////////////////////////////////////
+
+class HTTPResponseStream : public QIODevice
+{
+    public:
+
+                 HTTPResponseStream( HTTPRequest *pRequest );
+        virtual ~HTTPResponseStream();
+
+        void     SetContentType    ( const QString &sContentType );
+
+        bool     IsStreaming       () const { return m_bStreaming; }
+        long     Finish            ();
+
+        virtual bool isSequential  () const { return true; }
+
+    protected:
+
+        virtual qint64 readData    ( char *pData, qint64 nMaxLen );
+        virtual qint64 writeData   ( const char *pData, qint64 nLen );
+
+    private:
+
+        bool     Begin             ();
+        bool     Append            ( const char *pData, qint64 nLen,
+                                     bool bFinish );
+        bool     SendChunk         ();
+
+    private:
+
+        HTTPRequest        *m_pRequest;
+        QString             m_sContentType;
+
+        bool                m_bStreaming;
+        bool                m_bFailed;
+        long                m_nBytes;
+
+        QByteArray          m_chunk;
+        struct z_stream_s  *m_pZStream;
+
+        static const int    kStreamThreshold;
+        static const int    kChunkSize;
+};
+
+#endif
@@ -18,7 +18,7 @@ QMAKE_CLEAN += version.cpp
 # Input
 
 HEADERS += mmulticastsocketdevice.h     mbroadcastsocketdevice.h
-HEADERS += httprequest.h upnp.h ssdp.h taskqueue.h upnpsubscription.h
+HEADERS += httprequest.h httpresponsestream.h httpresponsecache.h upnp.h ssdp.h taskqueue.h upnpsubscription.h
 HEADERS += upnpdevice.h upnptasknotify.h upnptasksearch.h upnputil.h
 HEADERS += httpserver.h upnpcds.h upnpcdsobjects.h bufferedsocketdevice.h upnpmsrr.h
 HEADERS += eventing.h upnpcmgr.h upnptaskevent.h upnptaskcache.h ssdpcache.h
@@ -32,7 +32,7 @@ HEADERS += serializers/jsonSerializer.h serializers/soapSerializer.h
 HEADERS += serializers/xmlplistSerializer.h
 
 SOURCES += mmulticastsocketdevice.cpp
-SOURCES += httprequest.cpp upnp.cpp ssdp.cpp taskqueue.cpp upnputil.cpp
+SOURCES += httprequest.cpp httpresponsestream.cpp httpresponsecache.cpp upnp.cpp ssdp.cpp taskqueue.cpp upnputil.cpp
 SOURCES += upnpdevice.cpp upnptasknotify.cpp upnptasksearch.cpp
 SOURCES += httpserver.cpp upnpcds.cpp upnpcdsobjects.cpp bufferedsocketdevice.cpp
 SOURCES += eventing.cpp upnpcmgr.cpp upnpmsrr.cpp upnptaskevent.cpp ssdpcache.cpp
@@ -15,6 +15,9 @@
 #include <QMetaObject>
 #include <QMetaProperty>
 
+QMutex                                                  Serializer::m_propertyLock;
+QHash< const QMetaObject*, Serializer::PropertyList* >  Serializer::m_propertyCache;
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////////////////////////////
@@ -104,45 +107,79 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 {
     if (pObject != NULL)
     {
-        const QMetaObject *pMetaObject = pObject->metaObject();
+        const QMetaObject  *pMetaObject = pObject->metaObject();
+        const PropertyList &properties  = GetPropertyList( pMetaObject );
 
-        int nCount = pMetaObject->propertyCount();
+        PropertyList::const_iterator it = properties.begin();
 
-        for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+        for (; it != properties.end(); ++it)
         {
-            QMetaProperty metaProperty = pMetaObject->property( nIdx );
+            const PropertyInfo &info = *it;
+
+            // DESIGNABLE may be a member function (e.g. SerializeDetails),
+            // so this one is still asked of every object.
+
+            if (!info.metaProperty.isDesignable( pObject ))
+                continue;
+
+            if (!info.bTransient)
+                m_hash.addData( info.sNameUtf8 );
+
+            QVariant value( info.metaProperty.read( pObject ) );
 
-            if (metaProperty.isDesignable( pObject ))
+            if (!info.bTransient && !value.canConvert< QObject* >()) 
             {
-                const char *pszPropName = metaProperty.name();
-                QString     sPropName( pszPropName );
-
-                if ( sPropName.compare( "objectName" ) == 0)
-                    continue;
-                
-                bool bHash = false;
-
-                if (ReadPropertyMetadata( pObject, 
-                                          sPropName, 
-                                          "transient").toLower() != "true" )
-                {
-                    bHash = true;
-                    m_hash.addData( sPropName.toUtf8() );
-                }
-
-                QVariant value( pObject->property( pszPropName ) );
-
-                if (bHash && !value.canConvert< QObject* >()) 
-                {
-                    m_hash.addData( value.toString().toUtf8() );
-                }
-
-                AddProperty( sPropName, value, pMetaObject, &metaProperty );
+                m_hash.addData( value.toString().toUtf8() );
             }
+
+            AddProperty( info.sName, value, pMetaObject, &info.metaProperty );
         }
     }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+const Serializer::PropertyList &Serializer::GetPropertyList(
+                                                const QMetaObject *pMeta )
+{
+    QMutexLocker locker( &m_propertyLock );
+
+    PropertyList *pList = m_propertyCache.value( pMeta, NULL );
+
+    if (pList != NULL)
+        return *pList;
+
+    // Lists are never changed or freed once cached, so the reference
+    // returned stays valid after the lock is released.
+
+    pList = new PropertyList();
+
+    int nCount = pMeta->propertyCount();
+
+    for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+    {
+        PropertyInfo info;
+
+        info.metaProperty = pMeta->property( nIdx );
+        info.sName        = info.metaProperty.name();
+
+        if ( info.sName.compare( "objectName" ) == 0)
+            continue;
+
+        info.sNameUtf8    = info.sName.toUtf8();
+        info.bTransient   = ReadClassInfo( pMeta, info.sName, "transient" )
+                                .toLower() == "true";
+
+        pList->append( info );
+    }
+
+    m_propertyCache.insert( pMeta, pList );
+
+    return *pList;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -151,8 +188,17 @@ QString Serializer::ReadPropertyMetadata( const QObject *pObject,
                                                 QString  sPropName, 
                                                 QString  sKey )
 {
-    const QMetaObject *pMeta = pObject->metaObject();
+    return ReadClassInfo( pObject->metaObject(), sPropName, sKey );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
 
+QString Serializer::ReadClassInfo( const QMetaObject *pMeta,
+                                   const QString     &sPropName,
+                                   const QString     &sKey )
+{
     int nIdx = pMeta->indexOfClassInfo( sPropName.toUtf8() );
 
     if (nIdx >=0)
@@ -171,5 +217,3 @@ QString Serializer::ReadPropertyMetadata( const QObject *pObject,
 
     return QString();
 }
-
-
@@ -17,7 +17,10 @@
 #include "upnputil.h"
 
 #include <QList>
+#include <QHash>
+#include <QMutex>
 #include <QMetaType>
+#include <QMetaProperty>
 #include <QCryptographicHash>
 
 //////////////////////////////////////////////////////////////////////////////
@@ -54,6 +57,34 @@ class UPNP_PUBLIC Serializer
                                                  QString  sPropName, 
                                                  QString  sKey );
 
+        //////////////////////////////////////////////////////////////////////
+        // Property metadata is the same for every instance of a class, so it
+        // is read once per QMetaObject instead of once per object serialized.
+        //////////////////////////////////////////////////////////////////////
+
+        class PropertyInfo
+        {
+            public:
+
+                QMetaProperty   metaProperty;
+                QString         sName;
+                QByteArray      sNameUtf8;
+                bool            bTransient;
+        };
+
+        typedef QList< PropertyInfo > PropertyList;
+
+        static const PropertyList &GetPropertyList( const QMetaObject *pMeta );
+
+        static QString ReadClassInfo( const QMetaObject *pMeta,
+                                      const QString     &sPropName,
+                                      const QString     &sKey );
+
+    private:
+
+        static QMutex                                          m_propertyLock;
+        static QHash< const QMetaObject*, PropertyList* >      m_propertyCache;
+
     public:
 
         virtual void Serialize( const QObject *pObject, const QString &_sName = QString() );
@@ -71,6 +102,8 @@ class UPNP_PUBLIC Serializer
         {
             qRegisterMetaType< QList<QObject*> >("QList<QObject*>");
         }
+
+        virtual ~Serializer() {};
 };
 
 Q_DECLARE_METATYPE( QList<QObject*> )
@@ -14,6 +14,7 @@
 
 #include "mythlogging.h"
 #include "servicehost.h"
+#include "httpresponsecache.h"
 #include "wsdl.h"
 #include "xsd.h"
 
@@ -238,6 +239,27 @@ ServiceHost::ServiceHost(const QMetaObject &metaObject,
                                                          RequestTypeHead);
             }
 
+            // ------------------------------------------------------
+            // Responses of methods with a "<methodName>_Cache" class
+            // info are cached until one of the events it lists.
+            // ------------------------------------------------------
+
+            QString sCacheClassInfo = oInfo.m_sName + "_Cache";
+
+            nClassIdx =
+                m_oMetaObject.indexOfClassInfo(sCacheClassInfo.toAscii());
+
+            if (nClassIdx >=0)
+            {
+                QString sEvents = m_oMetaObject.classInfo(nClassIdx).value();
+
+                QStringList::const_iterator it;
+                QStringList events = sEvents.split( ',', QString::SkipEmptyParts );
+
+                for (it = events.begin(); it != events.end(); ++it)
+                    oInfo.m_sCacheEvents.append( (*it).trimmed() );
+            }
+
             m_Methods.insert( oInfo.m_sName, oInfo );
         }
     }
@@ -367,6 +389,28 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
 
                 if (( pRequest->m_eType & oInfo.m_eRequestType ) != 0)
                 {
+                    // ------------------------------------------------------
+                    // Can we answer from the response cache?
+                    // ------------------------------------------------------
+
+                    HttpResponseCache *pCache      = NULL;
+                    QString            sCacheKey;
+                    uint               nGeneration = 0;
+
+                    if (!oInfo.m_sCacheEvents.isEmpty() &&
+                        (pRequest->m_eType != RequestTypePost))
+                    {
+                        pCache    = HttpResponseCache::Get();
+                        sCacheKey = HttpResponseCache::GetKey( pRequest );
+
+                        if (pCache->Lookup( sCacheKey, oInfo.m_sCacheEvents,
+                                            pRequest, nGeneration ))
+                            return true;
+
+                        // The whole response is needed to cache it.
+                        pRequest->m_bStreamable = false;
+                    }
+
                     // ------------------------------------------------------
                     // Create new Instance of the Service Class so
                     // it's guaranteed to be on the same thread
@@ -380,6 +424,10 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
                                                     pRequest->m_mapParams);
 
                     bHandled = FormatResponse( pRequest, vResult );
+
+                    if (bHandled && pCache)
+                        pCache->Insert( sCacheKey, oInfo.m_sCacheEvents,
+                                        nGeneration, pRequest );
                 }
             }
 
@@ -437,6 +485,7 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QObject *pResults )
 
         pRequest->FormatActionResponse( pSer );
 
+        delete pSer;
         delete pResults;
 
         return true;
@@ -502,5 +551,7 @@ bool ServiceHost::FormatResponse( HTTPRequest *pRequest, QVariant vValue )
 
     pRequest->FormatActionResponse( pSer );
 
+    delete pSer;
+
     return true;
 }
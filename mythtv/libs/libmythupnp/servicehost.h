@@ -38,6 +38,7 @@ class UPNP_PUBLIC MethodInfo
         QString         m_sName;
         QMetaMethod     m_oMethod;
         RequestType     m_eRequestType;
+        QStringList     m_sCacheEvents;     // see HttpResponseCache
 
     public:
         MethodInfo();
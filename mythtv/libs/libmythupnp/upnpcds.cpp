@@ -17,11 +17,17 @@ using namespace std;
 #include "upnp.h"
 #include "upnpcds.h"
 #include "upnputil.h"
+#include "mythcorecontext.h"
 #include "mythlogging.h"
+#include "mythevent.h"
+#include "mythdate.h"
 
 #define DIDL_LITE_BEGIN "<DIDL-Lite xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmlns:upnp=\"urn:schemas-upnp-org:metadata-1-0/upnp/\" xmlns=\"urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/\">"
 #define DIDL_LITE_END   "</DIDL-Lite>";
 
+const uint UPnpCDS::kCacheMaxAgeSecs = 10 * 60;
+const int  UPnpCDS::kCacheMaxBytes   = 16 * 1024 * 1024;
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -52,7 +58,8 @@ QString UPnpCDSExtensionResults::GetResultXML(FilterMap &filter)
 /////////////////////////////////////////////////////////////////////////////
 
 UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
-  : Eventing( "UPnpCDS", "CDS_Event", sSharePath )
+  : Eventing( "UPnpCDS", "CDS_Event", sSharePath ),
+    m_nCacheBytes( 0 ), m_nCacheGeneration( 0 )
 {
     m_root.m_eType      = OT_Container;
     m_root.m_sId        = "0";
@@ -77,6 +84,8 @@ UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
     // Add our Service Definition to the device.
 
     RegisterService( pDevice );
+
+    gCoreContext->addListener( this );
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -85,6 +94,8 @@ UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
 
 UPnpCDS::~UPnpCDS()
 {
+    gCoreContext->removeListener( this );
+
     while (!m_extensions.empty())
     {
         delete m_extensions.back();
@@ -138,11 +149,186 @@ void UPnpCDS::UnregisterExtension( UPnpCDSExtension *pExtension )
 {
     if (pExtension)
     {
+        QMutexLocker locker( &m_cacheLock );
+
+        QStringList stale;
+        QHash< QString, UPnpCDSCachedResult >::const_iterator it;
+        for (it = m_cache.begin(); it != m_cache.end(); ++it)
+        {
+            if ((*it).m_pExtension == pExtension)
+                stale.append( it.key() );
+        }
+
+        for (int nIdx = 0; nIdx < stale.size(); nIdx++)
+            RemoveResult( stale[ nIdx ] );
+
+        m_nCacheGeneration++;
+
         delete pExtension;
         m_extensions.removeAll(pExtension);
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Drops the cached results of every extension interested in the event,
+// and tells subscribers which containers changed.
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDS::customEvent( QEvent *e )
+{
+    if (e->type() != MythEvent::MythEventMessage)
+        return;
+
+    QString     sMessage = static_cast< MythEvent* >(e)->Message();
+    QStringList sContainerUpdates;
+
+    {
+        QMutexLocker locker( &m_cacheLock );
+
+        UPnpCDSExtensionList::iterator it = m_extensions.begin();
+        for (; it != m_extensions.end(); ++it)
+        {
+            QStringList sEvents = (*it)->GetChangeEvents();
+
+            bool bChanged = false;
+            for (int nIdx = 0; nIdx < sEvents.size() && !bChanged; nIdx++)
+            {
+                bChanged = (sMessage == sEvents[ nIdx ]) ||
+                           sMessage.startsWith( sEvents[ nIdx ] + " " );
+            }
+
+            if (!bChanged)
+                continue;
+
+            (*it)->m_nUpdateId++;
+
+            sContainerUpdates << (*it)->m_sExtensionId
+                              << QString::number( (*it)->m_nUpdateId );
+
+            QStringList stale;
+            QHash< QString, UPnpCDSCachedResult >::const_iterator cit;
+            for (cit = m_cache.begin(); cit != m_cache.end(); ++cit)
+            {
+                if ((*cit).m_pExtension == *it)
+                    stale.append( cit.key() );
+            }
+
+            for (int nIdx = 0; nIdx < stale.size(); nIdx++)
+                RemoveResult( stale[ nIdx ] );
+        }
+
+        if (sContainerUpdates.isEmpty())
+            return;
+
+        m_nCacheGeneration++;
+    }
+
+    LOG(VB_UPNP, LOG_INFO,
+        QString("UPnpCDS::customEvent - %1 changed: %2")
+            .arg(sMessage.section( ' ', 0, 0 ))
+            .arg(sContainerUpdates.join(",")));
+
+    SetValue< QString >( "ContainerUpdateIDs", sContainerUpdates.join(",") );
+
+    unsigned short nId = GetValue< unsigned short >( "SystemUpdateID" );
+
+    SetValue< unsigned short >( "SystemUpdateID", nId + 1 );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Results depend on every request parameter and, through AddItem, on
+// the client type.
+/////////////////////////////////////////////////////////////////////////////
+
+QString UPnpCDS::GetCacheKey( HTTPRequest          *pRequest,
+                              const UPnpCDSRequest *pCDSRequest )
+{
+    QString sKey = pRequest->m_sMethod + "?";
+
+    QStringMap::const_iterator it = pRequest->m_mapParams.begin();
+    for (; it != pRequest->m_mapParams.end(); ++it)
+        sKey += it.key() + "=" + *it + "&";
+
+    sKey += QString( "|%1/%2" ).arg( pCDSRequest->m_eClient )
+                               .arg( pCDSRequest->m_nClientVersion );
+
+    return sKey;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool UPnpCDS::LookupResult( const QString       &sKey,
+                            UPnpCDSCachedResult &result,
+                            uint                &nGeneration )
+{
+    QMutexLocker locker( &m_cacheLock );
+
+    nGeneration = m_nCacheGeneration;
+
+    QHash< QString, UPnpCDSCachedResult >::const_iterator it =
+        m_cache.find( sKey );
+
+    if (it == m_cache.end())
+        return false;
+
+    if (MythDate::current().toTime_t() - (*it).m_nCreated > kCacheMaxAgeSecs)
+    {
+        RemoveResult( sKey );
+        return false;
+    }
+
+    result = *it;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDS::CacheResult( const QString             &sKey,
+                           const UPnpCDSCachedResult &result,
+                           uint                       nGeneration )
+{
+    QMutexLocker locker( &m_cacheLock );
+
+    // Something changed while this was built, it may already be stale.
+
+    if (nGeneration != m_nCacheGeneration)
+        return;
+
+    RemoveResult( sKey );
+
+    m_cache.insert( sKey, result );
+    m_cacheOrder.append( sKey );
+    m_nCacheBytes += result.m_sResultXML.size() * sizeof( QChar );
+
+    while ((m_nCacheBytes > kCacheMaxBytes) && !m_cacheOrder.isEmpty())
+    {
+        QString sOldest = m_cacheOrder.front();
+        RemoveResult( sOldest );
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Must be called with m_cacheLock held.
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDS::RemoveResult( const QString &sKey )
+{
+    QHash< QString, UPnpCDSCachedResult >::iterator it = m_cache.find( sKey );
+
+    if (it == m_cache.end())
+        return;
+
+    m_nCacheBytes -= (*it).m_sResultXML.size() * sizeof( QChar );
+
+    m_cache.erase( it );
+    m_cacheOrder.removeOne( sKey );
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -422,33 +608,63 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
     else
     {
         // ------------------------------------------------------------------
-        // Look for a CDS Extension that knows how to handle this ObjectID
+        // Answered before, and nothing changed since?
         // ------------------------------------------------------------------
 
-        UPnpCDSExtensionList::iterator it = m_extensions.begin();
-        for (; (it != m_extensions.end()) && !pResult; ++it)
-        {
-            LOG(VB_UPNP, LOG_INFO,
-                QString("UPNP Browse : Searching for : %1  / ObjectID : %2")
-                    .arg((*it)->m_sExtensionId).arg(request.m_sObjectId));
+        QString             sCacheKey = GetCacheKey( pRequest, &request );
+        UPnpCDSCachedResult cached;
+        uint                nGeneration;
 
-            pResult = (*it)->Browse(&request);
+        if (LookupResult( sCacheKey, cached, nGeneration ))
+        {
+            eErrorCode      = UPnPResult_Success;
+            nNumberReturned = cached.m_nNumberReturned;
+            nTotalMatches   = cached.m_nTotalMatches;
+            nUpdateID       = cached.m_pExtension->m_nUpdateId;
+            sResultXML      = cached.m_sResultXML;
         }
-
-        if (pResult != NULL)
+        else
         {
-            eErrorCode  = pResult->m_eErrorCode;
-            sErrorDesc  = pResult->m_sErrorDesc;
+            // --------------------------------------------------------------
+            // Look for a CDS Extension that knows how to handle this ObjectID
+            // --------------------------------------------------------------
 
-            if (eErrorCode == UPnPResult_Success)
+            UPnpCDSExtension *pExtension = NULL;
+
+            UPnpCDSExtensionList::iterator it = m_extensions.begin();
+            for (; (it != m_extensions.end()) && !pResult; ++it)
             {
-                nNumberReturned = pResult->m_List.count();
-                nTotalMatches   = pResult->m_nTotalMatches;
-                nUpdateID       = pResult->m_nUpdateID;
-                sResultXML      = pResult->GetResultXML(filter);
+                LOG(VB_UPNP, LOG_INFO,
+                    QString("UPNP Browse : Searching for : %1  / ObjectID : %2")
+                        .arg((*it)->m_sExtensionId).arg(request.m_sObjectId));
+
+                pResult    = (*it)->Browse(&request);
+                pExtension = *it;
             }
 
-            delete pResult;
+            if (pResult != NULL)
+            {
+                eErrorCode  = pResult->m_eErrorCode;
+                sErrorDesc  = pResult->m_sErrorDesc;
+
+                if (eErrorCode == UPnPResult_Success)
+                {
+                    nNumberReturned = pResult->m_List.count();
+                    nTotalMatches   = pResult->m_nTotalMatches;
+                    nUpdateID       = pExtension->m_nUpdateId;
+                    sResultXML      = pResult->GetResultXML(filter);
+
+                    cached.m_pExtension      = pExtension;
+                    cached.m_sResultXML      = sResultXML;
+                    cached.m_nNumberReturned = nNumberReturned;
+                    cached.m_nTotalMatches   = nTotalMatches;
+                    cached.m_nCreated        = MythDate::current().toTime_t();
+
+                    CacheResult( sCacheKey, cached, nGeneration );
+                }
+
+                delete pResult;
+            }
         }
     }
 
@@ -569,28 +785,53 @@ void UPnpCDS::HandleSearch( HTTPRequest *pRequest )
     bool bSearchDone = false;
 #endif
 
-    UPnpCDSExtensionList::iterator it = m_extensions.begin();
-    for (; (it != m_extensions.end()) && !pResult; ++it)
-        pResult = (*it)->Search(&request);
+    QString             sCacheKey = GetCacheKey( pRequest, &request );
+    UPnpCDSCachedResult cached;
+    uint                nGeneration;
 
-    if (pResult != NULL)
+    if (LookupResult( sCacheKey, cached, nGeneration ))
     {
-        eErrorCode  = pResult->m_eErrorCode;
-        sErrorDesc  = pResult->m_sErrorDesc;
+        eErrorCode      = UPnPResult_Success;
+        nNumberReturned = cached.m_nNumberReturned;
+        nTotalMatches   = cached.m_nTotalMatches;
+        nUpdateID       = cached.m_pExtension->m_nUpdateId;
+        sResultXML      = cached.m_sResultXML;
+    }
+    else
+    {
+        UPnpCDSExtension *pExtension = NULL;
 
-        if (eErrorCode == UPnPResult_Success)
+        UPnpCDSExtensionList::iterator it = m_extensions.begin();
+        for (; (it != m_extensions.end()) && !pResult; ++it)
         {
-            FilterMap filter =  (FilterMap) request.m_sFilter.split(',');
-            nNumberReturned = pResult->m_List.count();
-            nTotalMatches   = pResult->m_nTotalMatches;
-            nUpdateID       = pResult->m_nUpdateID;
-            sResultXML      = pResult->GetResultXML(filter);
-#if 0
-            bSearchDone = true;
-#endif
+            pResult    = (*it)->Search(&request);
+            pExtension = *it;
         }
 
-        delete pResult;
+        if (pResult != NULL)
+        {
+            eErrorCode  = pResult->m_eErrorCode;
+            sErrorDesc  = pResult->m_sErrorDesc;
+
+            if (eErrorCode == UPnPResult_Success)
+            {
+                FilterMap filter =  (FilterMap) request.m_sFilter.split(',');
+                nNumberReturned = pResult->m_List.count();
+                nTotalMatches   = pResult->m_nTotalMatches;
+                nUpdateID       = pExtension->m_nUpdateId;
+                sResultXML      = pResult->GetResultXML(filter);
+
+                cached.m_pExtension      = pExtension;
+                cached.m_sResultXML      = sResultXML;
+                cached.m_nNumberReturned = nNumberReturned;
+                cached.m_nTotalMatches   = nTotalMatches;
+                cached.m_nCreated        = MythDate::current().toTime_t();
+
+                CacheResult( sCacheKey, cached, nGeneration );
+            }
+
+            delete pResult;
+        }
     }
 
 #if 0
@@ -15,6 +15,8 @@
 
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 
 #include "upnp.h"
@@ -154,6 +156,11 @@ class UPNP_PUBLIC UPnpCDSExtension
         QString     m_sName;
         QString     m_sClass;
 
+        // Bumped by UPnpCDS whenever one of GetChangeEvents() is seen,
+        // reported as this extension's ContainerUpdateIDs entry.
+
+        short       m_nUpdateId;
+
     protected:
 
         QString RemoveToken ( const QString &sToken, const QString &sStr, int num );
@@ -220,6 +227,7 @@ class UPNP_PUBLIC UPnpCDSExtension
             m_sName        = QObject::tr(sName.toLatin1().constData());
             m_sExtensionId = sExtensionId;
             m_sClass       = sClass;
+            m_nUpdateId    = 1;
         }
 
         virtual ~UPnpCDSExtension() {}
@@ -229,10 +237,38 @@ class UPNP_PUBLIC UPnpCDSExtension
 
         virtual QString GetSearchCapabilities() { return( "" ); }
         virtual QString GetSortCapabilities  () { return( "" ); }
+
+        // Events (message prefixes) after which this extension's content
+        // may have changed. Until then its results are served from the
+        // UPnpCDS result cache.
+
+        virtual QStringList GetChangeEvents  () { return QStringList(); }
 };
 
 typedef QList<UPnpCDSExtension*> UPnpCDSExtensionList;
 
+//////////////////////////////////////////////////////////////////////////////
+
+class UPnpCDSCachedResult
+{
+    public:
+
+        UPnpCDSExtension   *m_pExtension;
+        QString             m_sResultXML;
+        short               m_nNumberReturned;
+        short               m_nTotalMatches;
+        uint                m_nCreated;     // time_t the result was built
+
+    public:
+
+        UPnpCDSCachedResult() : m_pExtension( NULL ),
+                                m_nNumberReturned( 0 ),
+                                m_nTotalMatches( 0 ),
+                                m_nCreated( 0 )
+        {
+        }
+};
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -251,6 +287,19 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         QString                m_sServiceDescFileName;
         QString                m_sControlUrl;
 
+        // Browse & Search results, already rendered as DIDL, keyed by
+        // request.  Entries of an extension are dropped when it reports
+        // a change, everything else only ages out.
+
+        QMutex                                  m_cacheLock;
+        QHash< QString, UPnpCDSCachedResult >   m_cache;
+        QList< QString >                        m_cacheOrder;   // oldest first
+        int                                     m_nCacheBytes;
+        uint                                    m_nCacheGeneration;
+
+        static const uint                       kCacheMaxAgeSecs;
+        static const int                        kCacheMaxBytes;
+
     private:
 
         UPnpCDSMethod       GetMethod              ( const QString &sURI  );
@@ -263,6 +312,13 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         void            HandleGetSystemUpdateID    ( HTTPRequest *pRequest );
         void            DetermineClient            ( HTTPRequest *pRequest, UPnpCDSRequest *pCDSRequest );
 
+        QString         GetCacheKey     ( HTTPRequest *pRequest, const UPnpCDSRequest *pCDSRequest );
+        bool            LookupResult    ( const QString &sKey, UPnpCDSCachedResult &result,
+                                          uint &nGeneration );
+        void            CacheResult     ( const QString &sKey, const UPnpCDSCachedResult &result,
+                                          uint nGeneration );
+        void            RemoveResult    ( const QString &sKey );
+
     protected:
 
         // Implement UPnpServiceImpl methods that we can
@@ -272,6 +328,8 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         virtual QString GetServiceControlURL() { return m_sControlUrl.mid( 1 ); }
         virtual QString GetServiceDescURL   () { return m_sControlUrl.mid( 1 ) + "/GetServDesc"; }
 
+        virtual void    customEvent         ( QEvent *e );
+
     public:
         UPnpCDS( UPnpDevice *pDevice,
                  const QString &sSharePath ); 
@@ -50,5 +50,36 @@ void MythAVTestCommandLineParser::LoadArguments(void)
                     "The number of seconds to run the test (default 5).", "")
                     ->SetGroup("Video Performance Testing")
                     ->SetChildOf("test");
+    add(QStringList(QStringList() << "-b" << "--benchmark"),
+                    "benchmark", false,
+                    "Run headless and print per stage timings.",
+                    "Use the null video and audio outputs, so no display or "
+                    "audio configuration is needed, and print demux, decode, "
+                    "filter, display and frame queue wait timings together "
+                    "with the frame rate, dropped frames, A/V sync error and "
+                    "peak memory use in a machine readable format.")
+                    ->SetGroup("Video Performance Testing")
+                    ->SetChildOf("test");
+    add("--realtime", "realtime", false,
+                    "Pace display at the stream frame rate.",
+                    "Instead of running as fast as possible, present each "
+                    "frame at its timestamp and drop frames that are more "
+                    "than one frame interval late, as normal playback does. "
+                    "Required to measure dropped frames and A/V sync error.")
+                    ->SetGroup("Video Performance Testing")
+                    ->SetChildOf("test");
+    add("--vfilters", "vfilters", "",
+                    "Video filter chain to apply, e.g. yadifdeint.",
+                    "Overrides the video filters of the playback profile, "
+                    "use this to measure software deinterlacers and "
+                    "filters with --benchmark.")
+                    ->SetGroup("Video Performance Testing")
+                    ->SetChildOf("test");
+    add("--benchmark-format", "benchmarkformat", "json",
+                    "Benchmark output format, 'json' or 'text'.",
+                    "'json' prints one JSON object, 'text' prints one "
+                    "key=value pair per line.")
+                    ->SetGroup("Video Performance Testing")
+                    ->SetChildOf("benchmark");
 }
 
@@ -1,9 +1,15 @@
+#include <sys/resource.h>
+#include <sys/time.h>
 #include <unistd.h>
+#include <cstdlib>
 #include <iostream>
+#include <algorithm>
 
 using namespace std;
 
 #include <QString>
+#include <QList>
+#include <QPair>
 #include <QRegExp>
 #include <QDir>
 #include <QApplication>
@@ -13,6 +19,8 @@ using namespace std;
 #include "programinfo.h"
 #include "commandlineparser.h"
 #include "mythplayer.h"
+#include "decoderbase.h"
+#include "filtermanager.h"
 #include "jitterometer.h"
 
 #include "exitcodes.h"
@@ -28,13 +36,37 @@ using namespace std;
 #include "mythuihelper.h"
 #include "mythmainwindow.h"
 
+/// Accumulates the time spent in one stage of the benchmark loop.
+class StageTimer
+{
+  public:
+    StageTimer() : total(0), maximum(0), count(0) {}
+
+    void Add(int64_t usecs)
+    {
+        total += usecs;
+        maximum = max(maximum, usecs);
+        count++;
+    }
+
+    double AverageMS(void) const
+        { return count ? (double)total / count / 1000.0 : 0.0; }
+
+    int64_t  total;
+    int64_t  maximum;
+    uint64_t count;
+};
+
 class VideoPerformanceTest
 {
   public:
     VideoPerformanceTest(const QString &filename, bool novsync, bool onlydecode,
-                         int runfor, bool deint)
+                         int runfor, bool deint, bool bench = false,
+                         bool paced = false, const QString &vfilters = "",
+                         const QString &format = "json")
       : file(filename), novideosync(novsync), decodeonly(onlydecode),
-        secondstorun(runfor), deinterlace(deint), ctx(NULL)
+        secondstorun(runfor), deinterlace(deint), benchmark(bench),
+        realtime(paced), filters(vfilters), outputformat(format), ctx(NULL)
     {
         if (secondstorun < 1)
             secondstorun = 1;
@@ -54,15 +86,21 @@ class VideoPerformanceTest
         if (novideosync) // TODO
             LOG(VB_GENERAL, LOG_INFO, "Will attempt to disable sync-to-vblank.");
 
+        PlayerFlags flags = kAudioMuted;
+        if (benchmark)
+            flags = (PlayerFlags)(flags | kVideoIsNull);
+
         RingBuffer *rb  = RingBuffer::Create(file, false, true, 2000);
-        MythPlayer  *mp  = new MythPlayer(kAudioMuted);
+        MythPlayer  *mp  = new MythPlayer(flags);
         mp->GetAudio()->SetAudioInfo("NULL", "NULL", 0, 0);
         mp->GetAudio()->SetNoAudio();
+        if (!filters.isEmpty())
+            mp->SetVideoFilters(filters);
         ctx = new PlayerContext("VideoPerformanceTest");
         ctx->SetRingBuffer(rb);
         ctx->SetPlayer(mp);
         ctx->SetPlayingInfo(new ProgramInfo(file));
-        mp->SetPlayerInfo(NULL, GetMythMainWindow(), ctx);
+        mp->SetPlayerInfo(NULL, benchmark ? NULL : GetMythMainWindow(), ctx);
         FrameScanType scan = deinterlace ? kScan_Interlaced : kScan_Progressive;
         if (!mp->StartPlaying())
         {
@@ -77,6 +115,9 @@ class VideoPerformanceTest
             return;
         }
 
+        if (benchmark && mp->decoder)
+            mp->decoder->SetCollectStats(true);
+
         LOG(VB_GENERAL, LOG_INFO, "-----------------------------------");
         LOG(VB_GENERAL, LOG_INFO, QString("Starting video performance test for '%1'.")
             .arg(file));
@@ -87,11 +128,23 @@ class VideoPerformanceTest
             LOG(VB_GENERAL, LOG_INFO, "Decoding frames only - skipping display.");
         LOG(VB_GENERAL, LOG_INFO, QString("Deinterlacing %1")
             .arg(deinterlace ? "enabled" : "disabled"));
+        if (realtime)
+            LOG(VB_GENERAL, LOG_INFO, "Pacing display at the stream frame rate.");
 
         Jitterometer *jitter = new Jitterometer("Performance: ", mp->GetFrameRate());
 
+        double  frame_rate   = mp->GetFrameRate();
+        int64_t frame_usecs  = (frame_rate > 0.0f) ?
+            (int64_t)(1000000.0 / frame_rate) : 40000;
+
+        StageTimer queue_wait, filter, display, sync_error;
+        uint64_t   frames = 0, dropped = 0;
+        int64_t    first_timecode = -1, first_usecs = 0;
+
         int ms = secondstorun * 1000;
         QTime start = QTime::currentTime();
+        int64_t start_usecs = DecoderStats::Now();
+        int64_t wait_start  = start_usecs;
         while (1)
         {
             int duration = start.msecsTo(QTime::currentTime());
@@ -121,25 +174,205 @@ class VideoPerformanceTest
             VideoFrame *frame = vo->GetLastShownFrame();
             mp->CheckAspectRatio(frame);
 
-            if (!decodeonly)
+            int64_t now = DecoderStats::Now();
+            queue_wait.Add(now - wait_start);
+
+            bool drop = false;
+            if (realtime && frame)
             {
+                // Present the frame at its timestamp, relative to the first
+                // frame, and drop it when we are already a frame late.
+                if (first_timecode < 0)
+                {
+                    first_timecode = frame->timecode;
+                    first_usecs    = now;
+                }
+                int64_t due = first_usecs +
+                    (frame->timecode - first_timecode) * 1000;
+                if (due > now)
+                {
+                    usleep(due - now);
+                    now = DecoderStats::Now();
+                }
+                int64_t late = now - due;
+                if (llabs(late) > 1000000)
+                {
+                    // timestamp discontinuity, start a new timeline
+                    first_timecode = frame->timecode;
+                    first_usecs    = now;
+                    late           = 0;
+                }
+                sync_error.Add(llabs(late));
+                drop = late > frame_usecs;
+                if (drop)
+                    dropped++;
+            }
+
+            if (!decodeonly && !drop)
+            {
+                int64_t filter_start = DecoderStats::Now();
                 vo->ProcessFrame(frame, NULL, NULL, dummy, scan);
+                // The null output ignores the filter chain, run it here so
+                // software filters and deinterlacers are still measured.
+                if (benchmark && mp->videoFilters && frame)
+                    mp->videoFilters->ProcessFrame(frame, scan);
+                int64_t display_start = DecoderStats::Now();
+                filter.Add(display_start - filter_start);
+
                 vo->PrepareFrame(frame, scan, NULL);
                 vo->Show(scan);
+                display.Add(DecoderStats::Now() - display_start);
             }
             vo->DoneDisplayingFrame(frame);
             jitter->RecordCycleTime();
+            frames++;
+            wait_start = DecoderStats::Now();
         }
         LOG(VB_GENERAL, LOG_INFO, "-----------------------------------");
         delete jitter;
+
+        if (!benchmark)
+            return;
+
+        int64_t elapsed = DecoderStats::Now() - start_usecs;
+        DecoderStats stats;
+        if (mp->decoder)
+            stats = mp->decoder->GetStats();
+
+        QList<QPair<QString, QString> > results;
+        AddResult(results, "file", file);
+        AddResult(results, "decoder", mp->decoder ?
+                  mp->decoder->GetCodecDecoderName() : QString());
+        AddResult(results, "width", mp->GetVideoSize().width());
+        AddResult(results, "height", mp->GetVideoSize().height());
+        AddResult(results, "stream_fps", frame_rate);
+        AddResult(results, "decode_only", decodeonly);
+        AddResult(results, "realtime", realtime);
+        AddResult(results, "filters", filters);
+        AddResult(results, "elapsed_ms", elapsed / 1000.0);
+        AddResult(results, "frames", frames);
+        AddResult(results, "fps", elapsed ? frames * 1000000.0 / elapsed : 0.0);
+        AddResult(results, "dropped_frames", dropped);
+        AddStage(results, "demux", stats.demux_usecs, stats.demux_packets);
+        AddStage(results, "video_decode", stats.video_usecs,
+                 stats.video_packets);
+        AddResult(results, "video_decode_frames", stats.video_frames);
+        AddStage(results, "audio_decode", stats.audio_usecs,
+                 stats.audio_packets);
+        AddStage(results, "filter", filter);
+        AddStage(results, "display", display);
+        AddStage(results, "queue_wait", queue_wait);
+        if (realtime)
+            AddStage(results, "av_sync_error", sync_error);
+        AddResult(results, "max_rss_kb", GetMaxRSS());
+
+        PrintResults(results);
     }
 
   private:
+    static void AddResult(QList<QPair<QString, QString> > &results,
+                          const QString &key, const QString &value)
+    {
+        QString escaped = value;
+        escaped.replace("\\", "\\\\").replace("\"", "\\\"");
+        results.push_back(qMakePair(key, QString("\"%1\"").arg(escaped)));
+    }
+
+    static void AddResult(QList<QPair<QString, QString> > &results,
+                          const QString &key, bool value)
+    {
+        results.push_back(qMakePair(key, QString(value ? "true" : "false")));
+    }
+
+    static void AddResult(QList<QPair<QString, QString> > &results,
+                          const QString &key, int value)
+    {
+        results.push_back(qMakePair(key, QString::number(value)));
+    }
+
+    static void AddResult(QList<QPair<QString, QString> > &results,
+                          const QString &key, uint64_t value)
+    {
+        results.push_back(qMakePair(key, QString::number((qulonglong)value)));
+    }
+
+    static void AddResult(QList<QPair<QString, QString> > &results,
+                          const QString &key, long value)
+    {
+        results.push_back(qMakePair(key, QString::number(value)));
+    }
+
+    static void AddResult(QList<QPair<QString, QString> > &results,
+                          const QString &key, double value)
+    {
+        results.push_back(qMakePair(key, QString::number(value, 'f', 3)));
+    }
+
+    /// Decoder stages only know their totals.
+    static void AddStage(QList<QPair<QString, QString> > &results,
+                         const QString &name, int64_t usecs, uint64_t count)
+    {
+        AddResult(results, name + "_total_ms", usecs / 1000.0);
+        AddResult(results, name + "_count", count);
+        AddResult(results, name + "_avg_ms",
+                  count ? (double)usecs / count / 1000.0 : 0.0);
+    }
+
+    static void AddStage(QList<QPair<QString, QString> > &results,
+                         const QString &name, const StageTimer &stage)
+    {
+        AddStage(results, name, stage.total, stage.count);
+        AddResult(results, name + "_max_ms", stage.maximum / 1000.0);
+    }
+
+    /// Peak resident set size of this process in KiB
+    static long GetMaxRSS(void)
+    {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) < 0)
+            return 0;
+#ifdef Q_OS_MAC
+        return usage.ru_maxrss / 1024; // reported in bytes on OS X
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+    void PrintResults(const QList<QPair<QString, QString> > &results) const
+    {
+        bool json = outputformat.toLower() != "text";
+        QString out = json ? "{\n" : "";
+        for (int i = 0; i < results.size(); i++)
+        {
+            if (json)
+            {
+                out += QString("  \"%1\": %2%3\n").arg(results[i].first)
+                    .arg(results[i].second)
+                    .arg((i + 1 < results.size()) ? "," : "");
+            }
+            else
+            {
+                QString value = results[i].second;
+                if (value.startsWith("\""))
+                    value = value.mid(1, value.length() - 2)
+                        .replace("\\\"", "\"").replace("\\\\", "\\");
+                out += QString("%1=%2\n").arg(results[i].first).arg(value);
+            }
+        }
+        if (json)
+            out += "}\n";
+        cout << out.toLocal8Bit().constData() << flush;
+    }
+
     QString file;
     bool    novideosync;
     bool    decodeonly;
     int     secondstorun;
     bool    deinterlace;
+    bool    benchmark;
+    bool    realtime;
+    QString filters;
+    QString outputformat;
     PlayerContext *ctx;
 };
 
@@ -164,7 +397,9 @@ int main(int argc, char *argv[])
         return GENERIC_EXIT_OK;
     }
 
-    QApplication a(argc, argv);
+    // The benchmark runs headless, it must not need an X display
+    bool benchmark = cmdline.toBool("test") && cmdline.toBool("benchmark");
+    QApplication a(argc, argv, !benchmark);
     QCoreApplication::setApplicationName(MYTH_APPNAME_MYTHAVTEST);
 
     int retval;
@@ -188,7 +423,7 @@ int main(int argc, char *argv[])
         filename = cmdline.GetArgs()[0];
 
     gContext = new MythContext(MYTH_BINARY_VERSION);
-    if (!gContext->Init())
+    if (!gContext->Init(!benchmark))
     {
         LOG(VB_GENERAL, LOG_ERR, "Failed to init MythContext, exiting.");
         return GENERIC_EXIT_NO_MYTHCONTEXT;
@@ -198,6 +433,22 @@ int main(int argc, char *argv[])
 
     setuid(getuid());
 
+    if (benchmark)
+    {
+        int seconds = 5;
+        if (!cmdline.toString("seconds").isEmpty())
+            seconds = cmdline.toInt("seconds");
+        VideoPerformanceTest *test = new VideoPerformanceTest(filename, false,
+                    cmdline.toBool("decodeonly"), seconds,
+                    cmdline.toBool("deinterlace"), true,
+                    cmdline.toBool("realtime"), cmdline.toString("vfilters"),
+                    cmdline.toString("benchmarkformat"));
+        test->Test();
+        delete test;
+        delete gContext;
+        return GENERIC_EXIT_OK;
+    }
+
     QString themename = gCoreContext->GetSetting("Theme");
     QString themedir = GetMythUI()->FindThemeDir(themename);
     if (themedir.isEmpty())
@@ -232,7 +483,8 @@ int main(int argc, char *argv[])
             seconds = cmdline.toInt("seconds");
         VideoPerformanceTest *test = new VideoPerformanceTest(filename, false,
                     cmdline.toBool("decodeonly"), seconds,
-                    cmdline.toBool("deinterlace"));
+                    cmdline.toBool("deinterlace"), false,
+                    cmdline.toBool("realtime"), cmdline.toString("vfilters"));
         test->Test();
         delete test;
     }
@@ -35,6 +35,7 @@ using namespace std;
 #include <QUrl>
 #include <QTcpServer>
 #include <QTimer>
+#include <QVector>
 #include <QNetworkInterface>
 #include <QNetworkProxy>
 
@@ -651,6 +652,10 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     {
         HandlePixmapGetIfModified(listline, pbs);
     }
+    else if (command == "QUERY_PREVIEWS")
+    {
+        HandleGetPreviews(listline, pbs);
+    }
     else if (command == "QUERY_ISRECORDING")
     {
         HandleIsRecording(listline, pbs);
@@ -883,6 +888,8 @@ void MainServer::customEvent(QEvent *e)
                     return;
                 }
 
+                m_previewCache.Invalidate(pginfokey);
+
                 broadcast.push_back("BACKEND_MESSAGE");
                 broadcast.push_back("GENERATED_PIXMAP");
                 broadcast += extra;
@@ -5628,6 +5635,167 @@ void MainServer::HandlePixmapGetIfModified(
     SendResponse(pbssock, strlist);
 }
 
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_PREVIEWS \e width \e height \e format \e secsin \e count
+ *             [\e etag \e programinfo]...
+ * Batched, size aware variant of QUERY_PIXMAP_GET_IF_MODIFIED.
+ * A \e width or \e height of 0 keeps the aspect ratio, \e format is
+ * "jpg" or "webp" (falls back to "jpg" if unsupported), \e secsin of -1
+ * selects the default preview and \e etag is "<EMPTY>" or the ETag the
+ * client already has.
+ *
+ * Returns "OK" \e count followed by \e status \e etag \e format
+ * \e lastmodified \e size \e base64data for each requested recording,
+ * where \e status is one of OK, NOT_MODIFIED, PENDING (generation has
+ * been queued, GENERATED_PIXMAP is sent when it is done) or ERROR and
+ * \e lastmodified is the time the preview was generated, in ISO format.
+ */
+void MainServer::HandleGetPreviews(const QStringList &slist, PlaybackSock *pbs)
+{
+    static const int kFieldsPerPreview = 6;
+
+    MythSocket *pbssock = pbs->getSocket();
+    QStringList strlist;
+
+    if (slist.size() < 6)
+    {
+        strlist = QStringList("ERROR");
+        strlist += "1: Parameter list too short";
+        SendResponse(pbssock, strlist);
+        return;
+    }
+
+    QStringList header = slist.mid(0, 5);
+    QSize       size(slist[1].toInt(), slist[2].toInt());
+    QString     format = PreviewCache::GetOutputFormat(slist[3]);
+    int         secsin = slist[4].toInt();
+    int         count  = slist[5].toInt();
+    int         stride = 1 + NUMPROGRAMLINES;
+
+    if ((count < 0) || (slist.size() < 6 + count * stride))
+    {
+        strlist = QStringList("ERROR");
+        strlist += "2: Parameter list too short";
+        SendResponse(pbssock, strlist);
+        return;
+    }
+
+    QVector<QStringList> results(count);
+
+    // Requests for recordings made by slave backends, grouped by hostname
+    QMap<QString, QList<int> > remote;
+
+    for (int i = 0; i < count; i++)
+    {
+        int offset = 6 + i * stride;
+        QString etag = slist[offset];
+        etag = (etag == "<EMPTY>") ? QString::null : etag;
+
+        QStringList::const_iterator it = slist.begin() + offset + 1;
+        ProgramInfo pginfo(it, slist.begin() + offset + stride);
+
+        results[i] << "ERROR" << "" << format << "" << "0" << "";
+
+        if (!pginfo.HasPathname())
+            continue;
+
+        QString key = pginfo.MakeUniqueKey();
+        pginfo.SetPathname(GetPlaybackURL(&pginfo));
+
+        if (!pginfo.IsLocal())
+        {
+            if (ismaster &&
+                pginfo.GetHostname() != gCoreContext->GetHostName())
+            {
+                remote[pginfo.GetHostname()].push_back(i);
+            }
+            continue;
+        }
+
+        QString source = (secsin > 0) ?
+            QString("%1.%2.png").arg(pginfo.GetPathname()).arg(secsin) :
+            pginfo.GetPathname() + ".png";
+
+        PreviewCacheEntry entry;
+        if (m_previewCache.Get(key, source, secsin, size, format, entry))
+        {
+            if (!etag.isEmpty() && etag == entry.etag)
+            {
+                results[i][0] = "NOT_MODIFIED";
+                results[i][1] = entry.etag;
+                results[i][2] = entry.format;
+                results[i][3] = MythDate::toString(entry.sourceMTime,
+                                                   MythDate::ISODate);
+            }
+            else
+            {
+                results[i][0] = "OK";
+                results[i][1] = entry.etag;
+                results[i][2] = entry.format;
+                results[i][3] = MythDate::toString(entry.sourceMTime,
+                                                   MythDate::ISODate);
+                results[i][4] = QString::number(entry.data.size());
+                results[i][5] = QString(entry.data.toBase64());
+            }
+            continue;
+        }
+
+        // No preview yet, queue one and let the client know it is coming.
+        QString token = QString("%1:%2").arg(key).arg(random());
+        m_previewRequestedBy[token] = pbs->getHostname();
+        if (secsin > 0)
+        {
+            PreviewGeneratorQueue::GetPreviewImage(
+                pginfo, QSize(0,0), source, secsin, true, token);
+        }
+        else
+        {
+            PreviewGeneratorQueue::GetPreviewImage(pginfo, token);
+        }
+        results[i][0] = "PENDING";
+    }
+
+    QMap<QString, QList<int> >::const_iterator rit = remote.begin();
+    for (; rit != remote.end(); ++rit)
+    {
+        PlaybackSock *slave = GetSlaveByHostname(rit.key());
+        if (!slave)
+            continue;
+
+        const QList<int> &indexes = *rit;
+        QStringList request = header;
+        request << QString::number(indexes.size());
+        for (int j = 0; j < indexes.size(); j++)
+            request += slist.mid(6 + indexes[j] * stride, stride);
+
+        QStringList reply = slave->ForwardRequest(request);
+        slave->DecrRef();
+
+        if (reply.size() < 2 + indexes.size() * kFieldsPerPreview ||
+            reply[0] != "OK")
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("HandleGetPreviews() bad reply from %1")
+                    .arg(rit.key()));
+            continue;
+        }
+
+        for (int j = 0; j < indexes.size(); j++)
+        {
+            results[indexes[j]] =
+                reply.mid(2 + j * kFieldsPerPreview, kFieldsPerPreview);
+        }
+    }
+
+    strlist = QStringList("OK");
+    strlist << QString::number(count);
+    for (int i = 0; i < count; i++)
+        strlist += results[i];
+
+    SendResponse(pbssock, strlist);
+}
+
 void MainServer::HandleBackendRefresh(MythSocket *socket)
 {
     QStringList retlist( "OK" );
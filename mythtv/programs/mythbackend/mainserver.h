@@ -23,6 +23,7 @@ using namespace std;
 #include "mythsocket.h"
 #include "mythdeque.h"
 #include "mythdownloadmanager.h"
+#include "previewcache.h"
 
 #ifdef DeleteFile
 #undef DeleteFile
@@ -196,6 +197,7 @@ class MainServer : public QObject, public MythSocketCBs
     void HandleGenPreviewPixmap(QStringList &slist, PlaybackSock *pbs);
     void HandlePixmapLastModified(QStringList &slist, PlaybackSock *pbs);
     void HandlePixmapGetIfModified(const QStringList &slist, PlaybackSock *pbs);
+    void HandleGetPreviews(const QStringList &slist, PlaybackSock *pbs);
     void HandleIsRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleCheckRecordingActive(QStringList &slist, PlaybackSock *pbs);
     void HandleFillProgramInfo(QStringList &slist, PlaybackSock *pbs);
@@ -316,6 +318,7 @@ class MainServer : public QObject, public MythSocketCBs
 
     typedef QHash<QString,QString> RequestedBy;
     RequestedBy                m_previewRequestedBy;
+    PreviewCache               m_previewCache;
 
     bool m_stopped;
 
@@ -0,0 +1,288 @@
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QCryptographicHash>
+#include <QImageWriter>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QImage>
+
+// MythTV headers
+#include "previewcache.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+
+#define LOC QString("PreviewCache: ")
+
+/// Widths produced from a single decode of the preview PNG; 0 terminated.
+const int PreviewCache::kLadderWidths[] = { 160, 320, 640, 0 };
+const int PreviewCache::kJPEGQuality    = 85;
+
+PreviewCache::PreviewCache() :
+    m_bytesUsed(0), m_byteBudget(0)
+{
+    SetByteBudget(
+        (qint64) gCoreContext->GetNumSetting("PreviewCacheSize", 32) << 20);
+}
+
+void PreviewCache::SetByteBudget(qint64 budget)
+{
+    QMutexLocker locker(&m_lock);
+    m_byteBudget = max(budget, (qint64)0);
+    Evict();
+}
+
+/** \fn PreviewCache::GetOutputFormat(const QString&)
+ *  \brief Returns the format that will actually be used for a request.
+ *
+ *  WebP is only used when the installed Qt image plugins can write it,
+ *  anything else falls back to JPEG.
+ */
+QString PreviewCache::GetOutputFormat(const QString &requested)
+{
+    static QMutex lock;
+    static int    webp_ok = -1;
+
+    if (requested.toLower() != "webp")
+        return "jpg";
+
+    QMutexLocker locker(&lock);
+    if (webp_ok < 0)
+    {
+        webp_ok = QImageWriter::supportedImageFormats()
+            .contains(QByteArray("webp")) ? 1 : 0;
+    }
+    return (webp_ok) ? "webp" : "jpg";
+}
+
+/** \fn PreviewCache::CalcScaledSize(const QSize&, const QSize&)
+ *  \brief Fills in a missing or zero dimension of the wanted size
+ *         from the aspect ratio of the source, and never upscales.
+ */
+QSize PreviewCache::CalcScaledSize(const QSize &source, const QSize &wanted)
+{
+    if (source.width() <= 0 || source.height() <= 0)
+        return QSize();
+
+    int width  = max(wanted.width(),  0);
+    int height = max(wanted.height(), 0);
+
+    if (!width && !height)
+        return source;
+
+    float aspect = (float)source.width() / source.height();
+    if (!width)
+        width = (int)(height * aspect + 0.5f);
+    if (!height)
+        height = (int)(width / aspect + 0.5f);
+
+    if (width >= source.width() || height >= source.height())
+        return source;
+
+    return QSize(max(width, 1), max(height, 1));
+}
+
+QString PreviewCache::MakeKey(const QString &recordingKey, int secsIn,
+                              const QSize &size, const QString &format)
+{
+    return QString("%1/%2/%3x%4/%5").arg(recordingKey).arg(secsIn)
+        .arg(size.width()).arg(size.height()).arg(format);
+}
+
+bool PreviewCache::Encode(const QImage &image, const QString &format,
+                          PreviewCacheEntry &entry)
+{
+    QBuffer buffer(&entry.data);
+    buffer.open(QIODevice::WriteOnly);
+
+    QImageWriter writer(&buffer, format.toLatin1());
+    writer.setQuality(kJPEGQuality);
+    if (!writer.write(image))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to encode %1: %2")
+                .arg(format).arg(writer.errorString()));
+        entry.data.clear();
+        return false;
+    }
+
+    entry.format = format;
+    entry.size   = image.size();
+    entry.etag   = QString("\"%1\"").arg(QString(
+        QCryptographicHash::hash(entry.data, QCryptographicHash::Md5)
+        .toHex()));
+
+    return true;
+}
+
+/** \fn PreviewCache::Get(const QString&, const QString&, int,
+ *                        const QSize&, const QString&, PreviewCacheEntry&)
+ *  \brief Returns a scaled copy of the preview in sourceFile.
+ *
+ *  \param recordingKey ProgramInfo::MakeUniqueKey() of the recording
+ *  \param sourceFile   full path of the full size preview PNG
+ *  \param secsIn       preview offset, -1 for the default preview
+ *  \param size         wanted size, a zero dimension keeps the aspect ratio
+ *  \param format       wanted output format, see GetOutputFormat()
+ *  \return true and fills in entry on success, false if the preview
+ *          PNG does not exist or could not be decoded.
+ */
+bool PreviewCache::Get(const QString &recordingKey, const QString &sourceFile,
+                       int secsIn, const QSize &size, const QString &format,
+                       PreviewCacheEntry &entry)
+{
+    QFileInfo finfo(sourceFile);
+    if (!finfo.exists() || finfo.size() <= 0)
+    {
+        Invalidate(recordingKey);
+        return false;
+    }
+
+    QString   fmt    = GetOutputFormat(format);
+    QDateTime mtime  = finfo.lastModified();
+    QString   key    = MakeKey(recordingKey, secsIn, size, fmt);
+
+    {
+        QMutexLocker locker(&m_lock);
+        QHash<QString, PreviewCacheEntry>::const_iterator it =
+            m_entries.find(key);
+        if (it != m_entries.end())
+        {
+            if ((*it).sourceMTime == mtime)
+            {
+                entry = *it;
+                Touch(key);
+                return true;
+            }
+            Remove(key);
+        }
+    }
+
+    // Decode once, outside of the lock, and encode the whole ladder.
+    QImage source(sourceFile);
+    if (source.isNull())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to decode '%1'").arg(sourceFile));
+        return false;
+    }
+
+    QList<QSize> sizes;
+    sizes.push_back(size);
+    for (uint i = 0; kLadderWidths[i]; i++)
+        sizes.push_back(QSize(kLadderWidths[i], 0));
+
+    bool found = false;
+    for (int i = 0; i < sizes.size(); i++)
+    {
+        QString ladderkey = MakeKey(recordingKey, secsIn, sizes[i], fmt);
+
+        if (i > 0)
+        {
+            QMutexLocker locker(&m_lock);
+            if (m_entries.contains(ladderkey) &&
+                m_entries[ladderkey].sourceMTime == mtime)
+            {
+                continue;
+            }
+        }
+
+        QSize scaled = CalcScaledSize(source.size(), sizes[i]);
+        QImage image = (scaled == source.size()) ? source :
+            source.scaled(scaled, Qt::IgnoreAspectRatio,
+                          Qt::SmoothTransformation);
+
+        PreviewCacheEntry newentry;
+        newentry.sourceMTime = mtime;
+        if (!Encode(image, fmt, newentry))
+            continue;
+
+        if (i == 0)
+        {
+            entry = newentry;
+            found = true;
+        }
+
+        QMutexLocker locker(&m_lock);
+        Insert(ladderkey, newentry);
+    }
+
+    LOG(VB_FILE, LOG_DEBUG, LOC + QString("Encoded %1 sizes of '%2'")
+            .arg(sizes.size()).arg(sourceFile));
+
+    return found;
+}
+
+/// Drops every cached size of every preview of the given recording.
+void PreviewCache::Invalidate(const QString &recordingKey)
+{
+    QMutexLocker locker(&m_lock);
+
+    QString prefix = recordingKey + "/";
+    QList<QString>::iterator it = m_lru.begin();
+    while (it != m_lru.end())
+    {
+        if ((*it).startsWith(prefix))
+        {
+            m_bytesUsed -= m_entries[*it].data.size();
+            m_entries.remove(*it);
+            it = m_lru.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void PreviewCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_entries.clear();
+    m_lru.clear();
+    m_bytesUsed = 0;
+}
+
+// Everything below is called with m_lock held.
+
+void PreviewCache::Insert(const QString &key, const PreviewCacheEntry &entry)
+{
+    if (entry.data.size() > m_byteBudget)
+        return;
+
+    Remove(key);
+    m_entries[key] = entry;
+    m_lru.push_back(key);
+    m_bytesUsed += entry.data.size();
+    Evict();
+}
+
+void PreviewCache::Remove(const QString &key)
+{
+    QHash<QString, PreviewCacheEntry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+        return;
+
+    m_bytesUsed -= (*it).data.size();
+    m_entries.erase(it);
+    m_lru.removeOne(key);
+}
+
+void PreviewCache::Touch(const QString &key)
+{
+    m_lru.removeOne(key);
+    m_lru.push_back(key);
+}
+
+void PreviewCache::Evict(void)
+{
+    while (m_bytesUsed > m_byteBudget && !m_lru.empty())
+    {
+        QString key = m_lru.takeFirst();
+        m_bytesUsed -= m_entries[key].data.size();
+        m_entries.remove(key);
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
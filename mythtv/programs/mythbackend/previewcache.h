@@ -0,0 +1,85 @@
+#ifndef PREVIEWCACHE_H_
+#define PREVIEWCACHE_H_
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+#include <QSize>
+
+class QImage;
+
+/** \class PreviewCacheEntry
+ *  \brief A single encoded preview image held by the PreviewCache.
+ */
+class PreviewCacheEntry
+{
+  public:
+    PreviewCacheEntry() {}
+
+    QByteArray data;         ///< encoded image (JPEG or WebP)
+    QString    etag;         ///< strong ETag, quoted, derived from data
+    QString    format;       ///< "jpg" or "webp"
+    QSize      size;         ///< actual pixel size of the encoded image
+    QDateTime  sourceMTime;  ///< mtime of the preview PNG it was made from
+};
+
+/** \class PreviewCache
+ *  \brief Memory cache of scaled, compressed recording previews.
+ *
+ *  Entries are keyed by recording (ProgramInfo::MakeUniqueKey()), preview
+ *  offset, requested size and output format. When an entry is missing
+ *  the full size preview PNG is decoded once and every size of the
+ *  standard ladder is encoded from that single decode, so a client
+ *  asking for a different size afterwards is served from memory.
+ *
+ *  The cache is bounded by a byte budget ("PreviewCacheSize" in MB),
+ *  entries are evicted in least recently used order.
+ */
+class PreviewCache
+{
+  public:
+    PreviewCache();
+
+    bool Get(const QString &recordingKey, const QString &sourceFile,
+             int secsIn, const QSize &size, const QString &format,
+             PreviewCacheEntry &entry);
+
+    void Invalidate(const QString &recordingKey);
+    void Clear(void);
+
+    void SetByteBudget(qint64 budget);
+    qint64 GetByteBudget(void) const { return m_byteBudget; }
+    qint64 GetBytesUsed(void) const { return m_bytesUsed; }
+
+    static QString GetOutputFormat(const QString &requested);
+    static QSize CalcScaledSize(const QSize &source, const QSize &wanted);
+
+  private:
+    static QString MakeKey(const QString &recordingKey, int secsIn,
+                           const QSize &size, const QString &format);
+    static bool Encode(const QImage &image, const QString &format,
+                       PreviewCacheEntry &entry);
+
+    void Insert(const QString &key, const PreviewCacheEntry &entry);
+    void Remove(const QString &key);
+    void Touch(const QString &key);
+    void Evict(void);
+
+  private:
+    mutable QMutex                   m_lock;
+    QHash<QString, PreviewCacheEntry> m_entries;
+    /// keys in least recently used first order
+    QList<QString>                   m_lru;
+    qint64                           m_bytesUsed;
+    qint64                           m_byteBudget;
+
+    static const int                 kLadderWidths[];
+    static const int                 kJPEGQuality;
+};
+
+#endif // PREVIEWCACHE_H_
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -1563,6 +1563,40 @@ bool Scheduler::GetAllPending(RecList &retList) const
     return hasconflicts;
 }
 
+/** \fn Scheduler::GetUpcomingPage(RecList&, bool, uint, uint) const
+ *  \brief Copies one page of the recordings which have not started yet.
+ *
+ *  Unless showAll is set only those that will actually record are
+ *  included. Only the requested page is copied, a count of 0 copies
+ *  everything from startIndex on.
+ *
+ *  \return the number of matching recordings, on every page.
+ */
+uint Scheduler::GetUpcomingPage(RecList &retList, bool showAll,
+                                uint startIndex, uint count) const
+{
+    QDateTime now = MythDate::current();
+
+    QMutexLocker lockit(&schedLock);
+
+    uint matched = 0;
+    RecConstIter it = reclist.begin();
+    for (; it != reclist.end(); ++it)
+    {
+        if ((*it)->GetRecordingStartTime() < now ||
+            (!showAll && (*it)->GetRecordingStatus() > rsWillRecord))
+            continue;
+
+        if (matched >= startIndex &&
+            (!count || matched < startIndex + count))
+            retList.push_back(new RecordingInfo(**it));
+
+        matched++;
+    }
+
+    return matched;
+}
+
 QMap<QString,ProgramInfo*> Scheduler::GetRecording(void) const
 {
     QMutexLocker lockit(&schedLock);
@@ -64,6 +64,8 @@ class Scheduler : public MThread, public MythScheduler
     // true iff there are conflicts
     bool GetAllPending(RecList &retList) const;
     virtual void GetAllPending(QStringList &strList) const;
+    uint GetUpcomingPage(RecList &retList, bool showAll,
+                         uint startIndex, uint count) const;
     virtual QMap<QString,ProgramInfo*> GetRecording(void) const;
 
     static void GetAllScheduled(QStringList &strList);
@@ -19,6 +19,10 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 
+#include <QCoreApplication>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
 #include <QMap>
 #include <QRegExp>
 
@@ -33,6 +37,7 @@
 #include "jobqueue.h"
 #include "encoderlink.h"
 #include "remoteutil.h"
+#include "mythdb.h"
 
 #include "serviceUtil.h"
 #include <mythscheduler.h>
@@ -40,6 +45,82 @@
 extern QMap<int, EncoderLink *> tvList;
 extern AutoExpire  *expirer;
 
+/////////////////////////////////////////////////////////////////////////////
+// Caches the number of recordings matching each filter used with
+// GetFilteredRecordedList(). Entries are dropped whenever the recording
+// list changes, and after kMaxAgeSecs in case a change was missed.
+/////////////////////////////////////////////////////////////////////////////
+
+class RecordedCountCache : public QObject
+{
+    public:
+
+        static RecordedCountCache *Get( void )
+        {
+            static QMutex              lock;
+            static RecordedCountCache *pCache = NULL;
+
+            QMutexLocker locker( &lock );
+
+            if (!pCache)
+            {
+                pCache = new RecordedCountCache();
+                // Events are delivered on the main thread, not on the
+                // HTTP server thread which happened to create us.
+                pCache->moveToThread( QCoreApplication::instance()->thread() );
+                gCoreContext->addListener( pCache );
+            }
+
+            return pCache;
+        }
+
+        bool Lookup( const QString &sKey, int &nCount )
+        {
+            QMutexLocker locker( &m_lock );
+
+            QHash< QString, QPair< uint, int > >::const_iterator it =
+                m_counts.find( sKey );
+
+            if (it == m_counts.end() ||
+                MythDate::current().toTime_t() - (*it).first > kMaxAgeSecs)
+                return false;
+
+            nCount = (*it).second;
+            return true;
+        }
+
+        void Insert( const QString &sKey, int nCount )
+        {
+            QMutexLocker locker( &m_lock );
+
+            m_counts[ sKey ] = qMakePair( MythDate::current().toTime_t(),
+                                          nCount );
+        }
+
+    protected:
+
+        void customEvent( QEvent *e )
+        {
+            if (e->type() != MythEvent::MythEventMessage)
+                return;
+
+            MythEvent *me = static_cast< MythEvent* >(e);
+
+            if (me->Message().startsWith( "RECORDING_LIST_CHANGE" ))
+            {
+                QMutexLocker locker( &m_lock );
+                m_counts.clear();
+            }
+        }
+
+    private:
+
+        QMutex                                 m_lock;
+        QHash< QString, QPair< uint, int > >   m_counts;
+
+        static const uint                      kMaxAgeSecs = 60;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -59,92 +140,105 @@ DTC::ProgramList* Dvr::GetFilteredRecordedList( bool           bDescending,
                                                 const QString &sRecGroup,
                                                 const QString &sStorageGroup )
 {
-    QMap< QString, ProgramInfo* > recMap;
-
-    if (gCoreContext->GetScheduler())
-        recMap = gCoreContext->GetScheduler()->GetRecording();
-
-    QMap< QString, uint32_t > inUseMap    = ProgramInfo::QueryInUseMap();
-    QMap< QString, bool >     isJobRunning= ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
-
-    ProgramList progList;
-
-    int desc = 0;
-    if (bDescending)
-        desc = -1;
-
-    LoadFromRecorded( progList, false, inUseMap, isJobRunning, recMap, desc );
-
-    QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
+    DTC::ProgramList *pPrograms = new DTC::ProgramList();
 
-    for (; mit != recMap.end(); mit = recMap.erase(mit))
-        delete *mit;
+    nStartIndex = max( nStartIndex, 0 );
 
     // ----------------------------------------------------------------------
-    // Build Response
+    // Build the filter, everything is done by the database so only the
+    // requested page of recordings is ever loaded.
     // ----------------------------------------------------------------------
 
-    DTC::ProgramList *pPrograms = new DTC::ProgramList();
-    int nAvailable = 0;
+    MSqlBindings bindings;
+    QString      sWhere;
+    bool         bMatchesNone = false;
 
-    if ((sTitleRegEx.isEmpty()) &&
-        (sRecGroup.isEmpty()) &&
-        (sStorageGroup.isEmpty()))
+    if (sRecGroup.isEmpty())
+        sWhere = "WHERE r.recgroup != 'Deleted' ";
+    else
     {
-        nStartIndex   = min( nStartIndex, (int)progList.size() );
-        nCount        = (nCount > 0) ? min( nCount, (int)progList.size() ) : progList.size();
-        int nEndIndex = min((nStartIndex + nCount), (int)progList.size() );
-        nCount        = nEndIndex - nStartIndex;
+        sWhere = "WHERE r.recgroup = :RECGROUP ";
+        bindings[":RECGROUP"] = sRecGroup;
+    }
 
-        nAvailable = progList.size();
+    if (!sStorageGroup.isEmpty())
+    {
+        sWhere += "AND r.storagegroup = :STORAGEGROUP ";
+        bindings[":STORAGEGROUP"] = sStorageGroup;
+    }
 
-        for( int n = nStartIndex; n < nEndIndex; n++)
+    if (!sTitleRegEx.isEmpty())
+    {
+        // QRegExp and MySQL REGEXP differ, match the distinct titles here
+        // so the filter keeps its meaning, and hand the database the list.
+        QStringList titles = MatchRecordedTitles( sTitleRegEx );
+
+        if (titles.empty())
+            bMatchesNone = true;
+        else
         {
-            ProgramInfo *pInfo = progList[ n ];
-            if (pInfo->GetRecordingGroup() != "Deleted")
+            QStringList params;
+            for (int i = 0; i < titles.size(); ++i)
             {
-                DTC::Program *pProgram = pPrograms->AddNewProgram();
-
-                FillProgramInfo( pProgram, pInfo, true );
+                QString param = QString(":TITLE%1").arg(i);
+                params << param;
+                bindings[param] = titles[i];
             }
+            sWhere += QString("AND r.title IN (%1) ").arg(params.join(","));
         }
     }
-    else
-    {
-        int nMax      = nCount;
 
-        nAvailable = 0;
-        nCount = 0;
+    int nAvailable = 0;
+    ProgramList progList;
 
-        QRegExp rTitleRegEx        = QRegExp(sTitleRegEx, Qt::CaseInsensitive);
+    if (!bMatchesNone)
+    {
+        nAvailable = CountRecorded( sWhere, bindings );
 
-        for( unsigned int n = 0; n < progList.size(); n++)
+        if (nStartIndex < nAvailable)
         {
-            ProgramInfo *pInfo = progList[ n ];
+            QString sDir = bDescending ? "DESC" : "ASC";
+            QString sSQL = sWhere +
+                QString("ORDER BY r.starttime %1, r.chanid %1 ").arg(sDir);
 
-            if ((!sTitleRegEx.isEmpty() && !pInfo->GetTitle().contains(rTitleRegEx)) ||
-                (!sRecGroup.isEmpty() && sRecGroup != pInfo->GetRecordingGroup()) ||
-                (!sStorageGroup.isEmpty() && sStorageGroup != pInfo->GetStorageGroup()))
-                continue;
+            // MySQL has no OFFSET without LIMIT, use its largest LIMIT.
+            sSQL += QString("LIMIT %1, %2 ").arg(nStartIndex)
+                .arg((nCount > 0) ? QString::number(nCount) :
+                                    QString("18446744073709551615"));
 
-            ++nAvailable;
+            QMap< QString, ProgramInfo* > recMap;
 
-            if ((nAvailable < nStartIndex) ||
-                (nCount >= nMax))
-                continue;
+            if (gCoreContext->GetScheduler())
+                recMap = gCoreContext->GetScheduler()->GetRecording();
 
-            ++nCount;
+            QMap< QString, uint32_t > inUseMap    = ProgramInfo::QueryInUseMap();
+            QMap< QString, bool >     isJobRunning= ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
 
-            DTC::Program *pProgram = pPrograms->AddNewProgram();
+            LoadFromRecorded( progList, sSQL, bindings,
+                              inUseMap, isJobRunning, recMap );
 
-            FillProgramInfo( pProgram, pInfo, true );
+            QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
+
+            for (; mit != recMap.end(); mit = recMap.erase(mit))
+                delete *mit;
         }
     }
 
+    // ----------------------------------------------------------------------
+    // Build Response
+    // ----------------------------------------------------------------------
+
+    for( unsigned int n = 0; n < progList.size(); n++)
+    {
+        DTC::Program *pProgram = pPrograms->AddNewProgram();
+
+        FillProgramInfo( pProgram, progList[ n ], true );
+    }
+
     // ----------------------------------------------------------------------
 
     pPrograms->setStartIndex    ( nStartIndex     );
-    pPrograms->setCount         ( nCount          );
+    pPrograms->setCount         ( progList.size() );
     pPrograms->setTotalAvailable( nAvailable      );
     pPrograms->setAsOf          ( MythDate::current() );
     pPrograms->setVersion       ( MYTH_BINARY_VERSION );
@@ -153,6 +247,73 @@ DTC::ProgramList* Dvr::GetFilteredRecordedList( bool           bDescending,
     return pPrograms;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Returns the distinct recorded titles matching sTitleRegEx
+/////////////////////////////////////////////////////////////////////////////
+
+QStringList Dvr::MatchRecordedTitles( const QString &sTitleRegEx )
+{
+    QStringList titles;
+    QRegExp     rTitleRegEx( sTitleRegEx, Qt::CaseInsensitive );
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT DISTINCT title FROM recorded");
+
+    if (!query.exec())
+    {
+        MythDB::DBError("Dvr::MatchRecordedTitles", query);
+        return titles;
+    }
+
+    while (query.next())
+    {
+        QString title = query.value(0).toString();
+        if (title.contains(rTitleRegEx))
+            titles << title;
+    }
+
+    return titles;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Returns the number of recordings matching sWhere. Clients page through
+// the same filter over and over, so the count is cached until the list of
+// recordings changes.
+/////////////////////////////////////////////////////////////////////////////
+
+int Dvr::CountRecorded( const QString &sWhere, const MSqlBindings &bindings )
+{
+    RecordedCountCache *pCache = RecordedCountCache::Get();
+
+    QString sKey = sWhere;
+    MSqlBindings::const_iterator it = bindings.begin();
+    for (; it != bindings.end(); ++it)
+        sKey += QString("|%1=%2").arg(it.key()).arg(it.value().toString());
+
+    int nCount;
+
+    if (pCache->Lookup( sKey, nCount ))
+        return nCount;
+
+    QString sSQL = "SELECT COUNT(*) FROM recorded AS r " + sWhere;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare( sSQL );
+    for (it = bindings.begin(); it != bindings.end(); ++it)
+        query.bindValue( it.key(), it.value() );
+
+    if (!query.exec() || !query.next())
+    {
+        MythDB::DBError("Dvr::CountRecorded", query);
+        return 0;
+    }
+
+    nCount = query.value(0).toInt();
+    pCache->Insert( sKey, nCount );
+
+    return nCount;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
@@ -310,24 +471,45 @@ DTC::ProgramList* Dvr::GetUpcomingList( int  nStartIndex,
                                         bool bShowAll )
 {
     RecordingList  recordingList;
-    RecordingList  tmpList;
-    bool hasConflicts;
-    LoadFromScheduler(tmpList, hasConflicts);
+    uint           nAvailable = 0;
 
-    // Sort the upcoming into only those which will record
-    RecordingList::iterator it = tmpList.begin();
-    for(; it < tmpList.end(); ++it)
+    nStartIndex = max( nStartIndex, 0 );
+    nCount      = max( nCount, 0 );
+
+    Scheduler *pSched = dynamic_cast< Scheduler* >(gCoreContext->GetScheduler());
+
+    if (pSched)
     {
-        if (!bShowAll && ((*it)->GetRecordingStatus() <= rsWillRecord) &&
-            ((*it)->GetRecordingStartTime() >=
-             QDateTime::currentDateTime()))
-        {
-            recordingList.push_back(new RecordingInfo(**it));
-        }
-        else if (bShowAll && ((*it)->GetRecordingStartTime() >=
-             QDateTime::currentDateTime()))
+        // On the master only the requested page is copied out of the
+        // scheduler, instead of serializing every pending recording.
+        RecList pageList;
+        nAvailable = pSched->GetUpcomingPage( pageList, bShowAll,
+                                              nStartIndex, nCount );
+
+        for (RecIter it = pageList.begin(); it != pageList.end(); ++it)
+            recordingList.push_back( *it );
+    }
+    else
+    {
+        RecordingList  tmpList;
+        bool hasConflicts;
+        LoadFromScheduler(tmpList, hasConflicts);
+
+        QDateTime now = MythDate::current();
+
+        // Sort the upcoming into only those which will record
+        RecordingList::iterator it = tmpList.begin();
+        for(; it < tmpList.end(); ++it)
         {
-            recordingList.push_back(new RecordingInfo(**it));
+            if (((*it)->GetRecordingStartTime() < now) ||
+                (!bShowAll && ((*it)->GetRecordingStatus() > rsWillRecord)))
+                continue;
+
+            if (((int)nAvailable >= nStartIndex) &&
+                (!nCount || (int)nAvailable < nStartIndex + nCount))
+                recordingList.push_back(new RecordingInfo(**it));
+
+            nAvailable++;
         }
     }
 
@@ -337,11 +519,7 @@ DTC::ProgramList* Dvr::GetUpcomingList( int  nStartIndex,
 
     DTC::ProgramList *pPrograms = new DTC::ProgramList();
 
-    nStartIndex   = min( nStartIndex, (int)recordingList.size() );
-    nCount        = (nCount > 0) ? min( nCount, (int)recordingList.size() ) : recordingList.size();
-    int nEndIndex = min((nStartIndex + nCount), (int)recordingList.size() );
-
-    for( int n = nStartIndex; n < nEndIndex; n++)
+    for( uint n = 0; n < recordingList.size(); n++)
     {
         ProgramInfo *pInfo = recordingList[ n ];
 
@@ -353,8 +531,8 @@ DTC::ProgramList* Dvr::GetUpcomingList( int  nStartIndex,
     // ----------------------------------------------------------------------
 
     pPrograms->setStartIndex    ( nStartIndex     );
-    pPrograms->setCount         ( nCount          );
-    pPrograms->setTotalAvailable( recordingList.size() );
+    pPrograms->setCount         ( recordingList.size() );
+    pPrograms->setTotalAvailable( nAvailable      );
     pPrograms->setAsOf          ( QDateTime::currentDateTime() );
     pPrograms->setVersion       ( MYTH_BINARY_VERSION );
     pPrograms->setProtoVer      ( MYTH_PROTO_VERSION  );
@@ -25,6 +25,7 @@
 #include <QScriptEngine>
 
 #include "services/dvrServices.h"
+#include "mythdbcon.h"
 
 class Dvr : public DvrServices
 {
@@ -110,6 +111,12 @@ class Dvr : public DvrServices
         bool              EnableRecordSchedule ( uint             RecordId   );
 
         bool              DisableRecordSchedule( uint             RecordId   );
+
+    private:
+
+        static QStringList MatchRecordedTitles( const QString      &sTitleRegEx );
+        static int         CountRecorded      ( const QString      &sWhere,
+                                                const MSqlBindings &bindings );
 };
 
 // --------------------------------------------------------------------------
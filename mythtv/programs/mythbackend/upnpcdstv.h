@@ -54,6 +54,11 @@ class UPnpCDSTv : public UPnpCDSExtension
         }
 
         virtual ~UPnpCDSTv() {}
+
+        virtual QStringList GetChangeEvents()
+        {
+            return QStringList( "RECORDING_LIST_CHANGE" );
+        }
 };
 
 #endif
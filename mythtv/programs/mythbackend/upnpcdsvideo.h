@@ -58,6 +58,11 @@ class UPnpCDSVideo : public UPnpCDSExtension
         {
         }
         virtual ~UPnpCDSVideo() {}
+
+        virtual QStringList GetChangeEvents()
+        {
+            return QStringList( "VIDEO_LIST_CHANGE" );
+        }
 };
 
 #endif
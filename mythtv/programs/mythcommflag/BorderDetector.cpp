@@ -1,5 +1,10 @@
 #include <sys/time.h>
 
+#include "mythconfig.h"
+#if ARCH_X86 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 extern "C" {
 #include "libavcodec/avcodec.h"        /* AVPicture */
 }
@@ -14,6 +19,46 @@ extern "C" {
 using namespace frameAnalyzer;
 using namespace commDetector2;
 
+namespace {
+
+#if ARCH_X86 && defined(__SSE2__)
+/* Pixels per row span checked at once by span_in_range(). */
+const int SPAN = 16;
+
+bool
+span_in_range(const unsigned char *pp, unsigned char *pminval,
+        unsigned char *pmaxval, int maxrange)
+{
+    /*
+     * If the SPAN pixels at "pp" together with [*pminval, *pmaxval] stay
+     * within "maxrange", widen the range to cover them and return true. None
+     * of them can then be an outlier, so this gives the same result as
+     * scanning them one at a time. Otherwise leave them to be scanned.
+     */
+    __m128i vmin = _mm_loadu_si128((const __m128i*)pp);
+    __m128i vmax = vmin;
+    vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 8));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 8));
+    vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 4));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+    vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 2));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+    vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 1));
+    vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+    unsigned char minval = min(*pminval,
+            (unsigned char)_mm_cvtsi128_si32(vmin));
+    unsigned char maxval = max(*pmaxval,
+            (unsigned char)_mm_cvtsi128_si32(vmax));
+    if (maxval - minval + 1 > maxrange)
+        return false;
+    *pminval = minval;
+    *pmaxval = maxval;
+    return true;
+}
+#endif
+
+};  /* namespace */
+
 BorderDetector::BorderDetector(void)
     : logoFinder(NULL),
       logo(NULL),
@@ -133,6 +178,10 @@ BorderDetector::getDimensions(const AVPicture *pgm, int pgmheight,
     int                     newrow, newcol, newwidth, newheight;
     bool                    top, bottom, left, right, inrange;
     int                     range, outliers, lines;
+#if ARCH_X86 && defined(__SSE2__)
+    const bool              sse2 = useSSE2();
+    int                     simdcol;
+#endif
 
     (void)gettimeofday(&start, NULL);
 
@@ -272,8 +321,25 @@ found_right:
         {
             outliers = 0;
             inrange = true;
+#if ARCH_X86 && defined(__SSE2__)
+            simdcol = mincol;
+#endif
             for (cc = mincol; cc < maxcol1; cc++)
             {
+#if ARCH_X86 && defined(__SSE2__)
+                if (sse2 && cc >= simdcol && cc + SPAN <= maxcol1 &&
+                        !(logo && rr >= logorow && rr < logorow + logoheight &&
+                            cc < logocol + logowidth && cc + SPAN > logocol))
+                {
+                    if (span_in_range(&pgm->data[0][rr * pgmwidth + cc],
+                                &minval, &maxval, MAXRANGE))
+                    {
+                        cc += SPAN - 1;
+                        continue;
+                    }
+                    simdcol = cc + SPAN;    /* Scan these one at a time. */
+                }
+#endif
                 if (logo && rrccinrect(rr, cc, logorow, logocol,
                             logowidth, logoheight))
                     continue;   /* Exclude logo area from analysis. */
@@ -321,8 +387,25 @@ found_top:
         {
             outliers = 0;
             inrange = true;
+#if ARCH_X86 && defined(__SSE2__)
+            simdcol = mincol;
+#endif
             for (cc = mincol; cc < maxcol1; cc++)
             {
+#if ARCH_X86 && defined(__SSE2__)
+                if (sse2 && cc >= simdcol && cc + SPAN <= maxcol1 &&
+                        !(logo && rr >= logorow && rr < logorow + logoheight &&
+                            cc < logocol + logowidth && cc + SPAN > logocol))
+                {
+                    if (span_in_range(&pgm->data[0][rr * pgmwidth + cc],
+                                &minval, &maxval, MAXRANGE))
+                    {
+                        cc += SPAN - 1;
+                        continue;
+                    }
+                    simdcol = cc + SPAN;    /* Scan these one at a time. */
+                }
+#endif
                 if (logo && rrccinrect(rr, cc, logorow, logocol,
                             logowidth, logoheight))
                     continue;   /* Exclude logo area from analysis. */
@@ -129,6 +129,7 @@ ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
 
     commDetectMethod(commDetectMethod_in),
     commBreakMapUpdateRequested(false),        sendCommBreakMapUpdates(false),
+    lastBuiltFrames(-1),
     verboseDebugging(false),
     lastFrameNumber(0),                        curFrameNumber(0),
     width(0),                                  height(0),
@@ -237,6 +238,7 @@ void ClassicCommDetector::Init()
             .arg(horizSpacing).arg(vertSpacing));
 
     framesProcessed = 0;
+    lastBuiltFrames = -1;
     totalMinBrightness = 0;
     blankFrameCount = 0;
 
@@ -436,9 +438,10 @@ bool ClassicCommDetector::go()
             }
         }
 
-        if ((sendCommBreakMapUpdates) &&
-            ((commBreakMapUpdateRequested) ||
-             ((currentFrameNumber % 500) == 0)))
+        // While recording, updates go out whether or not a viewer asked,
+        // so the break list is never more than an interval behind
+        if ((sendCommBreakMapUpdates || stillRecording) &&
+            ((commBreakMapUpdateRequested) || LiveUpdateDue()))
         {
             frm_dir_map_t commBreakMap;
             frm_dir_map_t::iterator it;
@@ -614,6 +617,14 @@ void ClassicCommDetector::GetCommercialBreakList(frm_dir_map_t &marks)
 
     LOG(VB_COMMFLAG, LOG_INFO, "CommDetect::GetCommBreakMap()");
 
+    // Nothing new since the last build, e.g. when the list we just
+    // signalled is fetched for sending out
+    if (lastBuiltFrames == (int64_t)framesProcessed)
+    {
+        marks = lastBuiltCommBreakMap;
+        return;
+    }
+
     marks.clear();
 
     CleanupFrameInfo();
@@ -636,6 +647,8 @@ void ClassicCommDetector::GetCommercialBreakList(frm_dir_map_t &marks)
     {
         BuildAllMethodsCommList();
         marks = commBreakMap;
+        lastBuiltCommBreakMap = marks;
+        lastBuiltFrames = framesProcessed;
         LOG(VB_COMMFLAG, LOG_INFO, "Final Commercial Break Map");
         return;
     }
@@ -678,6 +691,8 @@ void ClassicCommDetector::GetCommercialBreakList(frm_dir_map_t &marks)
         }
     }
 
+    lastBuiltCommBreakMap = marks;
+    lastBuiltFrames = framesProcessed;
     LOG(VB_COMMFLAG, LOG_INFO, "Final Commercial Break Map");
 }
 
@@ -117,6 +117,11 @@ class ClassicCommDetector : public CommDetectorBase
         bool commBreakMapUpdateRequested;
         bool sendCommBreakMapUpdates;
 
+        /// GetCommercialBreakList() result, reused until more frames
+        /// have been processed
+        frm_dir_map_t lastBuiltCommBreakMap;
+        int64_t lastBuiltFrames;
+
         int commDetectBorder;
         int commDetectBlankFrameMaxDiff;
         int commDetectDarkBrightness;
@@ -672,8 +672,12 @@ bool CommDetector2::go(void)
             if (!fullSpeed && !isRecording)
                 usleep(10000);  // 10ms
 
-            if (sendBreakMapUpdates && (breakMapUpdateRequested ||
-                        !(currentFrameNumber % 500)))
+            // While recording, updates go out whether or not a viewer
+            // asked, so the break list is never more than an interval behind
+            bool live = isRecording &&
+                !searchingForLogo(logoFinder, *currentPass);
+            if ((sendBreakMapUpdates || live) &&
+                (breakMapUpdateRequested || LiveUpdateDue()))
             {
                 frm_dir_map_t breakMap;
 
@@ -1,7 +1,11 @@
+#include "mythcorecontext.h"
 #include "CommDetectorBase.h"
 
-CommDetectorBase::CommDetectorBase() : m_bPaused(false), m_bStop(false)
+CommDetectorBase::CommDetectorBase() : m_bPaused(false), m_bStop(false),
+    m_liveUpdateInterval(
+        gCoreContext->GetNumSetting("CommFlagLiveUpdateInterval", 10) * 1000)
 {
+    m_liveUpdateTimer.start();
 }
 
 void CommDetectorBase::stop()
@@ -19,5 +23,18 @@ void CommDetectorBase::resume()
     m_bPaused = false;
 }
 
+/** \fn CommDetectorBase::LiveUpdateDue(void)
+ *  \brief Returns true, and starts the next interval, if it is time to
+ *         publish the break list again.
+ */
+bool CommDetectorBase::LiveUpdateDue(void)
+{
+    if (m_liveUpdateTimer.elapsed() < m_liveUpdateInterval)
+        return false;
+
+    m_liveUpdateTimer.restart();
+    return true;
+}
+
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -8,6 +8,7 @@ using namespace std;
 #include <QMap>
 
 #include "programtypes.h"
+#include "mythtimer.h"
 
 #define MAX_BLANK_FRAMES 180
 
@@ -51,8 +52,15 @@ signals:
 
 protected:    
     ~CommDetectorBase() {}
+    bool LiveUpdateDue(void);
+
     bool m_bPaused;
     bool m_bStop;    
+
+    /// Break list updates are published at most this often (msec),
+    /// which bounds how far viewers of a recording in progress lag
+    int       m_liveUpdateInterval;
+    MythTimer m_liveUpdateTimer;
     
 };
 
@@ -1,11 +1,15 @@
 // ANSI C headers
 #include <cstdlib>
+#include <cstring>
 
 // C++ headers
 #include <algorithm>
 using namespace std;
 
 #include "mythconfig.h"
+#if ARCH_X86 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // avlib/ffmpeg headers
 extern "C" {
@@ -24,6 +28,46 @@ namespace edgeDetector {
 
 using namespace frameAnalyzer;
 
+static void
+sgm_row(unsigned int *sgm, const unsigned char *rr0, const unsigned char *rr1,
+        int cc, int cc2)
+{
+    /* SGM of columns [cc, cc2) of the row whose pixels are "rr0". */
+#if ARCH_X86 && defined(__SSE2__)
+    if (useSSE2())
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        /* Eight pixels at a time; this reads up to rr0[cc2], as does C. */
+        for (; cc + 8 <= cc2; cc += 8)
+        {
+            __m128i nw = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64((const __m128i*)&rr0[cc]), zero);
+            __m128i ne = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64((const __m128i*)&rr0[cc + 1]), zero);
+            __m128i sw = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64((const __m128i*)&rr1[cc]), zero);
+            __m128i se = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64((const __m128i*)&rr1[cc + 1]), zero);
+            __m128i dx = _mm_sub_epi16(se, nw);
+            __m128i dy = _mm_sub_epi16(sw, ne);
+
+            /* Interleave dx/dy so that madd yields dx * dx + dy * dy. */
+            __m128i lo = _mm_unpacklo_epi16(dx, dy);
+            __m128i hi = _mm_unpackhi_epi16(dx, dy);
+            _mm_storeu_si128((__m128i*)&sgm[cc], _mm_madd_epi16(lo, lo));
+            _mm_storeu_si128((__m128i*)&sgm[cc + 4], _mm_madd_epi16(hi, hi));
+        }
+    }
+#endif
+    for (; cc < cc2; cc++)
+    {
+        int dx = rr1[cc + 1] - rr0[cc];     /* southeast - northwest */
+        int dy = rr1[cc] - rr0[cc + 1];     /* southwest - northeast */
+        sgm[cc] = dx * dx + dy * dy;
+    }
+}
+
 unsigned int *
 sgm_init_exclude(unsigned int *sgm, const AVPicture *src, int srcheight,
         int excluderow, int excludecol, int excludewidth, int excludeheight)
@@ -36,25 +80,29 @@ sgm_init_exclude(unsigned int *sgm, const AVPicture *src, int srcheight,
      * that pixel: how much it differs from its neighbors.
      */
     const int       srcwidth = src->linesize[0];
-    int             rr, cc, dx, dy, rr2, cc2;
+    int             rr, rr2, cc2, exclude1, exclude2;
     unsigned char   *rr0, *rr1;
 
     memset(sgm, 0, srcwidth * srcheight * sizeof(*sgm));
     rr2 = srcheight - 1;
     cc2 = srcwidth - 1;
+
+    /* Columns [exclude1, exclude2) of the excluded rows are skipped. */
+    exclude1 = min(max(0, excludecol), cc2);
+    exclude2 = max(exclude1, min(excludecol + excludewidth, cc2));
+
     for (rr = 0; rr < rr2; rr++)
     {
-        for (cc = 0; cc < cc2; cc++)
+        rr0 = &src->data[0][rr * srcwidth];
+        rr1 = &src->data[0][(rr + 1) * srcwidth];
+        if (rr >= excluderow && rr < excluderow + excludeheight)
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                rr0 = &src->data[0][rr * srcwidth + cc];
-                rr1 = &src->data[0][(rr + 1) * srcwidth + cc];
-                dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[rr * srcwidth + cc] = dx * dx + dy * dy;
-            }
+            sgm_row(&sgm[rr * srcwidth], rr0, rr1, 0, exclude1);
+            sgm_row(&sgm[rr * srcwidth], rr0, rr1, exclude2, cc2);
+        }
+        else
+        {
+            sgm_row(&sgm[rr * srcwidth], rr0, rr1, 0, cc2);
         }
     }
     return sgm;
@@ -68,9 +116,35 @@ sgm_init(unsigned int *sgm, const AVPicture *src, int srcheight)
 }
 #endif /* LATER */
 
-static int sort_ascending(const void *aa, const void *bb)
+static void
+mark_row(unsigned char *dst, const unsigned int *sgm, int cc, int cc2,
+        unsigned int thresholdval)
 {
-    return *(unsigned int*)aa - *(unsigned int*)bb;
+    /* Mark columns [cc, cc2) whose SGM is at least "thresholdval". */
+#if ARCH_X86 && defined(__SSE2__)
+    if (useSSE2())
+    {
+        /*
+         * SGM values are at most 2 * 255 * 255, so a signed compare against
+         * "thresholdval - 1" is safe, even when "thresholdval" is zero.
+         */
+        const __m128i thresh = _mm_set1_epi32((int)thresholdval - 1);
+        for (; cc + 8 <= cc2; cc += 8)
+        {
+            __m128i lo = _mm_cmpgt_epi32(
+                    _mm_loadu_si128((const __m128i*)&sgm[cc]), thresh);
+            __m128i hi = _mm_cmpgt_epi32(
+                    _mm_loadu_si128((const __m128i*)&sgm[cc + 4]), thresh);
+            __m128i vv = _mm_packs_epi32(lo, hi);
+            _mm_storel_epi64((__m128i*)&dst[cc], _mm_packs_epi16(vv, vv));
+        }
+    }
+#endif
+    for (; cc < cc2; cc++)
+    {
+        if (sgm[cc] >= thresholdval)
+            dst[cc] = UCHAR_MAX;
+    }
 }
 
 static int
@@ -91,28 +165,39 @@ edge_mark(AVPicture *dst, int dstheight,
 
     const int           dstwidth = dst->linesize[0];
     const int           padded_width = extraleft + dstwidth + extraright;
-    unsigned int        thresholdval;
-    int                 nn, dstnn, ii, rr, cc, first, last, last2;
+    unsigned int        thresholdval, newthresholdval;
+    int                 nn, dstnn, ii, jj, rr, first, exclude1, exclude2;
+    bool                excluded;
+    const unsigned int  *sgmrow;
 
     (void)extrabottom;  /* gcc */
 
+    /* Columns [exclude1, exclude2) of the excluded rows are skipped. */
+    exclude1 = min(max(0, excludecol), dstwidth);
+    exclude2 = max(exclude1, min(excludecol + excludewidth, dstwidth));
+
     /*
      * sgm: SGM values of padded (convolved) image
      *
-     * sgmsorted: sorted SGM values of unexcluded areas of unpadded image (same
-     * dimensions as "dst").
+     * sgmsorted: SGM values of unexcluded areas of unpadded image (same
+     * dimensions as "dst"), partitioned around the percentile below.
      */
     nn = 0;
     for (rr = 0; rr < dstheight; rr++)
     {
-        for (cc = 0; cc < dstwidth; cc++)
+        sgmrow = &sgm[(extratop + rr) * padded_width + extraleft];
+        if (rr >= excluderow && rr < excluderow + excludeheight)
+        {
+            memcpy(&sgmsorted[nn], sgmrow, exclude1 * sizeof(*sgmsorted));
+            nn += exclude1;
+            memcpy(&sgmsorted[nn], &sgmrow[exclude2],
+                    (dstwidth - exclude2) * sizeof(*sgmsorted));
+            nn += dstwidth - exclude2;
+        }
+        else
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                sgmsorted[nn++] = sgm[(extratop + rr) * padded_width +
-                    extraleft + cc];
-            }
+            memcpy(&sgmsorted[nn], sgmrow, dstwidth * sizeof(*sgmsorted));
+            nn += dstwidth;
         }
     }
 
@@ -132,29 +217,37 @@ edge_mark(AVPicture *dst, int dstheight,
             return 0;
     }
 
-    qsort(sgmsorted, nn, sizeof(*sgmsorted), sort_ascending);
-
+    /*
+     * Only the order statistics around the percentile are needed, not a full
+     * sort: after nth_element, everything before "ii" is no greater than
+     * "thresholdval" and everything after it no less.
+     */
     ii = percentile * nn / 100;
+    nth_element(sgmsorted, sgmsorted + ii, sgmsorted + nn);
     thresholdval = sgmsorted[ii];
 
     /*
      * Try not to pick up too many edges, and eliminate degenerate edge-less
      * cases.
+     *
+     * "first" is the sorted index of the first "thresholdval", and
+     * "newthresholdval" the next larger value (if any).
      */
-    for (first = ii; first > 0 && sgmsorted[first] == thresholdval; first--) ;
-    if (sgmsorted[first] != thresholdval)
-        first++;
+    first = 0;
+    for (jj = 0; jj < ii; jj++)
+        if (sgmsorted[jj] < thresholdval)
+            first++;
     if (first * 100 / nn < MINTHRESHOLDPCT)
     {
-        unsigned int    newthresholdval;
-
-        last2 = nn - 1;
-        for (last = ii; last < last2 && sgmsorted[last] == thresholdval;
-                last++) ;
-        if (sgmsorted[last] != thresholdval)
-            last--;
+        newthresholdval = thresholdval;
+        for (jj = ii + 1; jj < nn; jj++)
+        {
+            if (sgmsorted[jj] != thresholdval &&
+                    (newthresholdval == thresholdval ||
+                     sgmsorted[jj] < newthresholdval))
+                newthresholdval = sgmsorted[jj];
+        }
 
-        newthresholdval = sgmsorted[min(last + 1, nn - 1)];
         if (thresholdval == newthresholdval)
         {
             /* Degenerate case; no edges (e.g., blank frame). */
@@ -167,14 +260,14 @@ edge_mark(AVPicture *dst, int dstheight,
     /* sgm is a padded matrix; dst is the unpadded matrix. */
     for (rr = 0; rr < dstheight; rr++)
     {
-        for (cc = 0; cc < dstwidth; cc++)
-        {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight) &&
-                    sgm[(extratop + rr) * padded_width + extraleft + cc] >=
-                        thresholdval)
-                dst->data[0][rr * dstwidth + cc] = UCHAR_MAX;
-        }
+        unsigned char *dstrow = &dst->data[0][rr * dstwidth];
+
+        sgmrow = &sgm[(extratop + rr) * padded_width + extraleft];
+        excluded = rr >= excluderow && rr < excluderow + excludeheight;
+        mark_row(dstrow, sgmrow, 0, excluded ? exclude1 : dstwidth,
+                thresholdval);
+        if (excluded)
+            mark_row(dstrow, sgmrow, exclude2, dstwidth, thresholdval);
     }
     return 0;
 }
@@ -1,3 +1,9 @@
+#include "mythconfig.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
 #include "mythlogging.h"
 #include "CommDetector2.h"
 #include "FrameAnalyzer.h"
@@ -13,6 +19,31 @@ rrccinrect(int rr, int cc, int rrow, int rcol, int rwidth, int rheight)
         rr < rrow + rheight && cc < rcol + rwidth;
 }
 
+static bool sse2Allowed = true;
+
+bool
+useSSE2(void)
+{
+    /*
+     * Whether the SSE2 versions of the pixel loops may be used. They are only
+     * built when the compiler targets SSE2, but still check the CPU the same
+     * way the rest of the tree does.
+     */
+#if ARCH_X86 && defined(__SSE2__)
+    static const bool sse2 = av_get_cpu_flags() & AV_CPU_FLAG_SSE2;
+    return sse2 && sse2Allowed;
+#else
+    return false;
+#endif
+}
+
+void
+allowSSE2(bool allow)
+{
+    /* Lets simdSelfCheck() run the C versions on an SSE2 machine. */
+    sse2Allowed = allow;
+}
+
 void
 frameAnalyzerReportMap(const FrameAnalyzer::FrameMap *frameMap, float fps,
         const char *comment)
@@ -73,6 +73,9 @@ namespace frameAnalyzer {
 
 bool rrccinrect(int rr, int cc, int rrow, int rcol, int rwidth, int rheight);
 
+bool useSSE2(void);
+void allowSSE2(bool allow);
+
 void frameAnalyzerReportMap(const FrameAnalyzer::FrameMap *frameMap,
         float fps, const char *comment);
 
@@ -29,12 +29,33 @@ void Histogram::generateFromImage(unsigned char* frame, unsigned int frameWidth,
     if (maxScanY > frameHeight-1)
         maxScanY = frameHeight-1;
 
+    // Count into four tables so that runs of the same value, which are
+    // common (borders, blank frames), don't serialize on one counter.
+    int counts[4][256];
+    memset(counts,0,sizeof(counts));
+
     for(unsigned int y = minScanY; y < maxScanY; y += YSpacing)
-        for(unsigned int x = minScanX; x < maxScanX; x += XSpacing)
+    {
+        const unsigned char *row = &frame[y * frameWidth];
+        unsigned int x = minScanX;
+
+        for(; x + 3 * XSpacing < maxScanX; x += 4 * XSpacing)
+        {
+            counts[0][row[x]]++;
+            counts[1][row[x + XSpacing]]++;
+            counts[2][row[x + 2 * XSpacing]]++;
+            counts[3][row[x + 3 * XSpacing]]++;
+            numberOfSamples += 4;
+        }
+        for(; x < maxScanX; x += XSpacing)
         {
-            data[frame[y * frameWidth + x]]++;
+            counts[0][row[x]]++;
             numberOfSamples++;
         }
+    }
+
+    for(int i = 0; i < 256; i++)
+        data[i] = counts[0][i] + counts[1][i] + counts[2][i] + counts[3][i];
 }
 
 unsigned int Histogram::getAverageIntensity(void) const
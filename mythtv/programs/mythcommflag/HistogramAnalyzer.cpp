@@ -14,7 +14,6 @@
 #include "FrameAnalyzer.h"
 #include "PGMConverter.h"
 #include "BorderDetector.h"
-#include "quickselect.h"
 #include "TemplateFinder.h"
 #include "HistogramAnalyzer.h"
 
@@ -156,7 +155,6 @@ HistogramAnalyzer::HistogramAnalyzer(PGMConverter *pgmc, BorderDetector *bd,
     , fheight(NULL)
     , histogram(NULL)
     , monochromatic(NULL)
-    , buf(NULL)
     , lastframeno(-1)
     , debugLevel(0)
 #ifdef PGM_CONVERT_GREYSCALE
@@ -167,6 +165,17 @@ HistogramAnalyzer::HistogramAnalyzer(PGMConverter *pgmc, BorderDetector *bd,
     , debug_histval(false)
     , histval_done(false)
 {
+    /*
+     * TUNABLE:
+     *
+     * The smallest frame height to analyze at. Only coarse statistics of a
+     * sparse sample of pixels are kept (see RINC/CINC in analyzeFrame), so
+     * a fraction of HD resolution is plenty.
+     */
+    static const int    MINHEIGHT = 360;
+
+    pgmConverter->setMinimumHeight(MINHEIGHT);
+
     memset(histval, 0, sizeof(int) * (UCHAR_MAX + 1));
     memset(&analyze_time, 0, sizeof(analyze_time));
 
@@ -205,8 +214,6 @@ HistogramAnalyzer::~HistogramAnalyzer()
         delete []fheight;
     if (histogram)
         delete []histogram;
-    if (buf)
-        delete []buf;
 }
 
 enum FrameAnalyzer::analyzeFrameResult
@@ -262,9 +269,6 @@ HistogramAnalyzer::MythPlayerInited(MythPlayer *player, long long nframes)
     memset(histogram, 0, nframes * sizeof(*histogram));
     memset(monochromatic, 0, nframes * sizeof(*monochromatic));
 
-    unsigned int npixels = width * height;
-    buf = new unsigned char[npixels];
-
     if (debug_histval)
     {
         if (readData(debugdata, mean, median, stddev, frow, fcol,
@@ -313,7 +317,8 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
     bool                ismonochromatic;
     int                 croprow, cropcol, cropwidth, cropheight;
     unsigned int        borderpixels, livepixels, npixels, halfnpixels;
-    unsigned char       *pp, bordercolor;
+    unsigned int        color, nbelow, medianrank;
+    unsigned char       bordercolor;
     unsigned long long  sumval, sumsquares;
     int                 rr, cc, rr1, cc1, rr2, cc2, rr3, cc3;
     struct timeval      start, end, elapsed;
@@ -355,12 +360,13 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
         ((rr2 - rr1) / RINC) * ((cc3 - cc2) / CINC) +   /* right */
         ((rr3 - rr2) / RINC) * (cc3 / CINC);            /* bottom */
 
-    sumval = 0;
-    sumsquares = 0;
+    /*
+     * Only histogram the sampled pixels; the sums and the median all follow
+     * from the histogram, which is cheaper than accumulating them per pixel
+     * and selecting the median out of a copy of the samples.
+     */
     livepixels = 0;
-    pp = &buf[borderpixels];
     memset(histval, 0, sizeof(histval));
-    histval[DEFAULT_COLOR] += borderpixels;
     for (rr = rr1; rr < rr2; rr += RINC)
     {
         int rroffset = rr * pgmwidth;
@@ -371,21 +377,27 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
                     cc >= logocc1 && cc <= logocc2)
                 continue; /* Exclude logo area from analysis. */
 
-            unsigned char val = pgm->data[0][rroffset + cc];
-            *pp++ = val;
-            sumval += val;
-            sumsquares += val * val;
+            histval[pgm->data[0][rroffset + cc]]++;
             livepixels++;
-            histval[val]++;
         }
     }
     npixels = borderpixels + livepixels;
 
+    sumval = 0;
+    sumsquares = 0;
+    for (color = 0; color < UCHAR_MAX + 1; color++)
+    {
+        sumval += (unsigned long long)histval[color] * color;
+        sumsquares += (unsigned long long)histval[color] * color * color;
+    }
+
     /* Scale scores down to [0..255]. */
+    histval[DEFAULT_COLOR] += borderpixels;
     halfnpixels = npixels / 2;
-    for (unsigned int color = 0; color < UCHAR_MAX + 1; color++)
+    for (color = 0; color < UCHAR_MAX + 1; color++)
         histogram[frameno][color] =
             (histval[color] * UCHAR_MAX + halfnpixels) / npixels;
+    histval[DEFAULT_COLOR] -= borderpixels;
 
     bordercolor = 0;
     if (ismonochromatic && livepixels)
@@ -399,10 +411,20 @@ HistogramAnalyzer::analyzeFrame(const VideoFrame *frame, long long frameno)
         sumsquares += borderpixels * bordercolor * bordercolor;
     }
 
-    memset(buf, bordercolor, borderpixels * sizeof(*buf));
+    /* The median counts the border pixels as being of "bordercolor". */
+    histval[bordercolor] += borderpixels;
+    medianrank = (npixels - 1) / 2;
+    nbelow = 0;
+    for (color = 0; color < UCHAR_MAX; color++)
+    {
+        nbelow += histval[color];
+        if (nbelow > medianrank)
+            break;
+    }
+
     monochromatic[frameno] = ismonochromatic ? 1 : 0;
     mean[frameno] = (float)sumval / npixels;
-    median[frameno] = quick_select_median(buf, npixels);
+    median[frameno] = color;
     stddev[frameno] = npixels > 1 ?
         sqrt((sumsquares - (float)sumval * sumval / npixels) / (npixels - 1)) :
             0;
@@ -58,7 +58,6 @@ private:
     Histogram               *histogram;             /* histogram */
     unsigned char           *monochromatic;         /* computed boolean */
     int                     histval[UCHAR_MAX + 1]; /* temporary buffer */
-    unsigned char           *buf;                   /* temporary buffer */
     long long               lastframeno;
 
     /* Debugging */
@@ -5,6 +5,7 @@
 #include <QSize>
 
 // MythTV headers
+#include "mythcorecontext.h"
 #include "mythlogging.h"
 #include "mythplayer.h"
 #include "frame.h"          /* VideoFrame */
@@ -18,12 +19,17 @@ using namespace commDetector2;
 
 PGMConverter::PGMConverter(void)
     : frameno(-1)
+    , minheight(0)
+    , scale(1)
+    , fullwidth(-1)
+    , fullheight(-1)
     , width(-1)
     , height(-1)
 #ifdef PGM_CONVERT_GREYSCALE
     , time_reported(false)
 #endif /* PGM_CONVERT_GREYSCALE */
 {
+    memset(&full, 0, sizeof(full));
     memset(&pgm, 0, sizeof(pgm));
     memset(&convert_time, 0, sizeof(convert_time));
 }
@@ -32,9 +38,22 @@ PGMConverter::~PGMConverter(void)
 {
     width = -1;
 #ifdef PGM_CONVERT_GREYSCALE
+    avpicture_free(&full);
+    memset(&full, 0, sizeof(full));
     avpicture_free(&pgm);
     memset(&pgm, 0, sizeof(pgm));
-#endif /* PGM_CONVERT_GREYSCALE */
+#else  /* !PGM_CONVERT_GREYSCALE */
+    if (scale > 1)
+        avpicture_free(&pgm);
+    memset(&pgm, 0, sizeof(pgm));
+#endif /* !PGM_CONVERT_GREYSCALE */
+}
+
+void
+PGMConverter::setMinimumHeight(int _height)
+{
+    if (_height > minheight)
+        minheight = _height;
 }
 
 int
@@ -49,27 +68,70 @@ PGMConverter::MythPlayerInited(const MythPlayer *player)
         return 0;
 
     QSize buf_dim = player->GetVideoBufferSize();
-    width  = buf_dim.width();
-    height = buf_dim.height();
+    fullwidth  = buf_dim.width();
+    fullheight = buf_dim.height();
+
+    /*
+     * Frames are analyzed at full size unless "CommFlagAnalysisHeight"
+     * asks for smaller ones. The analyzers' heuristics are mostly relative
+     * to the frame size, but they never get less than they asked for.
+     */
+    int analysisheight =
+        gCoreContext->GetNumSetting("CommFlagAnalysisHeight", 0);
+    scale = analysisheight > 0 ?
+        max(1, fullheight / max(minheight, analysisheight)) : 1;
+    width  = fullwidth / scale;
+    height = fullheight / scale;
 
 #ifdef PGM_CONVERT_GREYSCALE
+    if (scale > 1 &&
+            avpicture_alloc(&full, PIX_FMT_GRAY8, fullwidth, fullheight))
+    {
+        LOG(VB_COMMFLAG, LOG_ERR, QString("PGMConverter::MythPlayerInited "
+                                          "avpicture_alloc full (%1x%2) failed")
+                .arg(fullwidth).arg(fullheight));
+        width = -1;
+        return -1;
+    }
     if (avpicture_alloc(&pgm, PIX_FMT_GRAY8, width, height))
     {
         LOG(VB_COMMFLAG, LOG_ERR, QString("PGMConverter::MythPlayerInited "
                                           "avpicture_alloc pgm (%1x%2) failed")
                 .arg(width).arg(height));
+        avpicture_free(&full);
+        memset(&full, 0, sizeof(full));
+        width = -1;
         return -1;
     }
     LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
                                        "using true greyscale conversion"));
 #else  /* !PGM_CONVERT_GREYSCALE */
+    if (scale > 1 && avpicture_alloc(&pgm, PIX_FMT_GRAY8, width, height))
+    {
+        LOG(VB_COMMFLAG, LOG_ERR, QString("PGMConverter::MythPlayerInited "
+                                          "avpicture_alloc pgm (%1x%2) failed")
+                .arg(width).arg(height));
+        width = -1;
+        return -1;
+    }
     LOG(VB_COMMFLAG, LOG_INFO, QString("PGMConverter::MythPlayerInited "
                                        "(YUV shortcut)"));
 #endif /* !PGM_CONVERT_GREYSCALE */
 
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("PGMConverter::MythPlayerInited analyzing %1x%2 as %3x%4")
+            .arg(fullwidth).arg(fullheight).arg(width).arg(height));
+
     return 0;
 }
 
+void
+PGMConverter::getDimensions(int *pwidth, int *pheight) const
+{
+    *pwidth = width;
+    *pheight = height;
+}
+
 const AVPicture *
 PGMConverter::getImage(const VideoFrame *frame, long long _frameno,
         int *pwidth, int *pheight)
@@ -89,19 +151,24 @@ PGMConverter::getImage(const VideoFrame *frame, long long _frameno,
 
 #ifdef PGM_CONVERT_GREYSCALE
     (void)gettimeofday(&start, NULL);
-    if (pgm_fill(&pgm, frame))
+    if (pgm_fill(scale > 1 ? &full : &pgm, frame))
+        goto error;
+    if (scale > 1 && pgm_downscale(&pgm, &full, fullheight, scale))
         goto error;
     (void)gettimeofday(&end, NULL);
     timersub(&end, &start, &elapsed);
     timeradd(&convert_time, &elapsed, &convert_time);
 #else  /* !PGM_CONVERT_GREYSCALE */
-    if (avpicture_fill(&pgm, frame->buf, PIX_FMT_GRAY8, width, height) == -1)
+    if (avpicture_fill(scale > 1 ? &full : &pgm, frame->buf, PIX_FMT_GRAY8,
+                fullwidth, fullheight) == -1)
     {
         LOG(VB_COMMFLAG, LOG_ERR,
             QString("PGMConverter::getImage error at frame %1 (%2x%3)")
-                .arg(_frameno).arg(width).arg(height));
+                .arg(_frameno).arg(fullwidth).arg(fullheight));
         goto error;
     }
+    if (scale > 1 && pgm_downscale(&pgm, &full, fullheight, scale))
+        goto error;
 #endif /* !PGM_CONVERT_GREYSCALE */
 
     frameno = _frameno;
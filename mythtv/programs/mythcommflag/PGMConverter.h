@@ -33,14 +33,27 @@ public:
     PGMConverter(void);
     ~PGMConverter(void);
 
+    /*
+     * Analyzers declare the smallest frame height their heuristics need,
+     * before MythPlayerInited. When "CommFlagAnalysisHeight" is set,
+     * frames are shrunk by the largest integer factor that still
+     * satisfies it and all of them.
+     */
+    void setMinimumHeight(int height);
+
     int MythPlayerInited(const MythPlayer *player);
+    void getDimensions(int *pwidth, int *pheight) const;
     const AVPicture *getImage(const VideoFrame *frame, long long frameno,
             int *pwidth, int *pheight);
     int reportTime(void);
 
 private:
     long long       frameno;            /* frame number */
+    int             minheight;          /* requested by the analyzers */
+    int             scale;              /* downscaling factor */
+    int             fullwidth, fullheight;  /* decoded frame dimensions */
     int             width, height;      /* frame dimensions */
+    AVPicture       full;               /* full-size grayscale frame */
     AVPicture       pgm;                /* grayscale frame */
 #ifdef PGM_CONVERT_GREYSCALE
     struct timeval  convert_time;
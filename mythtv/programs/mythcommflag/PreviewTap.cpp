@@ -0,0 +1,147 @@
+// ANSI C headers
+#include <cstring>
+
+// MythTV headers
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+#include "mythplayer.h"
+#include "programinfo.h"
+#include "previewgenerator.h"
+#include "myth_imgconvert.h"
+
+// Commercial Flagging headers
+#include "PreviewTap.h"
+
+#define LOC QString("PreviewTap: ")
+
+const int PreviewTap::kMaxCandidates    = 6;
+const int PreviewTap::kCandidateSpacing = 60;
+
+PreviewTap::PreviewTap(const ProgramInfo *_pginfo, MythPlayer *_player,
+                       const QString &_outfile)
+    : pginfo(_pginfo), player(_player), outfile(_outfile),
+      startTime(MythDate::current()), previewTime(0), timeInSeconds(true),
+      nextFrame(-1), spacing(0), tooSmall(false)
+{
+    previewTime = PreviewGenerator::GetDefaultPreviewTime(*pginfo,
+                                                          timeInSeconds);
+}
+
+PreviewTap::~PreviewTap()
+{
+    while (!candidates.empty())
+        delete [] candidates.takeFirst().rgb;
+}
+
+void PreviewTap::ProcessFrame(const VideoFrame *frame)
+{
+    if (tooSmall || candidates.size() >= kMaxCandidates)
+        return;
+
+    if (nextFrame < 0)
+    {
+        float fps = player->GetFrameRate();
+        if (fps <= 0.0f)
+            return;
+
+        nextFrame = (timeInSeconds) ?
+            (long long)(previewTime * fps) : previewTime;
+        spacing = (long long)(kCandidateSpacing * fps);
+    }
+
+    if (frame->frameNumber < nextFrame || frame->codec != FMT_YV12)
+        return;
+
+    // The commercial detector may decode at reduced resolution,
+    // leave those to PreviewGenerator rather than scale them up
+    int ppw = gCoreContext->GetNumSetting("PreviewPixmapWidth",  320);
+    int pph = gCoreContext->GetNumSetting("PreviewPixmapHeight", 240);
+    if (frame->width < ppw && frame->height < pph)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC +
+            QString("Frames are %1x%2, too small for a %3x%4 preview")
+                .arg(frame->width).arg(frame->height).arg(ppw).arg(pph));
+        tooSmall = true;
+        return;
+    }
+
+    AVPicture orig, retbuf;
+    memset(&orig, 0, sizeof(AVPicture));
+    for (uint i = 0; i < 3; i++)
+    {
+        orig.data[i]     = frame->buf + frame->offsets[i];
+        orig.linesize[i] = frame->pitches[i];
+    }
+
+    Candidate c;
+    c.frameNumber = frame->frameNumber;
+    c.width       = frame->width;
+    c.height      = frame->height;
+    c.aspect      = frame->aspect;
+    c.rgb         = new unsigned char[c.width * c.height * 4];
+
+    avpicture_fill(&retbuf, c.rgb, PIX_FMT_RGB32, c.width, c.height);
+    if (myth_sws_img_convert(&retbuf, PIX_FMT_RGB32, &orig,
+                             PIX_FMT_YUV420P, c.width, c.height) < 0)
+    {
+        delete [] c.rgb;
+        tooSmall = true;
+        return;
+    }
+
+    candidates.push_back(c);
+    nextFrame = frame->frameNumber + spacing;
+}
+
+bool PreviewTap::InBreak(const frm_dir_map_t &commBreakList,
+                         long long frameNumber)
+{
+    bool inBreak = false;
+    frm_dir_map_t::const_iterator it = commBreakList.begin();
+    for (; it != commBreakList.end() && (long long)it.key() <= frameNumber;
+         ++it)
+    {
+        if (*it == MARK_COMM_START)
+            inBreak = true;
+        else if (*it == MARK_COMM_END)
+            inBreak = false;
+    }
+    return inBreak;
+}
+
+/** \fn PreviewTap::Save(const frm_dir_map_t&)
+ *  \brief Writes out the preview, returns false if PreviewGenerator
+ *         still needs to make one.
+ */
+bool PreviewTap::Save(const frm_dir_map_t &commBreakList)
+{
+    if (candidates.empty())
+        return false;
+
+    // A bookmark made while we were flagging moves the preview
+    QDateTime bookmarkTime = pginfo->QueryBookmarkTimeStamp();
+    if (bookmarkTime.isValid() && bookmarkTime > startTime)
+        return false;
+
+    QList<Candidate>::const_iterator it = candidates.begin();
+    for (; it != candidates.end(); ++it)
+    {
+        if (!InBreak(commBreakList, (*it).frameNumber))
+            break;
+    }
+    if (it == candidates.end())
+        it = candidates.begin();
+
+    bool ok = PreviewGenerator::SavePreview(
+        outfile, (*it).rgb, (*it).width, (*it).height, (*it).aspect, 0, 0);
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC +
+        QString("%1 preview '%2' from frame %3")
+            .arg(ok ? "Saved" : "Failed to save").arg(outfile)
+            .arg((*it).frameNumber));
+
+    return ok;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,69 @@
+#ifndef __PREVIEWTAP_H__
+#define __PREVIEWTAP_H__
+
+// Qt headers
+#include <QDateTime>
+#include <QString>
+#include <QList>
+
+// MythTV headers
+#include "mythcommflagplayer.h"
+#include "programtypes.h"
+
+class ProgramInfo;
+
+/** \class PreviewTap
+ *  \brief Makes the recording's preview image from the frames decoded
+ *         for commercial detection.
+ *
+ *   A frame is kept at the point PreviewGenerator would grab it from,
+ *   and a few more after that a minute apart. Once the commercial breaks
+ *   are known, Save() writes out the first of them that is not in a
+ *   break, so the preview does not need a decode of its own.
+ */
+class PreviewTap : public FrameTap
+{
+  public:
+    PreviewTap(const ProgramInfo *pginfo, MythPlayer *player,
+               const QString &outfile);
+    ~PreviewTap();
+
+    void ProcessFrame(const VideoFrame *frame);
+    bool Save(const frm_dir_map_t &commBreakList);
+
+  private:
+    class Candidate
+    {
+      public:
+        Candidate() :
+            frameNumber(0), rgb(NULL), width(0), height(0), aspect(0.0f) {}
+
+        long long      frameNumber;
+        unsigned char *rgb;          ///< RGB32, allocated with new[]
+        int            width;
+        int            height;
+        float          aspect;
+    };
+
+    static bool InBreak(const frm_dir_map_t &commBreakList,
+                        long long frameNumber);
+
+    const ProgramInfo  *pginfo;
+    MythPlayer         *player;
+    QString             outfile;
+    QDateTime           startTime;     ///< for the bookmark check in Save()
+
+    long long           previewTime;
+    bool                timeInSeconds;
+    long long           nextFrame;     ///< -1 until the frame rate is known
+    long long           spacing;       ///< frames between candidates
+    bool                tooSmall;
+    QList<Candidate>    candidates;
+
+    static const int    kMaxCandidates;
+    static const int    kCandidateSpacing;  ///< seconds
+};
+
+#endif  /* !__PREVIEWTAP_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
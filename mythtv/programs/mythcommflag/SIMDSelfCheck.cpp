@@ -0,0 +1,270 @@
+// ANSI C headers
+#include <climits>
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+extern "C" {
+#include "libavcodec/avcodec.h"        /* AVPicture */
+}
+
+// MythTV headers
+#include "mythlogging.h"
+
+// Commercial Flagging headers
+#include "FrameAnalyzer.h"
+#include "pgm.h"
+#include "CannyEdgeDetector.h"
+#include "BorderDetector.h"
+#include "TemplateMatcher.h"
+#include "SIMDSelfCheck.h"
+
+using namespace frameAnalyzer;
+using namespace templateMatcher;
+
+namespace {
+
+enum FrameKind { kNoise, kFlat, kBoxed, kSparse, kNumKinds };
+
+const char *kindName[kNumKinds] = { "noise", "flat", "boxed", "sparse" };
+
+unsigned int
+rand_next(unsigned int *seed)
+{
+    /* Same sequence everywhere, unlike rand(). */
+    *seed = *seed * 1103515245 + 12345;
+    return (*seed >> 16) & 0x7fff;
+}
+
+void
+fill_frame(AVPicture *pict, int height, FrameKind kind, unsigned int seed)
+{
+    /*
+     * "noise" exercises every code path, "flat" the near-uniform areas where
+     * the edge percentile has many ties and the border ranges stay narrow,
+     * "boxed" letterboxing and pillarboxing, and "sparse" edge maps.
+     */
+    const int       width = pict->linesize[0];
+    const int       boxrows = height / 8;
+    const int       boxcols = width / 10;
+    int             rr, cc;
+
+    for (rr = 0; rr < height; rr++)
+    {
+        for (cc = 0; cc < width; cc++)
+        {
+            unsigned char   *pp = &pict->data[0][rr * width + cc];
+            unsigned int    rnd = rand_next(&seed);
+
+            switch (kind)
+            {
+                case kFlat:
+                    *pp = 16 + rnd % 3;
+                    break;
+                case kBoxed:
+                    if (rr < boxrows || rr >= height - boxrows ||
+                            cc < boxcols || cc >= width - boxcols)
+                        *pp = 16 + rnd % 2;
+                    else
+                        *pp = rnd & 0xff;
+                    break;
+                case kSparse:
+                    *pp = (rnd % 10) ? 0 : UCHAR_MAX;
+                    break;
+                default:
+                    *pp = rnd & 0xff;
+                    break;
+            }
+        }
+    }
+}
+
+int
+report(const QString &what, const QString &frame, bool match)
+{
+    if (match)
+        return 0;
+
+    LOG(VB_GENERAL, LOG_ERR, QString("SIMD self-check: %1 differs on %2")
+        .arg(what).arg(frame));
+    return 1;
+}
+
+int
+check_downscale(const AVPicture *src, int height, const QString &frame)
+{
+    const int               width = src->linesize[0];
+    AVPicture               dst;
+    vector<unsigned char>   cres, sres;
+    int                     cret, sret;
+
+    if (avpicture_alloc(&dst, PIX_FMT_GRAY8, width / 2, height / 2))
+        return report("pgm_downscale (avpicture_alloc)", frame, false);
+
+    const int size = dst.linesize[0] * (height / 2);
+
+    allowSSE2(false);
+    cret = pgm_downscale(&dst, src, height, 2);
+    cres.assign(dst.data[0], dst.data[0] + size);
+
+    allowSSE2(true);
+    sret = pgm_downscale(&dst, src, height, 2);
+    sres.assign(dst.data[0], dst.data[0] + size);
+
+    avpicture_free(&dst);
+    return report("pgm_downscale", frame, !cret && !sret && cres == sres);
+}
+
+int
+check_edges(CannyEdgeDetector *ed, const AVPicture *src, int height,
+        const QString &frame)
+{
+    /* No exclusion, one inside the frame and one against its corner. */
+    const int           width = src->linesize[0];
+    const int           exclude[][4] = {
+        { 0, 0, 0, 0 },
+        { height / 4, width / 4, width / 3, height / 5 },
+        { 0, width - 64, 64, 48 },
+    };
+    const int           percentiles[] = { 70, 90 };
+    int                 failures = 0;
+
+    for (unsigned int ii = 0; ii < sizeof(exclude) / sizeof(*exclude); ii++)
+    {
+        for (unsigned int jj = 0;
+                jj < sizeof(percentiles) / sizeof(*percentiles); jj++)
+        {
+            vector<unsigned char>   cres, sres;
+            const AVPicture         *edges;
+
+            ed->setExcludeArea(exclude[ii][0], exclude[ii][1],
+                    exclude[ii][2], exclude[ii][3]);
+
+            allowSSE2(false);
+            if ((edges = ed->detectEdges(src, height, percentiles[jj])))
+                cres.assign(edges->data[0],
+                        edges->data[0] + edges->linesize[0] * height);
+
+            allowSSE2(true);
+            if ((edges = ed->detectEdges(src, height, percentiles[jj])))
+                sres.assign(edges->data[0],
+                        edges->data[0] + edges->linesize[0] * height);
+
+            failures += report(
+                QString("edge detection (exclude %1, percentile %2)")
+                    .arg(ii).arg(percentiles[jj]),
+                frame, !cres.empty() && cres == sres);
+        }
+    }
+
+    ed->setExcludeArea(0, 0, 0, 0);
+    return failures;
+}
+
+int
+check_borders(BorderDetector *bd, const AVPicture *src, int height,
+        const QString &frame)
+{
+    int cret, crow, ccol, cwidth, cheight;
+    int sret, srow, scol, swidth, sheight;
+
+    allowSSE2(false);
+    cret = bd->getDimensions(src, height, BorderDetector::UNCACHED,
+            &crow, &ccol, &cwidth, &cheight);
+
+    allowSSE2(true);
+    sret = bd->getDimensions(src, height, BorderDetector::UNCACHED,
+            &srow, &scol, &swidth, &sheight);
+
+    return report("border detection", frame,
+            cret == sret && crow == srow && ccol == scol &&
+            cwidth == swidth && cheight == sheight);
+}
+
+int
+check_count(const unsigned char *aa, const unsigned char *bb, int size,
+        const QString &frame)
+{
+    /* Also leave 1 and 15 pixels for the C tail loop. */
+    const int   tails[] = { 0, 1, 15 };
+    int         failures = 0;
+
+    for (unsigned int ii = 0; ii < sizeof(tails) / sizeof(*tails); ii++)
+    {
+        const int   nn = size - tails[ii];
+        int         cset, cmatch, sset, smatch;
+
+        allowSSE2(false);
+        cset = pgm_count(aa, aa, nn);
+        cmatch = pgm_count(aa, bb, nn);
+
+        allowSSE2(true);
+        sset = pgm_count(aa, aa, nn);
+        smatch = pgm_count(aa, bb, nn);
+
+        failures += report(QString("pgm_count (%1 pixels)").arg(nn), frame,
+                cset == sset && cmatch == smatch);
+    }
+    return failures;
+}
+
+};  /* namespace */
+
+int
+simdSelfCheck(void)
+{
+    /* SD, HD, and a size that leaves partial SIMD spans. */
+    const int           sizes[][2] = {
+        { 720, 480 }, { 1920, 1080 }, { 706, 483 },
+    };
+    CannyEdgeDetector   edgeDetector;
+    BorderDetector      borderDetector;
+    int                 failures = 0;
+
+    allowSSE2(true);
+    if (!useSSE2())
+    {
+        LOG(VB_GENERAL, LOG_INFO,
+            "SIMD self-check: SSE2 is not available, nothing to check");
+        return 0;
+    }
+
+    for (unsigned int ii = 0; ii < sizeof(sizes) / sizeof(*sizes); ii++)
+    {
+        for (int kind = 0; kind < kNumKinds; kind++)
+        {
+            const int   height = sizes[ii][1];
+            AVPicture   pict, other;
+
+            if (avpicture_alloc(&pict, PIX_FMT_GRAY8, sizes[ii][0], height))
+                return failures + 1;
+            if (avpicture_alloc(&other, PIX_FMT_GRAY8, sizes[ii][0], height))
+            {
+                avpicture_free(&pict);
+                return failures + 1;
+            }
+
+            fill_frame(&pict, height, (FrameKind)kind, ii * kNumKinds + kind);
+            fill_frame(&other, height, kSparse, ii * kNumKinds + kind + 100);
+
+            QString frame = QString("%1x%2 %3 frame")
+                .arg(sizes[ii][0]).arg(height).arg(kindName[kind]);
+
+            failures += check_downscale(&pict, height, frame);
+            failures += check_edges(&edgeDetector, &pict, height, frame);
+            failures += check_borders(&borderDetector, &pict, height, frame);
+            failures += check_count(pict.data[0], other.data[0],
+                    pict.linesize[0] * height, frame);
+
+            avpicture_free(&other);
+            avpicture_free(&pict);
+        }
+    }
+
+    LOG(VB_GENERAL, failures ? LOG_ERR : LOG_INFO,
+        QString("SIMD self-check: %1 mismatches").arg(failures));
+    return failures;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
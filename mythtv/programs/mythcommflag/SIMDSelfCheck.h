@@ -0,0 +1,16 @@
+/*
+ * SIMDSelfCheck
+ *
+ * Run the analyzers' pixel loops on synthetic frames with and without their
+ * SSE2 versions, and check that the results are identical.
+ */
+
+#ifndef __SIMDSELFCHECK_H__
+#define __SIMDSELFCHECK_H__
+
+/* Return the number of mismatches found, 0 if all results match. */
+int simdSelfCheck(void);
+
+#endif  /* !__SIMDSELFCHECK_H__ */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -731,6 +731,15 @@ TemplateFinder::TemplateFinder(PGMConverter *pgmc, BorderDetector *bd,
      */
     unsigned int        samplesNeeded = 300;
 
+    /*
+     * TUNABLE:
+     *
+     * The smallest frame height to look for logos at. Logos only cover a
+     * small part of the frame; much below this their edges are too few to
+     * build a reliable template from.
+     */
+    static const int    MINHEIGHT = 480;
+
     /*
      * TUNABLE:
      *
@@ -758,6 +767,8 @@ TemplateFinder::TemplateFinder(PGMConverter *pgmc, BorderDetector *bd,
         QString("TemplateFinder: sampleTime=%1s, samplesNeeded=%2, endFrame=%3")
             .arg(sampleTime).arg(samplesNeeded).arg(endFrame));
 
+    pgmConverter->setMinimumHeight(MINHEIGHT);
+
     memset(&cropped, 0, sizeof(cropped));
     memset(&tmpl, 0, sizeof(tmpl));
     memset(&analyze_time, 0, sizeof(analyze_time));
@@ -807,9 +818,11 @@ TemplateFinder::MythPlayerInited(MythPlayer *player, long long nframes)
     QString tmpldims, playerdims;
 
     (void)nframes; /* gcc */
-    QSize buf_dim = player->GetVideoBufferSize();
-    width  = buf_dim.width();
-    height = buf_dim.height();
+    if (pgmConverter->MythPlayerInited(player))
+        return ANALYZE_FATAL;
+
+    /* The template is in the coordinates of the (possibly scaled) frames. */
+    pgmConverter->getDimensions(&width, &height);
     playerdims = QString("%1x%2").arg(width).arg(height);
 
     if (debug_template)
@@ -829,8 +842,18 @@ TemplateFinder::MythPlayerInited(MythPlayer *player, long long nframes)
         }
     }
 
-    if (pgmConverter->MythPlayerInited(player))
-        goto free_tmpl;
+    if (tmpl_done && tmpl_valid &&
+            (tmplrow + tmplheight > height || tmplcol + tmplwidth > width))
+    {
+        /* Cached at a different analysis size. */
+        LOG(VB_COMMFLAG, LOG_INFO,
+            QString("TemplateFinder::MythPlayerInited %1 does not fit %2, "
+                    "ignoring it").arg(tmpldims).arg(playerdims));
+        avpicture_free(&tmpl);
+        memset(&tmpl, 0, sizeof(tmpl));
+        tmpl_done = false;
+        tmpl_valid = false;
+    }
 
     if (borderDetector->MythPlayerInited(player))
         goto free_tmpl;
@@ -9,6 +9,11 @@
 #include <algorithm>
 using namespace std;
 
+#include "mythconfig.h"
+#if ARCH_X86 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // Qt headers
 #include <QFile>
 #include <QFileInfo>
@@ -30,22 +35,54 @@ using namespace std;
 
 using namespace commDetector2;
 using namespace frameAnalyzer;
+using namespace templateMatcher;
 
-namespace {
+namespace templateMatcher {
 
-int pgm_set(const AVPicture *pict, int height)
+int pgm_count(const unsigned char *aa, const unsigned char *bb, int size)
 {
-    const int   width = pict->linesize[0];
-    const int   size = height * width;
+    /* Return the number of pixels set in both "aa" and "bb". */
     int         score, ii;
 
     score = 0;
-    for (ii = 0; ii < size; ii++)
-        if (pict->data[0][ii])
+    ii = 0;
+#if ARCH_X86 && defined(__SSE2__)
+    if (useSSE2())
+    {
+        const __m128i   zero = _mm_setzero_si128();
+        const __m128i   one = _mm_set1_epi8(1);
+        __m128i         total = zero;
+
+        for (; ii + 16 <= size; ii += 16)
+        {
+            __m128i unset = _mm_or_si128(
+                _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&aa[ii]), zero),
+                _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&bb[ii]), zero));
+            total = _mm_add_epi64(total,
+                    _mm_sad_epu8(_mm_andnot_si128(unset, one), zero));
+        }
+        score = _mm_cvtsi128_si32(total) +
+            _mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+    }
+#endif
+    for (; ii < size; ii++)
+        if (aa[ii] && bb[ii])
             score++;
     return score;
 }
 
+};  /* namespace */
+
+namespace {
+
+int pgm_set(const AVPicture *pict, int height)
+{
+    const int   width = pict->linesize[0];
+    const int   size = height * width;
+
+    return pgm_count(pict->data[0], pict->data[0], size);
+}
+
 int pgm_match(const AVPicture *tmpl, const AVPicture *test, int height,
               int radius, unsigned short *pscore)
 {
@@ -61,6 +98,13 @@ int pgm_match(const AVPicture *tmpl, const AVPicture *test, int height,
         return -1;
     }
 
+    if (!radius)
+    {
+        /* No search window; each pixel only matches its counterpart. */
+        *pscore = pgm_count(tmpl->data[0], test->data[0], height * width);
+        return 0;
+    }
+
     score = 0;
     for (rr = 0; rr < height; rr++)
     {
@@ -28,6 +28,13 @@ class PGMConverter;
 class EdgeDetector;
 class TemplateFinder;
 
+namespace templateMatcher {
+
+/* Return the number of pixels set in both "aa" and "bb". */
+int pgm_count(const unsigned char *aa, const unsigned char *bb, int size);
+
+};  /* namespace */
+
 class TemplateMatcher : public FrameAnalyzer
 {
 public:
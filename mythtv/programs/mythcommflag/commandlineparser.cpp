@@ -67,6 +67,10 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
     add("--outputmethod", "outputmethod", "",
         "Format of output written to outputfile, essentials, full.", "")
             ->SetGroup("Commflagging");
+    add("--preview", "preview", false,
+        "Also make the preview image, from the frames decoded for "
+        "flagging.", "")
+            ->SetGroup("Commflagging");
     add("--queue", "queue", false,
         "Insert flagging job into the JobQueue, rather than "
         "running flagging in the foreground.", "");
@@ -84,6 +88,10 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
     add("--outputfile", "outputfile", "",
         "File to write commercial flagging output [debug].", "")
             ->SetGroup("Advanced");
+    add("--simd-selfcheck", "simdselfcheck", false,
+        "Check that the SSE2 frame analysis code gives the same results "
+        "as the C code, then exit.", "")
+            ->SetGroup("Advanced");
     add("--dry-run", "dryrun", false,
         "Don't actually queue operation, just list what would be done", "");
 
@@ -46,6 +46,8 @@ using namespace std;
 #include "CommDetectorFactory.h"
 #include "SlotRelayer.h"
 #include "CustomEventRelayer.h"
+#include "PreviewTap.h"
+#include "SIMDSelfCheck.h"
 
 #define LOC      QString("MythCommFlag: ")
 #define LOC_WARN QString("MythCommFlag, Warning: ")
@@ -481,6 +483,11 @@ static void commDetectorGotNewCommercialBreakList(void)
         QString("mythcommflag sending update: %1").arg(message));
 
     gCoreContext->SendMessage(message);
+
+    // Save it too while still recording, so that players started from
+    // now on have the breaks flagged so far from the moment they open
+    if (watchingRecording)
+        global_program_info->SaveCommBreakList(newCommercialMap);
 }
 
 static void incomingCustomEvent(QEvent* e)
@@ -540,7 +547,7 @@ static int DoFlagCommercials(
     ProgramInfo *program_info,
     bool showPercentage, bool fullSpeed, int jobid,
     MythCommFlagPlayer* cfp, enum SkipTypes commDetectMethod,
-    const QString &outputfilename, bool useDB)
+    const QString &outputfilename, bool useDB, PreviewTap *previewTap)
 {
     CommDetectorFactory factory;
     commDetector = factory.makeCommDetector(
@@ -597,6 +604,9 @@ static int DoFlagCommercials(
             program_info->SaveCommFlagged(COMM_FLAG_DONE);
         }
 
+        if (previewTap)
+            previewTap->Save(commBreakList);
+
         print_comm_flag_output(
             program_info, commBreakList, cfp->GetTotalFrameCount(),
             (outputMethod == kOutputMethodFull) ? commDetector : NULL,
@@ -897,6 +907,28 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
     ctx->SetPlayer(cfp);
     cfp->SetPlayerInfo(NULL, NULL, ctx);
 
+    // Share the decode with the preview, rather than the job queue
+    // decoding the recording again for it once we are done
+    PreviewTap *previewTap = NULL;
+    if (cmdline.toBool("preview"))
+    {
+        if (flags & kDecodeFewBlocks)
+        {
+            LOG(VB_COMMFLAG, LOG_INFO, "Not making a preview, blank frame "
+                "detection only decodes the middle of each frame.");
+        }
+        else if (!QFile::exists(filename))
+        {
+            LOG(VB_COMMFLAG, LOG_INFO, "Not making a preview, "
+                "the recording is not on a local file system.");
+        }
+        else
+        {
+            previewTap = new PreviewTap(program_info, cfp, filename + ".png");
+            cfp->AddFrameTap(previewTap);
+        }
+    }
+
     if (useDB)
     {
         if (program_info->GetRecordingEndTime() > MythDate::current())
@@ -932,7 +964,7 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
 
     breaksFound = DoFlagCommercials(
         program_info, progress, fullSpeed, jobid,
-        cfp, commDetectMethod, outputfilename, useDB);
+        cfp, commDetectMethod, outputfilename, useDB, previewTap);
 
     if (progress)
         cerr << breaksFound << "\n";
@@ -941,6 +973,7 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         .arg(breaksFound));
 
     delete ctx;
+    delete previewTap;
     global_program_info = NULL;
 
     return breaksFound;
@@ -1143,6 +1176,9 @@ int main(int argc, char *argv[])
 
     MythTranslation::load("mythfrontend");
 
+    if (cmdline.toBool("simdselfcheck"))
+        return simdSelfCheck() ? GENERIC_EXIT_NOT_OK : GENERIC_EXIT_OK;
+
     if (cmdline.toBool("chanid") && cmdline.toBool("starttime"))
     {
         // operate on a recording in the database
@@ -26,6 +26,8 @@ HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
 HEADERS += SceneChangeDetector.h
 HEADERS += PrePostRollFlagger.h
+HEADERS += PreviewTap.h
+HEADERS += SIMDSelfCheck.h
 
 HEADERS += LogoDetectorBase.h SceneChangeDetectorBase.h
 HEADERS += SlotRelayer.h CustomEventRelayer.h
@@ -47,6 +49,8 @@ SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
 SOURCES += SceneChangeDetector.cpp
 SOURCES += PrePostRollFlagger.cpp
+SOURCES += PreviewTap.cpp
+SOURCES += SIMDSelfCheck.cpp
 
 SOURCES += main.cpp commandlineparser.cpp
 
@@ -1,4 +1,10 @@
 #include <climits>
+#include <cstring>
+
+#include "mythconfig.h"
+#if ARCH_X86 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 extern "C" {
 #include "libavcodec/avcodec.h"
@@ -6,6 +12,7 @@ extern "C" {
 #include "frame.h"
 #include "mythlogging.h"
 #include "myth_imgconvert.h"
+#include "FrameAnalyzer.h"
 #include "pgm.h"
 
 // TODO: verify this
@@ -231,6 +238,122 @@ int pgm_overlay(AVPicture *dst, const AVPicture *s1, int s1height,
     return 0;
 }
 
+int pgm_downscale(AVPicture *dst, const AVPicture *src, int srcheight,
+                  int factor)
+{
+    /*
+     * Shrink an image by an integer factor, each pixel of "dst" being the
+     * (rounded) average of a "factor" x "factor" block of "src". Partial
+     * blocks at the right and bottom edges are dropped.
+     */
+    const int       srcwidth = src->linesize[0];
+    const int       dstwidth = dst->linesize[0];
+    const int       dstheight = srcheight / factor;
+    const int       area = factor * factor;
+    int             rr, cc, ii, jj, sum;
+
+    if (factor < 1 || dstwidth != srcwidth / factor)
+    {
+        LOG(VB_COMMFLAG, LOG_ERR,
+            QString("pgm_downscale bad dimensions: %1 / %2 != %3")
+                .arg(srcwidth).arg(factor).arg(dstwidth));
+        return -1;
+    }
+
+    for (rr = 0; rr < dstheight; rr++)
+    {
+        const unsigned char *srow = &src->data[0][rr * factor * srcwidth];
+        unsigned char       *drow = &dst->data[0][rr * dstwidth];
+
+        cc = 0;
+#if ARCH_X86 && defined(__SSE2__)
+        if (factor == 2 && frameAnalyzer::useSSE2())
+        {
+            /* 16 "dst" pixels from two rows of 32 "src" pixels. */
+            const __m128i   lobytes = _mm_set1_epi16(0x00ff);
+            const __m128i   round = _mm_set1_epi16(2);
+
+            for (; cc + 16 <= dstwidth; cc += 16)
+            {
+                const unsigned char *s0 = &srow[cc * 2];
+                const unsigned char *s1 = s0 + srcwidth;
+                __m128i a0 = _mm_loadu_si128((const __m128i*)s0);
+                __m128i a1 = _mm_loadu_si128((const __m128i*)(s0 + 16));
+                __m128i b0 = _mm_loadu_si128((const __m128i*)s1);
+                __m128i b1 = _mm_loadu_si128((const __m128i*)(s1 + 16));
+
+                /* Add horizontal pairs as 16-bit words, then the rows. */
+                __m128i lo = _mm_add_epi16(
+                    _mm_add_epi16(_mm_and_si128(a0, lobytes),
+                                  _mm_srli_epi16(a0, 8)),
+                    _mm_add_epi16(_mm_and_si128(b0, lobytes),
+                                  _mm_srli_epi16(b0, 8)));
+                __m128i hi = _mm_add_epi16(
+                    _mm_add_epi16(_mm_and_si128(a1, lobytes),
+                                  _mm_srli_epi16(a1, 8)),
+                    _mm_add_epi16(_mm_and_si128(b1, lobytes),
+                                  _mm_srli_epi16(b1, 8)));
+                lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+                hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 2);
+                _mm_storeu_si128((__m128i*)&drow[cc],
+                                 _mm_packus_epi16(lo, hi));
+            }
+        }
+#endif
+        for (; cc < dstwidth; cc++)
+        {
+            sum = 0;
+            for (ii = 0; ii < factor; ii++)
+            {
+                const unsigned char *pp = &srow[ii * srcwidth + cc * factor];
+                for (jj = 0; jj < factor; jj++)
+                    sum += pp[jj];
+            }
+            drow[cc] = (sum + area / 2) / area;
+        }
+    }
+
+    return 0;
+}
+
+#if ARCH_X86 && defined(__SSE2__)
+static inline void convolve4_sse2(unsigned char *dst, const unsigned char *src,
+                                  int step, const double *mask,
+                                  int mask_radius)
+{
+    /*
+     * Convolve four adjacent pixels at once, "step" apart being the direction
+     * of the convolution. Each lane does the same multiplies and adds in the
+     * same order as the C code, so the result is identical.
+     */
+    const __m128i zero = _mm_setzero_si128();
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    for (int ii = -mask_radius; ii <= mask_radius; ii++)
+    {
+        int in;
+        memcpy(&in, src + ii * step, 4);
+        __m128i px = _mm_cvtsi32_si128(in);
+        px = _mm_unpacklo_epi16(_mm_unpacklo_epi8(px, zero), zero);
+
+        const __m128d mm = _mm_set1_pd(mask[ii + mask_radius]);
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(mm, _mm_cvtepi32_pd(px)));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(mm,
+                    _mm_cvtepi32_pd(_mm_srli_si128(px, 8))));
+    }
+
+    /* (unsigned char)(sum + 0.5); sum is never negative. */
+    const __m128d half = _mm_set1_pd(0.5);
+    __m128i lo = _mm_cvttpd_epi32(_mm_add_pd(sum0, half));
+    __m128i hi = _mm_cvttpd_epi32(_mm_add_pd(sum1, half));
+    __m128i vv = _mm_unpacklo_epi64(lo, hi);
+    vv = _mm_packs_epi32(vv, vv);
+    vv = _mm_packus_epi16(vv, vv);
+    int out = _mm_cvtsi128_si32(vv);
+    memcpy(dst, &out, 4);
+}
+#endif
+
 int pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
                         const AVPicture *src, int srcheight,
                         const double *mask, int mask_radius)
@@ -253,6 +376,9 @@ int pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
     const int       newheight = srcheight + 2 * mask_radius;
     int             ii, rr, cc, rr2, cc2;
     double          sum;
+#if ARCH_X86 && defined(__SSE2__)
+    const bool      sse2 = frameAnalyzer::useSSE2();
+#endif
 
     /* Get a padded copy of the src image for use by the convolutions. */
     if (pgm_expand_uniform(s1, src, srcheight, mask_radius))
@@ -267,7 +393,19 @@ int pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
     cc2 = mask_radius + srcwidth;
     for (rr = mask_radius; rr < rr2; rr++)
     {
-        for (cc = mask_radius; cc < cc2; cc++)
+        cc = mask_radius;
+#if ARCH_X86 && defined(__SSE2__)
+        if (sse2)
+        {
+            for (; cc + 4 <= cc2; cc += 4)
+            {
+                convolve4_sse2(&s2->data[0][rr * newwidth + cc],
+                               &s1->data[0][rr * newwidth + cc], newwidth,
+                               mask, mask_radius);
+            }
+        }
+#endif
+        for (; cc < cc2; cc++)
         {
             sum = 0;
             for (ii = -mask_radius; ii <= mask_radius; ii++)
@@ -282,7 +420,19 @@ int pgm_convolve_radial(AVPicture *dst, AVPicture *s1, AVPicture *s2,
     /* "s2" convolve with row vector => "dst" */
     for (rr = mask_radius; rr < rr2; rr++)
     {
-        for (cc = mask_radius; cc < cc2; cc++)
+        cc = mask_radius;
+#if ARCH_X86 && defined(__SSE2__)
+        if (sse2)
+        {
+            for (; cc + 4 <= cc2; cc += 4)
+            {
+                convolve4_sse2(&dst->data[0][rr * newwidth + cc],
+                               &s2->data[0][rr * newwidth + cc], 1,
+                               mask, mask_radius);
+            }
+        }
+#endif
+        for (; cc < cc2; cc++)
         {
             sum = 0;
             for (ii = -mask_radius; ii <= mask_radius; ii++)
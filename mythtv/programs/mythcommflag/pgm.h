@@ -19,6 +19,8 @@ int pgm_crop(struct AVPicture *dst, const struct AVPicture *src, int srcheight,
 int pgm_overlay(struct AVPicture *dst,
         const struct AVPicture *s1, int s1height, int s1row, int s1col,
         const struct AVPicture *s2, int s2height);
+int pgm_downscale(struct AVPicture *dst, const struct AVPicture *src,
+        int srcheight, int factor);
 int pgm_convolve_radial(struct AVPicture *dst, struct AVPicture *s1,
         struct AVPicture *s2, const struct AVPicture *src, int srcheight,
         const double *mask, int mask_radius);
@@ -0,0 +1,332 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QStringList>
+#include <QRunnable>
+
+// MythTV headers
+#include "guidedatacache.h"
+#include "mthreadpool.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+#include "mythdbcon.h"
+
+#define LOC QString("GuideDataCache: ")
+
+/// Listings are cached in cells of one channel by three hours.
+const int GuideDataCache::kBlockSecs           = 3 * 60 * 60;
+const int GuideDataCache::kMaxAgeSecs          = 10 * 60;
+const int GuideDataCache::kMaxCells            = 4096;
+const int GuideDataCache::kMaxQueuedPrefetches = 8;
+
+class GuideDataLoader : public QRunnable
+{
+  public:
+    GuideDataLoader(GuideDataCache &c) : m_cache(c) {}
+
+    void run(void)
+    {
+        m_cache.RunPrefetch();
+    }
+
+    GuideDataCache &m_cache;
+};
+
+GuideDataCache::GuideDataCache() :
+    m_prefetchRunning(false)
+{
+}
+
+GuideDataCache::~GuideDataCache()
+{
+    QMutexLocker locker(&m_lock);
+
+    m_prefetchQueue.clear();
+    while (m_prefetchRunning)
+        m_prefetchWait.wait(&m_lock);
+
+    locker.unlock();
+    Clear();
+}
+
+/** \fn GuideDataCache::SetScheduleList(const ProgramList&)
+ *  \brief Sets the scheduler list used to fill in the recording status
+ *         of loaded listings, and drops everything loaded with the
+ *         previous list.
+ */
+void GuideDataCache::SetScheduleList(const ProgramList &schedList)
+{
+    QMutexLocker loadlocker(&m_loadLock);
+
+    m_schedList.clear();
+    ProgramList::const_iterator it = schedList.begin();
+    for (; it != schedList.end(); ++it)
+        m_schedList.push_back(new ProgramInfo(**it));
+
+    Clear();
+}
+
+void GuideDataCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    QHash<CellKey, Cell*>::iterator it = m_cells.begin();
+    for (; it != m_cells.end(); ++it)
+        delete *it;
+    m_cells.clear();
+    m_lru.clear();
+}
+
+/** \fn GuideDataCache::GetPage(const vector<uint>&, const QDateTime&,
+ *                              const QDateTime&, vector<ProgramList*>&)
+ *  \brief Returns the listings of each channel between start and end.
+ *
+ *  Anything not already cached is loaded with a single query for all
+ *  the channels. The lists in rows are new copies owned by the caller,
+ *  one per entry in chanids, sorted by start time.
+ */
+void GuideDataCache::GetPage(const vector<uint> &chanids,
+                             const QDateTime &start, const QDateTime &end,
+                             vector<ProgramList*> &rows)
+{
+    int firstBlock = BlockOf(start);
+    int lastBlock  = BlockOf(end);
+
+    Load(chanids, firstBlock, lastBlock);
+
+    QMutexLocker locker(&m_lock);
+
+    rows.clear();
+    vector<uint>::const_iterator cit = chanids.begin();
+    for (; cit != chanids.end(); ++cit)
+    {
+        ProgramList *proglist = new ProgramList();
+        rows.push_back(proglist);
+
+        for (int block = firstBlock; block <= lastBlock; block++)
+        {
+            CellKey key(*cit, block);
+            Cell *cell = m_cells.value(key);
+            if (!cell)
+                continue;
+            Touch(key);
+
+            // Programs spanning a block boundary are in both cells.
+            ProgramList::const_iterator it = cell->programs.begin();
+            for (; it != cell->programs.end(); ++it)
+            {
+                if ((*it)->GetScheduledEndTime() < start ||
+                    (*it)->GetScheduledStartTime() > end)
+                    continue;
+
+                if (!proglist->empty() &&
+                    (*it)->GetScheduledStartTime() <=
+                    proglist->back()->GetScheduledStartTime())
+                    continue;
+
+                proglist->push_back(new ProgramInfo(**it));
+            }
+        }
+    }
+}
+
+/** \fn GuideDataCache::Prefetch(const vector<uint>&, const QDateTime&,
+ *                               const QDateTime&)
+ *  \brief Queues a background load of the listings of each channel
+ *         between start and end, if they are not already cached.
+ *
+ *  Only the most recent requests are kept, when the user scrolls
+ *  faster than the database can keep up the oldest are dropped.
+ */
+void GuideDataCache::Prefetch(const vector<uint> &chanids,
+                              const QDateTime &start, const QDateTime &end)
+{
+    Request req;
+    req.chanids    = chanids;
+    req.firstBlock = BlockOf(start);
+    req.lastBlock  = BlockOf(end);
+
+    uint now = MythDate::current().toTime_t();
+
+    QMutexLocker locker(&m_lock);
+
+    bool needed = false;
+    vector<uint>::const_iterator it = chanids.begin();
+    for (; it != chanids.end() && !needed; ++it)
+    {
+        for (int block = req.firstBlock; block <= req.lastBlock; block++)
+        {
+            if (!IsCached(*it, block, now))
+            {
+                needed = true;
+                break;
+            }
+        }
+    }
+
+    if (!needed)
+        return;
+
+    m_prefetchQueue.push_back(req);
+    while (m_prefetchQueue.size() > kMaxQueuedPrefetches)
+        m_prefetchQueue.pop_front();
+
+    if (!m_prefetchRunning)
+    {
+        m_prefetchRunning = true;
+        MThreadPool::globalInstance()->start(
+            new GuideDataLoader(*this), "GuideDataLoader");
+    }
+}
+
+void GuideDataCache::RunPrefetch(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    while (!m_prefetchQueue.empty())
+    {
+        // Newest first, it is the most likely to be viewed next.
+        Request req = m_prefetchQueue.takeLast();
+        locker.unlock();
+        Load(req.chanids, req.firstBlock, req.lastBlock);
+        locker.relock();
+    }
+
+    m_prefetchRunning = false;
+    m_prefetchWait.wakeAll();
+}
+
+int GuideDataCache::BlockOf(const QDateTime &time)
+{
+    return time.toTime_t() / kBlockSecs;
+}
+
+/// \note Must be called with m_lock held.
+bool GuideDataCache::IsCached(uint chanid, int block, uint now) const
+{
+    Cell *cell = m_cells.value(CellKey(chanid, block));
+    return cell && (now - cell->loaded < (uint)kMaxAgeSecs);
+}
+
+/** \fn GuideDataCache::Load(const vector<uint>&, int, int)
+ *  \brief Loads every missing or expired cell of the given channels
+ *         and blocks with a single query.
+ */
+bool GuideDataCache::Load(const vector<uint> &chanids,
+                          int firstBlock, int lastBlock)
+{
+    QMutexLocker loadlocker(&m_loadLock);
+
+    // Check again, another load may have filled these while we waited.
+    uint now = MythDate::current().toTime_t();
+    vector<uint> missing;
+    {
+        QMutexLocker locker(&m_lock);
+        vector<uint>::const_iterator it = chanids.begin();
+        for (; it != chanids.end(); ++it)
+        {
+            for (int block = firstBlock; block <= lastBlock; block++)
+            {
+                if (!IsCached(*it, block, now))
+                {
+                    missing.push_back(*it);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (missing.empty())
+        return true;
+
+    QStringList ids;
+    vector<uint>::const_iterator it = missing.begin();
+    for (; it != missing.end(); ++it)
+        ids.push_back(QString::number(*it));
+
+    MSqlBindings bindings;
+    QString querystr = QString(
+        "WHERE program.chanid IN (%1) "
+        "  AND program.endtime >= :STARTTS "
+        "  AND program.starttime <= :ENDTS "
+        "  AND program.manualid = 0 ").arg(ids.join(","));
+    bindings[":STARTTS"] = MythDate::fromTime_t(firstBlock * kBlockSecs);
+    bindings[":ENDTS"]   = MythDate::fromTime_t((lastBlock + 1) * kBlockSecs);
+
+    ProgramList proglist;
+    if (!LoadFromProgram(proglist, querystr, bindings, m_schedList))
+        return false;
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Loaded %1 programs for %2 channels x %3 blocks")
+            .arg(proglist.size()).arg(missing.size())
+            .arg(lastBlock - firstBlock + 1));
+
+    QHash<CellKey, Cell*> loaded;
+    for (it = missing.begin(); it != missing.end(); ++it)
+    {
+        for (int block = firstBlock; block <= lastBlock; block++)
+        {
+            Cell *cell = new Cell();
+            cell->loaded = now;
+            loaded[CellKey(*it, block)] = cell;
+        }
+    }
+
+    // The results are ordered by start time, so each cell is too.
+    ProgramList::const_iterator pit = proglist.begin();
+    for (; pit != proglist.end(); ++pit)
+    {
+        uint chanid = (*pit)->GetChanID();
+        uint pstart = (*pit)->GetScheduledStartTime().toTime_t();
+        uint pend   = (*pit)->GetScheduledEndTime().toTime_t();
+        for (int block = firstBlock; block <= lastBlock; block++)
+        {
+            uint bstart = block * kBlockSecs;
+            if (pend < bstart || pstart > bstart + kBlockSecs)
+                continue;
+
+            Cell *cell = loaded.value(CellKey(chanid, block));
+            if (cell)
+                cell->programs.push_back(new ProgramInfo(**pit));
+        }
+    }
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<CellKey, Cell*>::iterator lit = loaded.begin();
+    for (; lit != loaded.end(); ++lit)
+    {
+        QHash<CellKey, Cell*>::iterator old = m_cells.find(lit.key());
+        if (old != m_cells.end())
+        {
+            delete *old;
+            m_lru.removeOne(lit.key());
+        }
+        m_cells[lit.key()] = *lit;
+        m_lru.push_back(lit.key());
+    }
+
+    Evict();
+
+    return true;
+}
+
+/// \note Must be called with m_lock held.
+void GuideDataCache::Touch(const CellKey &key)
+{
+    m_lru.removeOne(key);
+    m_lru.push_back(key);
+}
+
+/// \note Must be called with m_lock held.
+void GuideDataCache::Evict(void)
+{
+    while (m_cells.size() > kMaxCells && !m_lru.empty())
+        delete m_cells.take(m_lru.takeFirst());
+}
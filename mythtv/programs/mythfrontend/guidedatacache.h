@@ -0,0 +1,98 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+#ifndef _GUIDE_DATA_CACHE_H_
+#define _GUIDE_DATA_CACHE_H_
+
+// C++ headers
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+#include <QPair>
+
+// MythTV headers
+#include "programinfo.h"
+
+class GuideDataLoader;
+
+/** \class GuideDataCache
+ *  \brief In memory cache of program guide listings for the GuideGrid.
+ *
+ *  Listings are held in cells of one channel by kBlockSecs of time.
+ *  Every cell missing for a page of the guide is fetched with a single
+ *  query, so paging through the guide costs one query per page instead
+ *  of one per channel row, and a page that has been seen recently, or
+ *  has been prefetched on the background thread, costs none.
+ *
+ *  The number of cells is bounded, least recently used cells are
+ *  evicted first, and cells older than kMaxAgeSecs are reloaded so
+ *  new listings still show up in a guide left open for a long time.
+ */
+class GuideDataCache
+{
+    friend class GuideDataLoader;
+
+  public:
+    GuideDataCache();
+    ~GuideDataCache();
+
+    void SetScheduleList(const ProgramList &schedList);
+    void Clear(void);
+
+    void GetPage(const vector<uint> &chanids,
+                 const QDateTime &start, const QDateTime &end,
+                 vector<ProgramList*> &rows);
+    void Prefetch(const vector<uint> &chanids,
+                  const QDateTime &start, const QDateTime &end);
+
+  private:
+    typedef QPair<uint,int> CellKey;
+
+    class Cell
+    {
+      public:
+        Cell() : loaded(0) {}
+        ProgramList programs; ///< sorted by start time
+        uint        loaded;   ///< time_t when the cell was loaded
+    };
+
+    class Request
+    {
+      public:
+        vector<uint> chanids;
+        int          firstBlock;
+        int          lastBlock;
+    };
+
+    static int BlockOf(const QDateTime &time);
+    bool IsCached(uint chanid, int block, uint now) const;
+    bool Load(const vector<uint> &chanids, int firstBlock, int lastBlock);
+    void RunPrefetch(void);
+    void Touch(const CellKey &key);
+    void Evict(void);
+
+  private:
+    mutable QMutex          m_lock;
+    QHash<CellKey, Cell*>   m_cells;
+    /// cell keys in least recently used first order
+    QList<CellKey>          m_lru;
+    QList<Request>          m_prefetchQueue;
+    bool                    m_prefetchRunning;
+    mutable QWaitCondition  m_prefetchWait;
+
+    /// Serializes database loads, protects m_schedList
+    QMutex                  m_loadLock;
+    ProgramList             m_schedList;
+
+    static const int        kBlockSecs;
+    static const int        kMaxAgeSecs;
+    static const int        kMaxCells;
+    static const int        kMaxQueuedPrefetches;
+};
+
+#endif // _GUIDE_DATA_CACHE_H_
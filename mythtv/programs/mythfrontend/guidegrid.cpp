@@ -310,25 +310,23 @@ bool GuideGrid::Create()
 void GuideGrid::Load(void)
 {
     LoadFromScheduler(m_recList);
+    m_guideData.SetScheduleList(m_recList);
     fillChannelInfos();
 
     int maxchannel = max((int)GetChannelCount() - 1, 0);
     setStartChannel((int)(m_currentStartChannel) - (int)(m_channelCount / 2));
     m_channelCount = min(m_channelCount, maxchannel + 1);
 
+    vector<ProgramList*> page;
+    m_guideData.GetPage(getPageChanIDs(m_currentStartChannel),
+        m_currentStartTime.addSecs(0 - m_currentStartTime.time().second()),
+        m_currentEndTime.addSecs(0 - m_currentEndTime.time().second()),
+        page);
+
     for (int y = 0; y < m_channelCount; ++y)
     {
-        int chanNum = y + m_currentStartChannel;
-        if (chanNum >= (int) m_channelInfos.size())
-            chanNum -= (int) m_channelInfos.size();
-        if (chanNum >= (int) m_channelInfos.size())
-            continue;
-
-        if (chanNum < 0)
-            chanNum = 0;
-
         delete m_programs[y];
-        m_programs[y] = getProgramListFromProgram(chanNum);
+        m_programs[y] = page[y];
     }
 }
 
@@ -1060,33 +1058,97 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
 {
     m_guideGrid->ResetData();
 
+    if (!useExistingData)
+    {
+        // Load the whole page at once, a single query at most.
+        vector<ProgramList*> page;
+        m_guideData.GetPage(getPageChanIDs(m_currentStartChannel),
+            m_currentStartTime.addSecs(0 - m_currentStartTime.time().second()),
+            m_currentEndTime.addSecs(0 - m_currentEndTime.time().second()),
+            page);
+
+        for (int y = 0; y < m_channelCount; ++y)
+        {
+            delete m_programs[y];
+            m_programs[y] = page[y];
+        }
+    }
+
     for (int y = 0; y < m_channelCount; ++y)
     {
-        fillProgramRowInfos(y, useExistingData);
+        fillProgramRowInfos(y, true);
     }
+
+    prefetchAdjacentPages();
 }
 
 ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
 {
-    ProgramList *proglist = new ProgramList();
+    vector<uint> chanids;
+    chanids.push_back(GetChannelInfo(chanNum)->chanid);
 
-    if (proglist)
-    {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.manualid = 0 ";
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] =
-            m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":ENDTS"] =
-            m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+    vector<ProgramList*> page;
+    m_guideData.GetPage(chanids,
+        m_currentStartTime.addSecs(0 - m_currentStartTime.time().second()),
+        m_currentEndTime.addSecs(0 - m_currentEndTime.time().second()),
+        page);
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
-    }
+    return page[0];
+}
 
-    return proglist;
+/// Returns the chanid shown in row when the guide starts at startChannel,
+/// or 0 if the row is empty.
+uint GuideGrid::getChanIDForRow(int row, int startChannel) const
+{
+    int chanNum = row + startChannel;
+    if (chanNum >= (int) m_channelInfos.size())
+        chanNum -= (int) m_channelInfos.size();
+    if (chanNum >= (int) m_channelInfos.size())
+        return 0;
+
+    if (chanNum < 0)
+        chanNum = 0;
+
+    const DBChannel *chinfo = GetChannelInfo(chanNum);
+    return (chinfo) ? chinfo->chanid : 0;
+}
+
+vector<uint> GuideGrid::getPageChanIDs(int startChannel) const
+{
+    vector<uint> chanids;
+    for (int y = 0; y < m_channelCount; ++y)
+        chanids.push_back(getChanIDForRow(y, startChannel));
+    return chanids;
+}
+
+/** \fn GuideGrid::prefetchAdjacentPages(void)
+ *  \brief Loads the pages around the current one in the background,
+ *         so the next page up, down, left or right is already cached.
+ */
+void GuideGrid::prefetchAdjacentPages(void)
+{
+    int count = GetChannelCount();
+    if (!count || !m_channelCount)
+        return;
+
+    QDateTime start =
+        m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime end =
+        m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+    int span = start.secsTo(end);
+
+    int up   = ((int)m_currentStartChannel - m_channelCount) % count;
+    int down = ((int)m_currentStartChannel + m_channelCount) % count;
+    if (up < 0)
+        up += count;
+
+    // The most recent request is loaded first, so queue the page
+    // the user is most likely to move to last.
+    vector<uint> current = getPageChanIDs(m_currentStartChannel);
+    m_guideData.Prefetch(current, start.addSecs(-span), start);
+    m_guideData.Prefetch(getPageChanIDs(up), start, end);
+    m_guideData.Prefetch(current, end, end.addSecs(span));
+    m_guideData.Prefetch(getPageChanIDs(down), start, end);
 }
 
 void GuideGrid::fillProgramRowInfos(unsigned int row, bool useExistingData)
@@ -1358,6 +1420,7 @@ void GuideGrid::customEvent(QEvent *event)
         if (message == "SCHEDULE_CHANGE")
         {
             LoadFromScheduler(m_recList);
+            m_guideData.SetScheduleList(m_recList);
             fillProgramInfos();
             updateInfo();
         }
@@ -20,6 +20,7 @@ using namespace std;
 
 // mythfrontend
 #include "schedulecommon.h"
+#include "guidedatacache.h"
 
 using namespace std;
 
@@ -177,6 +178,9 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     void fillProgramInfos(bool useExistingData = false);
     void fillProgramRowInfos(unsigned int row, bool useExistingData = false);
     ProgramList *getProgramListFromProgram(int chanNum);
+    uint getChanIDForRow(int row, int startChannel) const;
+    vector<uint> getPageChanIDs(int startChannel) const;
+    void prefetchAdjacentPages(void);
 
     void setStartChannel(int newStartChannel);
 
@@ -200,6 +204,7 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     vector<ProgramList*> m_programs;
     ProgramInfo *m_programInfos[MAX_DISPLAY_CHANS][MAX_DISPLAY_TIMES];
     ProgramList  m_recList;
+    GuideDataCache m_guideData;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
@@ -1,6 +1,9 @@
 
 #include "playbackbox.h"
 
+// C++
+#include <algorithm>
+
 // QT
 #include <QCoreApplication>
 #include <QWaitCondition>
@@ -198,6 +201,43 @@ static bool comp_season_rev_less_than(
     return comp_season_rev(a, b) < 0;
 }
 
+/// The order of the ProgramInfoCache, which the "All Programs" list keeps.
+static bool comp_recstart_less_than(
+    const ProgramInfo *a, const ProgramInfo *b)
+{
+    if (a->GetRecordingStartTime() == b->GetRecordingStartTime())
+        return a->GetChanID() < b->GetChanID();
+    return a->GetRecordingStartTime() < b->GetRecordingStartTime();
+}
+
+static bool comp_recstart_rev_less_than(
+    const ProgramInfo *a, const ProgramInfo *b)
+{
+    return comp_recstart_less_than(b, a);
+}
+
+typedef bool (*ProgramInfoLessThan)(const ProgramInfo*, const ProgramInfo*);
+
+/// Returns the order of the episodes within a group for the
+/// "PlayBoxEpisodeSort" setting, or NULL if they are not sorted.
+static ProgramInfoLessThan get_episode_sort(
+    const QString &episodeSort, bool reverse)
+{
+    if (episodeSort == "OrigAirDate")
+        return reverse ? comp_originalAirDate_rev_less_than :
+                         comp_originalAirDate_less_than;
+    if (episodeSort == "Id")
+        return reverse ? comp_programid_rev_less_than :
+                         comp_programid_less_than;
+    if (episodeSort == "Date")
+        return reverse ? comp_recordDate_rev_less_than :
+                         comp_recordDate_less_than;
+    if (episodeSort == "Season")
+        return reverse ? comp_season_rev_less_than :
+                         comp_season_less_than;
+    return NULL;
+}
+
 static const uint s_artDelay[] =
     { kArtworkFanTimeout, kArtworkBannerTimeout, kArtworkCoverTimeout,};
 
@@ -399,7 +439,7 @@ PlaybackBox::PlaybackBox(MythScreenStack *parent, QString name, BoxType ltype,
       m_popupMenu(NULL),
       m_doToggleMenu(true),
       // Main Recording List support
-      m_progsInDB(0),
+      m_cacheGeneration(0),               m_progsInDB(0),
       // Other state
       m_op_on_playlist(false),
       m_programInfoCache(this),           m_playingSomething(false),
@@ -520,6 +560,11 @@ bool PlaybackBox::Create()
     m_noRecordingsText = dynamic_cast<MythUIText *> (GetChild("norecordings"));
 
     m_previewImage = dynamic_cast<MythUIImage *>(GetChild("preview"));
+    if (m_previewImage)
+    {
+        // Have the backend scale the previews to the size we show them at.
+        PreviewGeneratorQueue::SetFetchSize(m_previewImage->GetArea().size());
+    }
     m_artImage[kArtworkFanart] = dynamic_cast<MythUIImage*>(GetChild("fanart"));
     m_artImage[kArtworkBanner] = dynamic_cast<MythUIImage*>(GetChild("banner"));
     m_artImage[kArtworkCoverart]= dynamic_cast<MythUIImage*>(GetChild("coverart"));
@@ -1587,6 +1632,11 @@ bool PlaybackBox::UpdateUILists(void)
 
     m_progsInDB = 0;
     m_titleList.clear();
+    m_groupNames.clear();
+    m_searchRules.clear();
+    m_keyGroups.clear();
+    m_keyRecGroup.clear();
+    m_recGroupSizes.clear();
     m_progLists.clear();
     m_recordingList->Reset();
     m_groupList->Reset();
@@ -1600,16 +1650,13 @@ bool PlaybackBox::UpdateUILists(void)
     ViewTitleSort titleSort = (ViewTitleSort)gCoreContext->GetNumSetting(
                                 "DisplayGroupTitleSort", TitleSortAlphabetical);
 
-    QMap<QString, QString> sortedList;
-    QMap<int, QString> searchRule;
     QMap<int, int> recidEpisodes;
 
     m_programInfoCache.Refresh();
+    m_cacheGeneration = m_programInfoCache.GetGeneration();
 
     if (!m_programInfoCache.empty())
     {
-        QString sTitle;
-
         if ((m_viewMask & VIEW_SEARCHES))
         {
             MSqlQuery query(MSqlQuery::InitCon());
@@ -1623,7 +1670,7 @@ bool PlaybackBox::UpdateUILists(void)
                 {
                     QString tmpTitle = query.value(1).toString();
                     tmpTitle.remove(m_titleChaff);
-                    searchRule[query.value(0).toInt()] = tmpTitle;
+                    m_searchRules[query.value(0).toInt()] = tmpTitle;
                 }
             }
         }
@@ -1639,137 +1686,23 @@ bool PlaybackBox::UpdateUILists(void)
 
             m_progsInDB++;
             ProgramInfo *p = *it;
+            IndexRecGroup(p);
 
             if (p->GetTitle().isEmpty())
                 p->SetTitle(tr("_NO_TITLE_"));
 
-            if ((((p->GetRecordingGroup() == m_recGroup) ||
-                  ((m_recGroup == "All Programs") &&
-                   (p->GetRecordingGroup() != "Deleted") &&
-                   (p->GetRecordingGroup() != "LiveTV")) ||
-                  (p->GetRecordingGroup() == "LiveTV" &&
-                   (m_viewMask & VIEW_LIVETVGRP))) &&
-                 (m_recGroupPwCache[m_recGroup] == m_curGroupPassword)) ||
-                ((m_recGroupType[m_recGroup] == "category") &&
-                 ((p->GetCategory() == m_recGroup ) ||
-                  ((p->GetCategory().isEmpty()) &&
-                   (m_recGroup == tr("Unknown")))) &&
-                 ( !m_recGroupPwCache.contains(p->GetRecordingGroup()))))
-            {
-                if ((!(m_viewMask & VIEW_WATCHED)) && p->IsWatched())
-                    continue;
-
-                if (m_viewMask != VIEW_NONE &&
-                    (p->GetRecordingGroup() != "LiveTV" ||
-                     m_recGroup == "LiveTV"))
-                {
-                    m_progLists[""].push_front(p);
-                }
-
-                asKey = p->MakeUniqueKey();
-                if (asCache.contains(asKey))
-                    p->SetAvailableStatus(asCache[asKey], "UpdateUILists");
-                else
-                    p->SetAvailableStatus(asAvailable,  "UpdateUILists");
-
-                if (m_recGroup != "LiveTV" &&
-                    (p->GetRecordingGroup() == "LiveTV") &&
-                    (m_viewMask & VIEW_LIVETVGRP))
-                {
-                    QString tmpTitle = tr("Live TV");
-                    sortedList[tmpTitle.toLower()] = tmpTitle;
-                    m_progLists[tmpTitle.toLower()].push_front(p);
-                    m_progLists[tmpTitle.toLower()].setAutoDelete(false);
-                    continue;
-                }
-
-                if ((m_viewMask & VIEW_TITLES) && // Show titles
-                    ((p->GetRecordingGroup() != "LiveTV") ||
-                     (m_recGroup == "LiveTV")))
-                {
-                    sTitle = construct_sort_title(
-                        p->GetTitle(), m_viewMask, titleSort,
-                        p->GetRecordingPriority(), m_prefixes);
-                    sTitle = sTitle.toLower().simplified();
-
-                    if (!sortedList.contains(sTitle))
-                        sortedList[sTitle] = p->GetTitle();
-                    m_progLists[sortedList[sTitle].toLower()].push_front(p);
-                    m_progLists[sortedList[sTitle].toLower()].setAutoDelete(false);
-                }
-
-                if ((m_viewMask & VIEW_RECGROUPS) &&
-                    !p->GetRecordingGroup().isEmpty() &&
-                    p->GetRecordingGroup() != "LiveTV") // Show recording groups
-                {
-                    sortedList[p->GetRecordingGroup().toLower()] =
-                        p->GetRecordingGroup();
-                    m_progLists[p->GetRecordingGroup().toLower()]
-                        .push_front(p);
-                    m_progLists[p->GetRecordingGroup().toLower()]
-                        .setAutoDelete(false);
-                }
-
-                if ((m_viewMask & VIEW_CATEGORIES) &&
-                    !p->GetCategory().isEmpty()) // Show categories
-                {
-                    QString catl = p->GetCategory().toLower();
-                    sortedList[catl] = p->GetCategory();
-                    m_progLists[catl].push_front(p);
-                    m_progLists[catl].setAutoDelete(false);
-                }
-
-                if ((m_viewMask & VIEW_SEARCHES) &&
-                    !searchRule[p->GetRecordingRuleID()].isEmpty() &&
-                    p->GetTitle() != searchRule[p->GetRecordingRuleID()])
-                {   // Show search rules
-                    QString tmpTitle = QString("(%1)")
-                        .arg(searchRule[p->GetRecordingRuleID()]);
-                    sortedList[tmpTitle.toLower()] = tmpTitle;
-                    m_progLists[tmpTitle.toLower()].push_front(p);
-                    m_progLists[tmpTitle.toLower()].setAutoDelete(false);
-                }
+            if (!AddToGroups(p, titleSort, recidEpisodes, false))
+                continue;
 
-                if ((m_viewMask & VIEW_WATCHLIST) &&
-                    (p->GetRecordingGroup() != "LiveTV"))
-                {
-                    if (m_watchListAutoExpire && !p->IsAutoExpirable())
-                    {
-                        p->SetRecordingPriority2(wlExpireOff);
-                        LOG(VB_FILE, LOG_INFO, QString("Auto-expire off:  %1")
-                                .arg(p->GetTitle()));
-                    }
-                    else if (p->IsWatched())
-                    {
-                        p->SetRecordingPriority2(wlWatched);
-                        LOG(VB_FILE, LOG_INFO,
-                            QString("Marked as 'watched':  %1")
-                                .arg(p->GetTitle()));
-                    }
-                    else
-                    {
-                        if (p->GetRecordingRuleID())
-                            recidEpisodes[p->GetRecordingRuleID()] += 1;
-                        if (recidEpisodes[p->GetRecordingRuleID()] == 1 ||
-                            !p->GetRecordingRuleID())
-                        {
-                            m_progLists[m_watchGroupLabel].push_front(p);
-                            m_progLists[m_watchGroupLabel].setAutoDelete(false);
-                        }
-                        else
-                        {
-                            p->SetRecordingPriority2(wlEarlier);
-                            LOG(VB_FILE, LOG_INFO,
-                                QString("Not the earliest:  %1")
-                                    .arg(p->GetTitle()));
-                        }
-                    }
-                }
-            }
+            asKey = p->MakeUniqueKey();
+            if (asCache.contains(asKey))
+                p->SetAvailableStatus(asCache[asKey], "UpdateUILists");
+            else
+                p->SetAvailableStatus(asAvailable,  "UpdateUILists");
         }
     }
 
-    if (sortedList.empty())
+    if (m_groupNames.empty())
     {
         LOG(VB_GENERAL, LOG_WARNING, LOC + "SortedList is Empty");
         m_progLists[""];
@@ -1780,62 +1713,17 @@ bool PlaybackBox::UpdateUILists(void)
         return false;
     }
 
-    QString episodeSort = gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date");
+    ProgramInfoLessThan episodeSort = get_episode_sort(
+        gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date"),
+        (m_listOrder == 0 || m_type == kDeleteBox));
 
-    if (episodeSort == "OrigAirDate")
-    {
-        QMap<QString, ProgramList>::Iterator Iprog;
-        for (Iprog = m_progLists.begin(); Iprog != m_progLists.end(); ++Iprog)
-        {
-            if (!Iprog.key().isEmpty())
-            {
-                std::stable_sort((*Iprog).begin(), (*Iprog).end(),
-                                 (m_listOrder == 0 || m_type == kDeleteBox) ?
-                                 comp_originalAirDate_rev_less_than :
-                                 comp_originalAirDate_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Id")
-    {
-        QMap<QString, ProgramList>::Iterator Iprog;
-        for (Iprog = m_progLists.begin(); Iprog != m_progLists.end(); ++Iprog)
-        {
-            if (!Iprog.key().isEmpty())
-            {
-                std::stable_sort((*Iprog).begin(), (*Iprog).end(),
-                                 (m_listOrder == 0 || m_type == kDeleteBox) ?
-                                 comp_programid_rev_less_than :
-                                 comp_programid_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Date")
+    if (episodeSort)
     {
         QMap<QString, ProgramList>::iterator it;
         for (it = m_progLists.begin(); it != m_progLists.end(); ++it)
         {
             if (!it.key().isEmpty())
-            {
-                std::stable_sort((*it).begin(), (*it).end(),
-                                 (!m_listOrder || m_type == kDeleteBox) ?
-                                 comp_recordDate_rev_less_than :
-                                 comp_recordDate_less_than);
-            }
-        }
-    }
-    else if (episodeSort == "Season")
-    {
-        QMap<QString, ProgramList>::iterator it;
-        for (it = m_progLists.begin(); it != m_progLists.end(); ++it)
-        {
-            if (!it.key().isEmpty())
-            {
-                std::stable_sort((*it).begin(), (*it).end(),
-                                 (!m_listOrder || m_type == kDeleteBox) ?
-                                 comp_season_rev_less_than :
-                                 comp_season_less_than);
-            }
+                std::stable_sort((*it).begin(), (*it).end(), episodeSort);
         }
     }
 
@@ -2081,13 +1969,7 @@ bool PlaybackBox::UpdateUILists(void)
                          comp_recpriority2_less_than);
     }
 
-    m_titleList = QStringList("");
-    if (m_progLists[m_watchGroupLabel].size() > 0)
-        m_titleList << m_watchGroupName;
-    if ((m_progLists["livetv"].size() > 0) &&
-        (!sortedList.values().contains(tr("Live TV"))))
-        m_titleList << tr("Live TV");
-    m_titleList << sortedList.values();
+    UpdateTitleList();
 
     // Populate list of recording groups
     if (!m_programInfoCache.empty())
@@ -2146,6 +2028,380 @@ bool PlaybackBox::UpdateUILists(void)
     return true;
 }
 
+/** \brief Applies the changes made to the ProgramInfoCache since the
+ *         lists were last built, instead of rebuilding them.
+ *
+ *  Only the changed programs are taken out of their groups and put back
+ *  at their sorted position, the other groups are neither re-sorted nor
+ *  rebuilt. This falls back to UpdateUILists() after the cache has been
+ *  reloaded, when the watch list is shown as its order depends on
+ *  every recording, when the set of recording groups changes and when
+ *  no recordings are left to show.
+ *
+ *  \return True iff the lists were updated.
+ */
+bool PlaybackBox::UpdateUIListsIncremental(void)
+{
+    QStringList keys;
+    if ((m_viewMask & VIEW_WATCHLIST) || m_groupNames.empty() ||
+        !m_programInfoCache.GetChanges(m_cacheGeneration, keys) ||
+        RecGroupsChange(keys))
+    {
+        return false;
+    }
+
+    m_isFilling = true;
+
+    QStringList groupSelPref, itemSelPref, itemTopPref;
+    save_position(m_groupList, m_recordingList,
+                  groupSelPref, itemSelPref, itemTopPref);
+
+    ViewTitleSort titleSort = (ViewTitleSort)gCoreContext->GetNumSetting(
+                                "DisplayGroupTitleSort", TitleSortAlphabetical);
+
+    QMap<int, int> recidEpisodes;
+
+    QStringList::const_iterator it = keys.begin();
+    for (; it != keys.end(); ++it)
+    {
+        RemoveFromGroups(*it);
+
+        ProgramInfo *p = m_programInfoCache.GetProgramInfo(*it);
+        if (!p || p->IsDeletePending() ||
+            p->GetAvailableStatus() == asDeleted)
+        {
+            continue;
+        }
+
+        IndexRecGroup(p);
+
+        if (p->GetTitle().isEmpty())
+            p->SetTitle(tr("_NO_TITLE_"));
+
+        AddToGroups(p, titleSort, recidEpisodes, true);
+    }
+
+    m_progsInDB = m_keyRecGroup.size();
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Applied %1 changes to the recording lists")
+            .arg(keys.size()));
+
+    m_cacheGeneration = m_programInfoCache.GetGeneration();
+
+    // Nothing refers to the removed programs any more.
+    m_programInfoCache.RemoveDeleted();
+
+    if (m_groupNames.empty())
+    {
+        m_isFilling = false;
+        return false;
+    }
+
+    UpdateTitleList();
+    UpdateUIRecGroupList();
+    UpdateUIGroupList(groupSelPref);
+    UpdateUsageUI();
+
+    QStringList::const_iterator pit = m_playList.begin();
+    for (; pit != m_playList.end(); ++pit)
+    {
+        ProgramInfo *pginfo = FindProgramInUILists(*pit);
+        if (!pginfo)
+            continue;
+        MythUIButtonListItem *item =
+            m_recordingList->GetItemByData(qVariantFromValue(pginfo));
+        if (item)
+            item->DisplayState("yes", "playlist");
+    }
+
+    restore_position(m_groupList, m_recordingList,
+                     groupSelPref, itemSelPref, itemTopPref);
+
+    m_isFilling = false;
+
+    return true;
+}
+
+/** \brief Adds a program to the lists of every group it is shown in.
+ *
+ *  \param insertSorted If true the program is inserted at its sorted
+ *                      position, otherwise it is put at the front and
+ *                      the caller sorts the lists afterwards.
+ *  \return True iff the program is shown in the current view.
+ */
+bool PlaybackBox::AddToGroups(ProgramInfo *p, ViewTitleSort titleSort,
+                              QMap<int,int> &recidEpisodes, bool insertSorted)
+{
+    if (!(((p->GetRecordingGroup() == m_recGroup) ||
+           ((m_recGroup == "All Programs") &&
+            (p->GetRecordingGroup() != "Deleted") &&
+            (p->GetRecordingGroup() != "LiveTV")) ||
+           (p->GetRecordingGroup() == "LiveTV" &&
+            (m_viewMask & VIEW_LIVETVGRP))) &&
+          (m_recGroupPwCache[m_recGroup] == m_curGroupPassword)) &&
+        !((m_recGroupType[m_recGroup] == "category") &&
+          ((p->GetCategory() == m_recGroup ) ||
+           ((p->GetCategory().isEmpty()) &&
+            (m_recGroup == tr("Unknown")))) &&
+          ( !m_recGroupPwCache.contains(p->GetRecordingGroup()))))
+    {
+        return false;
+    }
+
+    if ((!(m_viewMask & VIEW_WATCHED)) && p->IsWatched())
+        return false;
+
+    ProgramInfoLessThan episodeSort = NULL;
+    if (insertSorted)
+    {
+        episodeSort = get_episode_sort(
+            gCoreContext->GetSetting("PlayBoxEpisodeSort", "Date"),
+            (m_listOrder == 0 || m_type == kDeleteBox));
+    }
+
+    // The lists are built from the cache in this order.
+    bool newest_first = (0==m_allOrder) || (kDeleteBox==m_type);
+
+    QStringList groups;
+
+    if (m_viewMask != VIEW_NONE &&
+        (p->GetRecordingGroup() != "LiveTV" || m_recGroup == "LiveTV"))
+    {
+        m_keyGroups[p->MakeUniqueKey()].push_back("");
+        ProgramList &all = m_progLists[""];
+        if (insertSorted)
+        {
+            ProgramInfoLessThan allSort = newest_first ?
+                comp_recstart_less_than : comp_recstart_rev_less_than;
+            all.insert(std::upper_bound(all.begin(), all.end(), p, allSort),
+                       p);
+        }
+        else
+            all.push_front(p);
+    }
+
+    if (m_recGroup != "LiveTV" &&
+        (p->GetRecordingGroup() == "LiveTV") &&
+        (m_viewMask & VIEW_LIVETVGRP))
+    {
+        QString tmpTitle = tr("Live TV");
+        m_groupNames[tmpTitle.toLower()] = tmpTitle;
+        groups.push_back(tmpTitle.toLower());
+    }
+    else
+    {
+        if ((m_viewMask & VIEW_TITLES) && // Show titles
+            ((p->GetRecordingGroup() != "LiveTV") ||
+             (m_recGroup == "LiveTV")))
+        {
+            QString sTitle = construct_sort_title(
+                p->GetTitle(), m_viewMask, titleSort,
+                p->GetRecordingPriority(), m_prefixes);
+            sTitle = sTitle.toLower().simplified();
+
+            if (!m_groupNames.contains(sTitle))
+                m_groupNames[sTitle] = p->GetTitle();
+            groups.push_back(m_groupNames[sTitle].toLower());
+        }
+
+        if ((m_viewMask & VIEW_RECGROUPS) &&
+            !p->GetRecordingGroup().isEmpty() &&
+            p->GetRecordingGroup() != "LiveTV") // Show recording groups
+        {
+            m_groupNames[p->GetRecordingGroup().toLower()] =
+                p->GetRecordingGroup();
+            groups.push_back(p->GetRecordingGroup().toLower());
+        }
+
+        if ((m_viewMask & VIEW_CATEGORIES) &&
+            !p->GetCategory().isEmpty()) // Show categories
+        {
+            QString catl = p->GetCategory().toLower();
+            m_groupNames[catl] = p->GetCategory();
+            groups.push_back(catl);
+        }
+
+        if ((m_viewMask & VIEW_SEARCHES) &&
+            !m_searchRules[p->GetRecordingRuleID()].isEmpty() &&
+            p->GetTitle() != m_searchRules[p->GetRecordingRuleID()])
+        {   // Show search rules
+            QString tmpTitle = QString("(%1)")
+                .arg(m_searchRules[p->GetRecordingRuleID()]);
+            m_groupNames[tmpTitle.toLower()] = tmpTitle;
+            groups.push_back(tmpTitle.toLower());
+        }
+
+        if ((m_viewMask & VIEW_WATCHLIST) &&
+            (p->GetRecordingGroup() != "LiveTV"))
+        {
+            if (m_watchListAutoExpire && !p->IsAutoExpirable())
+            {
+                p->SetRecordingPriority2(wlExpireOff);
+                LOG(VB_FILE, LOG_INFO, QString("Auto-expire off:  %1")
+                        .arg(p->GetTitle()));
+            }
+            else if (p->IsWatched())
+            {
+                p->SetRecordingPriority2(wlWatched);
+                LOG(VB_FILE, LOG_INFO,
+                    QString("Marked as 'watched':  %1")
+                        .arg(p->GetTitle()));
+            }
+            else
+            {
+                if (p->GetRecordingRuleID())
+                    recidEpisodes[p->GetRecordingRuleID()] += 1;
+                if (recidEpisodes[p->GetRecordingRuleID()] == 1 ||
+                    !p->GetRecordingRuleID())
+                {
+                    groups.push_back(m_watchGroupLabel);
+                }
+                else
+                {
+                    p->SetRecordingPriority2(wlEarlier);
+                    LOG(VB_FILE, LOG_INFO,
+                        QString("Not the earliest:  %1")
+                            .arg(p->GetTitle()));
+                }
+            }
+        }
+    }
+
+    if (!groups.empty())
+        m_keyGroups[p->MakeUniqueKey()] += groups;
+
+    QStringList::const_iterator it = groups.begin();
+    for (; it != groups.end(); ++it)
+    {
+        ProgramList &group = m_progLists[*it];
+        group.setAutoDelete(false);
+
+        if (insertSorted && episodeSort)
+        {
+            group.insert(std::upper_bound(group.begin(), group.end(),
+                                          p, episodeSort), p);
+        }
+        else if (insertSorted)
+            group.push_back(p);
+        else
+            group.push_front(p);
+    }
+
+    return true;
+}
+
+/** \brief Takes a program out of the group lists it was added to, and
+ *         drops the groups that are left empty.
+ */
+void PlaybackBox::RemoveFromGroups(const QString &piKey)
+{
+    QMap<QString,QString>::iterator rit = m_keyRecGroup.find(piKey);
+    if (rit != m_keyRecGroup.end())
+    {
+        if (--m_recGroupSizes[*rit] <= 0)
+            m_recGroupSizes.remove(*rit);
+        m_keyRecGroup.erase(rit);
+    }
+
+    uint      chanid;
+    QDateTime recstartts;
+    if (!ProgramInfo::ExtractKey(piKey, chanid, recstartts))
+        return;
+
+    QStringList groups = m_keyGroups.take(piKey);
+    QStringList::const_iterator it = groups.begin();
+    for (; it != groups.end(); ++it)
+    {
+        ProgramMap::iterator git = m_progLists.find(*it);
+        if (git == m_progLists.end())
+            continue;
+
+        ProgramList::iterator pit = (*git).begin();
+        while (pit != (*git).end())
+        {
+            if ((*pit)->GetChanID()             == chanid &&
+                (*pit)->GetRecordingStartTime() == recstartts)
+            {
+                pit = (*git).erase(pit);
+            }
+            else
+                ++pit;
+        }
+
+        if ((*git).empty() && !git.key().isEmpty())
+        {
+            QMap<QString,QString>::iterator nit = m_groupNames.begin();
+            while (nit != m_groupNames.end())
+            {
+                if ((*nit).toLower() == git.key())
+                    nit = m_groupNames.erase(nit);
+                else
+                    ++nit;
+            }
+            m_progLists.erase(git);
+        }
+    }
+}
+
+/// Counts a program in its recording group, for RecGroupsChange().
+void PlaybackBox::IndexRecGroup(const ProgramInfo *p)
+{
+    QString recgroup = p->GetRecordingGroup();
+    m_keyRecGroup[p->MakeUniqueKey()] = recgroup;
+    m_recGroupSizes[recgroup]++;
+}
+
+/** \brief Returns true if applying these changes would add, rename or
+ *         empty a recording group, the group selector then needs the
+ *         full rebuild.
+ */
+bool PlaybackBox::RecGroupsChange(const QStringList &keys) const
+{
+    QMap<QString,int> sizes;
+
+    QStringList::const_iterator it = keys.begin();
+    for (; it != keys.end(); ++it)
+    {
+        ProgramInfo *p = m_programInfoCache.GetProgramInfo(*it);
+        bool gone = !p || p->IsDeletePending() ||
+                    p->GetAvailableStatus() == asDeleted;
+
+        QMap<QString,QString>::const_iterator rit = m_keyRecGroup.find(*it);
+        if (rit == m_keyRecGroup.end())
+        {
+            if (!gone && !m_recGroupSizes.contains(p->GetRecordingGroup()))
+                return true;
+        }
+        else if (!gone)
+        {
+            if (*rit != p->GetRecordingGroup())
+                return true;
+        }
+        else
+        {
+            if (!sizes.contains(*rit))
+                sizes[*rit] = m_recGroupSizes.value(*rit);
+            if (--sizes[*rit] <= 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/// Rebuilds the list of pages from the group lists.
+void PlaybackBox::UpdateTitleList(void)
+{
+    m_titleList = QStringList("");
+    if (m_progLists[m_watchGroupLabel].size() > 0)
+        m_titleList << m_watchGroupName;
+    if ((m_progLists["livetv"].size() > 0) &&
+        (!m_groupNames.values().contains(tr("Live TV"))))
+        m_titleList << tr("Live TV");
+    m_titleList << m_groupNames.values();
+}
+
 void PlaybackBox::playSelectedPlaylist(bool _random)
 {
     if (_random)
@@ -3964,7 +4220,8 @@ void PlaybackBox::customEvent(QEvent *event)
                 m_needUpdate = true;
             else
             {
-                UpdateUILists();
+                if (!UpdateUIListsIncremental())
+                    UpdateUILists();
                 m_helper.ForceFreeSpaceUpdate();
             }
         }
@@ -268,6 +268,13 @@ class PlaybackBox : public ScheduleCommon
 
   private:
     bool UpdateUILists(void);
+    bool UpdateUIListsIncremental(void);
+    bool AddToGroups(ProgramInfo *p, ViewTitleSort titleSort,
+                     QMap<int,int> &recidEpisodes, bool insertSorted);
+    void RemoveFromGroups(const QString &piKey);
+    void IndexRecGroup(const ProgramInfo *p);
+    bool RecGroupsChange(const QStringList &keys) const;
+    void UpdateTitleList(void);
     void UpdateUIGroupList(const QStringList &groupPreferences);
     void UpdateUIRecGroupList(void);
 
@@ -403,6 +410,18 @@ class PlaybackBox : public ScheduleCommon
     // Main Recording List support
     QStringList         m_titleList;  ///< list of pages
     ProgramMap          m_progLists;  ///< lists of programs by page
+    /// display names of the pages, by sort key
+    QMap<QString,QString> m_groupNames;
+    /// search rule titles by recordid, for the search pages
+    QMap<int,QString>   m_searchRules;
+    /// ProgramInfoCache generation the lists were built from
+    uint                m_cacheGeneration;
+    /// pages each recording is on, by ProgramInfo key
+    QMap<QString,QStringList> m_keyGroups;
+    /// recording group of each recording, by ProgramInfo key
+    QMap<QString,QString> m_keyRecGroup;
+    /// number of recordings in each recording group
+    QMap<QString,int>   m_recGroupSizes;
     int                 m_progsInDB;  ///< total number of recordings in DB
     bool                m_isFilling;
 
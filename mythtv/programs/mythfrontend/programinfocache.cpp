@@ -14,6 +14,9 @@
 #include "remoteutil.h"
 #include "mythevent.h"
 
+/// Beyond this many changes a full rebuild of the lists is cheaper.
+const int ProgramInfoCache::kMaxChanges = 256;
+
 typedef vector<ProgramInfo*> *VPI_ptr;
 static void free_vec(VPI_ptr &v)
 {
@@ -44,7 +47,8 @@ class ProgramInfoLoader : public QRunnable
 
 ProgramInfoCache::ProgramInfoCache(QObject *o) :
     m_next_cache(NULL), m_listener(o),
-    m_load_is_queued(false), m_loads_in_progress(0)
+    m_load_is_queued(false), m_loads_in_progress(0),
+    m_generation(0), m_reload_generation(0)
 {
 }
 
@@ -135,10 +139,24 @@ void ProgramInfoCache::Refresh(void)
         }
         delete m_next_cache;
         m_next_cache = NULL;
+
+        m_reload_generation = ++m_generation;
+        m_changes.clear();
         return;
     }
     locker.unlock();
 
+    RemoveDeleted();
+}
+
+/** \brief Removes the list items marked for deletion from the cache.
+ *
+ *  \note This must only be called from the UI thread.
+ *  \note All references to the deleted ProgramInfo pointers should be
+ *        cleared before this is called.
+ */
+void ProgramInfoCache::RemoveDeleted(void)
+{
     Cache::iterator it = m_cache.begin();
     Cache::iterator nit = it;
     for (; it != m_cache.end(); it = nit)
@@ -166,7 +184,10 @@ bool ProgramInfoCache::Update(const ProgramInfo &pginfo)
         PICKey(pginfo.GetChanID(),pginfo.GetRecordingStartTime()));
 
     if (it != m_cache.end())
+    {
         it->second->clone(pginfo, true);
+        AddChange(pginfo.GetChanID(), pginfo.GetRecordingStartTime());
+    }
 
     return it != m_cache.end();
 }
@@ -219,6 +240,9 @@ void ProgramInfoCache::Add(const ProgramInfo &pginfo)
 
     PICKey key(pginfo.GetChanID(),pginfo.GetRecordingStartTime());
     m_cache[key] = new ProgramInfo(pginfo);
+
+    QMutexLocker locker(&m_lock);
+    AddChange(pginfo.GetChanID(), pginfo.GetRecordingStartTime());
 }
 
 /** \brief Marks a ProgramInfo in the cache for deletion on the next
@@ -231,11 +255,53 @@ bool ProgramInfoCache::Remove(uint chanid, const QDateTime &recstartts)
     Cache::iterator it = m_cache.find(PICKey(chanid,recstartts));
 
     if (it != m_cache.end())
+    {
         it->second->SetAvailableStatus(asDeleted, "PIC::Remove");
 
+        QMutexLocker locker(&m_lock);
+        AddChange(chanid, recstartts);
+    }
+
     return it != m_cache.end();
 }
 
+/** \brief Returns the generation of the cache, which is incremented on
+ *         every change to the cached programs.
+ */
+uint ProgramInfoCache::GetGeneration(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_generation;
+}
+
+/** \brief Returns the unique keys of the programs added, updated or
+ *         removed since the given generation.
+ *
+ *  \return False if the changes are not known, because the cache was
+ *          reloaded since, or a reload is waiting for Refresh(), or too
+ *          many changes were made. The caller should then start over
+ *          from the whole cache.
+ */
+bool ProgramInfoCache::GetChanges(uint generation, QStringList &keys) const
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_next_cache || (generation < m_reload_generation))
+        return false;
+
+    if (!m_changes.empty() && (m_changes.front().first > generation + 1))
+        return false;
+
+    QList<QPair<uint,QString> >::const_iterator it = m_changes.begin();
+    for (; it != m_changes.end(); ++it)
+    {
+        if ((*it).first > generation && !keys.contains((*it).second))
+            keys.push_back((*it).second);
+    }
+
+    return true;
+}
+
 void ProgramInfoCache::GetOrdered(vector<ProgramInfo*> &list, bool newest_first)
 {
     if (newest_first)
@@ -271,6 +337,17 @@ ProgramInfo *ProgramInfoCache::GetProgramInfo(const QString &piKey) const
     return NULL;
 }
 
+/// Logs a change to a cached program, m_lock must be held when this is called.
+void ProgramInfoCache::AddChange(uint chanid, const QDateTime &recstartts)
+{
+    m_changes.push_back(
+        qMakePair(++m_generation,
+                  ProgramInfo::MakeUniqueKey(chanid, recstartts)));
+
+    while (m_changes.size() > kMaxChanges)
+        m_changes.pop_front();
+}
+
 /// Clears the cache, m_lock must be held when this is called.
 void ProgramInfoCache::Clear(void)
 {
@@ -13,8 +13,11 @@ using namespace std;
 
 // Qt headers
 #include <QWaitCondition>
+#include <QStringList>
 #include <QDateTime>
 #include <QMutex>
+#include <QList>
+#include <QPair>
 
 class ProgramInfoLoader;
 class ProgramInfo;
@@ -33,6 +36,9 @@ class ProgramInfoCache
 
     // All the following public methods must only be called from the UI Thread.
     void Refresh(void);
+    void RemoveDeleted(void);
+    uint GetGeneration(void) const;
+    bool GetChanges(uint generation, QStringList &keys) const;
     void Add(const ProgramInfo&);
     bool Remove(uint chanid, const QDateTime &recstartts);
     bool Update(const ProgramInfo&);
@@ -48,6 +54,7 @@ class ProgramInfoCache
   private:
     void Load(const bool updateUI = true);
     void Clear(void);
+    void AddChange(uint chanid, const QDateTime &recstartts);
 
   private:
     class PICKey
@@ -77,6 +84,15 @@ class ProgramInfoCache
     bool                    m_load_is_queued;
     uint                    m_loads_in_progress;
     mutable QWaitCondition  m_load_wait;
+
+    /// Incremented on every change to the cached programs
+    uint                    m_generation;
+    /// Generation of the last reload, older changes are not logged
+    uint                    m_reload_generation;
+    /// Unique keys of the changed programs, by generation
+    QList<QPair<uint,QString> > m_changes;
+
+    static const int        kMaxChanges;
 };
 
 #endif // _PROGRAM_INFO_CACHE_H_
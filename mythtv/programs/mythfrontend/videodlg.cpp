@@ -2425,6 +2425,7 @@ void VideoDialog::DisplayMenu()
     MythMenu *menu = new MythMenu(label, this, "display");
 
     menu->AddItem(tr("Scan For Changes"), SLOT(doVideoScan()));
+    menu->AddItem(tr("Rescan All Directories"), SLOT(doFullVideoScan()));
     menu->AddItem(tr("Retrieve All Details"), SLOT(VideoAutoSearch()));
     menu->AddItem(tr("Filter Display"), SLOT(ChangeFilter()));
     menu->AddItem(tr("Browse By..."), NULL, CreateMetadataBrowseMenu());
@@ -3744,11 +3745,25 @@ void VideoDialog::OnVideoSearchDone(MetadataLookup *lookup)
 }
 
 void VideoDialog::doVideoScan()
+{
+    StartVideoScan(false);
+}
+
+/** \fn VideoDialog::doFullVideoScan()
+ *  \brief Scans every video directory, including those the directory
+ *         index considers unchanged.
+ */
+void VideoDialog::doFullVideoScan()
+{
+    StartVideoScan(true);
+}
+
+void VideoDialog::StartVideoScan(bool fullRescan)
 {
     if (!m_d->m_scanner)
         m_d->m_scanner = new VideoScanner();
     connect(m_d->m_scanner, SIGNAL(finished(bool)), SLOT(scanFinished(bool)));
-    m_d->m_scanner->doScan(GetVideoDirs());
+    m_d->m_scanner->doScan(GetVideoDirs(), fullRescan);
 }
 
 void VideoDialog::PromptToScan()
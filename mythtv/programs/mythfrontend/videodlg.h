@@ -133,6 +133,7 @@ class VideoDialog : public MythScreenType
     void OnVideoSearchListSelection(MetadataLookup *lookup);
 
     void doVideoScan();
+    void doFullVideoScan();
 
   protected slots:
     void scanFinished(bool);
@@ -174,6 +175,8 @@ class VideoDialog : public MythScreenType
 
     void SavePosition(void);
 
+    void StartVideoScan(bool fullRescan);
+
   private slots:
 
     void OnVideoImageSetDone(VideoMetadata *metadata);
@@ -76,6 +76,19 @@ HostCheckBox *VideoAggressivePC()
     return gc;
 }
 
+HostSpinBox *VideoScanFullRescanDays()
+{
+    HostSpinBox *gc = new HostSpinBox("VideoScanFullRescanDays", 0, 90, 1);
+    gc->setLabel(QObject::tr("Days between full video rescans"));
+    gc->setValue(7);
+    gc->setHelpText(QObject::tr("Scans only look into directories that "
+                    "changed since the last scan. After this many days every "
+                    "directory is scanned again, in case a change was "
+                    "missed. Set to 0 to never rescan everything "
+                    "automatically."));
+    return gc;
+}
+
 HostLineEdit *VideoStartupDirectory()
 {
     HostLineEdit *gc = new HostLineEdit("VideoStartupDir");
@@ -284,6 +297,7 @@ VideoGeneralSettings::VideoGeneralSettings()
     VConfigPage page2(pages, false);
     page2->addChild(SetOnInsertDVD());
     page2->addChild(VideoTreeRemember());
+    page2->addChild(VideoScanFullRescanDays());
 
     // page 3
     VerticalConfigurationGroup *pctrl =
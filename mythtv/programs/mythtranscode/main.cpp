@@ -22,6 +22,7 @@ using namespace std;
 #include "mythdate.h"
 #include "transcode.h"
 #include "mpeg2fix.h"
+#include "smartcut.h"
 #include "remotefile.h"
 #include "mythtranslation.h"
 #include "mythlogging.h"
@@ -641,7 +642,14 @@ int main(int argc, char *argv[])
         }
         else
         {
-            result = m2f->Start();
+            if (SmartCut::CanCut(infile))
+            {
+                SmartCut sc(infile, outfile, &deleteMap, showprogress, otype,
+                            update_func, check_func);
+                result = sc.Start();
+            }
+            else
+                result = m2f->Start();
             if (result == REENCODE_OK)
             {
                 result = BuildKeyframeIndex(m2f, outfile, posMap, jobID);
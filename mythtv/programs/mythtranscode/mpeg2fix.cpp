@@ -11,7 +11,9 @@
 #include <unistd.h>
 #include <getopt.h>
 #include <stdint.h>
+#include <errno.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 
 #include "config.h"
 #include "mpeg2fix.h"
@@ -37,6 +39,16 @@
 
 #define ATTR_ALIGN(align) __attribute__ ((__aligned__ (align)))
 
+// Seconds of the stream the replex ring buffers are sized to hold
+static const int kReplexBufferSecs = 5;
+
+static int64_t now_usecs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 static void *my_malloc(unsigned size, mpeg2_alloc_t reason)
 {
     (void)reason;
@@ -424,10 +436,10 @@ int MPEG2fixup::FindMPEG2Header(uint8_t *buf, int size, uint8_t code)
     return 0;
 }
 
-//fill_buffers will signal the main thread to start decoding again as soon
-//as it runs out of buffers.  It will then wait for the buffer to completely
-//fill before returning.  In this way, the 2 threads are never running
-// concurrently
+//fill_buffers is called by the multiplexer when it runs out of frames.  It
+//waits until the fixup thread has queued at least one frame of each stream.
+//The two threads otherwise run concurrently, each only waking the other
+//when it is waiting on it.
 static int fill_buffers(void *r, int finish)
 {
     MPEG2replex *rx = (MPEG2replex *)r;
@@ -438,9 +450,19 @@ static int fill_buffers(void *r, int finish)
     return (rx->WaitBuffers());
 }
 
+static int write_out(void *r, uint8_t *buf, int len)
+{
+    MPEG2replex *rx = (MPEG2replex *)r;
+
+    return (rx->WriteOut(buf, len));
+}
+
 MPEG2replex::MPEG2replex() :
     done(0),      otype(0),
-    ext_count(0), mplex(0)
+    ext_count(0), waiting(0),
+    adding(0),    wait_time(0),
+    add_wait_time(0), write_time(0),
+    bytes_written(0), mplex(0)
 {
     memset(&vrbuf, 0, sizeof(vrbuf));
     memset(extrbuf, 0, sizeof(extrbuf));
@@ -468,9 +490,12 @@ MPEG2replex::~MPEG2replex()
     }
 }
 
+// Called by the multiplexer, with mutex held
 int MPEG2replex::WaitBuffers()
 {
-    pthread_mutex_lock( &mutex );
+    int64_t start = now_usecs();
+
+    waiting = 1;
     while (1)
     {
         int i, ok = 1;
@@ -485,20 +510,55 @@ int MPEG2replex::WaitBuffers()
         if (ok || done)
             break;
 
-        pthread_cond_signal(&cond);
+        pthread_cond_broadcast(&cond);
         pthread_cond_wait(&cond, &mutex);
     }
-    pthread_mutex_unlock(&mutex);
+    waiting = 0;
+
+    wait_time += now_usecs() - start;
 
     if (done)
     {
         finish_mpg(mplex);
+        close(mplex->fd_out);
+        pthread_mutex_unlock(&mutex);
         pthread_exit(NULL);
     }
 
     return 0;
 }
 
+// Called by the multiplexer, with mutex held, for each batch of packs.
+// The mutex is let go while writing so the fixup thread can carry on.
+int MPEG2replex::WriteOut(uint8_t *buf, int len)
+{
+    if (adding)
+        pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+
+    int64_t start = now_usecs();
+    int left = len;
+    while (left > 0)
+    {
+        int ret = write(mplex->fd_out, buf, left);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, QString("Replex: write failed") + ENO);
+            break;
+        }
+        buf += ret;
+        left -= ret;
+    }
+
+    pthread_mutex_lock(&mutex);
+    write_time += now_usecs() - start;
+    bytes_written += len - left;
+
+    return len - left;
+}
+
 void *MPEG2fixup::ReplexStart(void *data)
 {
     MThread::ThreadSetup("MPEG2Replex");
@@ -534,38 +594,51 @@ void MPEG2replex::Start()
     fd_out = open(outfile.toLocal8Bit().constData(),
                   O_WRONLY | O_CREAT | O_TRUNC | O_LARGEFILE, 0644);
 
-    //await buffer fill
+    //let the constructor carry on, then await the first frame
     pthread_mutex_lock(&mutex);
-    pthread_cond_signal(&cond);
-    pthread_cond_wait(&cond, &mutex);
-    pthread_mutex_unlock(&mutex);
+    pthread_cond_broadcast(&cond);
+    while (!done && ring_avail(&index_vrbuf) < sizeof(index_unit))
+        pthread_cond_wait(&cond, &mutex);
 
     mplex = &mx;
 
     init_multiplex(&mx, &seq_head, extframe, exttype, exttypcnt,
                    video_delay, audio_delay, fd_out, fill_buffers,
                    &vrbuf, &index_vrbuf, extrbuf, index_extrbuf, otype);
+    mx.write_out = write_out;
     setup_multiplex(&mx);
 
+    // The ring buffers are only touched with mutex held, WaitBuffers()
+    // and WriteOut() let go of it while they wait.
     while (1)
     {
         check_times( &mx, &video_ok, ext_ok, &start);
         write_out_packs( &mx, video_ok, ext_ok);
+
+        if (adding)
+            pthread_cond_broadcast(&cond);
     }
 }
 
-#define INDEX_BUF (sizeof(index_unit) * 200)
 void MPEG2fixup::InitReplex()
 {
     // index_vrbuf contains index_units which describe a video frame
     //   it also contains the start pos of the next frame
     // index_arbuf only uses, pts, framesize, length, start, (active, err)
 
-    //this should support > 100 frames
-    uint32_t memsize = vFrame.first()->mpeg2_seq.width *
-                       vFrame.first()->mpeg2_seq.height * 10;
-    ring_init(&rx.vrbuf, memsize);
-    ring_init(&rx.index_vrbuf, INDEX_BUF);
+    // Size the buffers to hold kReplexBufferSecs of each stream at its
+    // peak rate, so the fixup and replex threads seldom wait on each other
+    const mpeg2_sequence_t &seq = vFrame.first()->mpeg2_seq;
+    uint32_t fps = seq.frame_period ? 27000000 / seq.frame_period : 30;
+    uint64_t vsize = (uint64_t)seq.byte_rate * kReplexBufferSecs;
+    vsize = qMax(vsize, (uint64_t)seq.width * seq.height * 2);
+    vsize = qMin(vsize, (uint64_t)32 * 1024 * 1024);
+    uint32_t vunits = qMax(fps * kReplexBufferSecs + 100, (uint32_t)200);
+    ring_init(&rx.vrbuf, vsize);
+    ring_init(&rx.index_vrbuf, sizeof(index_unit) * vunits);
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Replex video buffer %1 kB, %2 frames")
+            .arg(vsize / 1024).arg(vunits));
 
     memset(rx.exttype, 0, sizeof(rx.exttype));
     memset(rx.exttypcnt, 0, sizeof(rx.exttypcnt));
@@ -577,8 +650,13 @@ void MPEG2fixup::InitReplex()
             av_dict_get(inputFC->streams[it.key()]->metadata,
                         "language", NULL, 0);
         char *lang = metatag ? metatag->value : (char *)"";
-        ring_init(&rx.extrbuf[i], memsize / 5);
-        ring_init(&rx.index_extrbuf[i], INDEX_BUF);
+        uint32_t bit_rate = getCodecContext(it.key())->bit_rate;
+        uint32_t framesize = qMax((*it)->first()->pkt.size, 1);
+        uint32_t asize = qMax(bit_rate / 8 * kReplexBufferSecs,
+                              (uint32_t)256 * 1024);
+        uint32_t aunits = qMax(asize / framesize + 100, (uint32_t)200);
+        ring_init(&rx.extrbuf[i], asize);
+        ring_init(&rx.index_extrbuf[i], sizeof(index_unit) * aunits);
         rx.extframe[i].set = 1;
         rx.extframe[i].bit_rate = getCodecContext(it.key())->bit_rate;
         rx.extframe[i].framesize = (*it)->first()->pkt.size;
@@ -663,20 +741,26 @@ int MPEG2fixup::AddFrame(MPEG2frame *f)
     pthread_mutex_lock( &rx.mutex );
 
     FrameInfo(f);
+    int64_t start = now_usecs();
     while (ring_free(rb) < (unsigned int)f->pkt.size ||
             ring_free(rbi) < sizeof(index_unit))
     {
         int i, ok = 1;
 
-        if (rbi != &rx.index_vrbuf &&
-                ring_avail(&rx.index_vrbuf) < sizeof(index_unit))
-            ok = 0;
-
-        for (i = 0; i < ext_count; i++)
-            if (rbi != &rx.index_extrbuf[i] &&
-                    ring_avail(&rx.index_extrbuf[i]) < sizeof(index_unit))
+        // Only a multiplexer waiting on another stream can't make room,
+        // otherwise it is still working through what it has
+        if (rx.waiting)
+        {
+            if (rbi != &rx.index_vrbuf &&
+                    ring_avail(&rx.index_vrbuf) < sizeof(index_unit))
                 ok = 0;
 
+            for (i = 0; i < ext_count; i++)
+                if (rbi != &rx.index_extrbuf[i] &&
+                        ring_avail(&rx.index_extrbuf[i]) < sizeof(index_unit))
+                    ok = 0;
+        }
+
         if (!ok && ring_free(rb) < (unsigned int)f->pkt.size &&
                     ring_free(rbi) >= sizeof(index_unit))
         {
@@ -699,11 +783,14 @@ int MPEG2fixup::AddFrame(MPEG2frame *f)
             return 1;
         }
 
-        pthread_cond_signal(&rx.cond);
+        rx.adding = 1;
+        pthread_cond_broadcast(&rx.cond);
         pthread_cond_wait(&rx.cond, &rx.mutex);
+        rx.adding = 0;
 
         FrameInfo(f);
     }
+    rx.add_wait_time += now_usecs() - start;
 
     if (ring_write(rb, f->pkt.data, f->pkt.size)<0){
         pthread_mutex_unlock( &rx.mutex );
@@ -718,6 +805,8 @@ int MPEG2fixup::AddFrame(MPEG2frame *f)
             QString("Ring buffer overflow %1").arg(rbi->size));
         return 1;
     }
+    if (rx.waiting)
+        pthread_cond_broadcast(&rx.cond);
     pthread_mutex_unlock(&rx.mutex);
     last_written_pos = f->pkt.pos;
     return 0;
@@ -1906,6 +1995,7 @@ int MPEG2fixup::Start()
     int new_discard_state = 0;
     int ret;
     QMap<int, int> af_dlta_cnt, cutState;
+    int64_t startTime = now_usecs();
 
     AVPacket pkt, lastRealvPkt;
 
@@ -2485,12 +2575,27 @@ int MPEG2fixup::Start()
         }
     }
 
-    rx.done = 1;
     pthread_mutex_lock( &rx.mutex );
-    pthread_cond_signal(&rx.cond);
+    rx.done = 1;
+    pthread_cond_broadcast(&rx.cond);
     pthread_mutex_unlock( &rx.mutex );
     pthread_join(thread, NULL);
 
+    // Compare the remux rate with the rate the disk took the writes at
+    double elapsed = (now_usecs() - startTime) / 1000000.0;
+    double written = rx.bytes_written / (1024.0 * 1024.0);
+    double writeTime = rx.write_time / 1000000.0;
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Remuxed %1 MB in %2s (%3 MB/s), writing took %4s "
+                "(%5 MB/s). Replex waited %6s for frames, fixup waited "
+                "%7s for buffer space")
+            .arg(written, 0, 'f', 1).arg(elapsed, 0, 'f', 1)
+            .arg(elapsed > 0 ? written / elapsed : 0.0, 0, 'f', 1)
+            .arg(writeTime, 0, 'f', 1)
+            .arg(writeTime > 0 ? written / writeTime : 0.0, 0, 'f', 1)
+            .arg(rx.wait_time / 1000000.0, 0, 'f', 1)
+            .arg(rx.add_wait_time / 1000000.0, 0, 'f', 1));
+
     avformat_close_input(&inputFC);
     inputFC = NULL;
     return REENCODE_OK;
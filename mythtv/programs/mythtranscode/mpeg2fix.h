@@ -110,6 +110,7 @@ class MPEG2replex
     ~MPEG2replex();
     void Start();
     int WaitBuffers();
+    int WriteOut(uint8_t *buf, int len);
     int done;
     QString outfile;
     int otype;
@@ -123,9 +124,17 @@ class MPEG2replex
 
     pthread_mutex_t mutex;
     pthread_cond_t cond;
+    int waiting;  ///< the multiplexer is waiting for frames
+    int adding;   ///< AddFrame() is waiting for room
     audio_frame_t extframe[N_AUDIO];
     sequence_t seq_head;
 
+    // usecs, for the summary at the end
+    int64_t wait_time;
+    int64_t add_wait_time;
+    int64_t write_time;
+    int64_t bytes_written;
+
   private:
     multiplex_t *mplex;
 };
@@ -1,4 +1,5 @@
 #include <unistd.h>
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -6,6 +7,51 @@
 #include "ts.h"
 #include "mythlogging.h"
 
+static void write_all(multiplex_t *mx, uint8_t *buf, int len)
+{
+	int ret;
+
+	if (mx->write_out) {
+		mx->write_out(mx->priv, buf, len);
+		return;
+	}
+
+	while (len > 0) {
+		ret = write(mx->fd_out, buf, len);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0) {
+			LOG(VB_GENERAL, LOG_ERR, "multiplex: write failed");
+			return;
+		}
+		buf += ret;
+		len -= ret;
+	}
+}
+
+void flush_out(multiplex_t *mx)
+{
+	if (!mx->out_len)
+		return;
+
+	write_all(mx, mx->out_buf, mx->out_len);
+	mx->out_len = 0;
+}
+
+static void mx_write(multiplex_t *mx, uint8_t *buf, int len)
+{
+	if (mx->out_len + len > mx->out_size)
+		flush_out(mx);
+
+	if (len > mx->out_size) {
+		write_all(mx, buf, len);
+		return;
+	}
+
+	memcpy(mx->out_buf + mx->out_len, buf, len);
+	mx->out_len += len;
+}
+
 static int buffers_filled(multiplex_t *mx)
 {
 	int vavail=0, aavail=0, i;
@@ -200,12 +246,12 @@ static void writeout_video(multiplex_t *mx)
 	    viu->frame == I_FRAME){
 		if (!mx->startup && mx->is_ts){
 			write_ts_patpmt(mx->ext, mx->extcnt, 1, outbuf);
-			write(mx->fd_out, outbuf, mx->pack_size*2);
+			mx_write(mx, outbuf, mx->pack_size*2);
 			ptsinc(&mx->SCR, mx->SCRinc*2);
 		} else if (!mx->startup && mx->navpack){
 			write_nav_pack(mx->pack_size, mx->extcnt, 
 				       mx->SCR, mx->muxr, outbuf);
-			write(mx->fd_out, outbuf, mx->pack_size);
+			mx_write(mx, outbuf, mx->pack_size);
 			ptsinc(&mx->SCR, mx->SCRinc);
 		} else mx->startup = 0;
 #ifdef OUT_DEBUG
@@ -295,7 +341,7 @@ static void writeout_video(multiplex_t *mx)
 	//estimate next pts based on bitrate of this stream and data written
 	viu->dts = uptsdiff(viu->dts + ((nlength*viu->ptsrate)>>8), 0);
 
-	write(mx->fd_out, outbuf, written);
+	mx_write(mx, outbuf, written);
 
 #ifdef OUT_DEBUG
 	LOG(VB_GENERAL, LOG_DEBUG, "VPTS");
@@ -439,7 +485,7 @@ static void writeout_ext(multiplex_t *mx, int n)
 		return;
 
 	length -= nlength;
-	write(mx->fd_out, outbuf, written);
+	mx_write(mx, outbuf, written);
 
 	dummy_add(dbuf, dpts, aiu->length-length);
 	aiu->length = length;
@@ -476,7 +522,7 @@ static void writeout_padding (multiplex_t *mx)
 
 	write_padding_pes( mx->pack_size, mx->extcnt, mx->SCR, 
 			   mx->muxr, outbuf);
-	write(mx->fd_out, outbuf, mx->pack_size);
+	mx_write(mx, outbuf, mx->pack_size);
 }
 
 void check_times( multiplex_t *mx, int *video_ok, int *ext_ok, int *start)
@@ -635,7 +681,12 @@ void finish_mpg(multiplex_t *mx)
 	}
 	
 	if (mx->otype == REPLEX_MPEG2)
-		write(mx->fd_out, mpeg_end,4);
+		mx_write(mx, mpeg_end,4);
+
+	flush_out(mx);
+	free(mx->out_buf);
+	mx->out_buf = NULL;
+	mx->out_size = 0;
 
 	dummy_destroy(&mx->vdbuf);
 	for (i=0; i<mx->extcnt;i++)
@@ -685,6 +736,11 @@ void init_multiplex( multiplex_t *mx, sequence_t *seq_head,
 	uint32_t data_rate;
 
 	mx->fill_buffers = fill_buffers;
+	mx->write_out = NULL;
+	mx->out_len = 0;
+	mx->out_size = 0;
+	if ((mx->out_buf = (uint8_t *) malloc(MX_OUTBUF_SIZE)))
+		mx->out_size = MX_OUTBUF_SIZE;
 	mx->video_delay = video_delay;
 	mx->audio_delay = audio_delay;
 	mx->fd_out = fd;
@@ -855,14 +911,14 @@ void setup_multiplex(multiplex_t *mx)
 	if (mx->is_ts) {
 		uint8_t outbuf[2048];
 		write_ts_patpmt(mx->ext, mx->extcnt, 1, outbuf);
-		write(mx->fd_out, outbuf, mx->pack_size*2);
+		mx_write(mx, outbuf, mx->pack_size*2);
 		ptsinc(&mx->SCR, mx->SCRinc*2);
 		mx->startup = 1;
 	} else if (mx->navpack){
 		uint8_t outbuf[2048];
 		write_nav_pack(mx->pack_size, mx->extcnt, 
 			       mx->SCR, mx->muxr, outbuf);
-		write(mx->fd_out, outbuf, mx->pack_size);
+		mx_write(mx, outbuf, mx->pack_size);
 		ptsinc(&mx->SCR, mx->SCRinc);
 		mx->startup = 1;
 	} else mx->startup = 0;
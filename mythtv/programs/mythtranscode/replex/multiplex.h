@@ -81,11 +81,20 @@ typedef struct multiplex_s{
 
 	int (*fill_buffers)(void *p, int f);
 	void *priv;
+
+	// packs are collected here and written out a batch at a time,
+	// through write_out if it is set
+#define MX_OUTBUF_SIZE (1024*1024)
+	uint8_t *out_buf;
+	int out_len;
+	int out_size;
+	int (*write_out)(void *p, uint8_t *buf, int len);
 } multiplex_t;
 
 void check_times( multiplex_t *mx, int *video_ok, int *ext_ok, int *start);
 void write_out_packs( multiplex_t *mx, int video_ok, int *ext_ok);
 void finish_mpg(multiplex_t *mx);
+void flush_out(multiplex_t *mx);
 void init_multiplex( multiplex_t *mx, sequence_t *seq_head,
 		     audio_frame_t *extframe, int *exttype, int *exttypcnt,
 		     uint64_t video_delay, uint64_t audio_delay, int fd,
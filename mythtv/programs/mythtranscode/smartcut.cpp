@@ -0,0 +1,973 @@
+// C++
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+using namespace std;
+
+// Qt
+#include <QFileInfo>
+#include <QtAlgorithms>
+#include <QPair>
+
+// MythTV
+#include "config.h"
+#include "smartcut.h"
+#include "exitcodes.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+
+extern "C" {
+#include "libavutil/opt.h"
+#include "replex/multiplex.h"
+}
+
+#define LOC QString("SmartCut: ")
+
+SmartCut::SmartCut(const QString &inf, const QString &outf,
+                   frm_dir_map_t *deleteMap, bool showprog, int otype,
+                   void (*update_func)(float), int (*check_func)()) :
+    m_infile(inf), m_outfile(outf), m_otype(otype),
+    m_inputFC(NULL), m_outputFC(NULL), m_vid_id(-1),
+    m_frameDuration(0), m_dtsDelay(0), m_lastDts((int64_t)AV_NOPTS_VALUE),
+    m_canEncode(false), m_reencoded(0),
+    m_showprogress(showprog), m_update_status(update_func),
+    m_check_abort(check_func), m_status_update_time(5), m_filesize(0)
+{
+    if (deleteMap)
+        m_delMap = *deleteMap;
+
+    av_register_all();
+
+    if (m_showprogress || m_update_status)
+    {
+        if (m_update_status)
+        {
+            m_status_update_time = 20;
+            m_update_status(0);
+        }
+        m_statustime = MythDate::current();
+        m_statustime = m_statustime.addSecs(m_status_update_time);
+
+        const QFileInfo finfo(inf);
+        m_filesize = finfo.size();
+    }
+}
+
+SmartCut::~SmartCut()
+{
+    CloseAV();
+}
+
+/** \fn SmartCut::CanCut(const QString&)
+ *  \brief Returns true if inf should be cut by SmartCut rather than
+ *         MPEG2fixup, i.e. if its video is H.264.
+ */
+bool SmartCut::CanCut(const QString &inf)
+{
+    av_register_all();
+
+    AVFormatContext *fc = NULL;
+    QByteArray fname = inf.toLocal8Bit();
+    if (avformat_open_input(&fc, fname.constData(), NULL, NULL) < 0)
+        return false;
+
+    bool ok = false;
+    if (avformat_find_stream_info(fc, NULL) >= 0)
+    {
+        for (uint i = 0; i < fc->nb_streams; i++)
+        {
+            if (fc->streams[i]->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+            {
+                ok = fc->streams[i]->codec->codec_id == CODEC_ID_H264;
+                break;
+            }
+        }
+    }
+
+    avformat_close_input(&fc);
+    return ok;
+}
+
+/** \fn SmartCut::OutputFormat(int)
+ *  \brief Returns the libavformat muxer for a REPLEX_* output type, or
+ *         NULL if the output type can't carry H.264.
+ */
+const char *SmartCut::OutputFormat(int otype)
+{
+    switch (otype)
+    {
+        case REPLEX_MPEG2:
+        case REPLEX_HDTV:
+            return "mpeg";
+        case REPLEX_TS_SD:
+        case REPLEX_TS_HD:
+            return "mpegts";
+        default:
+            return NULL;
+    }
+}
+
+int SmartCut::Start(void)
+{
+    if (!OutputFormat(m_otype))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "DVD output can't carry H.264 video, "
+            "use a program or transport stream (--ostream ts)");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    if (!OpenInput())
+        return GENERIC_EXIT_NOT_OK;
+
+    int ret = ScanFrames();
+    if (ret != REENCODE_OK)
+        return ret;
+
+    AVCodecContext *enc = OpenEncoder(false, true);
+    m_canEncode = (enc != NULL);
+    if (enc)
+    {
+        avcodec_close(enc);
+        av_free(enc);
+    }
+    else
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + "No encoder for the video, "
+            "cuts will be rounded out to whole GOPs");
+    }
+
+    PlanCuts();
+
+    // Second pass, from the top
+    avformat_close_input(&m_inputFC);
+    if (!OpenInput() || !OpenOutput())
+    {
+        CloseAV();
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    ret = WriteOutput();
+    CloseAV();
+    return ret;
+}
+
+bool SmartCut::OpenInput(void)
+{
+    QByteArray fname = m_infile.toLocal8Bit();
+    if (avformat_open_input(&m_inputFC, fname.constData(), NULL, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open input file '%1'").arg(m_infile));
+        m_inputFC = NULL;
+        return false;
+    }
+
+    if (avformat_find_stream_info(m_inputFC, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't get stream info for '%1'").arg(m_infile));
+        avformat_close_input(&m_inputFC);
+        return false;
+    }
+
+    m_vid_id = -1;
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        if (m_inputFC->streams[i]->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+            m_vid_id = i;
+            break;
+        }
+    }
+
+    if (m_vid_id < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No video stream found");
+        avformat_close_input(&m_inputFC);
+        return false;
+    }
+
+    m_last_ts.clear();
+    return true;
+}
+
+bool SmartCut::OpenOutput(void)
+{
+    QByteArray fname = m_outfile.toLocal8Bit();
+    if (avformat_alloc_output_context2(&m_outputFC, NULL,
+                                       OutputFormat(m_otype),
+                                       fname.constData()) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't create the output context");
+        m_outputFC = NULL;
+        return false;
+    }
+
+    AVStream *ist = m_inputFC->streams[m_vid_id];
+    AVStream *ost = avformat_new_stream(m_outputFC, NULL);
+    if (!ost || avcodec_copy_context(ost->codec, ist->codec) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't create the video stream");
+        return false;
+    }
+    ost->codec->codec_tag = 0;
+    ost->sample_aspect_ratio = ist->sample_aspect_ratio;
+    ost->r_frame_rate = ist->r_frame_rate;
+    ost->time_base = ist->time_base;
+
+    m_aud_map.clear();
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVCodecContext *codec = m_inputFC->streams[i]->codec;
+        if (codec->codec_type != AVMEDIA_TYPE_AUDIO || !codec->channels)
+            continue;
+
+        ost = avformat_new_stream(m_outputFC, NULL);
+        if (!ost || avcodec_copy_context(ost->codec, codec) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't create an audio stream");
+            return false;
+        }
+        ost->codec->codec_tag = 0;
+        ost->time_base = m_inputFC->streams[i]->time_base;
+        m_aud_map[i] = ost->index;
+    }
+
+    if (avio_open(&m_outputFC->pb, fname.constData(), AVIO_FLAG_WRITE) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open output file '%1'").arg(m_outfile));
+        return false;
+    }
+
+    if (avformat_write_header(m_outputFC, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't write the output header");
+        return false;
+    }
+
+    return true;
+}
+
+void SmartCut::CloseAV(void)
+{
+    if (m_inputFC)
+        avformat_close_input(&m_inputFC);
+
+    if (m_outputFC)
+    {
+        if (m_outputFC->pb)
+            avio_close(m_outputFC->pb);
+        avformat_free_context(m_outputFC);
+        m_outputFC = NULL;
+    }
+}
+
+/** \fn SmartCut::Unwrap(int, int64_t)
+ *  \brief Returns ts with any timestamp wrap around undone, relative to
+ *         the last timestamp seen on the stream.
+ *
+ *  The first timestamp of a stream is taken relative to the first video
+ *  frame, so streams that start on either side of a wrap agree.
+ */
+int64_t SmartCut::Unwrap(int stream, int64_t ts)
+{
+    AVStream *st = m_inputFC->streams[stream];
+    int64_t wrap = 1LL << st->pts_wrap_bits;
+
+    int64_t last = ts;
+    QMap<int, int64_t>::const_iterator it = m_last_ts.find(stream);
+    if (it != m_last_ts.end())
+        last = *it;
+    else if (!m_frames.empty())
+        last = av_rescale_q(m_frames[0].dts,
+                            m_inputFC->streams[m_vid_id]->time_base,
+                            st->time_base);
+
+    ts += llround((double)(last - ts) / wrap) * wrap;
+    m_last_ts[stream] = ts;
+    return ts;
+}
+
+bool SmartCut::UpdateProgress(const AVPacket &pkt, float base, float scale)
+{
+    if (!(m_showprogress || m_update_status) ||
+        MythDate::current() <= m_statustime)
+        return true;
+
+    float percent_done = base;
+    if (m_filesize && pkt.pos > 0)
+        percent_done += scale * pkt.pos / m_filesize;
+    if (m_update_status)
+        m_update_status(percent_done);
+    if (m_showprogress)
+        LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                .arg(percent_done, 0, 'f', 1));
+    if (m_check_abort && m_check_abort())
+        return false;
+    m_statustime = MythDate::current();
+    m_statustime = m_statustime.addSecs(m_status_update_time);
+    return true;
+}
+
+/** \fn SmartCut::ScanFrames(void)
+ *  \brief First pass, numbers the video frames and splits them into GOPs
+ *         from the packet headers alone.
+ */
+int SmartCut::ScanFrames(void)
+{
+    AVStream *ist = m_inputFC->streams[m_vid_id];
+    int64_t wrap = 1LL << ist->pts_wrap_bits;
+
+    m_frames.clear();
+    m_gopStart.clear();
+    m_dtsDelay = 0;
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    while (av_read_frame(m_inputFC, &pkt) >= 0)
+    {
+        if (pkt.stream_index != m_vid_id)
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        int64_t pts = (pkt.pts != (int64_t)AV_NOPTS_VALUE) ? pkt.pts : pkt.dts;
+        int64_t dts = (pkt.dts != (int64_t)AV_NOPTS_VALUE) ? pkt.dts : pkt.pts;
+        if (pts == (int64_t)AV_NOPTS_VALUE)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Video frame %1 has no timestamp")
+                    .arg(m_frames.size()));
+            av_free_packet(&pkt);
+            return GENERIC_EXIT_NOT_OK;
+        }
+
+        FrameInfo frame;
+        frame.rawpts = pkt.pts;
+        frame.dts = Unwrap(m_vid_id, dts);
+        // pts is a little ahead of dts, so it can wrap on its own
+        int64_t delta = (pts - dts) % wrap;
+        if (delta > wrap / 2)
+            delta -= wrap;
+        else if (delta < -wrap / 2)
+            delta += wrap;
+        frame.pts = frame.dts + delta;
+        frame.keyframe = pkt.flags & AV_PKT_FLAG_KEY;
+
+        if (frame.keyframe)
+        {
+            m_gopStart.push_back(m_frames.size());
+            m_dtsDelay = max(m_dtsDelay, frame.pts - frame.dts);
+        }
+        frame.gop = m_gopStart.size() - 1;
+
+        m_frames.push_back(frame);
+
+        bool ok = UpdateProgress(pkt, 0.0, 30.0);
+        av_free_packet(&pkt);
+        if (!ok)
+            return REENCODE_STOPPED;
+    }
+
+    if (m_gopStart.empty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No keyframes found");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    // Number the frames in display order, the cutlist counts them that way
+    QVector<QPair<int64_t, int> > order;
+    order.reserve(m_frames.size());
+    for (int i = 0; i < m_frames.size(); i++)
+        order.push_back(qMakePair(m_frames[i].pts, i));
+    qSort(order);
+
+    QMap<int64_t, int> durations;
+    for (int i = 0; i < order.size(); i++)
+    {
+        m_frames[order[i].second].display = i;
+        if (i && i < 256)
+            durations[order[i].first - order[i - 1].first]++;
+    }
+
+    // The most common distance between frames, r_frame_rate is the field
+    // rate for some interlaced streams.
+    m_frameDuration = 0;
+    int count = 0;
+    QMap<int64_t, int>::const_iterator it = durations.begin();
+    for (; it != durations.end(); ++it)
+    {
+        if (it.key() > 0 && *it > count)
+        {
+            m_frameDuration = it.key();
+            count = *it;
+        }
+    }
+    if (m_frameDuration <= 0 && ist->r_frame_rate.num && ist->r_frame_rate.den)
+        m_frameDuration = av_rescale_q(1, av_inv_q(ist->r_frame_rate),
+                                       ist->time_base);
+    if (m_frameDuration <= 0)
+        m_frameDuration = 3003;
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("%1 video frames in %2 GOPs, frame duration %3")
+            .arg(m_frames.size()).arg(m_gopStart.size())
+            .arg(m_frameDuration));
+
+    return REENCODE_OK;
+}
+
+/** \fn SmartCut::PlanCuts(void)
+ *  \brief Decides what to do with each GOP and works out the timestamp
+ *         offset of each run of frames that is kept.
+ */
+void SmartCut::PlanCuts(void)
+{
+    int nframes = m_frames.size();
+    int ngops = m_gopStart.size();
+
+    // Same reading of the cutlist as MPEG2fixup
+    QVector<bool> keep(nframes);
+    {
+        frm_dir_map_t delMap = m_delMap;
+        bool discard = false;
+        if (delMap.contains(0))
+        {
+            discard = true;
+            delMap.remove(0);
+        }
+        if (!delMap.empty() && delMap.begin().value() == MARK_CUT_END)
+            discard = true;
+
+        for (int i = 0; i < nframes; i++)
+        {
+            while (!delMap.empty() && delMap.begin().key() <= (uint64_t)i)
+            {
+                discard = delMap.begin().value() == MARK_CUT_START;
+                delMap.erase(delMap.begin());
+            }
+            keep[i] = !discard;
+        }
+    }
+
+    m_gopAction.fill(kGOPDrop, ngops);
+    int copied = 0, reencoded = 0, dropped = 0;
+
+    for (int gop = 0; gop < ngops; gop++)
+    {
+        int first = m_gopStart[gop];
+        int last  = (gop + 1 < ngops) ? m_gopStart[gop + 1] : nframes;
+        int64_t keypts = m_frames[first].pts;
+
+        int kept = 0;
+        bool leading = false;
+        for (int i = first; i < last; i++)
+        {
+            kept += keep[m_frames[i].display];
+            leading |= m_frames[i].pts < keypts;
+        }
+
+        // Frames shown ahead of the keyframe refer back into the previous
+        // GOP, they only decode if it was copied as it is.
+        bool prevIntact = !gop || m_gopAction[gop - 1] == kGOPCopy ||
+                          m_gopAction[gop - 1] == kGOPReencodeLeading;
+
+        GOPAction action;
+        if (!kept)
+            action = kGOPDrop;
+        else if (kept == last - first && (prevIntact || !leading))
+            action = kGOPCopy;
+        else if (kept == last - first)
+            action = m_canEncode ? kGOPReencodeLeading : kGOPCopy;
+        else
+            action = m_canEncode ? kGOPReencode : kGOPCopy;
+        m_gopAction[gop] = action;
+
+        for (int i = first; i < last; i++)
+        {
+            FrameInfo &frame = m_frames[i];
+            if (action == kGOPDrop)
+                frame.emitted = false;
+            else if (action == kGOPReencode)
+                frame.emitted = keep[frame.display];
+            else if (!m_canEncode && !prevIntact && frame.pts < keypts)
+                frame.emitted = false;
+            else
+                frame.emitted = true;
+        }
+
+        if (action == kGOPDrop)
+            dropped++;
+        else if (action == kGOPCopy)
+            copied++;
+        else
+            reencoded++;
+    }
+
+    // Frames before the first keyframe can't be decoded
+    for (int i = 0; i < m_gopStart[0]; i++)
+        m_frames[i].emitted = false;
+
+    // Runs of emitted frames, in display order
+    QVector<int> order(nframes);
+    for (int i = 0; i < nframes; i++)
+        order[m_frames[i].display] = i;
+
+    m_runs.clear();
+    m_runStarts.clear();
+    int64_t initDelay = m_dtsDelay + m_frameDuration;
+    bool inRun = false;
+    for (int d = 0; d < nframes; d++)
+    {
+        FrameInfo &frame = m_frames[order[d]];
+        if (!frame.emitted)
+        {
+            inRun = false;
+            continue;
+        }
+
+        if (!inRun)
+        {
+            Run run;
+            run.start = frame.pts;
+            if (m_runs.empty())
+                run.offset = run.start - initDelay;
+            else
+                run.offset = m_runs.back().offset +
+                             (run.start - m_runs.back().end);
+            m_runs.push_back(run);
+            m_runStarts[run.start] = m_runs.size() - 1;
+            inRun = true;
+        }
+
+        m_runs.back().end = frame.pts + m_frameDuration;
+        frame.run = m_runs.size() - 1;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("%1 GOPs copied, %2 re-encoded, %3 dropped, %4 cuts")
+            .arg(copied).arg(reencoded).arg(dropped)
+            .arg(max(m_runs.size() - 1, 0)));
+}
+
+/** \fn SmartCut::WriteOutput(void)
+ *  \brief Second pass, copies or re-encodes the video as planned and
+ *         writes the audio that goes with it.
+ *
+ *  The packets of the current and previous GOP are held on to, a GOP
+ *  which is re-encoded is decoded from the start of the previous one.
+ */
+int SmartCut::WriteOutput(void)
+{
+    QList<AVPacket> prevGOP, curGOP;
+    int curGop = -1;
+    int vidx = 0;
+    int ret = REENCODE_OK;
+    m_lastDts = (int64_t)AV_NOPTS_VALUE;
+    m_reencoded = 0;
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    while (ret == REENCODE_OK && av_read_frame(m_inputFC, &pkt) >= 0)
+    {
+        if (!UpdateProgress(pkt, 30.0, 70.0))
+        {
+            av_free_packet(&pkt);
+            ret = REENCODE_STOPPED;
+            break;
+        }
+
+        if (pkt.stream_index != m_vid_id)
+        {
+            if (!WriteAudio(pkt))
+                ret = GENERIC_EXIT_WRITE_FRAME_ERROR;
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        if (vidx >= m_frames.size())
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        const FrameInfo &frame = m_frames[vidx++];
+        if (frame.gop != curGop)
+        {
+            if (curGop >= 0 && m_gopAction[curGop] != kGOPDrop &&
+                m_gopAction[curGop] != kGOPCopy)
+            {
+                ret = ReencodeGOP(prevGOP, curGOP, curGop);
+            }
+            FreePackets(prevGOP);
+            prevGOP = curGOP;
+            curGOP.clear();
+            curGop = frame.gop;
+        }
+
+        if (curGop < 0)
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        if (m_gopAction[curGop] == kGOPCopy && frame.emitted &&
+            !WriteVideo(pkt, frame, frame.pts, frame.dts))
+        {
+            ret = GENERIC_EXIT_WRITE_FRAME_ERROR;
+        }
+
+        av_dup_packet(&pkt);
+        curGOP.push_back(pkt);
+        av_init_packet(&pkt);
+    }
+
+    if (ret == REENCODE_OK && curGop >= 0 &&
+        m_gopAction[curGop] != kGOPDrop && m_gopAction[curGop] != kGOPCopy)
+    {
+        ret = ReencodeGOP(prevGOP, curGOP, curGop);
+    }
+
+    FreePackets(prevGOP);
+    FreePackets(curGOP);
+
+    if (ret == REENCODE_OK)
+    {
+        if (av_write_trailer(m_outputFC) < 0)
+            ret = GENERIC_EXIT_WRITE_FRAME_ERROR;
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Done, %1 frames re-encoded").arg(m_reencoded));
+    }
+
+    return ret;
+}
+
+/** \fn SmartCut::OpenEncoder(bool, bool)
+ *  \brief Opens an encoder matching the input video, with no B frames so
+ *         the packets come out in the order the frames go in.
+ */
+AVCodecContext *SmartCut::OpenEncoder(bool interlaced, bool quiet)
+{
+    AVStream *ist = m_inputFC->streams[m_vid_id];
+    AVCodec *codec = avcodec_find_encoder(ist->codec->codec_id);
+    if (!codec)
+        return NULL;
+
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    ctx->width = ist->codec->width;
+    ctx->height = ist->codec->height;
+    ctx->pix_fmt = ist->codec->pix_fmt;
+    ctx->sample_aspect_ratio = ist->codec->sample_aspect_ratio;
+    av_reduce(&ctx->time_base.num, &ctx->time_base.den,
+              m_frameDuration * ist->time_base.num, ist->time_base.den,
+              INT_MAX);
+    ctx->gop_size = 600;
+    ctx->max_b_frames = 0;
+    if (interlaced)
+        ctx->flags |= CODEC_FLAG_INTERLACED_DCT | CODEC_FLAG_INTERLACED_ME;
+
+    if (ist->codec->codec_id == CODEC_ID_H264)
+    {
+        ctx->bit_rate = 0;
+        av_opt_set(ctx->priv_data, "preset", "fast", 0);
+        av_opt_set(ctx->priv_data, "crf", "18", 0);
+    }
+    else
+    {
+        ctx->flags |= CODEC_FLAG_QSCALE;
+        ctx->global_quality = FF_QP2LAMBDA * 2;
+    }
+
+    if (avcodec_open2(ctx, codec, NULL) < 0)
+    {
+        if (!quiet)
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open the video encoder");
+        av_free(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+/** \fn SmartCut::ReencodeGOP(const QList<AVPacket>&,
+ *                            const QList<AVPacket>&, int)
+ *  \brief Decodes a GOP, and the one before it for the frames it refers
+ *         back to, and writes the kept frames encoded again.
+ *
+ *  For kGOPReencodeLeading only the frames shown ahead of the keyframe
+ *  are encoded, the rest of the GOP is then copied as it is.
+ */
+int SmartCut::ReencodeGOP(const QList<AVPacket> &prevGOP,
+                          const QList<AVPacket> &curGOP, int gop)
+{
+    AVStream *ist = m_inputFC->streams[m_vid_id];
+    bool leadingOnly = m_gopAction[gop] == kGOPReencodeLeading;
+    int first = m_gopStart[gop];
+    int64_t keypts = m_frames[first].pts;
+
+    // The frames to encode, by the pts the decoder hands back
+    QMap<int64_t, int> wanted;
+    for (int i = 0; i < curGOP.size(); i++)
+    {
+        const FrameInfo &frame = m_frames[first + i];
+        if (frame.emitted && (!leadingOnly || frame.pts < keypts))
+            wanted[frame.rawpts] = first + i;
+    }
+
+    AVCodec *dec = avcodec_find_decoder(ist->codec->codec_id);
+    AVCodecContext *dctx = dec ? avcodec_alloc_context3(dec) : NULL;
+    if (!dctx || avcodec_copy_context(dctx, ist->codec) < 0 ||
+        avcodec_open2(dctx, dec, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open the video decoder");
+        av_free(dctx);
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    // display number -> decoded picture
+    QMap<int, AVPicture> pictures;
+    bool interlaced = false, tff = false;
+    AVFrame *picture = avcodec_alloc_frame();
+
+    QList<AVPacket> pkts = prevGOP + curGOP;
+    AVPacket empty;
+    av_init_packet(&empty);
+    empty.data = NULL;
+    empty.size = 0;
+    pkts.push_back(empty);
+
+    for (int i = 0; i < pkts.size(); i++)
+    {
+        AVPacket pkt = pkts[i];
+        int got_picture;
+        do
+        {
+            got_picture = 0;
+            if (avcodec_decode_video2(dctx, picture, &got_picture, &pkt) < 0)
+                break;
+            if (!got_picture)
+                break;
+
+            QMap<int64_t, int>::const_iterator it =
+                wanted.find(picture->pkt_pts);
+            if (it == wanted.end())
+                continue;
+
+            int display = m_frames[*it].display;
+            if (pictures.contains(display))
+                continue;
+
+            if (pictures.empty())
+            {
+                interlaced = picture->interlaced_frame;
+                tff = picture->top_field_first;
+            }
+
+            AVPicture pic;
+            if (avpicture_alloc(&pic, dctx->pix_fmt,
+                                dctx->width, dctx->height) < 0)
+                continue;
+            av_picture_copy(&pic, (AVPicture *)picture, dctx->pix_fmt,
+                            dctx->width, dctx->height);
+            pictures[display] = pic;
+        } while (!pkt.data);   // draining the decoder
+    }
+
+    av_free(picture);
+    avcodec_close(dctx);
+    av_free(dctx);
+
+    if (pictures.size() != wanted.size())
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("GOP %1: only %2 of %3 frames decoded")
+                .arg(gop).arg(pictures.size()).arg(wanted.size()));
+    }
+
+    // display number -> decode index, in display order
+    QMap<int, int> order;
+    QMap<int64_t, int>::const_iterator wit = wanted.begin();
+    for (; wit != wanted.end(); ++wit)
+    {
+        if (pictures.contains(m_frames[*wit].display))
+            order[m_frames[*wit].display] = *wit;
+    }
+    QList<int> frames = order.values();
+
+    int ret = REENCODE_OK;
+    if (!pictures.empty())
+    {
+        AVCodecContext *ectx = OpenEncoder(interlaced, false);
+        if (!ectx)
+            ret = GENERIC_EXIT_NOT_OK;
+
+        AVFrame *frame = avcodec_alloc_frame();
+        int in = 0, out = 0;
+        QMap<int, AVPicture>::const_iterator pit = pictures.begin();
+        while (ectx && ret == REENCODE_OK)
+        {
+            AVFrame *input = NULL;
+            if (pit != pictures.end())
+            {
+                avcodec_get_frame_defaults(frame);
+                for (uint p = 0; p < 4; p++)
+                {
+                    frame->data[p] = (*pit).data[p];
+                    frame->linesize[p] = (*pit).linesize[p];
+                }
+                frame->pts = in++;
+                frame->interlaced_frame = interlaced;
+                frame->top_field_first = tff;
+                input = frame;
+                ++pit;
+            }
+
+            AVPacket pkt;
+            av_init_packet(&pkt);
+            pkt.data = NULL;
+            pkt.size = 0;
+            int got_packet = 0;
+            if (avcodec_encode_video2(ectx, &pkt, input, &got_packet) < 0)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC + "Encoding failed");
+                ret = GENERIC_EXIT_NOT_OK;
+                break;
+            }
+
+            if (got_packet && out < frames.size())
+            {
+                // No B frames, so packets come out in display order
+                const FrameInfo &fi = m_frames[frames[out++]];
+                if (!WriteVideo(pkt, fi, fi.pts, fi.pts - m_dtsDelay))
+                    ret = GENERIC_EXIT_WRITE_FRAME_ERROR;
+            }
+            av_free_packet(&pkt);
+
+            if (!input && !got_packet)
+                break;
+        }
+        m_reencoded += out;
+
+        av_free(frame);
+        if (ectx)
+        {
+            avcodec_close(ectx);
+            av_free(ectx);
+        }
+    }
+
+    QMap<int, AVPicture>::iterator pit = pictures.begin();
+    for (; pit != pictures.end(); ++pit)
+        avpicture_free(&(*pit));
+
+    if (ret == REENCODE_OK && leadingOnly)
+    {
+        for (int i = 0; i < curGOP.size() && ret == REENCODE_OK; i++)
+        {
+            const FrameInfo &frame = m_frames[first + i];
+            if (frame.emitted && frame.pts >= keypts &&
+                !WriteVideo(curGOP[i], frame, frame.pts, frame.dts))
+                ret = GENERIC_EXIT_WRITE_FRAME_ERROR;
+        }
+    }
+
+    return ret;
+}
+
+bool SmartCut::WriteVideo(const AVPacket &pkt, const FrameInfo &frame,
+                          int64_t pts, int64_t dts)
+{
+    if (frame.run < 0)
+        return true;
+
+    const Run &run = m_runs[frame.run];
+    pts -= run.offset;
+    dts -= run.offset;
+    if (m_lastDts != (int64_t)AV_NOPTS_VALUE && dts <= m_lastDts)
+        dts = m_lastDts + 1;
+    if (pts < dts)
+        pts = dts;
+    m_lastDts = dts;
+
+    AVStream *ist = m_inputFC->streams[m_vid_id];
+    AVStream *ost = m_outputFC->streams[0];
+
+    AVPacket out;
+    if (av_new_packet(&out, pkt.size) < 0)
+        return false;
+    memcpy(out.data, pkt.data, pkt.size);
+    out.stream_index = 0;
+    out.flags = pkt.flags;
+    out.pts = av_rescale_q(pts, ist->time_base, ost->time_base);
+    out.dts = av_rescale_q(dts, ist->time_base, ost->time_base);
+    out.duration = av_rescale_q(m_frameDuration, ist->time_base,
+                                ost->time_base);
+
+    int ret = av_interleaved_write_frame(m_outputFC, &out);
+    av_free_packet(&out);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't write a video frame");
+        return false;
+    }
+    return true;
+}
+
+/** \fn SmartCut::WriteAudio(AVPacket&)
+ *  \brief Writes an audio packet if it starts within a run of kept video.
+ *
+ *  Returns false only if writing fails, not for packets that are cut.
+ */
+bool SmartCut::WriteAudio(AVPacket &pkt)
+{
+    QMap<int, int>::const_iterator ait = m_aud_map.find(pkt.stream_index);
+    if (ait == m_aud_map.end())
+        return true;
+
+    int64_t ts = (pkt.pts != (int64_t)AV_NOPTS_VALUE) ? pkt.pts : pkt.dts;
+    if (ts == (int64_t)AV_NOPTS_VALUE)
+        return true;
+
+    AVStream *ist = m_inputFC->streams[pkt.stream_index];
+    AVStream *vst = m_inputFC->streams[m_vid_id];
+    AVStream *ost = m_outputFC->streams[*ait];
+
+    ts = Unwrap(pkt.stream_index, ts);
+    int64_t vts = av_rescale_q(ts, ist->time_base, vst->time_base);
+
+    QMap<int64_t, int>::const_iterator rit = m_runStarts.upperBound(vts);
+    if (rit == m_runStarts.begin())
+        return true;
+    --rit;
+    const Run &run = m_runs[*rit];
+    if (vts >= run.end)
+        return true;
+
+    ts -= av_rescale_q(run.offset, vst->time_base, ist->time_base);
+    pkt.stream_index = *ait;
+    pkt.pts = pkt.dts = av_rescale_q(ts, ist->time_base, ost->time_base);
+    pkt.duration = av_rescale_q(pkt.duration, ist->time_base, ost->time_base);
+    pkt.pos = -1;
+
+    if (av_interleaved_write_frame(m_outputFC, &pkt) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't write an audio frame");
+        return false;
+    }
+    return true;
+}
+
+void SmartCut::FreePackets(QList<AVPacket> &pkts)
+{
+    QList<AVPacket>::iterator it = pkts.begin();
+    for (; it != pkts.end(); ++it)
+        av_free_packet(&(*it));
+    pkts.clear();
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
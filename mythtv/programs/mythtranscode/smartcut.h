@@ -0,0 +1,146 @@
+#ifndef _SMARTCUT_H_
+#define _SMARTCUT_H_
+
+// C
+#include <stdint.h>
+
+extern "C"
+{
+//AVFormat/AVCodec
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+//Qt
+#include <QVector>
+#include <QList>
+#include <QMap>
+#include <QDateTime>
+
+// MythTV
+#include "transcodedefs.h"
+#include "programtypes.h"
+
+/** \class SmartCut
+ *  \brief Removes the cutlist from a recording at the packet level.
+ *
+ *  GOPs which are kept whole are copied untouched, only the GOPs a cut
+ *  point falls into are decoded and their kept frames encoded again,
+ *  starting with a keyframe. Audio packets are kept or dropped by the
+ *  time they start, against the video that is kept, so the audio stays
+ *  in sync to within one audio frame.
+ *
+ *  The file is read twice, first just the packet headers to number the
+ *  frames and plan each GOP, then to write the result. Unlike MPEG2fixup
+ *  this works with any video codec libavcodec can decode and the output
+ *  is muxed with libavformat, it is used for H.264. The output is a
+ *  program or transport stream as selected with --ostream, DVD output
+ *  is refused since it can't carry H.264.
+ *
+ *  If there is no encoder for the video codec, GOPs at the cut points
+ *  are copied whole, so a cut may leave up to one GOP of the removed
+ *  material on either side.
+ */
+class SmartCut
+{
+  public:
+    SmartCut(const QString &inf, const QString &outf,
+             frm_dir_map_t *deleteMap, bool showprog, int otype,
+             void (*update_func)(float) = NULL, int (*check_func)() = NULL);
+    ~SmartCut();
+
+    static bool CanCut(const QString &inf);
+
+    int Start(void);
+
+  private:
+    enum GOPAction
+    {
+        kGOPDrop,            ///< nothing in the GOP is kept
+        kGOPCopy,            ///< kept frames are copied
+        kGOPReencode,        ///< kept frames are encoded again
+        kGOPReencodeLeading, ///< frames shown before the keyframe are
+                             ///< encoded again, the rest copied
+    };
+
+    class FrameInfo
+    {
+      public:
+        FrameInfo() :
+            pts(0), dts(0), rawpts(0), display(0), gop(0), run(-1),
+            keyframe(false), emitted(false) {}
+
+        int64_t pts;      ///< unwrapped, video stream time base
+        int64_t dts;      ///< unwrapped, video stream time base
+        int64_t rawpts;   ///< as the decoder will return it
+        int     display;  ///< frame number, in display order
+        int     gop;
+        int     run;      ///< index into m_runs, if emitted
+        bool    keyframe;
+        bool    emitted;
+    };
+
+    class Run
+    {
+      public:
+        Run() : start(0), end(0), offset(0) {}
+
+        int64_t start;    ///< pts of the first frame of the run
+        int64_t end;      ///< pts just after the last frame of the run
+        int64_t offset;   ///< subtracted from timestamps in the run
+    };
+
+    bool OpenInput(void);
+    bool OpenOutput(void);
+    void CloseAV(void);
+    int  ScanFrames(void);
+    void PlanCuts(void);
+    int  WriteOutput(void);
+    AVCodecContext *OpenEncoder(bool interlaced, bool quiet);
+    int  ReencodeGOP(const QList<AVPacket> &prevGOP,
+                     const QList<AVPacket> &curGOP, int gop);
+    bool WriteVideo(const AVPacket &pkt, const FrameInfo &frame,
+                    int64_t pts, int64_t dts);
+    bool WriteAudio(AVPacket &pkt);
+    int64_t Unwrap(int stream, int64_t ts);
+    bool UpdateProgress(const AVPacket &pkt, float base, float scale);
+    static void FreePackets(QList<AVPacket> &pkts);
+    static const char *OutputFormat(int otype);
+
+  private:
+    QString           m_infile;
+    QString           m_outfile;
+    frm_dir_map_t     m_delMap;
+    int               m_otype;       ///< REPLEX_* output stream type
+
+    AVFormatContext  *m_inputFC;
+    AVFormatContext  *m_outputFC;
+    int               m_vid_id;
+    QMap<int, int>    m_aud_map;     ///< input stream -> output stream
+    QMap<int, int64_t> m_last_ts;    ///< for Unwrap()
+
+    QVector<FrameInfo> m_frames;     ///< in decode order
+    QVector<int>      m_gopStart;    ///< decode index of each keyframe
+    QVector<int>      m_gopAction;
+    QVector<Run>      m_runs;
+    QMap<int64_t, int> m_runStarts;  ///< Run.start -> index in m_runs
+    int64_t           m_frameDuration;
+    int64_t           m_dtsDelay;
+    int64_t           m_lastDts;
+    bool              m_canEncode;
+    int               m_reencoded;   ///< frames, for the summary
+
+    //progress indicators
+    bool              m_showprogress;
+    void            (*m_update_status)(float percent_done);
+    int             (*m_check_abort)();
+    QDateTime         m_statustime;
+    int               m_status_update_time;
+    uint64_t          m_filesize;
+};
+
+#endif // _SMARTCUT_H_
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -1,5 +1,7 @@
 #include <fcntl.h>
 #include <math.h>
+#include <string.h>
+#include <sys/time.h>
 #include <iostream>
 
 #include <QStringList>
@@ -10,6 +12,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QByteArray>
+#include <QThread>
 
 #include "mythconfig.h"
 
@@ -19,7 +22,7 @@
 #include "mythcorecontext.h"
 #include "jobqueue.h"
 #include "exitcodes.h"
-#include "mthreadpool.h"
+#include "mthread.h"
 #include "deletemap.h"
 
 #include "NuppelVideoRecorder.h"
@@ -602,99 +605,150 @@ typedef struct transcodeFrameInfo
     bool        isKey;
 } TranscodeFrameInfo;
 
-class TranscodeFrameQueue : public QRunnable
+/** \class TranscodeStageStats
+ *  \brief How one stage of the transcode pipeline spends its time.
+ *
+ *  A stage that mostly waits for input is starved by the stage before it,
+ *  one that mostly waits to hand on its output is held up by the stage
+ *  after it. The stage that is busy nearly all the time is the bottleneck.
+ */
+class TranscodeStageStats
+{
+  public:
+    TranscodeStageStats(const QString &name) :
+        m_name(name), m_frames(0), m_busy(0), m_waitIn(0), m_waitOut(0) {}
+
+    void AddFrame(int64_t usecs)
+    {
+        QMutexLocker locker(&m_lock);
+        m_frames++;
+        m_busy += usecs;
+    }
+
+    void AddBusy(int64_t usecs)
+        { QMutexLocker locker(&m_lock); m_busy += usecs; }
+    void AddWaitIn(int64_t usecs)
+        { QMutexLocker locker(&m_lock); m_waitIn += usecs; }
+    void AddWaitOut(int64_t usecs)
+        { QMutexLocker locker(&m_lock); m_waitOut += usecs; }
+
+    QString toString(void) const
+    {
+        QMutexLocker locker(&m_lock);
+        double busy = m_busy / 1000000.0;
+        return QString("%1 stage: %2 frames, busy %3s (%4 fps), "
+                       "waited %5s for input, %6s for output")
+            .arg(m_name).arg(m_frames).arg(busy, 0, 'f', 1)
+            .arg((busy > 0) ? m_frames / busy : 0.0, 0, 'f', 1)
+            .arg(m_waitIn / 1000000.0, 0, 'f', 1)
+            .arg(m_waitOut / 1000000.0, 0, 'f', 1);
+    }
+
+    static int64_t Now(void)
+    {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    }
+
+  private:
+    mutable QMutex m_lock;
+    QString        m_name;
+    long long      m_frames;
+    int64_t        m_busy;     ///< usecs
+    int64_t        m_waitIn;   ///< usecs
+    int64_t        m_waitOut;  ///< usecs
+};
+
+/** \class TranscodeFrameQueue
+ *  \brief First stage of the transcode pipeline, decodes and filters
+ *         frames ahead of the main loop, up to size frames at a time.
+ */
+class TranscodeFrameQueue : public MThread
 {
   public:
     TranscodeFrameQueue(MythPlayer *player, VideoOutput *videoout,
         bool cutlist, int size = 5)
-      : m_player(player),         m_videoOutput(videoout),
+      : MThread("TranscodeFrameQueue"),
+        m_player(player),         m_videoOutput(videoout),
         m_honorCutlist(cutlist),
         m_eof(false),             m_maxFrames(size),
-        m_runThread(true),        m_isRunning(false)
+        m_runThread(true),        m_stats("Decode/filter")
     {
-
     }
 
     ~TranscodeFrameQueue()
     {
-        m_runThread = false;
-        m_frameWaitCond.wakeAll();
-
-        while (m_isRunning)
-            usleep(50000);
+        stop();
     }
 
     void stop(void)
     {
-        m_runThread = false;
-        m_frameWaitCond.wakeAll();
-
-        while (m_isRunning)
-            usleep(50000);
+        {
+            QMutexLocker locker(&m_queueLock);
+            m_runThread = false;
+            m_frameWaitCond.wakeAll();
+        }
+        wait();
     }
 
     void run()
     {
+        RunProlog();
+
         frm_dir_map_t::iterator dm_iter;
 
-        m_isRunning = true;
-        while (m_runThread)
+        while (true)
         {
-            if (m_frameList.size() < m_maxFrames && !m_eof)
+            int64_t start = TranscodeStageStats::Now();
             {
-                TranscodeFrameInfo tfInfo;
-                tfInfo.frame = NULL;
-                tfInfo.didFF = 0;
-                tfInfo.isKey = false;
+                QMutexLocker locker(&m_queueLock);
+                while (m_runThread && m_frameList.size() >= m_maxFrames)
+                    m_frameWaitCond.wait(&m_queueLock);
+                if (!m_runThread)
+                    break;
+            }
+            int64_t ready = TranscodeStageStats::Now();
+            m_stats.AddWaitOut(ready - start);
 
-                if (m_player->TranscodeGetNextFrame(dm_iter, tfInfo.didFF,
-                    tfInfo.isKey, m_honorCutlist))
-                {
-                    tfInfo.frame = m_videoOutput->GetLastDecodedFrame();
+            TranscodeFrameInfo tfInfo;
+            tfInfo.frame = NULL;
+            tfInfo.didFF = 0;
+            tfInfo.isKey = false;
 
-                    QMutexLocker locker(&m_queueLock);
-                    m_frameList.append(tfInfo);
-                }
-                else
-                {
-                    m_eof = true;
-                }
-
-                m_frameWaitCond.wakeAll();
-            }
-            else
+            bool ok = m_player->TranscodeGetNextFrame(dm_iter, tfInfo.didFF,
+                tfInfo.isKey, m_honorCutlist);
+            if (ok)
             {
-                m_frameWaitLock.lock();
-                m_frameWaitCond.wait(&m_frameWaitLock);
-                m_frameWaitLock.unlock();
+                tfInfo.frame = m_videoOutput->GetLastDecodedFrame();
+                m_stats.AddFrame(TranscodeStageStats::Now() - ready);
             }
+
+            QMutexLocker locker(&m_queueLock);
+            if (ok)
+                m_frameList.append(tfInfo);
+            else
+                m_eof = true;
+            m_frameWaitCond.wakeAll();
+
+            if (m_eof)
+                break;
         }
-        m_isRunning = false;
+
+        RunEpilog();
     }
 
     VideoFrame *GetFrame(int &didFF, bool &isKey)
     {
-        m_queueLock.lock();
-
-        if (m_frameList.isEmpty())
-        {
-            m_queueLock.unlock();
-
-            if (m_eof)
-                return NULL;
-
-            m_frameWaitLock.lock();
-            m_frameWaitCond.wait(&m_frameWaitLock);
-            m_frameWaitLock.unlock();
+        QMutexLocker locker(&m_queueLock);
 
-            if (m_frameList.isEmpty())
-                return NULL;
+        while (m_frameList.isEmpty() && !m_eof && m_runThread)
+            m_frameWaitCond.wait(&m_queueLock);
 
-            m_queueLock.lock();
-        }
+        if (m_frameList.isEmpty())
+            return NULL;
 
         TranscodeFrameInfo tfInfo = m_frameList.takeFirst();
-        m_queueLock.unlock();
         m_frameWaitCond.wakeAll();
 
         didFF = tfInfo.didFF;
@@ -703,6 +757,8 @@ class TranscodeFrameQueue : public QRunnable
         return tfInfo.frame;
     }
 
+    const TranscodeStageStats &GetStats(void) const { return m_stats; }
+
   private:
     MythPlayer               *m_player;
     VideoOutput              *m_videoOutput;
@@ -710,11 +766,10 @@ class TranscodeFrameQueue : public QRunnable
     bool                      m_eof;
     int                       m_maxFrames;
     bool                      m_runThread;
-    bool                      m_isRunning;
     QMutex                    m_queueLock;
     QList<TranscodeFrameInfo> m_frameList;
     QWaitCondition            m_frameWaitCond;
-    QMutex                    m_frameWaitLock;
+    TranscodeStageStats       m_stats;
 };
 
 Transcode::Transcode(ProgramInfo *pginfo) :
@@ -863,12 +918,343 @@ static int get_int_option(RecordingProfile &profile, const QString &name)
     return ret_int;
 }
 
-static void TranscodeWriteText(void *ptr, unsigned char *buf, int len,
-                               int timecode, int pagenr)
+/** \class HLSVariantWriter
+ *  \brief Encoder for one rung of the HTTP Live Stream bitrate ladder,
+ *         fed with the frames scaled down from the main stream.
+ */
+class HLSVariantWriter
 {
-    NuppelVideoRecorder *nvr = (NuppelVideoRecorder *)ptr;
-    nvr->WriteText(buf, len, timecode, pagenr);
-}
+  public:
+    HLSVariantWriter() : avfw(NULL), scontext(NULL), buf(NULL) {}
+
+    AVFormatWriter     *avfw;
+    struct SwsContext  *scontext;
+    unsigned char      *buf;
+    VideoFrame          frame;
+};
+
+/** \class TranscodeEncoder
+ *  \brief Last stage of the transcode pipeline, encodes and writes the
+ *         video, audio and captions on a thread of its own.
+ *
+ *  Everything is written in the order it is queued. Video frames are
+ *  copied into one of a fixed number of buffers, so no more than that
+ *  many frames are ever waiting to be encoded.
+ */
+class TranscodeEncoder : public MThread
+{
+  public:
+    TranscodeEncoder(NuppelVideoRecorder *nvr, AVFormatWriter *avfw,
+                     AVFormatWriter *avfw2,
+                     QList<HLSVariantWriter> &hlsVariants,
+                     HTTPLiveStream *hls, int hlsSegmentSize,
+                     int width, int height, int buffers = 8) :
+        MThread("TranscodeEncoder"),
+        m_nvr(nvr), m_avfw(avfw), m_avfw2(avfw2), m_hlsVariants(hlsVariants),
+        m_hls(hls), m_hlsSegmentSize(hlsSegmentSize), m_hlsSegmentFrames(0),
+        m_audioFrame(0), m_running(true), m_busy(false), m_errored(false),
+        m_stats("Encode")
+    {
+        for (int i = 0; i < buffers; i++)
+        {
+            VideoFrame *frame = new VideoFrame;
+            memset(frame, 0, sizeof(VideoFrame));
+            frame->codec = FMT_YV12;
+            frame->width = width;
+            frame->height = height;
+            frame->size = width * height * 3 / 2;
+            frame->buf = new unsigned char[frame->size];
+            m_frames.push_back(frame);
+            m_free.push_back(frame);
+        }
+    }
+
+    ~TranscodeEncoder()
+    {
+        Stop();
+        for (int i = 0; i < m_frames.size(); i++)
+        {
+            delete [] m_frames[i]->buf;
+            delete m_frames[i];
+        }
+    }
+
+    /// Returns a buffer for the next frame, waiting for one to be free.
+    VideoFrame *GetFreeFrame(void)
+    {
+        QMutexLocker locker(&m_lock);
+        while (m_running && !m_errored && m_free.empty())
+            m_wait.wait(&m_lock);
+        if (!m_running || m_errored)
+            return NULL;
+        return m_free.takeFirst();
+    }
+
+    /// Queues a frame from GetFreeFrame() to be encoded.
+    void AddVideo(VideoFrame *frame, bool forceKey)
+    {
+        Item item(Item::kVideo);
+        item.frame = frame;
+        item.forceKey = forceKey;
+        Add(item);
+    }
+
+    void AddAudio(const QByteArray &buf, long long timecode)
+    {
+        Item item(Item::kAudio);
+        item.data = buf;
+        item.timecode = timecode;
+        Add(item);
+    }
+
+    /// CC608Reader::TranscodeWriteText() callback
+    static void WriteText(void *ptr, unsigned char *buf, int len,
+                          int timecode, int pagenr)
+    {
+        Item item(Item::kText);
+        item.data = QByteArray((const char *)buf, len);
+        item.timecode = timecode;
+        item.pagenr = pagenr;
+        ((TranscodeEncoder *)ptr)->Add(item);
+    }
+
+    /// Waits until everything queued so far is written.
+    bool Flush(void)
+    {
+        QMutexLocker locker(&m_lock);
+        while (m_running && !m_errored && (!m_queue.empty() || m_busy))
+            m_wait.wait(&m_lock);
+        return !m_errored;
+    }
+
+    /// Stops the thread, whatever is still queued is dropped.
+    void Stop(void)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            m_running = false;
+            m_wait.wakeAll();
+        }
+        wait();
+    }
+
+    bool IsErrored(void) const
+    {
+        QMutexLocker locker(&m_lock);
+        return m_errored;
+    }
+
+    const TranscodeStageStats &GetStats(void) const { return m_stats; }
+
+  protected:
+    void run(void)
+    {
+        RunProlog();
+
+        QMutexLocker locker(&m_lock);
+        while (m_running)
+        {
+            if (m_queue.empty())
+            {
+                int64_t start = TranscodeStageStats::Now();
+                m_wait.wait(&m_lock);
+                m_stats.AddWaitIn(TranscodeStageStats::Now() - start);
+                continue;
+            }
+
+            Item item = m_queue.takeFirst();
+            bool skip = m_errored;
+            m_busy = true;
+            locker.unlock();
+
+            int64_t start = TranscodeStageStats::Now();
+            bool ok = skip || Write(item);
+            if (item.type == Item::kVideo)
+                m_stats.AddFrame(TranscodeStageStats::Now() - start);
+            else
+                m_stats.AddBusy(TranscodeStageStats::Now() - start);
+
+            locker.relock();
+            m_busy = false;
+            if (item.frame)
+                m_free.push_back(item.frame);
+            if (!ok)
+                m_errored = true;
+            m_wait.wakeAll();
+        }
+
+        RunEpilog();
+    }
+
+  private:
+    class Item
+    {
+      public:
+        enum Type { kVideo, kAudio, kText };
+
+        Item(Type t) :
+            type(t), frame(NULL), forceKey(false), timecode(0), pagenr(0) {}
+        Item() :
+            type(kVideo), frame(NULL), forceKey(false), timecode(0),
+            pagenr(0) {}
+
+        Type        type;
+        VideoFrame *frame;
+        bool        forceKey;
+        QByteArray  data;
+        long long   timecode;
+        int         pagenr;
+    };
+
+    void Add(const Item &item)
+    {
+        QMutexLocker locker(&m_lock);
+        m_queue.push_back(item);
+        m_wait.wakeAll();
+    }
+
+    bool Write(Item &item)
+    {
+        unsigned char *buf = (unsigned char *)item.data.data();
+
+        if (item.type == Item::kText)
+        {
+            m_nvr->WriteText(buf, item.data.size(), item.timecode,
+                             item.pagenr);
+        }
+        else if (item.type == Item::kAudio && m_avfw)
+        {
+            m_avfw->WriteAudioFrame(buf, m_audioFrame, item.timecode);
+
+            if (m_avfw2)
+            {
+                if ((m_avfw2->GetTimecodeOffset() == -1) &&
+                    (m_avfw->GetTimecodeOffset() != -1))
+                {
+                    m_avfw2->SetTimecodeOffset(m_avfw->GetTimecodeOffset());
+                }
+
+                m_avfw2->WriteAudioFrame(buf, m_audioFrame, item.timecode);
+            }
+
+            QList<HLSVariantWriter>::iterator vit = m_hlsVariants.begin();
+            for (; vit != m_hlsVariants.end(); ++vit)
+            {
+                if (((*vit).avfw->GetTimecodeOffset() == -1) &&
+                    (m_avfw->GetTimecodeOffset() != -1))
+                {
+                    (*vit).avfw->SetTimecodeOffset(
+                        m_avfw->GetTimecodeOffset());
+                }
+
+                (*vit).avfw->WriteAudioFrame(buf, m_audioFrame,
+                                             item.timecode);
+            }
+
+            ++m_audioFrame;
+        }
+        else if (item.type == Item::kAudio)
+        {
+            m_nvr->SetOption("audioframesize", item.data.size());
+            m_nvr->WriteAudio(buf, m_audioFrame++, item.timecode);
+            if (m_nvr->IsErrored())
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    "Transcode: Encountered irrecoverable error in "
+                    "NVR::WriteAudio");
+                return false;
+            }
+        }
+        else if (m_avfw)
+        {
+            WriteVideoAVF(item.frame);
+        }
+        else if (item.forceKey)
+        {
+            m_nvr->WriteVideo(item.frame, true, true);
+        }
+        else
+        {
+            m_nvr->WriteVideo(item.frame);
+        }
+
+        return true;
+    }
+
+    void WriteVideoAVF(VideoFrame *frame)
+    {
+        if ((m_hls) &&
+            (m_avfw->GetFramesWritten()) &&
+            (m_hlsSegmentFrames > m_hlsSegmentSize) &&
+            (m_avfw->NextFrameIsKeyFrame()))
+        {
+            m_hls->AddSegment();
+            m_avfw->ReOpen(m_hls->GetCurrentFilename());
+
+            if (m_avfw2)
+                m_avfw2->ReOpen(m_hls->GetCurrentFilename(true));
+
+            for (int v = 0; v < m_hlsVariants.size(); ++v)
+                m_hlsVariants[v].avfw->ReOpen(
+                    m_hls->GetCurrentFilename(false, false, v + 1));
+
+            // The playlists are written in the background once
+            // every writer has flushed the finished segment.
+            m_hls->PublishSegments();
+
+            m_hlsSegmentFrames = 0;
+        }
+
+        m_avfw->WriteVideoFrame(frame);
+        ++m_hlsSegmentFrames;
+
+        AVPicture imageIn, imageOut;
+        QList<HLSVariantWriter>::iterator vit = m_hlsVariants.begin();
+        for (; vit != m_hlsVariants.end(); ++vit)
+        {
+            HLSVariantWriter &vw = *vit;
+
+            avpicture_fill(&imageIn, frame->buf, PIX_FMT_YUV420P,
+                           frame->width, frame->height);
+            avpicture_fill(&imageOut, vw.buf, PIX_FMT_YUV420P,
+                           vw.frame.width, vw.frame.height);
+
+            vw.scontext = sws_getCachedContext(vw.scontext,
+                           frame->width, frame->height, PIX_FMT_YUV420P,
+                           vw.frame.width, vw.frame.height,
+                           PIX_FMT_YUV420P, SWS_FAST_BILINEAR,
+                           NULL, NULL, NULL);
+
+            sws_scale(vw.scontext, imageIn.data, imageIn.linesize,
+                      0, frame->height,
+                      imageOut.data, imageOut.linesize);
+
+            vw.frame.timecode = frame->timecode;
+            vw.frame.frameNumber = frame->frameNumber;
+            vw.avfw->WriteVideoFrame(&vw.frame);
+        }
+    }
+
+  private:
+    NuppelVideoRecorder     *m_nvr;
+    AVFormatWriter          *m_avfw;
+    AVFormatWriter          *m_avfw2;
+    QList<HLSVariantWriter> &m_hlsVariants;
+    HTTPLiveStream          *m_hls;
+    int                      m_hlsSegmentSize;
+    int                      m_hlsSegmentFrames;
+    int                      m_audioFrame;
+
+    mutable QMutex           m_lock;
+    QWaitCondition           m_wait;
+    QList<Item>              m_queue;
+    QList<VideoFrame*>       m_frames;
+    QList<VideoFrame*>       m_free;
+    bool                     m_running;
+    bool                     m_busy;
+    bool                     m_errored;
+    TranscodeStageStats      m_stats;
+};
 
 int Transcode::TranscodeFile(const QString &inputname,
                              const QString &outputname,
@@ -882,13 +1268,12 @@ int Transcode::TranscodeFile(const QString &inputname,
 {
     QDateTime curtime = MythDate::current();
     QDateTime statustime = curtime;
-    int audioFrame = 0;
     Cutter *cutter = NULL;
     AVFormatWriter *avfw = NULL;
     AVFormatWriter *avfw2 = NULL;
+    QList<HLSVariantWriter> hlsVariants;
     HTTPLiveStream *hls = NULL;
     int hlsSegmentSize = 0;
-    int hlsSegmentFrames = 0;
 
     if (jobID >= 0)
         JobQueue::ChangeJobComment(jobID, "0% " + QObject::tr("Completed"));
@@ -1162,6 +1547,66 @@ int Transcode::TranscodeFile(const QString &inputname,
             avfw->SetFilename(hls->GetCurrentFilename());
             if (avfw2)
                 avfw2->SetFilename(hls->GetCurrentFilename(true));
+
+            // The rest of the ladder is encoded from the same decode, with
+            // the same key frame distance so the segments line up.
+            for (int v = 1; v <= hls->GetVariantCount(); ++v)
+            {
+                HTTPLiveStreamVariant var = hls->GetVariant(v);
+                HLSVariantWriter vw;
+
+                vw.avfw = new AVFormatWriter();
+                vw.avfw->SetContainer("mpegts");
+                vw.avfw->SetVideoCodec("libx264");
+                vw.avfw->SetAudioCodec("libmp3lame");
+                vw.avfw->SetVideoBitrate(var.bitrate);
+                vw.avfw->SetWidth(var.width);
+                vw.avfw->SetHeight(var.height);
+                vw.avfw->SetAspect(video_aspect);
+                vw.avfw->SetAudioBitrate(cmdAudioBitrate);
+                vw.avfw->SetAudioChannels(arb->m_channels);
+                vw.avfw->SetAudioBits(16);
+                vw.avfw->SetAudioSampleRate(arb->m_eff_audiorate);
+                vw.avfw->SetAudioSampleBytes(2);
+                vw.avfw->SetFramerate(halfFramerate ?
+                                      video_frame_rate/2 : video_frame_rate);
+                vw.avfw->SetKeyFrameDist(90);
+                vw.avfw->SetThreadCount(1);
+                vw.avfw->SetFilename(
+                    hls->GetCurrentFilename(false, false, v));
+
+                vw.frame.codec = FMT_YV12;
+                vw.frame.width = var.width;
+                vw.frame.height = var.height;
+                vw.frame.size = var.width * var.height * 3 / 2;
+                vw.buf = new unsigned char[vw.frame.size];
+                vw.frame.buf = vw.buf;
+
+                // The backend and the meta playlist expect every rung of
+                // the ladder, so a variant we can't write fails the stream.
+                if (!vw.avfw->Init() || !vw.avfw->OpenFile())
+                {
+                    LOG(VB_GENERAL, LOG_ERR,
+                        QString("Unable to open HLS variant %1x%2")
+                            .arg(var.width).arg(var.height));
+                    hls->UpdateStatus(kHLSStatusErrored);
+                    hls->UpdateStatusMessage(
+                        QString("Unable to open variant %1x%2")
+                            .arg(var.width).arg(var.height));
+                    delete vw.avfw;
+                    delete [] vw.buf;
+                    while (!hlsVariants.empty())
+                    {
+                        vw = hlsVariants.takeFirst();
+                        delete vw.avfw;
+                        delete [] vw.buf;
+                    }
+                    SetPlayerContext(NULL);
+                    return REENCODE_ERROR;
+                }
+
+                hlsVariants.push_back(vw);
+            }
         }
         else
         {
@@ -1172,8 +1617,15 @@ int Transcode::TranscodeFile(const QString &inputname,
             avfw->SetFramerate(video_frame_rate);
         }
 
-        avfw->SetThreadCount(
-            gCoreContext->GetNumSetting("HTTPLiveStreamThreads", 2));
+        // libx264 runs this many frame threads, the libavcodec encoders
+        // split each frame into slices.
+        if (hlsMode)
+            avfw->SetThreadCount(
+                gCoreContext->GetNumSetting("HTTPLiveStreamThreads", 2));
+        else
+            avfw->SetThreadCount(
+                gCoreContext->GetNumSetting("TranscodeThreads",
+                                            QThread::idealThreadCount()));
 
         if (avfw2)
             avfw2->SetThreadCount(1);
@@ -1208,6 +1660,9 @@ int Transcode::TranscodeFile(const QString &inputname,
 
         arb->m_audioFrameSize = avfw->GetAudioFrameSize() * arb->m_channels * 2;
 
+        if (hls)
+            hls->PublishSegments();
+
         GetPlayer()->SetVideoFilters(
             gCoreContext->GetSetting("HTTPLiveStreamFilters"));
     }
@@ -1240,10 +1695,11 @@ int Transcode::TranscodeFile(const QString &inputname,
         audsetting = get_str_option(profile, "audiocodec");
         vidfilters = get_str_option(profile, "transcodefilters");
 
-        if (encodingType == "MPEG-2" &&
+        if ((encodingType == "MPEG-2" || encodingType == "H.264") &&
             get_int_option(profile, "transcodelossless"))
         {
-            LOG(VB_GENERAL, LOG_NOTICE, "Switching to MPEG-2 transcoder.");
+            LOG(VB_GENERAL, LOG_NOTICE, QString("Switching to %1 transcoder.")
+                .arg(encodingType == "H.264" ? "lossless" : "MPEG-2"));
             SetPlayerContext(NULL);
             return REENCODE_MPEG2TRANS;
         }
@@ -1611,9 +2067,22 @@ int Transcode::TranscodeFile(const QString &inputname,
     else
         LOG(VB_GENERAL, LOG_INFO, "Transcoding Video and Audio");
 
+    // Decoding and filtering run ahead on one thread, encoding on another,
+    // this thread scales the frames and keeps the audio in step.
     TranscodeFrameQueue *frameQueue =
         new TranscodeFrameQueue(GetPlayer(), videoOutput, honorCutList);
-    MThreadPool::globalInstance()->start(frameQueue, "TranscodeFrameQueue");
+    frameQueue->start();
+
+    TranscodeEncoder *encoder = NULL;
+    if (!fifow)
+    {
+        encoder = new TranscodeEncoder(nvr, avfw, avfw2, hlsVariants, hls,
+                                       hlsSegmentSize, newWidth, newHeight);
+        encoder->start();
+    }
+    // The video filters run in the decode stage, this loop syncs the audio
+    // and scales the frames for the encoder.
+    TranscodeStageStats scaleStats("Scale");
 
     QTime flagTime;
     flagTime.start();
@@ -1627,9 +2096,14 @@ int Transcode::TranscodeFile(const QString &inputname,
     if (hls)
         hls->UpdateStatus(kHLSStatusRunning);
 
+    int64_t waitStart = TranscodeStageStats::Now();
     while ((!stopSignalled) &&
            (lastDecode = frameQueue->GetFrame(did_ff, is_key)))
     {
+        int64_t loopStart = TranscodeStageStats::Now();
+        int64_t waitOut = 0;
+        scaleStats.AddWaitIn(loopStart - waitStart);
+
         if (first_loop)
         {
             copyaudio = GetPlayer()->GetRawAudioState();
@@ -1763,9 +2237,9 @@ int Transcode::TranscodeFile(const QString &inputname,
 
                 unlink(outputname.toLocal8Bit().constData());
                 delete [] newFrame;
+                delete encoder;
+                delete frameQueue;
                 SetPlayerContext(NULL);
-                if (frameQueue)
-                    frameQueue->stop();
                 return REENCODE_ERROR;
             }
 
@@ -1874,7 +2348,11 @@ int Transcode::TranscodeFile(const QString &inputname,
             {
                 video_aspect = new_aspect;
                 if (nvr)
+                {
+                    // nvr is the encoder thread's to use
+                    encoder->Flush();
                     nvr->SetNewVideoParams(video_aspect);
+                }
             }
 
 
@@ -1892,86 +2370,16 @@ int Transcode::TranscodeFile(const QString &inputname,
                         .arg(newWidth).arg(newHeight));
             }
 
-            if ((video_width == newWidth) && (video_height == newHeight))
-            {
-                frame.buf = lastDecode->buf;
-            }
-            else
-            {
-                frame.buf = newFrame;
-                avpicture_fill(&imageIn, lastDecode->buf, PIX_FMT_YUV420P,
-                               video_width, video_height);
-                avpicture_fill(&imageOut, frame.buf, PIX_FMT_YUV420P,
-                               newWidth, newHeight);
-
-                int bottomBand = (video_height == 1088) ? 8 : 0;
-                scontext = sws_getCachedContext(scontext, video_width,
-                               video_height, PIX_FMT_YUV420P, newWidth,
-                               newHeight, PIX_FMT_YUV420P,
-                               SWS_FAST_BILINEAR, NULL, NULL, NULL);
-
-                sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
-                          video_height - bottomBand,
-                          imageOut.data, imageOut.linesize);
-            }
-
             // audio is fully decoded, so we need to reencode it
             if (arb->GetCount(frame.timecode))
             {
-                int loop = 0;
-                int bytesConsumed = 0;
-                int buffersConsumed = 0;
                 int count = arb->GetCount(frame.timecode);
-                for (loop = 0; loop < count; loop++)
+                for (int loop = 0; loop < count; loop++)
                 {
                     AudioBuffer *ab = arb->GetData();
-                    unsigned char *buf = (unsigned char *)ab->m_buffer.data();
-                    if (avfMode)
-                    {
-                        if (did_ff != 1)
-                        {
-                            avfw->WriteAudioFrame(buf, audioFrame,
-                                                  ab->m_time - timecodeOffset);
-
-                            if (avfw2)
-                            {
-                                if ((avfw2->GetTimecodeOffset() == -1) &&
-                                    (avfw->GetTimecodeOffset() != -1))
-                                {
-                                    avfw2->SetTimecodeOffset(
-                                        avfw->GetTimecodeOffset());
-                                }
-
-                                avfw2->WriteAudioFrame(buf, audioFrame,
-                                                   ab->m_time - timecodeOffset);
-                            }
-
-                            ++audioFrame;
-                        }
-                    }
-                    else
-                    {
-                        nvr->SetOption("audioframesize", ab->m_buffer.size());
-                        nvr->WriteAudio(buf, audioFrame++,
-                                        ab->m_time - timecodeOffset);
-                        if (nvr->IsErrored())
-                        {
-                            LOG(VB_GENERAL, LOG_ERR,
-                                "Transcode: Encountered irrecoverable error in "
-                                "NVR::WriteAudio");
-
-                            delete [] newFrame;
-                            SetPlayerContext(NULL);
-                            if (frameQueue)
-                                frameQueue->stop();
-                            delete ab;
-                            return REENCODE_ERROR;
-                        }
-                    }
-
-                    ++buffersConsumed;
-                    bytesConsumed += ab->m_buffer.size();
-
+                    if (!avfMode || did_ff != 1)
+                        encoder->AddAudio(ab->m_buffer,
+                                          ab->m_time - timecodeOffset);
                     delete ab;
                 }
             }
@@ -1979,45 +2387,66 @@ int Transcode::TranscodeFile(const QString &inputname,
             if (!avfMode)
             {
                 GetPlayer()->GetCC608Reader()->
-                    TranscodeWriteText(&TranscodeWriteText, (void *)(nvr));
+                    TranscodeWriteText(&TranscodeEncoder::WriteText,
+                                       (void *)(encoder));
             }
             lasttimecode = frame.timecode;
             frame.timecode -= timecodeOffset;
 
-            if (avfMode)
+            bool writeVideo = true;
+            if (avfMode && halfFramerate && !skippedLastFrame)
+            {
+                skippedLastFrame = true;
+                writeVideo = false;
+            }
+            else
+                skippedLastFrame = false;
+
+            VideoFrame *encFrame = NULL;
+            if (writeVideo)
+            {
+                int64_t start = TranscodeStageStats::Now();
+                encFrame = encoder->GetFreeFrame();
+                waitOut += TranscodeStageStats::Now() - start;
+            }
+
+            if (encFrame)
             {
-                if (halfFramerate && !skippedLastFrame)
+                encFrame->timecode = frame.timecode;
+                encFrame->frameNumber = frame.frameNumber;
+
+                if ((video_width == newWidth) && (video_height == newHeight))
                 {
-                    skippedLastFrame = true;
+                    memcpy(encFrame->buf, lastDecode->buf, encFrame->size);
                 }
                 else
                 {
-                    skippedLastFrame = false;
-
-                    if ((hls) &&
-                        (avfw->GetFramesWritten()) &&
-                        (hlsSegmentFrames > hlsSegmentSize) &&
-                        (avfw->NextFrameIsKeyFrame()))
-                    {
-                        hls->AddSegment();
-                        avfw->ReOpen(hls->GetCurrentFilename());
-
-                        if (avfw2)
-                            avfw2->ReOpen(hls->GetCurrentFilename(true));
+                    avpicture_fill(&imageIn, lastDecode->buf, PIX_FMT_YUV420P,
+                                   video_width, video_height);
+                    avpicture_fill(&imageOut, encFrame->buf, PIX_FMT_YUV420P,
+                                   newWidth, newHeight);
 
-                        hlsSegmentFrames = 0;
-                    }
+                    int bottomBand = (video_height == 1088) ? 8 : 0;
+                    scontext = sws_getCachedContext(scontext, video_width,
+                                   video_height, PIX_FMT_YUV420P, newWidth,
+                                   newHeight, PIX_FMT_YUV420P,
+                                   SWS_FAST_BILINEAR, NULL, NULL, NULL);
 
-                    avfw->WriteVideoFrame(&frame);
-                    ++hlsSegmentFrames;
+                    sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
+                              video_height - bottomBand,
+                              imageOut.data, imageOut.linesize);
                 }
+
+                encoder->AddVideo(encFrame, forceKeyFrames);
             }
-            else
+
+            if (encoder->IsErrored())
             {
-                if (forceKeyFrames)
-                    nvr->WriteVideo(&frame, true, true);
-                else
-                    nvr->WriteVideo(&frame);
+                delete [] newFrame;
+                delete encoder;
+                delete frameQueue;
+                SetPlayerContext(NULL);
+                return REENCODE_ERROR;
             }
         }
         if (MythDate::current() > statustime)
@@ -2048,9 +2477,9 @@ int Transcode::TranscodeFile(const QString &inputname,
 
                 unlink(outputname.toLocal8Bit().constData());
                 delete [] newFrame;
+                delete encoder;
+                delete frameQueue;
                 SetPlayerContext(NULL);
-                if (frameQueue)
-                    frameQueue->stop();
                 return REENCODE_CUTLIST_CHANGE;
             }
 
@@ -2063,9 +2492,9 @@ int Transcode::TranscodeFile(const QString &inputname,
 
                     unlink(outputname.toLocal8Bit().constData());
                     delete [] newFrame;
+                    delete encoder;
+                    delete frameQueue;
                     SetPlayerContext(NULL);
-                    if (frameQueue)
-                        frameQueue->stop();
                     return REENCODE_STOPPED;
                 }
 
@@ -2089,6 +2518,12 @@ int Transcode::TranscodeFile(const QString &inputname,
                             .arg(percentage).arg(flagFPS));
 
             }
+
+            LOG(VB_GENERAL, LOG_DEBUG, LOC + frameQueue->GetStats().toString());
+            LOG(VB_GENERAL, LOG_DEBUG, LOC + scaleStats.toString());
+            if (encoder)
+                LOG(VB_GENERAL, LOG_DEBUG, LOC + encoder->GetStats().toString());
+
             curtime = MythDate::current().addSecs(20);
         }
 
@@ -2096,7 +2531,28 @@ int Transcode::TranscodeFile(const QString &inputname,
         frame.frameNumber = 1 + (curFrameNum << 1);
 
         GetPlayer()->DiscardVideoFrame(lastDecode);
+
+        int64_t loopEnd = TranscodeStageStats::Now();
+        scaleStats.AddFrame(loopEnd - loopStart - waitOut);
+        scaleStats.AddWaitOut(waitOut);
+        waitStart = loopEnd;
+    }
+
+    bool encodeFailed = false;
+    if (encoder)
+    {
+        encodeFailed = !encoder->Flush();
+        encoder->Stop();
     }
+    frameQueue->stop();
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + frameQueue->GetStats().toString());
+    LOG(VB_GENERAL, LOG_INFO, LOC + scaleStats.toString());
+    if (encoder)
+        LOG(VB_GENERAL, LOG_INFO, LOC + encoder->GetStats().toString());
+
+    delete encoder;
+    delete frameQueue;
 
     sws_freeContext(scontext);
 
@@ -2108,6 +2564,9 @@ int Transcode::TranscodeFile(const QString &inputname,
         if (avfw2)
             avfw2->CloseFile();
 
+        for (int v = 0; v < hlsVariants.size(); ++v)
+            hlsVariants[v].avfw->CloseFile();
+
         if (!hls && m_proginfo)
         {
             m_proginfo->ClearPositionMap(MARK_KEYFRAME);
@@ -2134,6 +2593,14 @@ int Transcode::TranscodeFile(const QString &inputname,
     if (avfw2)
         delete avfw2;
 
+    while (!hlsVariants.empty())
+    {
+        HLSVariantWriter vw = hlsVariants.takeFirst();
+        sws_freeContext(vw.scontext);
+        delete vw.avfw;
+        delete [] vw.buf;
+    }
+
     if (hls)
     {
         if (!stopSignalled)
@@ -2150,13 +2617,10 @@ int Transcode::TranscodeFile(const QString &inputname,
         delete hls;
     }
 
-    if (frameQueue)
-        frameQueue->stop();
-
     delete [] newFrame;
     SetPlayerContext(NULL);
 
-    return REENCODE_OK;
+    return encodeFailed ? REENCODE_ERROR : REENCODE_OK;
 }
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -148,6 +148,19 @@ static GlobalCheckBox *SaveTranscoding()
     return gc;
 };
 
+static GlobalSpinBox *HTTPLiveStreamVariants()
+{
+    GlobalSpinBox *gs = new GlobalSpinBox("HTTPLiveStreamVariants", 0, 4, 1);
+    gs->setLabel(QObject::tr("HTTP Live Stream lower bitrates"));
+    gs->setValue(2);
+    gs->setHelpText(QObject::tr("Number of lower bitrate versions encoded "
+                    "with each HTTP Live Stream, each at half the bitrate "
+                    "of the one above it, so players can switch to them "
+                    "on slow connections. Set to 0 to encode only the "
+                    "requested bitrate."));
+    return gs;
+};
+
 static HostCheckBox *TruncateDeletes()
 {
     HostCheckBox *hc = new HostCheckBox("TruncateDeletesSlowly");
@@ -546,6 +559,54 @@ static HostSpinBox *JobQueueMaxSimultaneousJobs()
     return gc;
 };
 
+static HostSpinBox *JobQueueMaxClassJobs(const QString &setting,
+                                         const QString &label)
+{
+    HostSpinBox *gc = new HostSpinBox(setting, 0, 10, 1);
+    gc->setLabel(label);
+    gc->setHelpText(QObject::tr("The Job Queue will run at most this many "
+                    "jobs of this type simultaneously on this backend, "
+                    "in addition to the overall limit. 0 means no "
+                    "additional limit."));
+    gc->setValue(0);
+    return gc;
+};
+
+static HostSpinBox *JobQueueMaxCPULoad()
+{
+    HostSpinBox *gc = new HostSpinBox("JobQueueMaxCPULoad", 0, 400, 10);
+    gc->setLabel(QObject::tr("Defer CPU heavy jobs above load (%)"));
+    gc->setHelpText(QObject::tr("Commercial detection and transcoding jobs "
+                    "will not be started while the one minute load average "
+                    "is above this percentage of the available CPU cores. "
+                    "0 disables this check."));
+    gc->setValue(0);
+    return gc;
+};
+
+static HostSpinBox *JobQueueMaxDiskBusy()
+{
+    HostSpinBox *gc = new HostSpinBox("JobQueueMaxDiskBusy", 0, 100, 5);
+    gc->setLabel(QObject::tr("Defer CPU heavy jobs above disk load (%)"));
+    gc->setHelpText(QObject::tr("Commercial detection and transcoding jobs "
+                    "will not be started while the busiest local disk is "
+                    "utilized more than this percentage of the time. "
+                    "0 disables this check."));
+    gc->setValue(0);
+    return gc;
+};
+
+static HostSpinBox *JobQueueMaxActiveRecorders()
+{
+    HostSpinBox *gc = new HostSpinBox("JobQueueMaxActiveRecorders", 0, 32, 1);
+    gc->setLabel(QObject::tr("Defer CPU heavy jobs while recording on"));
+    gc->setHelpText(QObject::tr("Commercial detection and transcoding jobs "
+                    "will not be started while at least this many tuners "
+                    "are recording on this backend. 0 disables this check."));
+    gc->setValue(0);
+    return gc;
+};
+
 static HostSpinBox *JobQueueCheckFrequency()
 {
     HostSpinBox *gc = new HostSpinBox("JobQueueCheckFrequency", 5, 300, 5);
@@ -627,6 +688,47 @@ static GlobalCheckBox *AutoCommflagWhileRecording()
     return gc;
 };
 
+static GlobalSpinBox *CommFlagLiveUpdateInterval()
+{
+    GlobalSpinBox *gc = new GlobalSpinBox("CommFlagLiveUpdateInterval",
+                                          1, 120, 1);
+    gc->setLabel(QObject::tr("Commercial break update interval while "
+                             "recording (secs)"));
+    gc->setValue(10);
+    gc->setHelpText(QObject::tr("While a recording is being flagged as it "
+                                "is recorded, the commercial breaks found "
+                                "so far are saved and sent to anyone "
+                                "watching it this often."));
+    return gc;
+};
+
+static GlobalSpinBox *CommFlagAnalysisHeight()
+{
+    GlobalSpinBox *gs = new GlobalSpinBox("CommFlagAnalysisHeight",
+                                          0, 1080, 60);
+    gs->setLabel(QObject::tr("Commercial detection frame height"));
+    gs->setValue(0);
+    gs->setHelpText(QObject::tr("If set, frames of high definition "
+                    "recordings are shrunk to about this height before "
+                    "looking for commercials, which is much faster but "
+                    "may find fewer breaks. Set to 0 to analyze full "
+                    "size frames."));
+    return gs;
+};
+
+static GlobalCheckBox *JobQueueCommFlagPreview()
+{
+    GlobalCheckBox *gc = new GlobalCheckBox("JobQueueCommFlagPreview");
+    gc->setLabel(QObject::tr("Make previews while detecting commercials"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, the commercial detection job "
+                                "makes the recording's preview image from "
+                                "the video it decodes anyway, instead of "
+                                "the recording being decoded again for it "
+                                "afterwards."));
+    return gc;
+};
+
 static GlobalLineEdit *UserJob(uint job_num)
 {
     GlobalLineEdit *gc = new GlobalLineEdit(QString("UserJob%1").arg(job_num));
@@ -956,6 +1058,28 @@ BackendSettings::BackendSettings() {
     group5->addChild(JobQueueMaxSimultaneousJobs());
     group5->addChild(JobQueueCheckFrequency());
 
+    HorizontalConfigurationGroup* group5b =
+              new HorizontalConfigurationGroup(false, false);
+    VerticalConfigurationGroup* group5b1 =
+              new VerticalConfigurationGroup(false, false);
+    group5b1->addChild(JobQueueMaxClassJobs("JobQueueMaxCommFlagJobs",
+        QObject::tr("Maximum simultaneous commercial detection jobs")));
+    group5b1->addChild(JobQueueMaxClassJobs("JobQueueMaxTranscodeJobs",
+        QObject::tr("Maximum simultaneous transcoding jobs")));
+    group5b1->addChild(JobQueueMaxClassJobs("JobQueueMaxMetadataJobs",
+        QObject::tr("Maximum simultaneous metadata lookup jobs")));
+    group5b1->addChild(JobQueueMaxClassJobs("JobQueueMaxUserJobs",
+        QObject::tr("Maximum simultaneous user jobs")));
+    group5b->addChild(group5b1);
+
+    VerticalConfigurationGroup* group5b2 =
+              new VerticalConfigurationGroup(false, false);
+    group5b2->addChild(JobQueueMaxCPULoad());
+    group5b2->addChild(JobQueueMaxDiskBusy());
+    group5b2->addChild(JobQueueMaxActiveRecorders());
+    group5b->addChild(group5b2);
+    group5->addChild(group5b);
+
     HorizontalConfigurationGroup* group5a =
               new HorizontalConfigurationGroup(false, false);
     VerticalConfigurationGroup* group5a1 =
@@ -982,10 +1106,14 @@ BackendSettings::BackendSettings() {
     group6->setLabel(QObject::tr("Job Queue (Global)"));
     group6->addChild(JobsRunOnRecordHost());
     group6->addChild(AutoCommflagWhileRecording());
+    group6->addChild(CommFlagLiveUpdateInterval());
+    group6->addChild(CommFlagAnalysisHeight());
     group6->addChild(JobQueueCommFlagCommand());
+    group6->addChild(JobQueueCommFlagPreview());
     group6->addChild(JobQueueTranscodeCommand());
     group6->addChild(AutoTranscodeBeforeAutoCommflag());
     group6->addChild(SaveTranscoding());
+    group6->addChild(HTTPLiveStreamVariants());
     addChild(group6);
 
     VerticalConfigurationGroup* group7 = new VerticalConfigurationGroup(false);